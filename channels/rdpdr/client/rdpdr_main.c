@@ -51,6 +51,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__LINUX__) || defined(__linux__)
+#include <errno.h>
+#include <poll.h>
 #endif
 
 #ifdef __MACOSX__
@@ -1075,14 +1081,50 @@ static void first_hotplug(rdpdrPlugin* rdpdr)
 	}
 }
 
+/* Returns TRUE if the mounts should be checked again, FALSE once the thread is stopped */
+static BOOL drive_hotplug_wait(rdpdrPlugin* rdpdr, int mounts)
+{
+	WINPR_ASSERT(rdpdr);
+
+#if defined(__LINUX__) || defined(__linux__)
+	/* The kernel flags /proc/self/mounts with POLLPRI whenever the mount table changes */
+	const int stop = GetEventFileDescriptor(rdpdr->stopEvent);
+	if ((mounts >= 0) && (stop >= 0))
+	{
+		struct pollfd fds[] = { { .fd = stop, .events = POLLIN, .revents = 0 },
+			                    { .fd = mounts, .events = POLLPRI, .revents = 0 } };
+
+		int rc = 0;
+		do
+		{
+			rc = poll(fds, ARRAYSIZE(fds), -1);
+		} while ((rc < 0) && (errno == EINTR));
+
+		if (rc > 0)
+			return WaitForSingleObject(rdpdr->stopEvent, 0) == WAIT_TIMEOUT;
+
+		WLog_Print(rdpdr->log, WLOG_WARN, "poll on mount table failed, falling back to polling");
+	}
+#else
+	WINPR_UNUSED(mounts);
+#endif
+
+	return WaitForSingleObject(rdpdr->stopEvent, 1000) == WAIT_TIMEOUT;
+}
+
 static DWORD WINAPI drive_hotplug_thread_func(LPVOID arg)
 {
 	rdpdrPlugin* rdpdr = (rdpdrPlugin*)arg;
+	int mounts = -1;
 
 	WINPR_ASSERT(rdpdr);
 	WINPR_ASSERT(rdpdr->stopEvent);
 
-	while (WaitForSingleObject(rdpdr->stopEvent, 1000) == WAIT_TIMEOUT)
+#if defined(__LINUX__) || defined(__linux__)
+	mounts = open("/proc/self/mounts", O_RDONLY | O_CLOEXEC);
+#endif
+
+	while (drive_hotplug_wait(rdpdr, mounts))
 	{
 		UINT error = ERROR_CALL_NOT_IMPLEMENTED;
 		if (rdpdr->context.RdpdrHotplugDevice)
@@ -1105,6 +1147,9 @@ static DWORD WINAPI drive_hotplug_thread_func(LPVOID arg)
 
 out:
 {
+	if (mounts >= 0)
+		close(mounts);
+
 	const UINT error = GetLastError();
 	if (error && rdpdr->rdpcontext)
 		setChannelError(rdpdr->rdpcontext, error, "reported an error");
@@ -493,6 +493,49 @@ static BOOL rdpei_poll_run(rdpContext* context, void* userdata)
 	return rc;
 }
 
+/* Touch contacts are repeated every frame while they are down, pen contacts only when changed */
+static BOOL rdpei_has_pending_contacts(const RDPEI_PLUGIN* rdpei)
+{
+	WINPR_ASSERT(rdpei);
+
+	for (UINT16 i = 0; i < rdpei->maxTouchContacts; i++)
+	{
+		const RDPINPUT_CONTACT_POINT* contactPoint = &rdpei->contactPoints[i];
+		if (contactPoint->dirty || contactPoint->active)
+			return TRUE;
+	}
+
+	for (UINT16 i = 0; i < rdpei->maxPenContacts; i++)
+	{
+		if (rdpei->penContactPoints[i].dirty)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Returns the time until the next frame is due or INFINITE if there is nothing to send */
+static DWORD rdpei_poll_delay(RDPEI_PLUGIN* rdpei)
+{
+	DWORD delay = INFINITE;
+
+	WINPR_ASSERT(rdpei);
+
+	EnterCriticalSection(&rdpei->lock);
+	if (rdpei_has_pending_contacts(rdpei))
+	{
+		const UINT64 now = GetTickCount64();
+		const UINT64 last = rdpei->lastPollEventTime;
+		const UINT64 elapsed = (now > last) ? now - last : 0;
+		delay = (elapsed < 20ULL) ? (DWORD)(20ULL - elapsed) : 0;
+	}
+	else
+		(void)ResetEvent(rdpei->event);
+	LeaveCriticalSection(&rdpei->lock);
+
+	return delay;
+}
+
 static DWORD WINAPI rdpei_periodic_update(LPVOID arg)
 {
 	DWORD status = 0;
@@ -516,7 +559,19 @@ static DWORD WINAPI rdpei_periodic_update(LPVOID arg)
 
 	while (rdpei->running)
 	{
-		status = WaitForSingleObject(rdpei->event, 20);
+		/* Sleep until a contact changes, only tick while contacts are down */
+		const DWORD delay = rdpei_poll_delay(rdpei);
+		if (delay == INFINITE)
+			status = WaitForSingleObject(rdpei->event, INFINITE);
+		else
+		{
+			if (delay > 0)
+				Sleep(delay);
+			status = WAIT_OBJECT_0;
+		}
+
+		if (!rdpei->running)
+			break;
 
 		if (status == WAIT_FAILED)
 		{
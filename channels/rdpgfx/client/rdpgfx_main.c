@@ -359,6 +359,52 @@ static UINT rdpgfx_send_supported_caps(GENERIC_CHANNEL_CALLBACK* callback)
 	return IFCALLRESULT(ERROR_BAD_CONFIGURATION, context->CapsAdvertise, context, &pdu);
 }
 
+static void rdpgfx_pending_frames_clear(RDPGFX_PLUGIN* gfx)
+{
+	WINPR_ASSERT(gfx);
+
+	EnterCriticalSection(&gfx->PendingFramesLock);
+	gfx->PendingFramesCount = 0;
+	LeaveCriticalSection(&gfx->PendingFramesLock);
+}
+
+static BOOL rdpgfx_pending_frame_push(RDPGFX_PLUGIN* gfx, const RDPGFX_FRAME_ACKNOWLEDGE_PDU* ack)
+{
+	BOOL rc = FALSE;
+
+	WINPR_ASSERT(gfx);
+	WINPR_ASSERT(ack);
+
+	EnterCriticalSection(&gfx->PendingFramesLock);
+	if (gfx->PendingFramesCount >= gfx->PendingFramesSize)
+	{
+		const size_t size = MAX(16, gfx->PendingFramesSize * 2);
+		RDPGFX_FRAME_ACKNOWLEDGE_PDU* tmp = (RDPGFX_FRAME_ACKNOWLEDGE_PDU*)realloc(
+		    gfx->PendingFrames, size * sizeof(RDPGFX_FRAME_ACKNOWLEDGE_PDU));
+		if (!tmp)
+			goto fail;
+		gfx->PendingFrames = tmp;
+		gfx->PendingFramesSize = size;
+	}
+
+	gfx->PendingFrames[gfx->PendingFramesCount++] = *ack;
+	rc = TRUE;
+fail:
+	LeaveCriticalSection(&gfx->PendingFramesLock);
+	return rc;
+}
+
+static void rdpgfx_pending_frame_pop(RDPGFX_PLUGIN* gfx, UINT32 frameId)
+{
+	WINPR_ASSERT(gfx);
+
+	EnterCriticalSection(&gfx->PendingFramesLock);
+	if ((gfx->PendingFramesCount > 0) &&
+	    (gfx->PendingFrames[gfx->PendingFramesCount - 1].frameId == frameId))
+		gfx->PendingFramesCount--;
+	LeaveCriticalSection(&gfx->PendingFramesLock);
+}
+
 /**
  * Function description
  *
@@ -383,6 +429,7 @@ static UINT rdpgfx_recv_caps_confirm_pdu(GENERIC_CHANNEL_CALLBACK* callback, wSt
 	Stream_Read_UINT32(s, capsSet.length);  /* capsDataLength (4 bytes) */
 	Stream_Read_UINT32(s, capsSet.flags);   /* capsData (4 bytes) */
 	gfx->TotalDecodedFrames = 0;
+	rdpgfx_pending_frames_clear(gfx);
 	gfx->ConnectionCaps = capsSet;
 	WLog_Print(gfx->log, WLOG_DEBUG,
 	           "RecvCapsConfirmPdu: version: %s [0x%08" PRIX32 "] flags: 0x%08" PRIX32 "",
@@ -1055,6 +1102,56 @@ static UINT rdpgfx_recv_delete_surface_pdu(GENERIC_CHANNEL_CALLBACK* callback, w
 	return error;
 }
 
+/**
+ * Function description
+ * Acknowledge all pending frames up to and including frameId. The queue depth reported
+ * is the number of frames waiting for presentation at the time the frame was presented,
+ * the frame itself included, so it never collides with QUEUE_DEPTH_UNAVAILABLE.
+ *
+ * @return 0 on success, otherwise a Win32 error code
+ */
+static UINT rdpgfx_frame_presented(RdpgfxClientContext* context, UINT32 frameId)
+{
+	UINT error = CHANNEL_RC_OK;
+
+	WINPR_ASSERT(context);
+	RDPGFX_PLUGIN* gfx = (RDPGFX_PLUGIN*)context->handle;
+	WINPR_ASSERT(gfx);
+
+	EnterCriticalSection(&gfx->PendingFramesLock);
+	size_t count = 0;
+	for (; count < gfx->PendingFramesCount; count++)
+	{
+		if (gfx->PendingFrames[count].frameId == frameId)
+			break;
+	}
+
+	if (count == gfx->PendingFramesCount)
+		goto fail;
+	count++;
+
+	for (size_t x = 0; x < count; x++)
+	{
+		RDPGFX_FRAME_ACKNOWLEDGE_PDU ack = gfx->PendingFrames[x];
+		ack.queueDepth = (UINT32)MIN(UINT32_MAX - 1, gfx->PendingFramesCount - x);
+
+		const UINT rc = rdpgfx_send_frame_acknowledge_pdu(context, &ack);
+		if ((rc != CHANNEL_RC_OK) && (error == CHANNEL_RC_OK))
+		{
+			WLog_Print(gfx->log, WLOG_ERROR,
+			           "rdpgfx_send_frame_acknowledge_pdu failed with error %" PRIu32 "", rc);
+			error = rc;
+		}
+	}
+
+	gfx->PendingFramesCount -= count;
+	memmove(gfx->PendingFrames, &gfx->PendingFrames[count],
+	        gfx->PendingFramesCount * sizeof(RDPGFX_FRAME_ACKNOWLEDGE_PDU));
+fail:
+	LeaveCriticalSection(&gfx->PendingFramesLock);
+	return error;
+}
+
 /**
  * Function description
  *
@@ -1112,6 +1209,20 @@ static UINT rdpgfx_recv_end_frame_pdu(GENERIC_CHANNEL_CALLBACK* callback, wStrea
 	Stream_Read_UINT32(s, pdu.frameId); /* frameId (4 bytes) */
 	DEBUG_RDPGFX(gfx->log, "RecvEndFramePdu: frameId: %" PRIu32 "", pdu.frameId);
 
+	const BOOL deferAck = context && context->DeferFrameAcknowledge && gfx->sendFrameAcks &&
+	                      !gfx->suspendFrameAcks;
+
+	/* Queue the frame before EndFrame, the client may present it from within the callback */
+	if (deferAck)
+	{
+		RDPGFX_FRAME_ACKNOWLEDGE_PDU pending = { 0 };
+		pending.frameId = pdu.frameId;
+		pending.totalFramesDecoded = gfx->TotalDecodedFrames + 1;
+
+		if (!rdpgfx_pending_frame_push(gfx, &pending))
+			return CHANNEL_RC_NO_MEMORY;
+	}
+
 	const UINT64 start = GetTickCount64();
 	if (context)
 	{
@@ -1121,6 +1232,9 @@ static UINT rdpgfx_recv_end_frame_pdu(GENERIC_CHANNEL_CALLBACK* callback, wStrea
 		{
 			WLog_Print(gfx->log, WLOG_ERROR, "context->EndFrame failed with error %" PRIu32 "",
 			           error);
+			/* the frame is never presented, it must not hold back later frames */
+			if (deferAck)
+				rdpgfx_pending_frame_pop(gfx, pdu.frameId);
 			return error;
 		}
 	}
@@ -1134,7 +1248,11 @@ static UINT rdpgfx_recv_end_frame_pdu(GENERIC_CHANNEL_CALLBACK* callback, wStrea
 	ack.frameId = pdu.frameId;
 	ack.totalFramesDecoded = gfx->TotalDecodedFrames;
 
-	if (gfx->suspendFrameAcks)
+	if (deferAck)
+	{
+		/* acknowledged by FramePresented */
+	}
+	else if (gfx->suspendFrameAcks)
 	{
 		ack.queueDepth = SUSPEND_FRAME_ACKNOWLEDGEMENT;
 
@@ -2116,6 +2234,13 @@ static UINT rdpgfx_on_close(IWTSVirtualChannelCallback* pChannelCallback)
 	free_surfaces(context, gfx->SurfaceTable);
 	evict_cache_slots(context, gfx->MaxCacheSlots, gfx->CacheSlots);
 
+	/* FramePresented is called from the render thread, it must not send on the closed channel */
+	EnterCriticalSection(&gfx->PendingFramesLock);
+	gfx->PendingFramesCount = 0;
+	if (gfx->base.listener_callback && (gfx->base.listener_callback->channel_callback == callback))
+		gfx->base.listener_callback->channel_callback = NULL;
+	LeaveCriticalSection(&gfx->PendingFramesLock);
+
 	free(callback);
 	gfx->UnacknowledgedFrames = 0;
 	gfx->TotalDecodedFrames = 0;
@@ -2301,6 +2426,8 @@ static UINT init_plugin_cb(GENERIC_DYNVC_PLUGIN* base, rdpContext* rcontext,
 		return CHANNEL_RC_NO_MEMORY;
 	}
 
+	InitializeCriticalSection(&gfx->PendingFramesLock);
+
 	context->handle = (void*)gfx;
 	context->GetSurfaceIds = rdpgfx_get_surface_ids;
 	context->SetSurfaceData = rdpgfx_set_surface_data;
@@ -2311,6 +2438,7 @@ static UINT init_plugin_cb(GENERIC_DYNVC_PLUGIN* base, rdpContext* rcontext,
 	context->FrameAcknowledge = rdpgfx_send_frame_acknowledge_pdu;
 	context->CacheImportOffer = rdpgfx_send_cache_import_offer_pdu;
 	context->QoeFrameAcknowledge = rdpgfx_send_qoe_frame_acknowledge_pdu;
+	context->FramePresented = rdpgfx_frame_presented;
 
 	gfx->base.iface.pInterface = (void*)context;
 	gfx->context = context;
@@ -2337,6 +2465,11 @@ void rdpgfx_client_context_free(RdpgfxClientContext* context)
 	}
 
 	HashTable_Free(gfx->SurfaceTable);
+	DeleteCriticalSection(&gfx->PendingFramesLock);
+	free(gfx->PendingFrames);
+	gfx->PendingFrames = NULL;
+	gfx->PendingFramesCount = 0;
+	gfx->PendingFramesSize = 0;
 	free(context);
 }
 
@@ -45,6 +45,11 @@ typedef struct
 	BOOL suspendFrameAcks;
 	BOOL sendFrameAcks;
 
+	CRITICAL_SECTION PendingFramesLock;
+	RDPGFX_FRAME_ACKNOWLEDGE_PDU* PendingFrames;
+	size_t PendingFramesCount;
+	size_t PendingFramesSize;
+
 	wHashTable* SurfaceTable;
 
 	UINT16 MaxCacheSlots;
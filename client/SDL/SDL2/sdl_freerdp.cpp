@@ -1329,7 +1329,8 @@ static int sdl_client_thread_run(SdlContext* sdl, std::string& error_msg)
 		if (status == WAIT_FAILED)
 			break;
 
-		if (!freerdp_check_event_handles(context))
+		const UINT32 sources = freerdp_get_ready_event_sources(context, handles, nCount, status);
+		if (!freerdp_check_event_sources(context, sources))
 		{
 			if (client_auto_reconnect(instance))
 			{
@@ -24,6 +24,7 @@
 #include <freerdp/client/rail.h>
 #include <freerdp/client/cliprdr.h>
 #include <freerdp/client/disp.h>
+#include <freerdp/client/rdpgfx.h>
 
 #include "sdl_channels.hpp"
 #include "sdl_freerdp.hpp"
@@ -51,6 +52,15 @@ void sdl_OnChannelConnectedEventHandler(void* context, const ChannelConnectedEve
 		WINPR_ASSERT(disp);
 		(void)sdl->disp.init(disp);
 	}
+	else if (strcmp(e->name, RDPGFX_DVC_CHANNEL_NAME) == 0)
+	{
+		freerdp_client_OnChannelConnectedEventHandler(context, e);
+
+		/* frames are drawn by the main thread, acknowledge them after presentation */
+		auto gfx = reinterpret_cast<RdpgfxClientContext*>(e->pInterface);
+		WINPR_ASSERT(gfx);
+		gfx->DeferFrameAcknowledge = TRUE;
+	}
 	else
 		freerdp_client_OnChannelConnectedEventHandler(context, e);
 }
@@ -17,6 +17,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <mutex>
@@ -365,6 +366,18 @@ static BOOL sdl_draw_to_window(SdlContext* sdl, std::map<Uint32, SdlWindow>& win
 	return TRUE;
 }
 
+/* If the event is lost the damage stays pending, the next frame must post again */
+static BOOL sdl_post_update(SdlContext* sdl)
+{
+	WINPR_ASSERT(sdl);
+
+	if (sdl_push_user_event(SDL_EVENT_USER_UPDATE))
+		return TRUE;
+
+	sdl->unpost();
+	return FALSE;
+}
+
 /* This function is called when the library completed composing a new
  * frame. Read out the changed areas and blit them to your output device.
  * The image buffer will have the format specified by gdi_init
@@ -380,14 +393,23 @@ static BOOL sdl_end_paint(rdpContext* context)
 	WINPR_ASSERT(gdi->primary->hdc);
 	WINPR_ASSERT(gdi->primary->hdc->hwnd);
 	WINPR_ASSERT(gdi->primary->hdc->hwnd->invalid);
-	if (gdi->suppressOutput || gdi->primary->hdc->hwnd->invalid->null)
-		return TRUE;
+
+	/* gfx frames are acknowledged once the main thread drew them */
+	const int64_t frameId = gdi->inGfxFrame ? gdi->frameId : -1;
 
 	const INT32 ninvalid = gdi->primary->hdc->hwnd->ninvalid;
 	const GDI_RGN* cinvalid = gdi->primary->hdc->hwnd->cinvalid;
 
-	if (ninvalid < 1)
-		return TRUE;
+	if (gdi->suppressOutput || gdi->primary->hdc->hwnd->invalid->null || (ninvalid < 1))
+	{
+		if ((frameId < 0) || !gdi->gfx || !gdi->gfx->DeferFrameAcknowledge)
+			return TRUE;
+
+		/* nothing to draw, but acknowledge the frame together with the pending damage */
+		if (!sdl->push({}, frameId))
+			return TRUE;
+		return sdl_post_update(sdl);
+	}
 
 	std::vector<SDL_Rect> rects;
 	for (INT32 x = 0; x < ninvalid; x++)
@@ -396,8 +418,29 @@ static BOOL sdl_end_paint(rdpContext* context)
 		rects.push_back({ rgn.x, rgn.y, rgn.w, rgn.h });
 	}
 
-	sdl->push(std::move(rects));
-	return sdl_push_user_event(SDL_EVENT_USER_UPDATE);
+	/* the render thread draws the damage of all frames since its last update at once,
+	 * so there is never more than one update event outstanding */
+	if (!sdl->push(std::move(rects), frameId))
+		return TRUE;
+	return sdl_post_update(sdl);
+}
+
+static void sdl_frame_presented(SdlContext* sdl, int64_t frameId)
+{
+	WINPR_ASSERT(sdl);
+
+	if (frameId < 0)
+		return;
+
+	auto gdi = sdl->context()->gdi;
+	if (!gdi || !gdi->gfx)
+		return;
+
+	auto gfx = gdi->gfx;
+	const auto rc =
+	    IFCALLRESULT(CHANNEL_RC_OK, gfx->FramePresented, gfx, static_cast<UINT32>(frameId));
+	if (rc != CHANNEL_RC_OK)
+		WLog_Print(sdl->log, WLOG_WARN, "FramePresented failed with %" PRIu32, rc);
 }
 
 static void sdl_destroy_primary(SdlContext* sdl)
@@ -900,12 +943,11 @@ static int sdl_run(SdlContext* sdl)
 				break;
 				case SDL_EVENT_USER_UPDATE:
 				{
-					std::vector<SDL_Rect> rectangles;
-					do
-					{
-						rectangles = sdl->pop();
+					int64_t frameId = -1;
+					const auto rectangles = sdl->pop(frameId);
+					if (!rectangles.empty())
 						sdl_draw_to_window(sdl, sdl->windows, rectangles);
-					} while (!rectangles.empty());
+					sdl_frame_presented(sdl, frameId);
 				}
 				break;
 				case SDL_EVENT_USER_CREATE_WINDOWS:
@@ -1329,7 +1371,8 @@ static int sdl_client_thread_run(SdlContext* sdl, std::string& error_msg)
 		if (status == WAIT_FAILED)
 			break;
 
-		if (!freerdp_check_event_handles(context))
+		const UINT32 sources = freerdp_get_ready_event_sources(context, handles, nCount, status);
+		if (!freerdp_check_event_sources(context, sources))
 		{
 			if (client_auto_reconnect(instance))
 			{
@@ -1827,20 +1870,66 @@ int64_t SdlContext::monitorId(uint32_t index) const
 	return _monitorIds[index];
 }
 
-void SdlContext::push(std::vector<SDL_Rect>&& rects)
+static bool sdl_rect_contains(const SDL_Rect& outer, const SDL_Rect& inner)
 {
-	std::unique_lock lock(_queue_mux);
-	_queue.emplace(std::move(rects));
+	return (inner.x >= outer.x) && (inner.y >= outer.y) &&
+	       (inner.x + inner.w <= outer.x + outer.w) && (inner.y + inner.h <= outer.y + outer.h);
 }
 
-std::vector<SDL_Rect> SdlContext::pop()
+bool SdlContext::push(std::vector<SDL_Rect>&& rects, int64_t frameId)
 {
-	std::unique_lock lock(_queue_mux);
-	if (_queue.empty())
+	/* beyond this the pending damage is replaced by its bounding box */
+	const size_t maxDamageRects = 64;
+
+	std::unique_lock lock(_damage_mux);
+	if (_damage.empty())
+		_damage = std::move(rects);
+	else
+	{
+		for (const auto& rect : rects)
+		{
+			if (std::any_of(_damage.begin(), _damage.end(), [&](const SDL_Rect& cur)
+			                { return sdl_rect_contains(cur, rect); }))
+				continue;
+
+			_damage.erase(std::remove_if(_damage.begin(), _damage.end(),
+			                             [&](const SDL_Rect& cur)
+			                             { return sdl_rect_contains(rect, cur); }),
+			              _damage.end());
+			_damage.push_back(rect);
+		}
+	}
+
+	if (_damage.size() > maxDamageRects)
 	{
-		return {};
+		SDL_Rect bounds = _damage.front();
+		for (const auto& rect : _damage)
+			SDL_GetRectUnion(&bounds, &rect, &bounds);
+		_damage = { bounds };
 	}
-	auto val = std::move(_queue.front());
-	_queue.pop();
-	return val;
+
+	if (frameId >= 0)
+		_damageFrameId = frameId;
+
+	const bool post = !_damagePosted;
+	_damagePosted = true;
+	return post;
+}
+
+std::vector<SDL_Rect> SdlContext::pop(int64_t& frameId)
+{
+	std::unique_lock lock(_damage_mux);
+	frameId = _damageFrameId;
+	_damageFrameId = -1;
+	_damagePosted = false;
+
+	std::vector<SDL_Rect> damage;
+	damage.swap(_damage);
+	return damage;
+}
+
+void SdlContext::unpost()
+{
+	std::unique_lock lock(_damage_mux);
+	_damagePosted = false;
 }
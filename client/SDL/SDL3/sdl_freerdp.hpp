@@ -23,7 +23,6 @@
 #include <thread>
 #include <map>
 #include <atomic>
-#include <queue>
 #include <mutex>
 
 #include <freerdp/freerdp.h>
@@ -75,8 +74,14 @@ class SdlContext
 	const std::vector<SDL_DisplayID>& monitorIds() const;
 	int64_t monitorId(uint32_t index) const;
 
-	void push(std::vector<SDL_Rect>&& rects);
-	std::vector<SDL_Rect> pop();
+	/* merges the damage of a frame into the pending damage,
+	 * returns true if no update event is outstanding and one needs to be posted */
+	[[nodiscard]] bool push(std::vector<SDL_Rect>&& rects, int64_t frameId = -1);
+	/* takes all pending damage and the id of the newest frame it contains */
+	std::vector<SDL_Rect> pop(int64_t& frameId);
+	/* forgets the outstanding update event after posting it failed,
+	 * the pending damage is kept and the next push posts again */
+	void unpost();
 
 	void setHasCursor(bool val);
 	[[nodiscard]] bool hasCursor() const;
@@ -87,8 +92,10 @@ class SdlContext
 	bool _cursor_visible = true;
 	rdpPointer* _cursor = nullptr;
 	std::vector<SDL_DisplayID> _monitorIds;
-	std::mutex _queue_mux;
-	std::queue<std::vector<SDL_Rect>> _queue;
+	std::mutex _damage_mux;
+	std::vector<SDL_Rect> _damage;
+	int64_t _damageFrameId = -1;
+	bool _damagePosted = false;
 
   public:
 	wLog* log;
@@ -0,0 +1,319 @@
+
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/crypto.h>
+
+#include <freerdp/codec/color.h>
+
+#include "../xf_gfx.h"
+
+#define TEST_WIDTH 64
+#define TEST_HEIGHT 48
+
+typedef struct
+{
+	UINT32 width;
+	UINT32 height;
+} test_size;
+
+/* upscales, bilinear downscale, box filter downscale and a box filter on one axis only */
+static const test_size test_sizes[] = {
+	{ 128, 96 }, { 232, 170 }, { 40, 30 }, { 21, 16 }, { 16, 48 }
+};
+
+static BOOL test_surface_init(xfGfxSurface* surface)
+{
+	surface->gdi.format = PIXEL_FORMAT_BGRX32;
+	surface->gdi.mappedWidth = TEST_WIDTH;
+	surface->gdi.mappedHeight = TEST_HEIGHT;
+	surface->gdi.scanline = TEST_WIDTH * 4;
+	surface->gdi.data = winpr_aligned_calloc(TEST_HEIGHT, surface->gdi.scanline, 16);
+	return surface->gdi.data != NULL;
+}
+
+/* A gradient, linear in x and y, so that the filter results can be computed */
+static void test_fill_gradient(xfGfxSurface* surface)
+{
+	for (UINT32 y = 0; y < TEST_HEIGHT; y++)
+	{
+		BYTE* line = &surface->gdi.data[1ull * y * surface->gdi.scanline];
+		for (UINT32 x = 0; x < TEST_WIDTH; x++)
+		{
+			const UINT32 color = FreeRDPGetColor(surface->gdi.format, (BYTE)((x + y) * 2),
+			                                     (BYTE)(y * 5), (BYTE)(x * 4), 0xFF);
+			(void)FreeRDPWriteColor(&line[4ull * x], surface->gdi.format, color);
+		}
+	}
+}
+
+/* The source position the center of a destination pixel maps to */
+static double test_position(UINT32 dst, UINT32 dstSize, UINT32 srcSize)
+{
+	const double pos = (dst + 0.5) * srcSize / dstSize - 0.5;
+	return MIN(MAX(pos, 0.0), srcSize - 1.0);
+}
+
+static BOOL test_scale(xfGfxSurface* surface, const test_size* size, UINT32 DstFormat)
+{
+	const RECTANGLE_16 rect = { 0, 0, (UINT16)size->width, (UINT16)size->height };
+
+	if (!xf_gfx_scaled_alloc(surface, size->width, size->height, DstFormat, 32))
+		return FALSE;
+	return xf_gfx_scale_rect(surface, DstFormat, &rect);
+}
+
+/* Blue, green and red of a pixel */
+static void test_read_pixel(const BYTE* data, UINT32 format, BYTE bgr[3])
+{
+	const UINT32 color = FreeRDPReadColor(data, format);
+	FreeRDPSplitColor(color, format, &bgr[2], &bgr[1], &bgr[0], NULL, NULL);
+}
+
+static void test_scaled_pixel(const xfGfxSurface* surface, UINT32 x, UINT32 y, BYTE bgr[3])
+{
+	const BYTE* line = &surface->scaled[1ull * y * surface->scaledScanline];
+	test_read_pixel(&line[4ull * x], PIXEL_FORMAT_BGRX32, bgr);
+}
+
+/* The scaled gradient must match the gradient at the mapped positions */
+static BOOL test_gradient(xfGfxSurface* surface, const test_size* size)
+{
+	test_fill_gradient(surface);
+	if (!test_scale(surface, size, PIXEL_FORMAT_BGRX32))
+		return FALSE;
+
+	for (UINT32 y = 0; y < size->height; y++)
+	{
+		const double py = test_position(y, size->height, TEST_HEIGHT);
+		for (UINT32 x = 0; x < size->width; x++)
+		{
+			const double px = test_position(x, size->width, TEST_WIDTH);
+			const double expected[] = { px * 4.0, py * 5.0, (px + py) * 2.0 };
+			BYTE bgr[3] = { 0 };
+			test_scaled_pixel(surface, x, y, bgr);
+
+			for (size_t c = 0; c < ARRAYSIZE(expected); c++)
+			{
+				if (fabs(bgr[c] - expected[c]) > 4.0)
+				{
+					printf("gradient %" PRIu32 "x%" PRIu32 " pixel %" PRIu32 "x%" PRIu32
+					       " channel %" PRIuz ": %" PRIu8 " != %f\n",
+					       size->width, size->height, x, y, c, bgr[c], expected[c]);
+					return FALSE;
+				}
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+/* Compare with freerdp_image_scale, if the build has swscale or cairo to scale with */
+static BOOL test_image_scale(xfGfxSurface* surface, const test_size* size)
+{
+	BOOL rc = FALSE;
+	const UINT32 step = size->width * 4;
+	BYTE* ref = winpr_aligned_calloc(size->height, step, 16);
+	if (!ref)
+		return FALSE;
+
+	test_fill_gradient(surface);
+	if (!freerdp_image_scale(ref, PIXEL_FORMAT_BGRX32, step, 0, 0, size->width, size->height,
+	                         surface->gdi.data, surface->gdi.format, surface->gdi.scanline, 0, 0,
+	                         TEST_WIDTH, TEST_HEIGHT))
+	{
+		rc = TRUE;
+		goto fail;
+	}
+
+	if (!test_scale(surface, size, PIXEL_FORMAT_BGRX32))
+		goto fail;
+
+	for (UINT32 y = 0; y < size->height; y++)
+	{
+		for (UINT32 x = 0; x < size->width; x++)
+		{
+			BYTE a[3] = { 0 };
+			BYTE b[3] = { 0 };
+			test_scaled_pixel(surface, x, y, a);
+			test_read_pixel(&ref[1ull * y * step + 4ull * x], PIXEL_FORMAT_BGRX32, b);
+
+			for (size_t c = 0; c < ARRAYSIZE(a); c++)
+			{
+				if (abs(a[c] - b[c]) > 8)
+					goto fail;
+			}
+		}
+	}
+
+	rc = TRUE;
+fail:
+	winpr_aligned_free(ref);
+	return rc;
+}
+
+/* The cached scaler of a surface must match freerdp_image_scale in the damaged rectangles */
+static BOOL test_scaler(xfGfxSurface* surface, const test_size* size)
+{
+	BOOL rc = FALSE;
+	const UINT32 step = size->width * 4;
+	const RECTANGLE_16 damage[] = { { 0, 0, (UINT16)(size->width / 2), 4 },
+		                            { 1, (UINT16)(size->height / 2), (UINT16)size->width,
+		                              (UINT16)size->height } };
+	BYTE* ref = winpr_aligned_calloc(size->height, step, 16);
+	if (!ref)
+		return FALSE;
+
+	if (!xf_gfx_scaled_alloc(surface, size->width, size->height, PIXEL_FORMAT_BGRX32, 32))
+		goto fail;
+
+	for (size_t round = 0; round < 2; round++)
+	{
+		if (winpr_RAND(surface->gdi.data, 1ull * TEST_HEIGHT * surface->gdi.scanline) < 0)
+			goto fail;
+
+		const BOOL scaled = freerdp_image_scale(
+		    ref, PIXEL_FORMAT_BGRX32, step, 0, 0, size->width, size->height, surface->gdi.data,
+		    surface->gdi.format, surface->gdi.scanline, 0, 0, TEST_WIDTH, TEST_HEIGHT);
+
+		/* without a scaling library both fail and the built-in scaler is used */
+		if (!surface->scaler)
+		{
+			rc = !scaled;
+			goto fail;
+		}
+
+		/* the context is reused for every update of the surface */
+		if (!scaled || !freerdp_image_scaler_scale(surface->scaler, surface->scaled,
+		                                           surface->scaledScanline, surface->gdi.data,
+		                                           surface->gdi.scanline, damage,
+		                                           ARRAYSIZE(damage)))
+			goto fail;
+
+		for (size_t x = 0; x < ARRAYSIZE(damage); x++)
+		{
+			const RECTANGLE_16* rect = &damage[x];
+			for (UINT32 y = rect->top; y < rect->bottom; y++)
+			{
+				if (memcmp(&surface->scaled[1ull * y * surface->scaledScanline + 4ull * rect->left],
+				           &ref[1ull * y * step + 4ull * rect->left],
+				           4ull * (rect->right - rect->left)) != 0)
+					goto fail;
+			}
+		}
+	}
+
+	rc = TRUE;
+fail:
+	winpr_aligned_free(ref);
+	return rc;
+}
+
+/* Scaling only the damage of a changed surface must give the same result as scaling it all */
+static BOOL test_damage(xfGfxSurface* surface, const test_size* size, UINT32 DstFormat)
+{
+	BOOL rc = FALSE;
+	xfGfxSurface full = { 0 };
+	full.gdi = surface->gdi;
+
+	if (winpr_RAND(surface->gdi.data, 1ull * TEST_HEIGHT * surface->gdi.scanline) < 0)
+		return FALSE;
+	if (!test_scale(surface, size, DstFormat))
+		return FALSE;
+
+	for (size_t round = 0; round < 16; round++)
+	{
+		BYTE tmp[4] = { 0 };
+		if (winpr_RAND(tmp, sizeof(tmp)) < 0)
+			goto fail;
+
+		RECTANGLE_16 rect = { 0 };
+		rect.left = tmp[0] % TEST_WIDTH;
+		rect.top = tmp[1] % TEST_HEIGHT;
+		rect.right = (UINT16)MIN(TEST_WIDTH, rect.left + 1 + tmp[2] % 8);
+		rect.bottom = (UINT16)MIN(TEST_HEIGHT, rect.top + 1 + tmp[3] % 8);
+
+		for (UINT32 y = rect.top; y < rect.bottom; y++)
+		{
+			BYTE* line = &surface->gdi.data[1ull * y * surface->gdi.scanline];
+			if (winpr_RAND(&line[4ull * rect.left], 4ull * (rect.right - rect.left)) < 0)
+				goto fail;
+		}
+
+		RECTANGLE_16 dst = { 0 };
+		xf_gfx_scale_damage(surface, &rect, &dst);
+		if ((dst.left < dst.right) && (dst.top < dst.bottom) &&
+		    !xf_gfx_scale_rect(surface, DstFormat, &dst))
+			goto fail;
+
+		if (!test_scale(&full, size, DstFormat))
+			goto fail;
+
+		for (UINT32 y = 0; y < size->height; y++)
+		{
+			if (memcmp(&surface->scaled[1ull * y * surface->scaledScanline],
+			           &full.scaled[1ull * y * full.scaledScanline], 4ull * size->width) != 0)
+			{
+				printf("damage %" PRIu16 "x%" PRIu16 "-%" PRIu16 "x%" PRIu16
+				       " not covered at %" PRIu32 "x%" PRIu32 " line %" PRIu32 "\n",
+				       rect.left, rect.top, rect.right, rect.bottom, size->width, size->height,
+				       y);
+				goto fail;
+			}
+		}
+	}
+
+	rc = TRUE;
+fail:
+	xf_gfx_scaled_free(&full);
+	return rc;
+}
+
+int TestX11GfxScale(int argc, char* argv[])
+{
+	int rc = -1;
+	xfGfxSurface surface = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	if (!test_surface_init(&surface))
+		goto fail;
+
+	for (size_t x = 0; x < ARRAYSIZE(test_sizes); x++)
+	{
+		const test_size* size = &test_sizes[x];
+
+		if (!test_gradient(&surface, size))
+		{
+			printf("TestX11GfxScale: scaled gradient does not match\n");
+			goto fail;
+		}
+
+		if (!test_image_scale(&surface, size))
+		{
+			printf("TestX11GfxScale: result differs from freerdp_image_scale\n");
+			goto fail;
+		}
+
+		if (!test_scaler(&surface, size))
+		{
+			printf("TestX11GfxScale: scaler differs from freerdp_image_scale\n");
+			goto fail;
+		}
+
+		if (!test_damage(&surface, size, PIXEL_FORMAT_BGRX32) ||
+		    !test_damage(&surface, size, PIXEL_FORMAT_RGBX32))
+		{
+			printf("TestX11GfxScale: scaled damage does not match the scaled surface\n");
+			goto fail;
+		}
+	}
+
+	rc = 0;
+fail:
+	xf_gfx_scaled_free(&surface);
+	winpr_aligned_free(surface.gdi.data);
+	return rc;
+}
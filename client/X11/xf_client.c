@@ -1644,7 +1644,9 @@ static DWORD WINAPI xf_client_thread(LPVOID param)
 			break;
 
 		{
-			if (!freerdp_check_event_handles(context))
+			const UINT32 sources =
+			    freerdp_get_ready_event_sources(context, handles, nCount, waitStatus);
+			if (!freerdp_check_event_sources(context, sources))
 			{
 				if (client_auto_reconnect_ex(instance, handle_window_events))
 					continue;
@@ -35,6 +35,300 @@
 
 #define TAG CLIENT_TAG("x11")
 
+static UINT32 x11_pad_scanline(UINT32 scanline, UINT32 inPad)
+{
+	/* Ensure X11 alignment is met */
+	if (inPad > 0)
+	{
+		const UINT32 align = inPad / 8;
+		const UINT32 pad = align - scanline % align;
+
+		if (align != pad)
+			scanline += pad;
+	}
+
+	/* 16 byte alignment is required for ASM optimized code */
+	if (scanline % 16)
+		scanline += 16 - scanline % 16;
+
+	return scanline;
+}
+
+void xf_gfx_scaled_free(xfGfxSurface* surface)
+{
+	WINPR_ASSERT(surface);
+
+	if (surface->scaledImage)
+	{
+		surface->scaledImage->data = NULL;
+		XDestroyImage(surface->scaledImage);
+	}
+	freerdp_image_scaler_free(surface->scaler);
+	winpr_aligned_free(surface->scaled);
+	winpr_aligned_free(surface->scaledLine);
+	free(surface->scaledColumns);
+
+	surface->scaler = NULL;
+	surface->scaledImage = NULL;
+	surface->scaled = NULL;
+	surface->scaledLine = NULL;
+	surface->scaledColumns = NULL;
+	surface->scaledWidth = 0;
+	surface->scaledHeight = 0;
+}
+
+/* Bilinear filtering skips source pixels when downscaling by more than 2, average them instead */
+static BOOL xf_gfx_scale_is_box(UINT32 dstSize, UINT32 srcSize)
+{
+	return srcSize > 2ull * dstSize;
+}
+
+/* Source pixels and weight (8 bit fixed point) for filtering of a destination pixel */
+static xfGfxScaleTap xf_gfx_scale_tap(UINT32 dst, UINT32 dstSize, UINT32 srcSize)
+{
+	xfGfxScaleTap tap = { 0 };
+
+	WINPR_ASSERT(dstSize > 0);
+	WINPR_ASSERT(srcSize > 0);
+
+	if (xf_gfx_scale_is_box(dstSize, srcSize))
+	{
+		/* all source pixels the destination pixel covers */
+		tap.box = TRUE;
+		tap.x0 = (UINT32)((1ull * dst * srcSize) / dstSize);
+		tap.x1 = (UINT32)((1ull * (dst + 1) * srcSize + dstSize - 1) / dstSize);
+		tap.x1 = MIN(MAX(tap.x1, tap.x0 + 1), srcSize);
+		return tap;
+	}
+
+	/* position of the destination pixel center in the source */
+	const INT64 pos = ((2ll * dst + 1ll) * srcSize * 256ll) / (2ll * dstSize) - 128ll;
+	if (pos > 0)
+	{
+		tap.x0 = (UINT32)(pos >> 8);
+		tap.weight = (UINT32)(pos & 0xFF);
+	}
+
+	if (tap.x0 >= srcSize - 1)
+	{
+		tap.x0 = srcSize - 1;
+		tap.weight = 0;
+	}
+	tap.x1 = MIN(tap.x0 + 1, srcSize - 1);
+	return tap;
+}
+
+/* Range of destination pixels the filter taps of the source pixels [start, end) reach */
+static void xf_gfx_scale_span(UINT32 start, UINT32 end, UINT32 srcSize, UINT32 dstSize,
+                              UINT16* pStart, UINT16* pEnd)
+{
+	const double scale = 1.0 * dstSize / srcSize;
+	/* the bilinear taps reach half a source pixel to both sides, which grows with the scale */
+	const double reach = xf_gfx_scale_is_box(dstSize, srcSize) ? 0.0 : 0.5;
+	/* and one more pixel for the rounding of the fixed point positions */
+	const double first = floor((start - reach) * scale - reach) - 1.0;
+	const double last = ceil((end + reach) * scale - reach) + 1.0;
+
+	*pStart = (UINT16)MAX(0.0, first);
+	*pEnd = (UINT16)MIN(dstSize, last);
+}
+
+void xf_gfx_scale_damage(const xfGfxSurface* surface, const RECTANGLE_16* rect, RECTANGLE_16* dst)
+{
+	WINPR_ASSERT(surface);
+	WINPR_ASSERT(rect);
+	WINPR_ASSERT(dst);
+
+	xf_gfx_scale_span(rect->left, rect->right, surface->gdi.mappedWidth, surface->scaledWidth,
+	                  &dst->left, &dst->right);
+	xf_gfx_scale_span(rect->top, rect->bottom, surface->gdi.mappedHeight, surface->scaledHeight,
+	                  &dst->top, &dst->bottom);
+}
+
+/* Interpolates all four channels of two 32bpp pixels at once */
+static inline UINT32 xf_gfx_lerp(UINT32 a, UINT32 b, UINT32 weight)
+{
+	const UINT32 inv = 256 - weight;
+	const UINT32 rb = (((a & 0x00FF00FF) * inv + (b & 0x00FF00FF) * weight) >> 8) & 0x00FF00FF;
+	const UINT32 ag =
+	    (((a >> 8) & 0x00FF00FF) * inv + ((b >> 8) & 0x00FF00FF) * weight) & 0xFF00FF00;
+	return rb | ag;
+}
+
+/* Number of source pixels a tap reads and the weight of the n-th one */
+static inline UINT32 xf_gfx_tap_count(const xfGfxScaleTap* tap)
+{
+	return tap->box ? tap->x1 - tap->x0 : 2;
+}
+
+static inline UINT32 xf_gfx_tap_pixel(const xfGfxScaleTap* tap, UINT32 n)
+{
+	if (tap->box)
+		return tap->x0 + n;
+	return (n == 0) ? tap->x0 : tap->x1;
+}
+
+static inline UINT32 xf_gfx_tap_weight(const xfGfxScaleTap* tap, UINT32 n)
+{
+	if (tap->box)
+		return 1;
+	return (n == 0) ? 256 - tap->weight : tap->weight;
+}
+
+/* Weighted average of all source pixels the row and column taps read, if any of them is a box */
+static UINT32 xf_gfx_filter(const xfGfxSurface* surface, const xfGfxScaleTap* row,
+                            const xfGfxScaleTap* col)
+{
+	UINT32 sum[4] = { 0 };
+	UINT32 total = 0;
+
+	for (UINT32 y = 0; y < xf_gfx_tap_count(row); y++)
+	{
+		const UINT32 wy = xf_gfx_tap_weight(row, y);
+		const UINT32* src =
+		    (const UINT32*)&surface->gdi.data[1ull * xf_gfx_tap_pixel(row, y) *
+		                                      surface->gdi.scanline];
+
+		for (UINT32 x = 0; x < xf_gfx_tap_count(col); x++)
+		{
+			const UINT32 w = wy * xf_gfx_tap_weight(col, x);
+			const UINT32 pixel = src[xf_gfx_tap_pixel(col, x)];
+
+			for (size_t c = 0; c < ARRAYSIZE(sum); c++)
+				sum[c] += ((pixel >> (8 * c)) & 0xFF) * w;
+			total += w;
+		}
+	}
+
+	UINT32 result = 0;
+	for (size_t c = 0; c < ARRAYSIZE(sum); c++)
+		result |= ((sum[c] + total / 2) / total) << (8 * c);
+	return result;
+}
+
+BOOL xf_gfx_scaled_alloc(xfGfxSurface* surface, UINT32 width, UINT32 height, UINT32 DstFormat,
+                         UINT32 scanlinePad)
+{
+	WINPR_ASSERT(surface);
+
+	xf_gfx_scaled_free(surface);
+	if ((width == 0) || (height == 0))
+		return FALSE;
+
+	surface->scaledScanline =
+	    x11_pad_scanline(width * FreeRDPGetBytesPerPixel(DstFormat), scanlinePad);
+	surface->scaled = winpr_aligned_calloc(height, surface->scaledScanline, 16);
+	surface->scaledLine = winpr_aligned_calloc(width, sizeof(UINT32), 16);
+	surface->scaledColumns = calloc(width, sizeof(xfGfxScaleTap));
+
+	if (!surface->scaled || !surface->scaledLine || !surface->scaledColumns)
+	{
+		WLog_ERR(TAG, "unable to allocate scaled output buffer");
+		xf_gfx_scaled_free(surface);
+		return FALSE;
+	}
+
+	for (UINT32 x = 0; x < width; x++)
+		surface->scaledColumns[x] = xf_gfx_scale_tap(x, width, surface->gdi.mappedWidth);
+
+	/* one scaling context per surface and output size, NULL selects the built-in scaler */
+	surface->scaler =
+	    freerdp_image_scaler_new(DstFormat, width, height, surface->gdi.format,
+	                             surface->gdi.mappedWidth, surface->gdi.mappedHeight);
+
+	surface->scaledWidth = width;
+	surface->scaledHeight = height;
+	return TRUE;
+}
+
+static BOOL xf_gfx_scaled_update(xfContext* xfc, xfGfxSurface* surface)
+{
+	WINPR_ASSERT(xfc);
+	WINPR_ASSERT(surface);
+
+	const UINT32 width = surface->gdi.outputTargetWidth;
+	const UINT32 height = surface->gdi.outputTargetHeight;
+
+	if (surface->scaledImage && (surface->scaledWidth == width) &&
+	    (surface->scaledHeight == height))
+		return TRUE;
+
+	rdpGdi* gdi = xfc->common.context.gdi;
+	WINPR_ASSERT(gdi);
+
+	if (!xf_gfx_scaled_alloc(surface, width, height, gdi->dstFormat,
+	                         WINPR_ASSERTING_INT_CAST(uint32_t, xfc->scanline_pad)))
+		return FALSE;
+
+	WINPR_ASSERT(xfc->depth != 0);
+	surface->scaledImage = LogDynAndXCreateImage(
+	    xfc->log, xfc->display, xfc->visual, WINPR_ASSERTING_INT_CAST(uint32_t, xfc->depth),
+	    ZPixmap, 0, (char*)surface->scaled, width, height, xfc->scanline_pad,
+	    WINPR_ASSERTING_INT_CAST(int, surface->scaledScanline));
+
+	if (!surface->scaledImage)
+	{
+		WLog_ERR(TAG, "an error occurred when creating the scaled XImage");
+		xf_gfx_scaled_free(surface);
+		return FALSE;
+	}
+
+	surface->scaledImage->byte_order = LSBFirst;
+	surface->scaledImage->bitmap_bit_order = LSBFirst;
+	return TRUE;
+}
+
+/* The built-in scaler is plain C and not vectorized on purpose. It only runs in builds without
+ * swscale and cairo, which bring their own optimized scalers, and the color conversion of the
+ * filtered lines already uses the SIMD primitives of freerdp_image_copy_no_overlap. */
+BOOL xf_gfx_scale_rect(xfGfxSurface* surface, UINT32 DstFormat, const RECTANGLE_16* rect)
+{
+	WINPR_ASSERT(surface);
+	WINPR_ASSERT(rect);
+	WINPR_ASSERT(FreeRDPGetBytesPerPixel(surface->gdi.format) == 4);
+
+	const BOOL direct = FreeRDPAreColorFormatsEqualNoAlpha(DstFormat, surface->gdi.format);
+	const UINT32 width = rect->right - rect->left;
+
+	for (UINT32 y = rect->top; y < rect->bottom; y++)
+	{
+		const xfGfxScaleTap row =
+		    xf_gfx_scale_tap(y, surface->scaledHeight, surface->gdi.mappedHeight);
+		const BYTE* data = surface->gdi.data;
+		const UINT32* src0 = (const UINT32*)&data[1ull * row.x0 * surface->gdi.scanline];
+		const UINT32* src1 = (const UINT32*)&data[1ull * row.x1 * surface->gdi.scanline];
+		UINT32* line = (UINT32*)surface->scaledLine;
+
+		if (direct)
+			line = (UINT32*)&surface->scaled[1ull * y * surface->scaledScanline];
+
+		for (UINT32 x = rect->left; x < rect->right; x++)
+		{
+			const xfGfxScaleTap* col = &surface->scaledColumns[x];
+
+			if (row.box || col->box)
+				line[x] = xf_gfx_filter(surface, &row, col);
+			else
+			{
+				const UINT32 top = xf_gfx_lerp(src0[col->x0], src0[col->x1], col->weight);
+				const UINT32 bottom = xf_gfx_lerp(src1[col->x0], src1[col->x1], col->weight);
+				line[x] = xf_gfx_lerp(top, bottom, row.weight);
+			}
+		}
+
+		if (!direct)
+		{
+			if (!freerdp_image_copy_no_overlap(
+			        surface->scaled, DstFormat, surface->scaledScanline, rect->left, y, width, 1,
+			        surface->scaledLine, surface->gdi.format, surface->scaledWidth * 4, rect->left,
+			        0, NULL, FREERDP_FLIP_NONE))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
 static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 {
 	UINT rc = ERROR_INTERNAL_ERROR;
@@ -43,6 +337,7 @@ static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 	RECTANGLE_16 surfaceRect = { 0 };
 	UINT32 nbRects = 0;
 	const RECTANGLE_16* rects = NULL;
+	RECTANGLE_16* damage = NULL;
 
 	WINPR_ASSERT(xfc);
 	WINPR_ASSERT(surface);
@@ -67,35 +362,69 @@ static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 
 	WINPR_ASSERT(surface->gdi.mappedWidth);
 	WINPR_ASSERT(surface->gdi.mappedHeight);
-	const double sx = 1.0 * surface->gdi.outputTargetWidth / (double)surface->gdi.mappedWidth;
-	const double sy = 1.0 * surface->gdi.outputTargetHeight / (double)surface->gdi.mappedHeight;
+	const BOOL scaled = (surface->gdi.outputTargetWidth != surface->gdi.mappedWidth) ||
+	                    (surface->gdi.outputTargetHeight != surface->gdi.mappedHeight);
 
 	if (!(rects = region16_rects(&surface->gdi.invalidRegion, &nbRects)))
 		return CHANNEL_RC_OK;
 
+	if (scaled)
+	{
+		if (!xf_gfx_scaled_update(xfc, surface))
+			goto fail;
+
+		damage = calloc(nbRects, sizeof(RECTANGLE_16));
+		if (!damage)
+			goto fail;
+
+		/* the filter taps of the pixels around the damage reach into it */
+		for (UINT32 x = 0; x < nbRects; x++)
+			xf_gfx_scale_damage(surface, &rects[x], &damage[x]);
+
+		/* a scaling library handles all damaged rectangles in one call */
+		if (surface->scaler &&
+		    !freerdp_image_scaler_scale(surface->scaler, surface->scaled,
+		                                surface->scaledScanline, surface->gdi.data,
+		                                surface->gdi.scanline, damage, nbRects))
+			goto fail;
+	}
+
+	XImage* image = scaled ? surface->scaledImage : surface->image;
+
 	for (UINT32 x = 0; x < nbRects; x++)
 	{
 		const RECTANGLE_16* rect = &rects[x];
-		const UINT32 nXSrc = rect->left;
-		const UINT32 nYSrc = rect->top;
-		const UINT32 swidth = rect->right - nXSrc;
-		const UINT32 sheight = rect->bottom - nYSrc;
-		const UINT32 nXDst = (UINT32)lround(1.0 * surfaceX + nXSrc * sx);
-		const UINT32 nYDst = (UINT32)lround(1.0 * surfaceY + nYSrc * sy);
-		const UINT32 dwidth = (UINT32)lround(1.0 * swidth * sx);
-		const UINT32 dheight = (UINT32)lround(1.0 * sheight * sy);
-
-		if (surface->stage)
+		RECTANGLE_16 dst = *rect;
+
+		if (scaled)
 		{
-			if (!freerdp_image_scale(surface->stage, gdi->dstFormat, surface->stageScanline, nXSrc,
-			                         nYSrc, dwidth, dheight, surface->gdi.data, surface->gdi.format,
-			                         surface->gdi.scanline, nXSrc, nYSrc, swidth, sheight))
+			dst = damage[x];
+			if ((dst.left >= dst.right) || (dst.top >= dst.bottom))
+				continue;
+
+			if (!surface->scaler && !xf_gfx_scale_rect(surface, gdi->dstFormat, &dst))
+				goto fail;
+		}
+		else if (surface->stage)
+		{
+			if (!freerdp_image_copy_no_overlap(
+			        surface->stage, gdi->dstFormat, surface->stageScanline, rect->left, rect->top,
+			        rect->right - rect->left, rect->bottom - rect->top, surface->gdi.data,
+			        surface->gdi.format, surface->gdi.scanline, rect->left, rect->top, NULL,
+			        FREERDP_FLIP_NONE))
 				goto fail;
 		}
 
+		const UINT32 nXSrc = dst.left;
+		const UINT32 nYSrc = dst.top;
+		const UINT32 nXDst = surfaceX + nXSrc;
+		const UINT32 nYDst = surfaceY + nYSrc;
+		const UINT32 dwidth = dst.right - dst.left;
+		const UINT32 dheight = dst.bottom - dst.top;
+
 		if (xfc->remote_app)
 		{
-			LogDynAndXPutImage(xfc->log, xfc->display, xfc->primary, xfc->gc, surface->image,
+			LogDynAndXPutImage(xfc->log, xfc->display, xfc->primary, xfc->gc, image,
 			                   WINPR_ASSERTING_INT_CAST(int, nXSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nYSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nXDst),
@@ -109,7 +438,7 @@ static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 		    if (freerdp_settings_get_bool(settings, FreeRDP_SmartSizing) ||
 		        freerdp_settings_get_bool(settings, FreeRDP_MultiTouchGestures))
 		{
-			LogDynAndXPutImage(xfc->log, xfc->display, xfc->primary, xfc->gc, surface->image,
+			LogDynAndXPutImage(xfc->log, xfc->display, xfc->primary, xfc->gc, image,
 			                   WINPR_ASSERTING_INT_CAST(int, nXSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nYSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nXDst),
@@ -122,7 +451,7 @@ static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 		else
 #endif
 		{
-			LogDynAndXPutImage(xfc->log, xfc->display, xfc->drawable, xfc->gc, surface->image,
+			LogDynAndXPutImage(xfc->log, xfc->display, xfc->drawable, xfc->gc, image,
 			                   WINPR_ASSERTING_INT_CAST(int, nXSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nYSrc),
 			                   WINPR_ASSERTING_INT_CAST(int, nXDst),
@@ -132,6 +461,7 @@ static UINT xf_OutputUpdate(xfContext* xfc, xfGfxSurface* surface)
 
 	rc = CHANNEL_RC_OK;
 fail:
+	free(damage);
 	region16_clear(&surface->gdi.invalidRegion);
 	LogDynAndXSetClipMask(xfc->log, xfc->display, xfc->gc, None);
 	LogDynAndXSync(xfc->log, xfc->display, False);
@@ -258,25 +588,6 @@ fail:
 	return status;
 }
 
-static UINT32 x11_pad_scanline(UINT32 scanline, UINT32 inPad)
-{
-	/* Ensure X11 alignment is met */
-	if (inPad > 0)
-	{
-		const UINT32 align = inPad / 8;
-		const UINT32 pad = align - scanline % align;
-
-		if (align != pad)
-			scanline += pad;
-	}
-
-	/* 16 byte alignment is required for ASM optimized code */
-	if (scanline % 16)
-		scanline += 16 - scanline % 16;
-
-	return scanline;
-}
-
 /**
  * Function description
  *
@@ -430,6 +741,7 @@ static UINT xf_DeleteSurface(RdpgfxClientContext* context,
 		XDestroyImage(surface->image);
 		winpr_aligned_free(surface->gdi.data);
 		winpr_aligned_free(surface->stage);
+		xf_gfx_scaled_free(surface);
 		region16_uninit(&surface->gdi.invalidRegion);
 		codecs = surface->gdi.codecs;
 		free(surface);
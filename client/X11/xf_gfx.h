@@ -25,14 +25,33 @@
 #include "xf_client.h"
 #include "xfreerdp.h"
 
+#include <freerdp/api.h>
 #include <freerdp/gdi/gfx.h>
 
+typedef struct
+{
+	UINT32 x0;     /* first source pixel */
+	UINT32 x1;     /* second bilinear source pixel, or one past the last box filter pixel */
+	UINT32 weight; /* bilinear weight of x1 in 8 bit fixed point */
+	BOOL box;      /* average the source pixels [x0, x1) */
+} xfGfxScaleTap;
+
 struct xf_gfx_surface
 {
 	gdiGfxSurface gdi;
 	BYTE* stage;
 	UINT32 stageScanline;
 	XImage* image;
+
+	/* output target sized copy, only used if the surface is mapped to a scaled output */
+	BYTE* scaled;
+	BYTE* scaledLine;
+	UINT32 scaledScanline;
+	UINT32 scaledWidth;
+	UINT32 scaledHeight;
+	xfGfxScaleTap* scaledColumns;
+	XImage* scaledImage;
+	FREERDP_IMAGE_SCALER* scaler; /* NULL if the built-in scaler is used */
 };
 typedef struct xf_gfx_surface xfGfxSurface;
 
@@ -42,4 +61,15 @@ void xf_graphics_pipeline_init(xfContext* xfc, RdpgfxClientContext* gfx);
 
 void xf_graphics_pipeline_uninit(xfContext* xfc, RdpgfxClientContext* gfx);
 
+/* Scaling of surfaces mapped to an output of a different size. The built-in scaler is used if
+ * freerdp_image_scaler_new fails, e.g. if neither swscale nor cairo is available */
+FREERDP_LOCAL BOOL xf_gfx_scaled_alloc(xfGfxSurface* surface, UINT32 width, UINT32 height,
+                                       UINT32 DstFormat, UINT32 scanlinePad);
+FREERDP_LOCAL void xf_gfx_scaled_free(xfGfxSurface* surface);
+/* The rectangle of the scaled output that must be updated for a damaged surface rectangle */
+FREERDP_LOCAL void xf_gfx_scale_damage(const xfGfxSurface* surface, const RECTANGLE_16* rect,
+                                       RECTANGLE_16* dst);
+FREERDP_LOCAL BOOL xf_gfx_scale_rect(xfGfxSurface* surface, UINT32 DstFormat,
+                                     const RECTANGLE_16* rect);
+
 #endif /* FREERDP_CLIENT_X11_GFX_H */
@@ -4902,6 +4902,13 @@ static int parse_command_line(rdpSettings* settings, const COMMAND_LINE_ARGUMENT
 			if (!freerdp_settings_set_bool(settings, FreeRDP_CompressionEnabled, enable))
 				return fail_at(arg, COMMAND_LINE_ERROR);
 		}
+		CommandLineSwitchCase(arg, "vc-compression")
+		{
+			if (!freerdp_settings_set_uint32(settings, FreeRDP_VCFlags,
+			                                 enable ? (VCCAPS_COMPR_SC | VCCAPS_COMPR_CS_8K)
+			                                        : VCCAPS_NO_COMPR))
+				return fail_at(arg, COMMAND_LINE_ERROR);
+		}
 		CommandLineSwitchCase(arg, "compression-level")
 		{
 			const int rc = parse_command_line_option_uint32(settings, arg, FreeRDP_CompressionLevel,
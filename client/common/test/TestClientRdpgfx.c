@@ -0,0 +1,321 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/stream.h>
+
+#include <freerdp/freerdp.h>
+#include <freerdp/dvc.h>
+#include <freerdp/addin.h>
+#include <freerdp/settings.h>
+#include <freerdp/client/channels.h>
+#include <freerdp/client/rdpgfx.h>
+#include <freerdp/channels/rdpgfx.h>
+
+#define TEST_MAX_ACKS 16
+
+typedef struct
+{
+	IDRDYNVC_ENTRY_POINTS entryPoints;
+	IWTSVirtualChannelManager mgr;
+	IWTSVirtualChannel channel;
+	IWTSListener listener;
+
+	rdpContext rdp;
+	IWTSPlugin* plugin;
+	IWTSListenerCallback* listenerCallback;
+	IWTSVirtualChannelCallback* callback;
+	RdpgfxClientContext* gfx;
+
+	UINT endFrameError;
+	RDPGFX_FRAME_ACKNOWLEDGE_PDU acks[TEST_MAX_ACKS];
+	size_t numAcks;
+} TestGfx;
+
+static TestGfx* s_test = NULL;
+
+static UINT test_register_plugin(IDRDYNVC_ENTRY_POINTS* pEntryPoints, const char* name,
+                                 IWTSPlugin* pPlugin)
+{
+	TestGfx* test = (TestGfx*)pEntryPoints;
+
+	WINPR_UNUSED(name);
+	test->plugin = pPlugin;
+	return CHANNEL_RC_OK;
+}
+
+static IWTSPlugin* test_get_plugin(IDRDYNVC_ENTRY_POINTS* pEntryPoints, const char* name)
+{
+	TestGfx* test = (TestGfx*)pEntryPoints;
+
+	WINPR_UNUSED(name);
+	return test->plugin;
+}
+
+static rdpSettings* test_get_settings(IDRDYNVC_ENTRY_POINTS* pEntryPoints)
+{
+	TestGfx* test = (TestGfx*)pEntryPoints;
+	return test->rdp.settings;
+}
+
+static rdpContext* test_get_context(IDRDYNVC_ENTRY_POINTS* pEntryPoints)
+{
+	TestGfx* test = (TestGfx*)pEntryPoints;
+	return &test->rdp;
+}
+
+static UINT test_create_listener(IWTSVirtualChannelManager* pChannelMgr, const char* pszChannelName,
+                                 ULONG ulFlags, IWTSListenerCallback* pListenerCallback,
+                                 IWTSListener** ppListener)
+{
+	WINPR_UNUSED(pChannelMgr);
+	WINPR_UNUSED(pszChannelName);
+	WINPR_UNUSED(ulFlags);
+
+	s_test->listenerCallback = pListenerCallback;
+	*ppListener = &s_test->listener;
+	return CHANNEL_RC_OK;
+}
+
+static UINT test_destroy_listener(IWTSVirtualChannelManager* pChannelMgr, IWTSListener* pListener)
+{
+	WINPR_UNUSED(pChannelMgr);
+	WINPR_UNUSED(pListener);
+	return CHANNEL_RC_OK;
+}
+
+static UINT test_write(IWTSVirtualChannel* pChannel, ULONG cbSize, const BYTE* pBuffer,
+                       void* pReserved)
+{
+	wStream sbuffer = { 0 };
+	UINT16 cmdId = 0;
+
+	WINPR_UNUSED(pChannel);
+	WINPR_UNUSED(pReserved);
+
+	wStream* s = Stream_StaticConstInit(&sbuffer, pBuffer, cbSize);
+	if (!Stream_CheckAndLogRequiredLength("test", s, RDPGFX_HEADER_SIZE))
+		return ERROR_INVALID_DATA;
+
+	Stream_Read_UINT16(s, cmdId);
+	Stream_Seek(s, 6); /* flags, pduLength */
+	if (cmdId != RDPGFX_CMDID_FRAMEACKNOWLEDGE)
+		return CHANNEL_RC_OK;
+
+	if ((s_test->numAcks >= TEST_MAX_ACKS) || !Stream_CheckAndLogRequiredLength("test", s, 12))
+		return ERROR_INVALID_DATA;
+
+	RDPGFX_FRAME_ACKNOWLEDGE_PDU* ack = &s_test->acks[s_test->numAcks++];
+	Stream_Read_UINT32(s, ack->queueDepth);
+	Stream_Read_UINT32(s, ack->frameId);
+	Stream_Read_UINT32(s, ack->totalFramesDecoded);
+	return CHANNEL_RC_OK;
+}
+
+static UINT test_on_open(RdpgfxClientContext* context, BOOL* do_caps_advertise,
+                         BOOL* do_frame_acks)
+{
+	WINPR_UNUSED(context);
+	WINPR_UNUSED(do_frame_acks);
+
+	*do_caps_advertise = FALSE;
+	return CHANNEL_RC_OK;
+}
+
+static UINT test_end_frame(RdpgfxClientContext* context, const RDPGFX_END_FRAME_PDU* endFrame)
+{
+	WINPR_UNUSED(context);
+	WINPR_UNUSED(endFrame);
+	return s_test->endFrameError;
+}
+
+/* sends a start and end frame PDU as one uncompressed bulk segment */
+static UINT test_send_frame(TestGfx* test, UINT32 frameId)
+{
+	wStream* s = Stream_New(NULL, 64);
+	if (!s)
+		return CHANNEL_RC_NO_MEMORY;
+
+	Stream_Write_UINT8(s, 0xE0); /* ZGFX_SEGMENTED_SINGLE */
+	Stream_Write_UINT8(s, 0x04); /* PACKET_COMPR_TYPE_RDP8, not compressed */
+
+	Stream_Write_UINT16(s, RDPGFX_CMDID_STARTFRAME);
+	Stream_Write_UINT16(s, 0);
+	Stream_Write_UINT32(s, RDPGFX_HEADER_SIZE + RDPGFX_START_FRAME_PDU_SIZE);
+	Stream_Write_UINT32(s, 0); /* timestamp */
+	Stream_Write_UINT32(s, frameId);
+
+	Stream_Write_UINT16(s, RDPGFX_CMDID_ENDFRAME);
+	Stream_Write_UINT16(s, 0);
+	Stream_Write_UINT32(s, RDPGFX_HEADER_SIZE + RDPGFX_END_FRAME_PDU_SIZE);
+	Stream_Write_UINT32(s, frameId);
+
+	Stream_SealLength(s);
+	Stream_SetPosition(s, 0);
+
+	const UINT rc = test->callback->OnDataReceived(test->callback, s);
+	Stream_Free(s, TRUE);
+	return rc;
+}
+
+static BOOL test_check_acks(TestGfx* test, const RDPGFX_FRAME_ACKNOWLEDGE_PDU* expected,
+                            size_t count)
+{
+	BOOL rc = TRUE;
+
+	if (test->numAcks != count)
+	{
+		printf("got %" PRIuz " frame acknowledges, expected %" PRIuz "\n", test->numAcks, count);
+		rc = FALSE;
+	}
+
+	for (size_t x = 0; rc && (x < count); x++)
+	{
+		const RDPGFX_FRAME_ACKNOWLEDGE_PDU* ack = &test->acks[x];
+		if ((ack->frameId != expected[x].frameId) ||
+		    (ack->queueDepth != expected[x].queueDepth) ||
+		    (ack->totalFramesDecoded != expected[x].totalFramesDecoded))
+		{
+			printf("ack %" PRIuz ": frame %" PRIu32 " depth %" PRIu32 " decoded %" PRIu32
+			       ", expected frame %" PRIu32 " depth %" PRIu32 " decoded %" PRIu32 "\n",
+			       x, ack->frameId, ack->queueDepth, ack->totalFramesDecoded,
+			       expected[x].frameId, expected[x].queueDepth, expected[x].totalFramesDecoded);
+			rc = FALSE;
+		}
+	}
+
+	test->numAcks = 0;
+	return rc;
+}
+
+static BOOL test_deferred_acks(TestGfx* test)
+{
+	RdpgfxClientContext* gfx = test->gfx;
+
+	for (UINT32 frameId = 1; frameId <= 3; frameId++)
+	{
+		if (test_send_frame(test, frameId) != CHANNEL_RC_OK)
+			return FALSE;
+	}
+
+	/* nothing is acknowledged before the frames are presented */
+	if (!test_check_acks(test, NULL, 0))
+		return FALSE;
+
+	/* presenting a frame acknowledges all older ones first */
+	{
+		const RDPGFX_FRAME_ACKNOWLEDGE_PDU expected[] = { { 3, 1, 1 }, { 2, 2, 2 } };
+		if ((gfx->FramePresented(gfx, 2) != CHANNEL_RC_OK) ||
+		    !test_check_acks(test, expected, ARRAYSIZE(expected)))
+			return FALSE;
+	}
+
+	{
+		const RDPGFX_FRAME_ACKNOWLEDGE_PDU expected[] = { { 1, 3, 3 } };
+		if ((gfx->FramePresented(gfx, 3) != CHANNEL_RC_OK) ||
+		    !test_check_acks(test, expected, ARRAYSIZE(expected)))
+			return FALSE;
+	}
+
+	/* frames are acknowledged only once */
+	if ((gfx->FramePresented(gfx, 1) != CHANNEL_RC_OK) || !test_check_acks(test, NULL, 0))
+		return FALSE;
+
+	/* a frame the client failed to end is dropped, it does not hold back the next one */
+	test->endFrameError = ERROR_INTERNAL_ERROR;
+	if (test_send_frame(test, 4) == CHANNEL_RC_OK)
+		return FALSE;
+	test->endFrameError = CHANNEL_RC_OK;
+
+	if (test_send_frame(test, 5) != CHANNEL_RC_OK)
+		return FALSE;
+
+	{
+		const RDPGFX_FRAME_ACKNOWLEDGE_PDU expected[] = { { 1, 5, 4 } };
+		if ((gfx->FramePresented(gfx, 4) != CHANNEL_RC_OK) || !test_check_acks(test, NULL, 0) ||
+		    (gfx->FramePresented(gfx, 5) != CHANNEL_RC_OK) ||
+		    !test_check_acks(test, expected, ARRAYSIZE(expected)))
+			return FALSE;
+	}
+
+	/* frames pending when the channel closes are never acknowledged */
+	if (test_send_frame(test, 6) != CHANNEL_RC_OK)
+		return FALSE;
+
+	IWTSVirtualChannelCallback* callback = test->callback;
+	test->callback = NULL;
+	if (callback->OnClose(callback) != CHANNEL_RC_OK)
+		return FALSE;
+
+	if ((gfx->FramePresented(gfx, 6) != CHANNEL_RC_OK) || !test_check_acks(test, NULL, 0))
+		return FALSE;
+
+	return TRUE;
+}
+
+int TestClientRdpgfx(int argc, char* argv[])
+{
+	int rc = -1;
+	BOOL accept = TRUE;
+	TestGfx test = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	PVIRTUALCHANNELENTRY pvce = freerdp_channels_load_static_addin_entry(
+	    RDPGFX_CHANNEL_NAME, NULL, NULL, FREERDP_ADDIN_CHANNEL_DYNAMIC);
+	PDVC_PLUGIN_ENTRY entry = WINPR_FUNC_PTR_CAST(pvce, PDVC_PLUGIN_ENTRY);
+	if (!entry)
+	{
+		printf("rdpgfx is not a builtin channel, skipping\n");
+		return 0;
+	}
+
+	s_test = &test;
+	test.entryPoints.RegisterPlugin = test_register_plugin;
+	test.entryPoints.GetPlugin = test_get_plugin;
+	test.entryPoints.GetRdpSettings = test_get_settings;
+	test.entryPoints.GetRdpContext = test_get_context;
+	test.mgr.CreateListener = test_create_listener;
+	test.mgr.DestroyListener = test_destroy_listener;
+	test.channel.Write = test_write;
+
+	test.rdp.settings = freerdp_settings_new(0);
+	if (!test.rdp.settings)
+		goto fail;
+
+	if ((entry(&test.entryPoints) != CHANNEL_RC_OK) || !test.plugin)
+		goto fail;
+
+	test.gfx = (RdpgfxClientContext*)test.plugin->pInterface;
+	if (!test.gfx)
+		goto fail;
+	test.gfx->DeferFrameAcknowledge = TRUE;
+	test.gfx->OnOpen = test_on_open;
+	test.gfx->EndFrame = test_end_frame;
+
+	if ((test.plugin->Initialize(test.plugin, &test.mgr) != CHANNEL_RC_OK) ||
+	    !test.listenerCallback)
+		goto fail;
+
+	if ((test.listenerCallback->OnNewChannelConnection(test.listenerCallback, &test.channel, NULL,
+	                                                   &accept, &test.callback) !=
+	     CHANNEL_RC_OK) ||
+	    !test.callback)
+		goto fail;
+
+	if (test.callback->OnOpen(test.callback) != CHANNEL_RC_OK)
+		goto fail;
+
+	if (!test_deferred_acks(&test))
+		goto fail;
+
+	rc = 0;
+fail:
+	if (test.callback)
+		test.callback->OnClose(test.callback);
+	if (test.plugin)
+		test.plugin->Terminated(test.plugin);
+	freerdp_settings_free(test.rdp.settings);
+	s_test = NULL;
+	return rc;
+}
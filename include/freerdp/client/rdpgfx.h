@@ -114,6 +114,7 @@ extern "C"
 	                                         const RDPGFX_FRAME_ACKNOWLEDGE_PDU* frameAcknowledge);
 	typedef UINT (*pcRdpgfxQoeFrameAcknowledge)(
 	    RdpgfxClientContext* context, const RDPGFX_QOE_FRAME_ACKNOWLEDGE_PDU* qoeFrameAcknowledge);
+	typedef UINT (*pcRdpgfxFramePresented)(RdpgfxClientContext* context, UINT32 frameId);
 
 	typedef UINT (*pcRdpgfxMapWindowForSurface)(RdpgfxClientContext* context, UINT16 surfaceID,
 	                                            UINT64 windowID);
@@ -175,6 +176,21 @@ extern "C"
 		CRITICAL_SECTION mux;
 		rdpCodecs* codecs;
 		PROFILER_DEFINE(SurfaceProfiler)
+
+		/** Set by the client if frames are presented asynchronously after EndFrame returned.
+		 *  The frame acknowledge is then delayed until FramePresented is called and reports
+		 *  the number of frames still waiting for presentation as queue depth.
+		 *  Frames that did not paint anything still get an EndPaint without invalid area
+		 *  while the gfx frame is active, the client must present those in order as well.
+		 *  @since version 3.16.0
+		 */
+		BOOL DeferFrameAcknowledge;
+
+		/** Acknowledge all frames up to and including frameId as presented.
+		 *  Unknown frame ids are ignored.
+		 *  @since version 3.16.0
+		 */
+		pcRdpgfxFramePresented FramePresented;
 	};
 
 	FREERDP_API void rdpgfx_client_context_free(RdpgfxClientContext* context);
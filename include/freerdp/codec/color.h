@@ -24,6 +24,7 @@
 
 #include <winpr/crt.h>
 #include <freerdp/api.h>
+#include <freerdp/types.h>
 
 #ifdef __cplusplus
 extern "C"
@@ -432,6 +433,62 @@ typedef struct gdi_palette gdiPalette;
 	                                     UINT32 nSrcStep, UINT32 nXSrc, UINT32 nYSrc,
 	                                     UINT32 nSrcWidth, UINT32 nSrcHeight);
 
+	/** @brief Scaler for repeated scaling of images with the same sizes and formats
+	 *  @since version 3.16.0
+	 */
+	typedef struct S_FREERDP_IMAGE_SCALER FREERDP_IMAGE_SCALER;
+
+	/** @brief Free a scaler created by \ref freerdp_image_scaler_new
+	 *
+	 *  @param scaler The scaler to free, may be \b NULL
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API void freerdp_image_scaler_free(FREERDP_IMAGE_SCALER* scaler);
+
+	/** @brief Create a scaler that scales a whole source image to a whole destination image.
+	 *
+	 *  The scaling context of swscale or cairo is set up once and reused for every call of
+	 *  \ref freerdp_image_scaler_scale
+	 *
+	 *  @param DstFormat  destination buffer format
+	 *  @param nDstWidth  width of destination in pixels
+	 *  @param nDstHeight height of destination in pixels
+	 *  @param SrcFormat  source buffer format
+	 *  @param nSrcWidth  width of source in pixels
+	 *  @param nSrcHeight height of source in pixels
+	 *
+	 *  @return A new scaler or \b NULL if the build has no scaling library or it does not
+	 * support the formats
+	 *  @since version 3.16.0
+	 */
+	WINPR_ATTR_MALLOC(freerdp_image_scaler_free, 1)
+	FREERDP_API FREERDP_IMAGE_SCALER* freerdp_image_scaler_new(DWORD DstFormat, UINT32 nDstWidth,
+	                                                           UINT32 nDstHeight, DWORD SrcFormat,
+	                                                           UINT32 nSrcWidth,
+	                                                           UINT32 nSrcHeight);
+
+	/** @brief Scale the source image to the destination.
+	 *
+	 *  Only the given destination rectangles must be up to date afterwards, depending on the
+	 *  scaling library the whole destination might be updated.
+	 *
+	 *  @param scaler    The scaler to use. Must not be \b NULL
+	 *  @param pDstData  destination buffer
+	 *  @param nDstStep  destination buffer stride (line in bytes)
+	 *  @param pSrcData  source buffer
+	 *  @param nSrcStep  source buffer stride (line in bytes)
+	 *  @param rects     destination rectangles to update, \b NULL for the whole destination
+	 *  @param count     number of rectangles in \b rects
+	 *
+	 *  @return          TRUE if success, FALSE otherwise
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API BOOL freerdp_image_scaler_scale(FREERDP_IMAGE_SCALER* scaler,
+	                                            BYTE* WINPR_RESTRICT pDstData, UINT32 nDstStep,
+	                                            const BYTE* WINPR_RESTRICT pSrcData,
+	                                            UINT32 nSrcStep, const RECTANGLE_16* rects,
+	                                            UINT32 count);
+
 	/** @brief fill an area with the color provided.
 	 *
 	 * @param pDstData  destination buffer
@@ -76,6 +76,33 @@ extern "C"
 	                                  const RECTANGLE_16* regionRect, BYTE** ppDstData,
 	                                  UINT32* pDstSize, RDPGFX_H264_METABLOCK* meta);
 
+	/** @brief Compress a frame where only the given areas changed since the last call.
+	 *
+	 *  Only the 64x64 tiles touched by \b damageRects are converted to YUV, the remaining
+	 *  frame content is kept from the previous call. The resulting change map is passed on
+	 *  to the encoder backend (if supported) so unchanged macroblocks can be coded as skips.
+	 *
+	 *  @param h264 The h264 context to use for compression
+	 *  @param pSrcData The source image data
+	 *  @param SrcFormat The pixel format of the source image
+	 *  @param nSrcStep The size of a line in bytes of the source image
+	 *  @param nSrcWidth The width of the source image in pixels
+	 *  @param nSrcHeight The height of the source image
+	 *  @param damageRects The areas that changed since the last call
+	 *  @param numDamageRects The number of rectangles in \b damageRects
+	 *  @param ppDstData A pointer that will hold the allocated result buffer
+	 *  @param pDstSize A pointer for the destination buffer size in bytes
+	 *  @param meta The metablock to fill with the changed areas
+	 *
+	 *  @return \b >0 for new data, \b 0 if nothing changed, \b <0 for an error
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API INT32 avc420_compress_region(H264_CONTEXT* h264, const BYTE* pSrcData,
+	                                         DWORD SrcFormat, UINT32 nSrcStep, UINT32 nSrcWidth,
+	                                         UINT32 nSrcHeight, const RECTANGLE_16* damageRects,
+	                                         UINT32 numDamageRects, BYTE** ppDstData,
+	                                         UINT32* pDstSize, RDPGFX_H264_METABLOCK* meta);
+
 	/** @brief API for user to fill YUV I420 buffer before encoding
 	 *
 	 *  @param h264 The h264 context to query
@@ -63,6 +63,10 @@ extern "C"
 		PROGRESSIVE_CONTEXT* progressive;
 		BITMAP_PLANAR_CONTEXT* planar;
 		BITMAP_INTERLEAVED_CONTEXT* interleaved;
+
+		UINT32 LazyFlags; /** @since version 3.16.0 */
+		UINT32 Width;     /** @since version 3.16.0 */
+		UINT32 Height;    /** @since version 3.16.0 */
 	};
 	typedef struct rdp_codecs rdpCodecs;
 
@@ -71,6 +75,32 @@ extern "C"
 	FREERDP_API BOOL freerdp_client_codecs_reset(rdpCodecs* codecs, UINT32 flags, UINT32 width,
 	                                             UINT32 height);
 
+	/**
+	 * @brief Like \b freerdp_client_codecs_prepare but only records the codecs.
+	 * The contexts are created by \b freerdp_client_codecs_ensure on first use.
+	 *
+	 * @param codecs A pointer to a rdpCodecs instance
+	 * @param flags A mask of \b FreeRDP_CodecFlags to prepare
+	 * @param width The width used for the codecs once created
+	 * @param height The height used for the codecs once created
+	 *
+	 * @return \b TRUE for success, \b FALSE otherwise
+	 * @since version 3.16.0
+	 */
+	FREERDP_API BOOL freerdp_client_codecs_prepare_lazy(rdpCodecs* codecs, UINT32 flags,
+	                                                    UINT32 width, UINT32 height);
+
+	/**
+	 * @brief Create all codec contexts in \b flags that were prepared lazily and not used yet.
+	 *
+	 * @param codecs A pointer to a rdpCodecs instance
+	 * @param flags A mask of \b FreeRDP_CodecFlags required by the caller
+	 *
+	 * @return \b TRUE if the contexts are available, \b FALSE otherwise
+	 * @since version 3.16.0
+	 */
+	FREERDP_API BOOL freerdp_client_codecs_ensure(rdpCodecs* codecs, UINT32 flags);
+
 	/**
 	 * @brief Free a rdpCodecs instance
 	 * @param codecs A pointer to a rdpCodecs instance or NULL
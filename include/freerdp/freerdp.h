@@ -644,6 +644,49 @@ owned by rdpRdp */
 	FREERDP_API DWORD freerdp_get_event_handles(rdpContext* context, HANDLE* events, DWORD count);
 	FREERDP_API BOOL freerdp_check_event_handles(rdpContext* context);
 
+	/** @brief Event sources reported by \ref freerdp_get_ready_event_sources
+	 *  @since version 3.16.0
+	 */
+	typedef enum
+	{
+		FREERDP_EVENT_SOURCE_NONE = 0x00,
+		FREERDP_EVENT_SOURCE_TRANSPORT = 0x01,     /**!< transport, abort or timer event */
+		FREERDP_EVENT_SOURCE_CHANNELS = 0x02,      /**!< channel messages or registered handles */
+		FREERDP_EVENT_SOURCE_CHANNEL_ERROR = 0x04, /**!< a channel reported an error */
+		FREERDP_EVENT_SOURCE_ALL = 0x07
+	} FreeRDPEventSource;
+
+	/** @brief Determine which event sources became ready after a wait on the handles returned
+	 * by \ref freerdp_get_event_handles
+	 *
+	 *  WaitForMultipleObjects reports the lowest signaled index, so all handles before that index
+	 *  are known not to be ready and only the remaining ones are probed. Handles registered by
+	 *  channels are not probed as that would reset auto reset events, a registered handle after
+	 *  that index always reports \b FREERDP_EVENT_SOURCE_CHANNELS.
+	 *
+	 *  @param context The rdp context the handles were retrieved for. Must not be \b NULL
+	 *  @param events The array filled by \ref freerdp_get_event_handles
+	 *  @param count The number of handles in \b events
+	 *  @param waitStatus The result of WaitForMultipleObjects relative to \b events
+	 *
+	 *  @return A mask of \b FreeRDPEventSource values, \b FREERDP_EVENT_SOURCE_ALL if the
+	 * readiness could not be determined.
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API UINT32 freerdp_get_ready_event_sources(rdpContext* context, const HANDLE* events,
+	                                                   DWORD count, DWORD waitStatus);
+
+	/** @brief Like \ref freerdp_check_event_handles but only dispatches the given event sources.
+	 *
+	 *  @param context The rdp context to check. Must not be \b NULL
+	 *  @param sources A mask of \b FreeRDPEventSource values, usually the result of
+	 * \ref freerdp_get_ready_event_sources
+	 *
+	 *  @return \b TRUE for success, \b FALSE otherwise
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API BOOL freerdp_check_event_sources(rdpContext* context, UINT32 sources);
+
 	FREERDP_API wMessageQueue* freerdp_get_message_queue(freerdp* instance, DWORD id);
 	FREERDP_API HANDLE freerdp_get_message_queue_event_handle(freerdp* instance, DWORD id);
 	FREERDP_API int freerdp_message_queue_process_message(freerdp* instance, DWORD id,
@@ -701,6 +744,18 @@ owned by rdpRdp */
 
 	FREERDP_API ULONG freerdp_get_transport_sent(rdpContext* context, BOOL resetCount);
 
+	/** @brief Query the number of bytes written to the transport that have not been sent yet.
+	 *
+	 *  Counts data held in the transport output buffer and, where the platform reports it,
+	 *  data still queued in the kernel socket send buffer. Encoders can use this to skip or
+	 *  merge frames while the connection is backed up.
+	 *
+	 *  @param context The context to query, must not be \b NULL
+	 *  @return The number of unsent bytes
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API size_t freerdp_get_transport_unsent(rdpContext* context);
+
 	FREERDP_API BOOL freerdp_nla_impersonate(rdpContext* context);
 	FREERDP_API BOOL freerdp_nla_revert_to_self(rdpContext* context);
 
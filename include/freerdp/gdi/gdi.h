@@ -520,6 +520,9 @@ extern "C"
 		GeometryClientContext* geometry;
 
 		wLog* log;
+
+		/** TRUE if the current gfx frame was handed to EndPaint, @since version 3.16.0 */
+		BOOL gfxFramePainted;
 	};
 	typedef struct rdp_gdi rdpGdi;
 
@@ -0,0 +1,100 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ * FreeRDP Proxy Server
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef FREERDP_SERVER_PROXY_CAPTURE_H
+#define FREERDP_SERVER_PROXY_CAPTURE_H
+
+#include <winpr/wtypes.h>
+
+#include <freerdp/api.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	/** @brief An asynchronous file sink for capture and audit modules.
+	 *
+	 *  Packets handed to the sink are queued and appended to their file by a background thread.
+	 *  Each packet is stored as a 64 bit little endian length followed by the packet data.
+	 *  Files stay open until closed with \b pf_capture_sink_close or until the sink is freed,
+	 *  and are flushed once per batch of queued writes instead of once per write.
+	 *
+	 *  A sink is thread safe and meant to be shared by all sessions of a module.
+	 *
+	 *  @since version 3.16.0
+	 */
+	typedef struct proxy_capture_sink proxyCaptureSink;
+
+	/**
+	 * @brief pf_capture_sink_free Writes all pending data, closes all files and frees the sink.
+	 *
+	 * @param sink The sink to free. Might be NULL.
+	 *
+	 * @since version 3.16.0
+	 */
+	FREERDP_API void pf_capture_sink_free(proxyCaptureSink* sink);
+
+	/**
+	 * @brief pf_capture_sink_new Creates a new sink and starts its writer thread.
+	 *
+	 * @param max_queued The maximum number of bytes waiting to be written. Writers block
+	 *                   while the queue is full. 0 selects a default.
+	 *
+	 * @return A new sink or NULL on failure.
+	 *
+	 * @since version 3.16.0
+	 */
+	WINPR_ATTR_MALLOC(pf_capture_sink_free, 1)
+	FREERDP_API proxyCaptureSink* pf_capture_sink_new(size_t max_queued);
+
+	/**
+	 * @brief pf_capture_sink_write Queues a packet to be appended to a file.
+	 *
+	 * The packet is copied, the caller may reuse the buffer as soon as the function returns.
+	 * The length prefix and the data are queued together, packets written to the same file
+	 * from several threads do not interleave. Packets are appended in the order they were
+	 * queued.
+	 *
+	 * @param sink The sink to use. Must NOT be NULL.
+	 * @param path The file to append to. It is opened on first use. Must NOT be NULL.
+	 * @param data The packet data. May be NULL if \b length is 0.
+	 * @param length The number of bytes of the packet.
+	 *
+	 * @return TRUE if the data was queued, FALSE on failure.
+	 *
+	 * @since version 3.16.0
+	 */
+	FREERDP_API BOOL pf_capture_sink_write(proxyCaptureSink* sink, const char* path,
+	                                       const BYTE* data, size_t length);
+
+	/**
+	 * @brief pf_capture_sink_close Queues closing a file after all writes queued before.
+	 *
+	 * @param sink The sink to use. Must NOT be NULL.
+	 * @param path The file to close. Must NOT be NULL.
+	 *
+	 * @return TRUE if the request was queued, FALSE on failure.
+	 *
+	 * @since version 3.16.0
+	 */
+	FREERDP_API BOOL pf_capture_sink_close(proxyCaptureSink* sink, const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERDP_SERVER_PROXY_CAPTURE_H */
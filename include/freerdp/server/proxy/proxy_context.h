@@ -26,6 +26,7 @@
 #include <freerdp/types.h>
 
 #include <freerdp/freerdp.h>
+#include <freerdp/transport_io.h>
 #include <freerdp/channels/wtsvc.h>
 
 #include <freerdp/server/proxy/proxy_config.h>
@@ -42,6 +43,11 @@ extern "C"
 	typedef struct proxy_module proxyModule;
 	typedef struct p_server_static_channel_context pServerStaticChannelContext;
 
+	/** @brief backend connection dialed while the front end is still connecting
+	 *  @since version 3.16.0
+	 */
+	typedef struct p_early_dial proxyEarlyDial;
+
 	typedef struct s_InterceptContextMapEntry
 	{
 		void (*free)(struct s_InterceptContextMapEntry*);
@@ -139,6 +145,8 @@ extern "C"
 			char* c;
 			void* v;
 		} computerName;
+
+		pTCPConnect client_tcp_connect_original; /** @since version 3.16.0 */
 	};
 
 	/**
@@ -161,6 +169,9 @@ extern "C"
 		/* used to external modules to store per-session info */
 		wHashTable* modules_info;
 		psPeerReceiveChannelData server_receive_channel_data_original;
+
+		BOOL early_dial_attempted;  /** @since version 3.16.0 */
+		proxyEarlyDial* early_dial; /** @since version 3.16.0 */
 	};
 
 	FREERDP_API BOOL pf_context_copy_settings(rdpSettings* dst, const rdpSettings* src);
@@ -62,6 +62,24 @@ extern "C"
 	FREERDP_API BOOL pf_server_add_module(proxyServer* server, proxyModuleEntryPoint ep,
 	                                      void* userdata);
 
+	/**
+	 * @brief pf_server_get_early_dial_target Gets the target the proxy connects to while a
+	 *                                        client still authenticates against the proxy.
+	 *
+	 * Only a fixed target from the configuration qualifies, and only if no module filters
+	 * the target address. Just the TCP connection is set up early.
+	 *
+	 * @param server The server instance. Must NOT be NULL.
+	 * @param hostname Receives the host name of the target. Must NOT be NULL.
+	 * @param port Receives the port of the target. Must NOT be NULL.
+	 *
+	 * @return TRUE if the target is connected to early, FALSE otherwise.
+	 *
+	 * @since version 3.16.0
+	 */
+	FREERDP_API BOOL pf_server_get_early_dial_target(const proxyServer* server,
+	                                                 const char** hostname, UINT16* port);
+
 	/**
 	 * @brief pf_server_start Starts the proxy, binding the configured port.
 	 *
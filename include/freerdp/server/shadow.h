@@ -180,6 +180,8 @@ extern "C"
 		size_t maxClientsConnected;
 		BOOL SupportMultiRectBitmapUpdates; /** @since version 3.13.0 */
 		BOOL ShowMouseCursor;               /** @since version 3.15.0 */
+		BOOL GfxMixedContent;               /** @since version 3.16.0 */
+		char* SubsystemOptions;             /** @since version 3.16.0 */
 	};
 
 	struct rdp_shadow_surface
@@ -308,6 +310,16 @@ extern "C"
 	} SHADOW_MSG_OUT_AUDIO_OUT_VOLUME;
 
 	FREERDP_API void shadow_subsystem_set_entry_builtin(const char* name);
+
+	/** @brief Select a subsystem built into freerdp-shadow-subsystem
+	 *
+	 *  @param name The name of the subsystem or \b NULL for the default one
+	 *
+	 *  @return \b 0 for success, \b <0 if no subsystem with that name is built in
+	 *
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API int shadow_subsystem_set_entry_builtin_ex(const char* name);
 	FREERDP_API void shadow_subsystem_set_entry(pfnShadowSubsystemEntry pEntry);
 
 #if !defined(WITHOUT_FREERDP_3x_DEPRECATED)
@@ -387,6 +399,52 @@ extern "C"
 	                                                   UINT32 format2, UINT32 nStep2,
 	                                                   RECTANGLE_16* WINPR_RESTRICT rect);
 
+	/** @brief Compare independent areas (e.g. monitors) of two framebuffer images in parallel
+	 *  and copy the changed parts from image 2 to image 1.
+	 *
+	 *  @param pData1  A pointer to the data of image 1 (destination)
+	 *  @param format1 The format of image 1
+	 *  @param nStep1  The line width in bytes of image 1
+	 *  @param pData2  A pointer to the data of image 2 (source)
+	 *  @param format2 The format of image 2
+	 *  @param nStep2  The line width in bytes of image 2
+	 *  @param areas   The non overlapping areas to compare, relative to both images
+	 *  @param numAreas The number of areas
+	 *  @param region  A region the changed rectangle of each area is added to
+	 *
+	 *  @return the number of changed areas and \b <0 for any error
+	 *
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API int shadow_capture_compare_areas_with_format(
+	    BYTE* WINPR_RESTRICT pData1, UINT32 format1, UINT32 nStep1,
+	    const BYTE* WINPR_RESTRICT pData2, UINT32 format2, UINT32 nStep2,
+	    const RECTANGLE_16* WINPR_RESTRICT areas, UINT32 numAreas, REGION16* WINPR_RESTRICT region);
+
+	/** @brief Compare independent areas (e.g. monitors) of two framebuffer images in parallel
+	 *  without copying anything.
+	 *
+	 *  Used by subsystems capturing into a second buffer they swap with the surface buffer.
+	 *
+	 *  @param pData1  A pointer to the data of image 1 (previous frame)
+	 *  @param format1 The format of image 1
+	 *  @param nStep1  The line width in bytes of image 1
+	 *  @param pData2  A pointer to the data of image 2 (new frame)
+	 *  @param format2 The format of image 2
+	 *  @param nStep2  The line width in bytes of image 2
+	 *  @param areas   The non overlapping areas to compare, relative to both images
+	 *  @param numAreas The number of areas
+	 *  @param region  A region the changed rectangle of each area is added to
+	 *
+	 *  @return the number of changed areas and \b <0 for any error
+	 *
+	 *  @since version 3.16.0
+	 */
+	FREERDP_API int shadow_capture_diff_areas_with_format(
+	    const BYTE* WINPR_RESTRICT pData1, UINT32 format1, UINT32 nStep1,
+	    const BYTE* WINPR_RESTRICT pData2, UINT32 format2, UINT32 nStep2,
+	    const RECTANGLE_16* WINPR_RESTRICT areas, UINT32 numAreas, REGION16* WINPR_RESTRICT region);
+
 	FREERDP_API void shadow_subsystem_frame_update(rdpShadowSubsystem* subsystem);
 
 	FREERDP_API BOOL shadow_client_post_msg(rdpShadowClient* client, void* context, UINT32 type,
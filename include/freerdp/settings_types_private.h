@@ -831,7 +831,10 @@ struct rdp_settings
 	SETTINGS_DEPRECATED(ALIGN64 UINT32 Floatbar);                /* 5196 */
 	SETTINGS_DEPRECATED(ALIGN64 UINT32 TcpConnectTimeout);       /* 5197 */
 	SETTINGS_DEPRECATED(ALIGN64 UINT32 FakeMouseMotionInterval); /* 5198 */
-	UINT64 padding5312[5312 - 5199];                             /* 5199 */
+	SETTINGS_DEPRECATED(ALIGN64 UINT32 TcpNotSentLowWatermark);  /** 5199
+		                                                          * @since version 3.16.0
+		                                                          */
+	UINT64 padding5312[5312 - 5200];                             /* 5200 */
 
 	/**
 	 * WARNING: End of ABI stable zone!
@@ -240,6 +240,16 @@ int bulk_decompress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSr
 int bulk_compress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSrcData, UINT32 SrcSize,
                   const BYTE** WINPR_RESTRICT ppDstData, UINT32* WINPR_RESTRICT pDstSize,
                   UINT32* WINPR_RESTRICT pFlags)
+{
+	WINPR_ASSERT(bulk);
+	return bulk_compress_type(bulk, bulk_compression_level(bulk), pSrcData, SrcSize, ppDstData,
+	                          pDstSize, pFlags);
+}
+
+int bulk_compress_type(rdpBulk* WINPR_RESTRICT bulk, UINT32 type,
+                       const BYTE* WINPR_RESTRICT pSrcData, UINT32 SrcSize,
+                       const BYTE** WINPR_RESTRICT ppDstData, UINT32* WINPR_RESTRICT pDstSize,
+                       UINT32* WINPR_RESTRICT pFlags)
 {
 	int status = -1;
 
@@ -260,14 +270,13 @@ int bulk_compress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSrcD
 	}
 
 	*pDstSize = sizeof(bulk->OutputBuffer);
-	(void)bulk_compression_level(bulk);
 	(void)bulk_compression_max_size(bulk);
 
-	switch (bulk->CompressionLevel)
+	switch (type)
 	{
 		case PACKET_COMPR_TYPE_8K:
 		case PACKET_COMPR_TYPE_64K:
-			mppc_set_compression_level(bulk->mppcSend, bulk->CompressionLevel);
+			mppc_set_compression_level(bulk->mppcSend, type);
 			status = mppc_compress(bulk->mppcSend, pSrcData, SrcSize, bulk->OutputBuffer, ppDstData,
 			                       pDstSize, pFlags);
 			break;
@@ -280,11 +289,11 @@ int bulk_compress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSrcD
 			                         ppDstData, pDstSize, pFlags);
 			break;
 		case PACKET_COMPR_TYPE_RDP8:
-			WLog_ERR(TAG, "Unsupported bulk compression type %08" PRIx32, bulk->CompressionLevel);
+			WLog_ERR(TAG, "Unsupported bulk compression type %08" PRIx32, type);
 			status = -1;
 			break;
 		default:
-			WLog_ERR(TAG, "Unknown bulk compression type %08" PRIx32, bulk->CompressionLevel);
+			WLog_ERR(TAG, "Unknown bulk compression type %08" PRIx32, type);
 			status = -1;
 			break;
 	}
@@ -301,7 +310,7 @@ int bulk_compress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSrcD
 			         "Compress Type: %" PRIu32 " Flags: %s (0x%08" PRIX32
 			         ") Compression Ratio: %f (%" PRIu32 " / %" PRIu32 "), Total: %f (%" PRIu64
 			         " / %" PRIu64 ")",
-			         bulk->CompressionLevel, bulk_get_compression_flags_string(*pFlags), *pFlags,
+			         type, bulk_get_compression_flags_string(*pFlags), *pFlags,
 			         CompressionRatio, CompressedBytes, UncompressedBytes,
 			         metrics->TotalCompressionRatio, metrics->TotalCompressedBytes,
 			         metrics->TotalUncompressedBytes);
@@ -36,6 +36,11 @@ FREERDP_LOCAL int bulk_decompress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINP
 FREERDP_LOCAL int bulk_compress(rdpBulk* WINPR_RESTRICT bulk, const BYTE* WINPR_RESTRICT pSrcData,
                                 UINT32 SrcSize, const BYTE** WINPR_RESTRICT ppDstData,
                                 UINT32* WINPR_RESTRICT pDstSize, UINT32* WINPR_RESTRICT pFlags);
+FREERDP_LOCAL int bulk_compress_type(rdpBulk* WINPR_RESTRICT bulk, UINT32 type,
+                                     const BYTE* WINPR_RESTRICT pSrcData, UINT32 SrcSize,
+                                     const BYTE** WINPR_RESTRICT ppDstData,
+                                     UINT32* WINPR_RESTRICT pDstSize,
+                                     UINT32* WINPR_RESTRICT pFlags);
 
 FREERDP_LOCAL void bulk_reset(rdpBulk* WINPR_RESTRICT bulk);
 
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 
 #include <winpr/crt.h>
+#include <winpr/cast.h>
 
 #include <freerdp/log.h>
 #include <freerdp/freerdp.h>
@@ -1277,6 +1278,156 @@ BOOL freerdp_image_scale(BYTE* WINPR_RESTRICT pDstData, DWORD DstFormat, UINT32
 	return rc;
 }
 
+struct S_FREERDP_IMAGE_SCALER
+{
+	UINT32 nDstWidth;
+	UINT32 nDstHeight;
+	UINT32 nSrcWidth;
+	UINT32 nSrcHeight;
+#if defined(WITH_SWSCALE)
+	struct SwsContext* resize;
+#endif
+};
+
+void freerdp_image_scaler_free(FREERDP_IMAGE_SCALER* scaler)
+{
+	if (!scaler)
+		return;
+
+#if defined(WITH_SWSCALE)
+	sws_freeContext(scaler->resize);
+#endif
+	free(scaler);
+}
+
+FREERDP_IMAGE_SCALER* freerdp_image_scaler_new(DWORD DstFormat, UINT32 nDstWidth,
+                                               UINT32 nDstHeight, DWORD SrcFormat,
+                                               UINT32 nSrcWidth, UINT32 nSrcHeight)
+{
+#if defined(WITH_SWSCALE) || defined(WITH_CAIRO)
+	if ((nDstWidth == 0) || (nDstHeight == 0) || (nSrcWidth == 0) || (nSrcHeight == 0))
+		return NULL;
+
+	if ((nDstWidth > INT_MAX) || (nDstHeight > INT_MAX) || (nSrcWidth > INT_MAX) ||
+	    (nSrcHeight > INT_MAX))
+		return NULL;
+
+	FREERDP_IMAGE_SCALER* scaler = calloc(1, sizeof(FREERDP_IMAGE_SCALER));
+	if (!scaler)
+		return NULL;
+
+	scaler->nDstWidth = nDstWidth;
+	scaler->nDstHeight = nDstHeight;
+	scaler->nSrcWidth = nSrcWidth;
+	scaler->nSrcHeight = nSrcHeight;
+
+#if defined(WITH_SWSCALE)
+	const int srcFormat = av_format_for_buffer(SrcFormat);
+	const int dstFormat = av_format_for_buffer(DstFormat);
+
+	if ((srcFormat == AV_PIX_FMT_NONE) || (dstFormat == AV_PIX_FMT_NONE))
+		goto fail;
+
+	scaler->resize = sws_getContext((int)nSrcWidth, (int)nSrcHeight, srcFormat, (int)nDstWidth,
+	                                (int)nDstHeight, dstFormat, SWS_BILINEAR, NULL, NULL, NULL);
+	if (!scaler->resize)
+		goto fail;
+#else
+	/* cairo scales 32bpp images without converting them */
+	if ((FreeRDPGetBytesPerPixel(SrcFormat) != 4) ||
+	    !FreeRDPAreColorFormatsEqualNoAlpha_int(DstFormat, SrcFormat))
+		goto fail;
+#endif
+
+	return scaler;
+
+fail:
+	freerdp_image_scaler_free(scaler);
+	return NULL;
+#else
+	WINPR_UNUSED(DstFormat);
+	WINPR_UNUSED(nDstWidth);
+	WINPR_UNUSED(nDstHeight);
+	WINPR_UNUSED(SrcFormat);
+	WINPR_UNUSED(nSrcWidth);
+	WINPR_UNUSED(nSrcHeight);
+	return NULL;
+#endif
+}
+
+BOOL freerdp_image_scaler_scale(FREERDP_IMAGE_SCALER* scaler, BYTE* WINPR_RESTRICT pDstData,
+                                UINT32 nDstStep, const BYTE* WINPR_RESTRICT pSrcData,
+                                UINT32 nSrcStep, const RECTANGLE_16* rects, UINT32 count)
+{
+	WINPR_ASSERT(scaler);
+	WINPR_ASSERT(pDstData);
+	WINPR_ASSERT(pSrcData);
+	WINPR_ASSERT(rects || (count == 0));
+
+	if ((nDstStep > INT_MAX) || (nSrcStep > INT_MAX))
+		return FALSE;
+
+#if defined(WITH_SWSCALE)
+	/* swscale only accepts source slices in order, so the whole image is scaled in one call */
+	const BYTE* src = pSrcData;
+	BYTE* dst = pDstData;
+	const int srcStep[1] = { (int)nSrcStep };
+	const int dstStep[1] = { (int)nDstStep };
+
+	WINPR_UNUSED(rects);
+	WINPR_UNUSED(count);
+
+	const int res =
+	    sws_scale(scaler->resize, &src, srcStep, 0, (int)scaler->nSrcHeight, &dst, dstStep);
+	return (res == (int)scaler->nDstHeight);
+#elif defined(WITH_CAIRO)
+	/* the cairo surfaces only wrap the buffers, painting is clipped to the rectangles */
+	BOOL rc = FALSE;
+	cairo_t* cairo_context = NULL;
+	cairo_surface_t* csrc = cairo_image_surface_create_for_data(
+	    WINPR_CAST_CONST_PTR_AWAY(pSrcData, unsigned char*), CAIRO_FORMAT_ARGB32,
+	    (int)scaler->nSrcWidth, (int)scaler->nSrcHeight, (int)nSrcStep);
+	cairo_surface_t* cdst =
+	    cairo_image_surface_create_for_data(pDstData, CAIRO_FORMAT_ARGB32, (int)scaler->nDstWidth,
+	                                        (int)scaler->nDstHeight, (int)nDstStep);
+
+	if ((cairo_surface_status(csrc) != CAIRO_STATUS_SUCCESS) ||
+	    (cairo_surface_status(cdst) != CAIRO_STATUS_SUCCESS))
+		goto fail;
+
+	cairo_context = cairo_create(cdst);
+	if (cairo_status(cairo_context) != CAIRO_STATUS_SUCCESS)
+		goto fail;
+
+	for (UINT32 x = 0; x < count; x++)
+	{
+		const RECTANGLE_16* rect = &rects[x];
+		cairo_rectangle(cairo_context, rect->left, rect->top, rect->right - rect->left,
+		                rect->bottom - rect->top);
+	}
+	if (count > 0)
+		cairo_clip(cairo_context);
+
+	cairo_scale(cairo_context, 1.0 * scaler->nDstWidth / scaler->nSrcWidth,
+	            1.0 * scaler->nDstHeight / scaler->nSrcHeight);
+	cairo_set_operator(cairo_context, CAIRO_OPERATOR_SOURCE);
+	cairo_set_source_surface(cairo_context, csrc, 0, 0);
+	cairo_paint(cairo_context);
+	rc = TRUE;
+fail:
+	cairo_destroy(cairo_context);
+	cairo_surface_destroy(csrc);
+	cairo_surface_destroy(cdst);
+	return rc;
+#else
+	WINPR_UNUSED(pDstData);
+	WINPR_UNUSED(pSrcData);
+	WINPR_UNUSED(rects);
+	WINPR_UNUSED(count);
+	return FALSE;
+#endif
+}
+
 DWORD FreeRDPAreColorFormatsEqualNoAlpha(DWORD first, DWORD second)
 {
 	return FreeRDPAreColorFormatsEqualNoAlpha_int(first, second);
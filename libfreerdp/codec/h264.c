@@ -29,6 +29,7 @@
 #include <freerdp/primitives.h>
 #include <freerdp/codec/h264.h>
 #include <freerdp/codec/yuv.h>
+#include <freerdp/codec/region.h>
 #include <freerdp/log.h>
 
 #include "h264.h"
@@ -278,6 +279,23 @@ INT32 h264_compress(H264_CONTEXT* h264, BYTE** ppDstData, UINT32* pDstSize)
 	return h264->subsystem->Compress(h264, pcYUVData, h264->iStride, ppDstData, pDstSize);
 }
 
+static INT32 h264_compress_with_change_map(H264_CONTEXT* h264, const BYTE* pcYUVData[3],
+                                           const RDPGFX_H264_METABLOCK* meta, BYTE** ppDstData,
+                                           UINT32* pDstSize)
+{
+	WINPR_ASSERT(h264);
+	WINPR_ASSERT(h264->subsystem);
+	WINPR_ASSERT(meta);
+
+	/* let the backend know which areas changed, everything else can be coded as skip */
+	h264->changedRects = meta->regionRects;
+	h264->numChangedRects = meta->numRegionRects;
+	const INT32 rc = h264->subsystem->Compress(h264, pcYUVData, h264->iStride, ppDstData, pDstSize);
+	h264->changedRects = NULL;
+	h264->numChangedRects = 0;
+	return rc;
+}
+
 INT32 avc420_compress(H264_CONTEXT* h264, const BYTE* pSrcData, DWORD SrcFormat, UINT32 nSrcStep,
                       UINT32 nSrcWidth, UINT32 nSrcHeight, const RECTANGLE_16* regionRect,
                       BYTE** ppDstData, UINT32* pDstSize, RDPGFX_H264_METABLOCK* meta)
@@ -331,13 +349,206 @@ INT32 avc420_compress(H264_CONTEXT* h264, const BYTE* pSrcData, DWORD SrcFormat,
 	for (size_t x = 0; x < 3; x++)
 		pcYUVData[x] = pYUVData[x];
 
-	rc = h264->subsystem->Compress(h264, pcYUVData, h264->iStride, ppDstData, pDstSize);
+	rc = h264_compress_with_change_map(h264, pcYUVData, meta, ppDstData, pDstSize);
+	if (rc >= 0)
+		h264->firstLumaFrameDone = TRUE;
+
+fail:
+	if (rc < 0)
+		free_h264_metablock(meta);
+	return rc;
+}
+
+static void copy_tile(const RECTANGLE_16* WINPR_RESTRICT rect, BYTE* WINPR_RESTRICT pDst[3],
+                      BYTE* WINPR_RESTRICT pSrc[3], const UINT32 iStride[3])
+{
+	WINPR_ASSERT(rect);
+
+	const size_t width = rect->right - rect->left;
+	for (size_t y = rect->top; y < rect->bottom; y++)
+		memcpy(&pDst[0][y * iStride[0] + rect->left], &pSrc[0][y * iStride[0] + rect->left],
+		       width);
+
+	for (size_t y = rect->top / 2; y < (rect->bottom + 1ull) / 2; y++)
+	{
+		for (size_t x = 1; x < 3; x++)
+			memcpy(&pDst[x][y * iStride[x] + rect->left / 2],
+			       &pSrc[x][y * iStride[x] + rect->left / 2], (width + 1) / 2);
+	}
+}
+
+static void mark_damage(BYTE* map, size_t wc, size_t hc, const RECTANGLE_16* frame,
+                        const RECTANGLE_16* damageRects, UINT32 numDamageRects)
+{
+	WINPR_ASSERT(map);
+	WINPR_ASSERT(frame);
+
+	for (UINT32 x = 0; x < numDamageRects; x++)
+	{
+		RECTANGLE_16 rect = { 0 };
+		if (!rectangles_intersection(&damageRects[x], frame, &rect))
+			continue;
+
+		const size_t right = MIN(wc, (rect.right + 63ull) / 64);
+		const size_t bottom = MIN(hc, (rect.bottom + 63ull) / 64);
+		for (size_t ty = rect.top / 64; ty < bottom; ty++)
+		{
+			for (size_t tx = rect.left / 64; tx < right; tx++)
+				map[ty * wc + tx] = 1;
+		}
+	}
+}
+
+INT32 avc420_compress_region(H264_CONTEXT* h264, const BYTE* pSrcData, DWORD SrcFormat,
+                             UINT32 nSrcStep, UINT32 nSrcWidth, UINT32 nSrcHeight,
+                             const RECTANGLE_16* damageRects, UINT32 numDamageRects,
+                             BYTE** ppDstData, UINT32* pDstSize, RDPGFX_H264_METABLOCK* meta)
+{
+	INT32 rc = -1;
+	BYTE* map = NULL;
+	RECTANGLE_16* spans = NULL;
+	RECTANGLE_16* rectangles = NULL;
+	BYTE* pYUVData[3] = { 0 };
+	BYTE* pOldYUVData[3] = { 0 };
+	size_t nspans = 0;
+	size_t count = 0;
+
+	if (!h264 || !meta || !h264->Compressor || (!damageRects && (numDamageRects > 0)))
+		return -1;
+
+	if (!h264->subsystem->Compress)
+		return -1;
+
+	if ((nSrcWidth > UINT16_MAX) || (nSrcHeight > UINT16_MAX))
+		return -1;
+
+	const RECTANGLE_16 frame = { .left = 0,
+		                         .top = 0,
+		                         .right = (UINT16)nSrcWidth,
+		                         .bottom = (UINT16)nSrcHeight };
+
+	/* NV12 layout is not supported by the partial conversion, convert the whole frame */
+	if (h264->hwAccel)
+		return avc420_compress(h264, pSrcData, SrcFormat, nSrcStep, nSrcWidth, nSrcHeight, &frame,
+		                       ppDstData, pDstSize, meta);
+
+	const BOOL full = !h264->firstLumaFrameDone || (h264->width != nSrcWidth) ||
+	                  (h264->height != nSrcHeight);
+
+	if (!avc420_ensure_buffer(h264, nSrcStep, nSrcWidth, nSrcHeight))
+		return -1;
+
+	/* The buffer written last holds the complete previous frame. Only the damaged tiles are
+	 * converted into it, the other buffer keeps a copy of their previous content to detect
+	 * which of them actually changed. */
+	for (size_t x = 0; x < 3; x++)
+	{
+		pYUVData[x] = h264->encodingBuffer ? h264->pOldYUVData[x] : h264->pYUVData[x];
+		pOldYUVData[x] = h264->encodingBuffer ? h264->pYUVData[x] : h264->pOldYUVData[x];
+	}
+
+	const size_t wc = (nSrcWidth + 63ull) / 64;
+	const size_t hc = (nSrcHeight + 63ull) / 64;
+	map = calloc(wc * hc, sizeof(BYTE));
+	spans = calloc(wc * hc, sizeof(RECTANGLE_16));
+	rectangles = calloc(wc * hc, sizeof(RECTANGLE_16));
+	if (!map || !spans || !rectangles)
+		goto fail;
+
+	if (full)
+		memset(map, 1, wc * hc);
+	else
+		mark_damage(map, wc, hc, &frame, damageRects, numDamageRects);
+
+	/* merge horizontally adjacent damaged tiles to reduce the number of conversion jobs */
+	for (size_t ty = 0; ty < hc; ty++)
+	{
+		for (size_t tx = 0; tx < wc; tx++)
+		{
+			if (!map[ty * wc + tx])
+				continue;
+
+			const size_t start = tx;
+			while ((tx < wc) && map[ty * wc + tx])
+			{
+				const RECTANGLE_16 tile = {
+					.left = (UINT16)(tx * 64),
+					.top = (UINT16)(ty * 64),
+					.right = (UINT16)MIN(nSrcWidth, (tx + 1) * 64),
+					.bottom = (UINT16)MIN(nSrcHeight, (ty + 1) * 64),
+				};
+				if (!full)
+					copy_tile(&tile, pOldYUVData, pYUVData, h264->iStride);
+				tx++;
+			}
+
+			RECTANGLE_16* span = &spans[nspans++];
+			span->left = (UINT16)(start * 64);
+			span->top = (UINT16)(ty * 64);
+			span->right = (UINT16)MIN(nSrcWidth, tx * 64);
+			span->bottom = (UINT16)MIN(nSrcHeight, (ty + 1) * 64);
+		}
+	}
+
+	if (nspans == 0)
+	{
+		rc = 0;
+		goto fail;
+	}
+
+	WINPR_ASSERT(nspans <= UINT32_MAX);
+	if (!yuv420_context_encode(h264->yuv, pSrcData, nSrcStep, SrcFormat, h264->iStride, pYUVData,
+	                           spans, (UINT32)nspans))
+		goto fail;
+
+	if (full)
+		rectangles[count++] = frame;
+	else
+	{
+		for (size_t ty = 0; ty < hc; ty++)
+		{
+			for (size_t tx = 0; tx < wc; tx++)
+			{
+				if (!map[ty * wc + tx])
+					continue;
+
+				const RECTANGLE_16 tile = {
+					.left = (UINT16)(tx * 64),
+					.top = (UINT16)(ty * 64),
+					.right = (UINT16)MIN(nSrcWidth, (tx + 1) * 64),
+					.bottom = (UINT16)MIN(nSrcHeight, (ty + 1) * 64),
+				};
+				if (diff_tile(&tile, pYUVData, pOldYUVData, h264->iStride))
+					rectangles[count++] = tile;
+			}
+		}
+	}
+
+	/* ownership of rectangles is passed on to meta */
+	const BOOL res = allocate_h264_metablock(h264->QP, rectangles, meta, count);
+	rectangles = NULL;
+	if (!res)
+		goto fail;
+
+	if (meta->numRegionRects == 0)
+	{
+		rc = 0;
+		goto fail;
+	}
+
+	{
+		const BYTE* pcYUVData[3] = { pYUVData[0], pYUVData[1], pYUVData[2] };
+		rc = h264_compress_with_change_map(h264, pcYUVData, meta, ppDstData, pDstSize);
+	}
 	if (rc >= 0)
 		h264->firstLumaFrameDone = TRUE;
 
 fail:
 	if (rc < 0)
 		free_h264_metablock(meta);
+	free(rectangles);
+	free(spans);
+	free(map);
 	return rc;
 }
 
@@ -706,6 +917,8 @@ BOOL h264_context_reset(H264_CONTEXT* h264, UINT32 width, UINT32 height)
 
 	h264->width = width;
 	h264->height = height;
+	h264->firstLumaFrameDone = FALSE;
+	h264->firstChromaFrameDone = FALSE;
 
 	if (h264->subsystem && h264->subsystem->Uninit)
 		h264->subsystem->Uninit(h264);
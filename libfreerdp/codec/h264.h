@@ -85,6 +85,10 @@ extern "C"
 
 		void* lumaData;
 		wLog* log;
+
+		/* areas that changed since the last frame, only valid during Compress */
+		const RECTANGLE_16* changedRects;
+		UINT32 numChangedRects;
 	};
 
 	FREERDP_LOCAL BOOL avc420_ensure_buffer(H264_CONTEXT* h264, UINT32 stride, UINT32 width,
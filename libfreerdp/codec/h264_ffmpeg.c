@@ -374,6 +374,54 @@ fail:
 	return rc;
 }
 
+/* Pass the change map of the frame as ROI side data. Changed areas are encoded with the
+ * configured quantizer, everything else gets the maximum quantizer offset so the encoder can
+ * cheaply code those macroblocks as skips. */
+static BOOL libavcodec_set_change_map(H264_CONTEXT* WINPR_RESTRICT h264, AVFrame* frame)
+{
+	WINPR_ASSERT(h264);
+	WINPR_ASSERT(frame);
+
+#if LIBAVUTIL_VERSION_INT >= AV_VERSION_INT(56, 25, 100)
+	av_frame_remove_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST);
+
+	if (!h264->changedRects || (h264->numChangedRects == 0))
+		return TRUE;
+
+	/* The first region containing a macroblock takes precedence */
+	const size_t count = h264->numChangedRects + 1ull;
+	AVFrameSideData* sd = av_frame_new_side_data(frame, AV_FRAME_DATA_REGIONS_OF_INTEREST,
+	                                             count * sizeof(AVRegionOfInterest));
+	if (!sd)
+		return FALSE;
+
+	AVRegionOfInterest* roi = (AVRegionOfInterest*)sd->data;
+	for (size_t x = 0; x < h264->numChangedRects; x++)
+	{
+		const RECTANGLE_16* rect = &h264->changedRects[x];
+		AVRegionOfInterest* cur = &roi[x];
+		cur->self_size = sizeof(AVRegionOfInterest);
+		cur->top = rect->top;
+		cur->bottom = rect->bottom;
+		cur->left = rect->left;
+		cur->right = rect->right;
+		cur->qoffset = av_make_q(0, 1);
+	}
+
+	AVRegionOfInterest* unchanged = &roi[h264->numChangedRects];
+	unchanged->self_size = sizeof(AVRegionOfInterest);
+	unchanged->top = 0;
+	unchanged->bottom = frame->height;
+	unchanged->left = 0;
+	unchanged->right = frame->width;
+	unchanged->qoffset = av_make_q(1, 1);
+#else
+	WINPR_UNUSED(h264);
+	WINPR_UNUSED(frame);
+#endif
+	return TRUE;
+}
+
 static int libavcodec_compress(H264_CONTEXT* WINPR_RESTRICT h264,
                                const BYTE** WINPR_RESTRICT pSrcYuv,
                                const UINT32* WINPR_RESTRICT pStride,
@@ -461,6 +509,16 @@ static int libavcodec_compress(H264_CONTEXT* WINPR_RESTRICT h264,
 	}
 #endif
 
+#ifdef WITH_VAAPI_H264_ENCODING
+	if (!libavcodec_set_change_map(h264, sys->hwctx ? sys->hwVideoFrame : sys->videoFrame))
+#else
+	if (!libavcodec_set_change_map(h264, sys->videoFrame))
+#endif
+	{
+		WLog_Print(h264->log, WLOG_ERROR, "Failed to attach change map to video frame");
+		goto fail;
+	}
+
 	/* avcodec_encode_video2 is deprecated with libavcodec 57.48.101 */
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 48, 101)
 #ifdef WITH_VAAPI_H264_ENCODING
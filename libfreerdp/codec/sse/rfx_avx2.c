@@ -0,0 +1,267 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ * RemoteFX Codec Library - AVX2 Optimizations
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <winpr/assert.h>
+#include <winpr/cast.h>
+#include <winpr/platform.h>
+#include <freerdp/config.h>
+
+#include "../rfx_types.h"
+#include "rfx_avx2.h"
+
+#include "../../core/simd.h"
+
+#if defined(SSE_AVX_INTRINSICS_ENABLED)
+#include <immintrin.h>
+
+static inline __m256i LOAD_SI256(const void* ptr)
+{
+	return _mm256_loadu_si256((const __m256i*)ptr);
+}
+
+static inline void STORE_SI256(void* ptr, __m256i val)
+{
+	_mm256_storeu_si256((__m256i*)ptr, val);
+}
+
+/* Returns { v[0], v[0], v[1], ..., v[14] }, the 16 bit elements shifted up by one */
+static inline __m256i mm256_shift_up_epi16(__m256i v)
+{
+	const __m256i low = _mm256_permute2x128_si256(v, v, 0x08);
+	const __m256i shifted = _mm256_alignr_epi8(v, low, 14);
+	return _mm256_insert_epi16(shifted, _mm256_extract_epi16(v, 0), 0);
+}
+
+/* Returns { v[1], v[2], ..., v[15], v[15] }, the 16 bit elements shifted down by one */
+static inline __m256i mm256_shift_down_epi16(__m256i v)
+{
+	const __m256i high = _mm256_permute2x128_si256(v, v, 0x81);
+	const __m256i shifted = _mm256_alignr_epi8(high, v, 2);
+	return _mm256_insert_epi16(shifted, _mm256_extract_epi16(v, 15), 15);
+}
+
+static inline void rfx_quantization_decode_block_avx2(INT16* WINPR_RESTRICT buffer,
+                                                      size_t buffer_size, UINT32 factor)
+{
+	if (factor == 0)
+		return;
+
+	const __m128i shift = _mm_cvtsi32_si128(WINPR_ASSERTING_INT_CAST(int, factor));
+	for (size_t x = 0; x < buffer_size; x += 16)
+	{
+		const __m256i a = LOAD_SI256(&buffer[x]);
+		STORE_SI256(&buffer[x], _mm256_sll_epi16(a, shift));
+	}
+}
+
+static void rfx_quantization_decode_avx2(INT16* WINPR_RESTRICT buffer,
+                                         const UINT32* WINPR_RESTRICT quantVals)
+{
+	WINPR_ASSERT(buffer);
+	WINPR_ASSERT(quantVals);
+
+	rfx_quantization_decode_block_avx2(&buffer[0], 1024, quantVals[8] - 1);    /* HL1 */
+	rfx_quantization_decode_block_avx2(&buffer[1024], 1024, quantVals[7] - 1); /* LH1 */
+	rfx_quantization_decode_block_avx2(&buffer[2048], 1024, quantVals[9] - 1); /* HH1 */
+	rfx_quantization_decode_block_avx2(&buffer[3072], 256, quantVals[5] - 1);  /* HL2 */
+	rfx_quantization_decode_block_avx2(&buffer[3328], 256, quantVals[4] - 1);  /* LH2 */
+	rfx_quantization_decode_block_avx2(&buffer[3584], 256, quantVals[6] - 1);  /* HH2 */
+	rfx_quantization_decode_block_avx2(&buffer[3840], 64, quantVals[2] - 1);   /* HL3 */
+	rfx_quantization_decode_block_avx2(&buffer[3904], 64, quantVals[1] - 1);   /* LH3 */
+	rfx_quantization_decode_block_avx2(&buffer[3968], 64, quantVals[3] - 1);   /* HH3 */
+	rfx_quantization_decode_block_avx2(&buffer[4032], 64, quantVals[0] - 1);   /* LL3 */
+}
+
+static inline void rfx_dwt_2d_decode_block_horiz_avx2(INT16* WINPR_RESTRICT l,
+                                                      const INT16* WINPR_RESTRICT h,
+                                                      INT16* WINPR_RESTRICT dst,
+                                                      size_t subband_width)
+{
+	const __m256i one = _mm256_set1_epi16(1);
+
+	WINPR_ASSERT((subband_width % 16) == 0);
+
+	for (size_t y = 0; y < subband_width; y++)
+	{
+		INT16* l_row = &l[y * subband_width];
+		const INT16* h_row = &h[y * subband_width];
+		INT16* dst_row = &dst[y * subband_width * 2];
+
+		/* Even coefficients */
+		for (size_t n = 0; n < subband_width; n += 16)
+		{
+			/* dst[2n] = l[n] - ((h[n-1] + h[n] + 1) >> 1); */
+			const __m256i l_n = LOAD_SI256(&l_row[n]);
+			const __m256i h_n = LOAD_SI256(&h_row[n]);
+			const __m256i h_n_m = (n == 0) ? mm256_shift_up_epi16(h_n) : LOAD_SI256(&h_row[n - 1]);
+
+			__m256i tmp_n = _mm256_add_epi16(_mm256_add_epi16(h_n, h_n_m), one);
+			tmp_n = _mm256_srai_epi16(tmp_n, 1);
+			STORE_SI256(&l_row[n], _mm256_sub_epi16(l_n, tmp_n));
+		}
+
+		/* Odd coefficients */
+		for (size_t n = 0; n < subband_width; n += 16)
+		{
+			/* dst[2n + 1] = (h[n] << 1) + ((dst[2n] + dst[2n + 2]) >> 1); */
+			const __m256i h_n = _mm256_slli_epi16(LOAD_SI256(&h_row[n]), 1);
+			const __m256i dst_n = LOAD_SI256(&l_row[n]);
+			const __m256i dst_n_p = (n + 16 == subband_width) ? mm256_shift_down_epi16(dst_n)
+			                                                  : LOAD_SI256(&l_row[n + 1]);
+
+			__m256i tmp_n = _mm256_add_epi16(dst_n_p, dst_n);
+			tmp_n = _mm256_srai_epi16(tmp_n, 1);
+			tmp_n = _mm256_add_epi16(tmp_n, h_n);
+
+			/* unpack works on 128 bit lanes, restore the element order before storing */
+			const __m256i lo = _mm256_unpacklo_epi16(dst_n, tmp_n);
+			const __m256i hi = _mm256_unpackhi_epi16(dst_n, tmp_n);
+			STORE_SI256(&dst_row[2 * n], _mm256_permute2x128_si256(lo, hi, 0x20));
+			STORE_SI256(&dst_row[2 * n + 16], _mm256_permute2x128_si256(lo, hi, 0x31));
+		}
+	}
+}
+
+/* The 8x8 level has rows of 8 coefficients only, that fits a 128 bit register */
+static inline void rfx_dwt_2d_decode_block_horiz_8_avx2(INT16* WINPR_RESTRICT l,
+                                                        const INT16* WINPR_RESTRICT h,
+                                                        INT16* WINPR_RESTRICT dst)
+{
+	const __m128i one = _mm_set1_epi16(1);
+
+	for (size_t y = 0; y < 8; y++)
+	{
+		INT16* l_row = &l[y * 8];
+		const INT16* h_row = &h[y * 8];
+		INT16* dst_row = &dst[y * 16];
+
+		const __m128i h_n = _mm_loadu_si128((const __m128i*)h_row);
+		const __m128i h_n_m = _mm_insert_epi16(_mm_slli_si128(h_n, 2), h_row[0], 0);
+		__m128i tmp_n = _mm_add_epi16(_mm_add_epi16(h_n, h_n_m), one);
+		tmp_n = _mm_srai_epi16(tmp_n, 1);
+		const __m128i dst_n = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)l_row), tmp_n);
+
+		const __m128i dst_n_p = _mm_insert_epi16(_mm_srli_si128(dst_n, 2),
+		                                         _mm_extract_epi16(dst_n, 7), 7);
+		tmp_n = _mm_srai_epi16(_mm_add_epi16(dst_n_p, dst_n), 1);
+		tmp_n = _mm_add_epi16(tmp_n, _mm_slli_epi16(h_n, 1));
+
+		_mm_storeu_si128((__m128i*)l_row, dst_n);
+		_mm_storeu_si128((__m128i*)dst_row, _mm_unpacklo_epi16(dst_n, tmp_n));
+		_mm_storeu_si128((__m128i*)&dst_row[8], _mm_unpackhi_epi16(dst_n, tmp_n));
+	}
+}
+
+static inline void rfx_dwt_2d_decode_block_vert_avx2(const INT16* WINPR_RESTRICT l,
+                                                     const INT16* WINPR_RESTRICT h,
+                                                     INT16* WINPR_RESTRICT dst,
+                                                     size_t subband_width)
+{
+	const __m256i one = _mm256_set1_epi16(1);
+	const size_t total_width = subband_width + subband_width;
+
+	WINPR_ASSERT((total_width % 16) == 0);
+
+	/* Even coefficients */
+	for (size_t n = 0; n < subband_width; n++)
+	{
+		const INT16* l_row = &l[n * total_width];
+		const INT16* h_row = &h[n * total_width];
+		const INT16* h_row_m = (n == 0) ? h_row : &h[(n - 1) * total_width];
+		INT16* dst_row = &dst[2 * n * total_width];
+
+		for (size_t x = 0; x < total_width; x += 16)
+		{
+			/* dst[2n] = l[n] - ((h[n-1] + h[n] + 1) >> 1); */
+			const __m256i l_n = LOAD_SI256(&l_row[x]);
+			const __m256i h_n = LOAD_SI256(&h_row[x]);
+			const __m256i h_n_m = LOAD_SI256(&h_row_m[x]);
+			__m256i tmp_n = _mm256_add_epi16(_mm256_add_epi16(h_n, h_n_m), one);
+			tmp_n = _mm256_srai_epi16(tmp_n, 1);
+			STORE_SI256(&dst_row[x], _mm256_sub_epi16(l_n, tmp_n));
+		}
+	}
+
+	/* Odd coefficients */
+	for (size_t n = 0; n < subband_width; n++)
+	{
+		const INT16* h_row = &h[n * total_width];
+		INT16* dst_row = &dst[(2 * n + 1) * total_width];
+		const INT16* dst_row_m = dst_row - total_width;
+		const INT16* dst_row_p = (n == subband_width - 1) ? dst_row_m : dst_row + total_width;
+
+		for (size_t x = 0; x < total_width; x += 16)
+		{
+			/* dst[2n + 1] = (h[n] << 1) + ((dst[2n] + dst[2n + 2]) >> 1); */
+			const __m256i h_n = _mm256_slli_epi16(LOAD_SI256(&h_row[x]), 1);
+			const __m256i dst_n_m = LOAD_SI256(&dst_row_m[x]);
+			const __m256i dst_n_p = LOAD_SI256(&dst_row_p[x]);
+			__m256i tmp_n = _mm256_srai_epi16(_mm256_add_epi16(dst_n_m, dst_n_p), 1);
+			STORE_SI256(&dst_row[x], _mm256_add_epi16(tmp_n, h_n));
+		}
+	}
+}
+
+static inline void rfx_dwt_2d_decode_block_avx2(INT16* WINPR_RESTRICT buffer,
+                                                INT16* WINPR_RESTRICT idwt, size_t subband_width)
+{
+	/* The 4 sub-bands are stored in HL(0), LH(1), HH(2), LL(3) order. */
+	INT16* hl = buffer;
+	INT16* lh = buffer + 1ULL * subband_width * subband_width;
+	INT16* hh = buffer + 2ULL * subband_width * subband_width;
+	INT16* ll = buffer + 3ULL * subband_width * subband_width;
+	INT16* l_dst = idwt;
+	INT16* h_dst = idwt + 2ULL * subband_width * subband_width;
+
+	/* Inverse DWT in horizontal direction, results in 2 sub-bands in L, H order in idwt. */
+	if (subband_width == 8)
+	{
+		rfx_dwt_2d_decode_block_horiz_8_avx2(ll, hl, l_dst);
+		rfx_dwt_2d_decode_block_horiz_8_avx2(lh, hh, h_dst);
+	}
+	else
+	{
+		rfx_dwt_2d_decode_block_horiz_avx2(ll, hl, l_dst, subband_width);
+		rfx_dwt_2d_decode_block_horiz_avx2(lh, hh, h_dst, subband_width);
+	}
+
+	/* Inverse DWT in vertical direction, results are stored in original buffer. */
+	rfx_dwt_2d_decode_block_vert_avx2(l_dst, h_dst, buffer, subband_width);
+}
+
+static void rfx_dwt_2d_decode_avx2(INT16* WINPR_RESTRICT buffer, INT16* WINPR_RESTRICT dwt_buffer)
+{
+	WINPR_ASSERT(buffer);
+	WINPR_ASSERT(dwt_buffer);
+
+	rfx_dwt_2d_decode_block_avx2(&buffer[3840], dwt_buffer, 8);
+	rfx_dwt_2d_decode_block_avx2(&buffer[3072], dwt_buffer, 16);
+	rfx_dwt_2d_decode_block_avx2(&buffer[0], dwt_buffer, 32);
+}
+#endif
+
+void rfx_init_avx2_int(RFX_CONTEXT* WINPR_RESTRICT context)
+{
+#if defined(SSE_AVX_INTRINSICS_ENABLED)
+	PROFILER_RENAME(context->priv->prof_rfx_quantization_decode, "rfx_quantization_decode_avx2")
+	PROFILER_RENAME(context->priv->prof_rfx_dwt_2d_decode, "rfx_dwt_2d_decode_avx2")
+	context->quantization_decode = rfx_quantization_decode_avx2;
+	context->dwt_2d_decode = rfx_dwt_2d_decode_avx2;
+#else
+	WINPR_UNUSED(context);
+#endif
+}
@@ -8,6 +8,7 @@
 
 #include <freerdp/freerdp.h>
 #include <freerdp/codec/color.h>
+#include <freerdp/codec/region.h>
 
 static const char* print_ns(UINT64 start, UINT64 end, char* buffer, size_t len)
 {
@@ -139,6 +140,85 @@ fail:
 	return rc;
 }
 
+static BOOL testEncodeRegion(uint32_t format, uint32_t width, uint32_t height)
+{
+	BOOL rc = FALSE;
+	void* src = NULL;
+	uint8_t* dst = NULL;
+	uint32_t dstsize = 0;
+	uint32_t stride = 0;
+	RDPGFX_H264_METABLOCK meta = { 0 };
+	H264_CONTEXT* h264 = h264_context_new(TRUE);
+	if (!h264)
+		goto fail;
+
+	if (!h264_context_reset(h264, width, height))
+		goto fail;
+
+	src = allocRGB(format, width, height, &stride);
+	if (!src)
+		goto fail;
+
+	/* first frame is always fully encoded */
+	const UINT64 start = winpr_GetUnixTimeNS();
+	if (avc420_compress_region(h264, src, format, stride, width, height, NULL, 0, &dst, &dstsize,
+	                           &meta) <= 0)
+		goto fail;
+	const UINT64 end = winpr_GetUnixTimeNS();
+	if (meta.numRegionRects != 1)
+		goto fail;
+	free_h264_metablock(&meta);
+
+	/* damage without changes must not produce a frame */
+	const RECTANGLE_16 full = { .left = 0, .top = 0, .right = width, .bottom = height };
+	if (avc420_compress_region(h264, src, format, stride, width, height, &full, 1, &dst, &dstsize,
+	                           &meta) != 0)
+		goto fail;
+	free_h264_metablock(&meta);
+
+	/* two small changes far apart, only their tiles may be reported */
+	const size_t bpp = FreeRDPGetBytesPerPixel(format);
+	const RECTANGLE_16 damage[] = {
+		{ .left = 0, .top = 0, .right = 2, .bottom = 2 },
+		{ .left = width - 2, .top = height - 2, .right = width, .bottom = height }
+	};
+	for (size_t x = 0; x < ARRAYSIZE(damage); x++)
+	{
+		const RECTANGLE_16* cur = &damage[x];
+		for (size_t y = cur->top; y < cur->bottom; y++)
+			memset(&((BYTE*)src)[y * stride + cur->left * bpp], 0xFF,
+			       (cur->right - cur->left) * bpp);
+	}
+
+	const UINT64 dstart = winpr_GetUnixTimeNS();
+	if (avc420_compress_region(h264, src, format, stride, width, height, damage,
+	                           ARRAYSIZE(damage), &dst, &dstsize, &meta) < 0)
+		goto fail;
+	const UINT64 dend = winpr_GetUnixTimeNS();
+
+	if ((meta.numRegionRects == 0) || (meta.numRegionRects > ARRAYSIZE(damage)))
+		goto fail;
+
+	for (size_t x = 0; x < meta.numRegionRects; x++)
+	{
+		const RECTANGLE_16* cur = &meta.regionRects[x];
+		if (!rectangles_intersects(cur, &damage[0]) && !rectangles_intersects(cur, &damage[1]))
+			goto fail;
+	}
+
+	char buffer[64] = { 0 };
+	char dbuffer[64] = { 0 };
+	printf("[%s] %" PRIu32 "x%" PRIu32 " full frame took %s, sparse damage took %s\n", __func__,
+	       width, height, print_ns(start, end, buffer, sizeof(buffer)),
+	       print_ns(dstart, dend, dbuffer, sizeof(dbuffer)));
+	rc = TRUE;
+fail:
+	h264_context_free(h264);
+	free_h264_metablock(&meta);
+	free(src);
+	return rc;
+}
+
 int TestFreeRDPCodecH264(int argc, char* argv[])
 {
 	WINPR_UNUSED(argc);
@@ -188,5 +268,8 @@ int TestFreeRDPCodecH264(int argc, char* argv[])
 		}
 	}
 
+	if (!testEncodeRegion(PIXEL_FORMAT_BGRX32, width, height))
+		return -1;
+
 	return 0;
 }
@@ -4,6 +4,14 @@
 #include <freerdp/freerdp.h>
 #include <freerdp/codec/rfx.h>
 
+#if defined(BUILD_TESTING_INTERNAL)
+#include <winpr/crypto.h>
+
+#include "../rfx_types.h"
+#include "../rfx_dwt.h"
+#include "../rfx_quantization.h"
+#endif
+
 static BYTE encodeHeaderSample[] = {
 	/* as in 4.2.2 */
 	0xc0, 0xcc, 0x0c, 0x00, 0x00, 0x00, 0xca, 0xac, 0xcc, 0xca, 0x00, 0x01, 0xc3, 0xcc, 0x0d, 0x00,
@@ -842,6 +850,72 @@ static BOOL fuzzyCompareImage(const UINT32* crefImage, const BYTE* img, size_t n
 	return TRUE;
 }
 
+#if defined(BUILD_TESTING_INTERNAL)
+/* 4096 coefficients of a tile plus the padding the decoder buffers have */
+#define TEST_COEFFS 4096
+#define TEST_BUFFER_SIZE ((TEST_COEFFS + 16) * sizeof(INT16))
+
+/* Random coefficients in [-127, 127], small enough that no kernel overflows 16 bit */
+static BOOL test_random_coefficients(INT16* buffer)
+{
+	if (winpr_RAND(buffer, TEST_COEFFS * sizeof(INT16)) < 0)
+		return FALSE;
+
+	for (size_t x = 0; x < TEST_COEFFS; x++)
+		buffer[x] = (INT16)(buffer[x] % 128);
+	return TRUE;
+}
+
+/* The decode kernels the context picked (AVX2, SSE2 or NEON) must match the generic ones */
+static BOOL test_decode_kernels(RFX_CONTEXT* context)
+{
+	BOOL rc = FALSE;
+	INT16* ref = winpr_aligned_calloc(TEST_BUFFER_SIZE, 1, 32);
+	INT16* opt = winpr_aligned_calloc(TEST_BUFFER_SIZE, 1, 32);
+	INT16* dwt = winpr_aligned_calloc(TEST_BUFFER_SIZE, 2, 32);
+	if (!ref || !opt || !dwt)
+		goto fail;
+
+	for (size_t round = 0; round < 16; round++)
+	{
+		UINT32 quant[10] = { 0 };
+		for (size_t x = 0; x < ARRAYSIZE(quant); x++)
+			quant[x] = 6 + (UINT32)((round + x) % 4);
+
+		if (!test_random_coefficients(ref))
+			goto fail;
+		memcpy(opt, ref, TEST_COEFFS * sizeof(INT16));
+
+		rfx_quantization_decode(ref, quant);
+		context->quantization_decode(opt, quant);
+		if (memcmp(ref, opt, TEST_COEFFS * sizeof(INT16)) != 0)
+		{
+			(void)fprintf(stderr, "[%s] quantization_decode mismatch\n", __func__);
+			goto fail;
+		}
+
+		if (!test_random_coefficients(ref))
+			goto fail;
+		memcpy(opt, ref, TEST_COEFFS * sizeof(INT16));
+
+		rfx_dwt_2d_decode(ref, dwt);
+		context->dwt_2d_decode(opt, dwt);
+		if (memcmp(ref, opt, TEST_COEFFS * sizeof(INT16)) != 0)
+		{
+			(void)fprintf(stderr, "[%s] dwt_2d_decode mismatch\n", __func__);
+			goto fail;
+		}
+	}
+
+	rc = TRUE;
+fail:
+	winpr_aligned_free(ref);
+	winpr_aligned_free(opt);
+	winpr_aligned_free(dwt);
+	return rc;
+}
+#endif
+
 int TestFreeRDPCodecRemoteFX(int argc, char* argv[])
 {
 	int rc = -1;
@@ -877,6 +951,11 @@ int TestFreeRDPCodecRemoteFX(int argc, char* argv[])
 	if (!fuzzyCompareImage(srefImage, dest, IMG_WIDTH * IMG_HEIGHT))
 		goto fail;
 
+#if defined(BUILD_TESTING_INTERNAL)
+	if (!test_decode_kernels(context))
+		goto fail;
+#endif
+
 	rc = 0;
 fail:
 	region16_uninit(&region);
@@ -823,21 +823,16 @@ static BOOL pool_encode(YUV_CONTEXT* WINPR_RESTRICT context, PTP_WORK_CALLBACK c
 		return TRUE;
 	}
 
-	/* case where we use threads */
-	for (UINT32 x = 0; x < numRegionRects; x++)
-	{
-		const RECTANGLE_16* rect = &regionRects[x];
-		const UINT32 height = rect->bottom - rect->top;
-		const UINT32 steps = (height + context->heightStep / 2) / context->heightStep;
-
-		waitCount += steps;
-	}
+	/* case where we use threads
+	 * split each rectangle in bands of (even) heightStep lines, small rectangles (e.g. damaged
+	 * tiles) are converted by a single job */
+	const UINT32 heightStep = MAX(2, context->heightStep & ~1u);
 
 	for (UINT32 x = 0; x < numRegionRects; x++)
 	{
 		const RECTANGLE_16* rect = &regionRects[x];
 		const UINT32 height = rect->bottom - rect->top;
-		const UINT32 steps = (height + context->heightStep / 2) / context->heightStep;
+		const UINT32 steps = (height + heightStep - 1) / heightStep;
 
 		for (UINT32 y = 0; y < steps; y++)
 		{
@@ -851,7 +846,8 @@ static BOOL pool_encode(YUV_CONTEXT* WINPR_RESTRICT context, PTP_WORK_CALLBACK c
 			}
 
 			current = &context->work_enc_params[waitCount];
-			r.top += y * context->heightStep;
+			r.top += y * heightStep;
+			r.bottom = (UINT16)MIN(rect->bottom, r.top + heightStep);
 			*current = pool_encode_fill(&r, context, pSrcData, nSrcStep, SrcFormat, iStride,
 			                            pYUVLumaData, pYUVChromaData);
 			if (!submit_object(&context->work_objects[waitCount], cb, current, context))
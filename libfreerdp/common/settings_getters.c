@@ -1997,6 +1997,9 @@ UINT32 freerdp_settings_get_uint32(WINPR_ATTR_UNUSED const rdpSettings* settings
 		case FreeRDP_TcpKeepAliveRetries:
 			return settings->TcpKeepAliveRetries;
 
+		case FreeRDP_TcpNotSentLowWatermark:
+			return settings->TcpNotSentLowWatermark;
+
 		case FreeRDP_ThreadingFlags:
 			return settings->ThreadingFlags;
 
@@ -2522,6 +2525,10 @@ BOOL freerdp_settings_set_uint32(WINPR_ATTR_UNUSED rdpSettings* settings,
 			settings->TcpKeepAliveRetries = cnv.c;
 			break;
 
+		case FreeRDP_TcpNotSentLowWatermark:
+			settings->TcpNotSentLowWatermark = cnv.c;
+			break;
+
 		case FreeRDP_ThreadingFlags:
 			settings->ThreadingFlags = cnv.c;
 			break;
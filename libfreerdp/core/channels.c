@@ -28,6 +28,7 @@
 
 #include <winpr/crt.h>
 #include <winpr/assert.h>
+#include <winpr/cast.h>
 #include <winpr/stream.h>
 #include <winpr/wtsapi.h>
 
@@ -50,6 +51,109 @@
 
 #define TAG FREERDP_TAG("core.channels")
 
+static BOOL freerdp_channel_compression_enabled(const rdpRdp* rdp, const rdpMcsChannel* channel)
+{
+	WINPR_ASSERT(rdp);
+	WINPR_ASSERT(channel);
+
+	const rdpSettings* settings = rdp->settings;
+	WINPR_ASSERT(settings);
+
+	/* [MS-RDPBCGR] 2.2.1.3.4.1 Channel Definition Structure */
+	if (!(channel->options & CHANNEL_OPTION_COMPRESS) &&
+	    !((channel->options & CHANNEL_OPTION_COMPRESS_RDP) && settings->CompressionEnabled))
+		return FALSE;
+
+	/* [MS-RDPBCGR] 2.2.7.1.10 Virtual Channel Capability Set, flags are already negotiated */
+	const UINT32 flags = freerdp_settings_get_uint32(settings, FreeRDP_VCFlags);
+	if (settings->ServerMode)
+		return (flags & VCCAPS_COMPR_SC) != 0;
+	return (flags & VCCAPS_COMPR_CS_8K) != 0;
+}
+
+/**
+ * Compress a virtual channel chunk with the shared bulk compression context.
+ * Server to client data uses the negotiated compression type, client to server data is
+ * limited to RDP 4.0 (8K) compression.
+ */
+BOOL freerdp_channel_compress_chunk(rdpRdp* rdp, const rdpMcsChannel* channel, const BYTE** pData,
+                                    size_t* pChunkSize, UINT32* pFlags)
+{
+	int status = 0;
+	UINT32 DstSize = 0;
+	const BYTE* pDstData = NULL;
+	UINT32 compressionFlags = 0;
+
+	WINPR_ASSERT(rdp);
+	WINPR_ASSERT(pData);
+	WINPR_ASSERT(pChunkSize);
+	WINPR_ASSERT(pFlags);
+
+	if (!freerdp_channel_compression_enabled(rdp, channel))
+		return TRUE;
+
+	/* the RDP 4.0 history buffer is 8K, larger chunks are sent uncompressed */
+	const size_t maxSize = rdp->settings->ServerMode ? UINT16_MAX : 8192;
+	if (*pChunkSize >= maxSize)
+		return TRUE;
+
+	const UINT32 SrcSize = (UINT32)*pChunkSize;
+	if (rdp->settings->ServerMode)
+		status = bulk_compress(rdp->bulk, *pData, SrcSize, &pDstData, &DstSize, &compressionFlags);
+	else
+		status = bulk_compress_type(rdp->bulk, PACKET_COMPR_TYPE_8K, *pData, SrcSize, &pDstData,
+		                            &DstSize, &compressionFlags);
+
+	if (status < 0)
+	{
+		WLog_ERR(TAG, "bulk_compress() failed for channel %s", channel->Name);
+		return FALSE;
+	}
+
+	/* a flush without compression still has to be signalled to the peer */
+	if (compressionFlags)
+	{
+		*pData = pDstData;
+		*pChunkSize = DstSize;
+		*pFlags |= (compressionFlags << CHANNEL_PACKET_COMPRESSION_SHIFT) &
+		           CHANNEL_PACKET_COMPRESSION_MASK;
+	}
+
+	return TRUE;
+}
+
+static BOOL freerdp_channel_decompress_chunk(rdpRdp* rdp, const BYTE** pData, size_t* pChunkSize,
+                                             UINT32* pFlags)
+{
+	const BYTE* pDstData = NULL;
+	UINT32 DstSize = 0;
+
+	WINPR_ASSERT(rdp);
+	WINPR_ASSERT(pData);
+	WINPR_ASSERT(pChunkSize);
+	WINPR_ASSERT(pFlags);
+
+	const UINT32 compressionFlags =
+	    (*pFlags & CHANNEL_PACKET_COMPRESSION_MASK) >> CHANNEL_PACKET_COMPRESSION_SHIFT;
+	if (compressionFlags == 0)
+		return TRUE;
+
+	*pFlags &= (UINT32)~CHANNEL_PACKET_COMPRESSION_MASK;
+	if (*pChunkSize > UINT32_MAX)
+		return FALSE;
+
+	if (bulk_decompress(rdp->bulk, *pData, (UINT32)*pChunkSize, &pDstData, &DstSize,
+	                    compressionFlags) < 0)
+	{
+		WLog_ERR(TAG, "bulk_decompress() failed");
+		return FALSE;
+	}
+
+	*pData = pDstData;
+	*pChunkSize = DstSize;
+	return TRUE;
+}
+
 BOOL freerdp_channel_send(rdpRdp* rdp, UINT16 channelId, const BYTE* data, size_t size)
 {
 	size_t left = 0;
@@ -99,7 +203,13 @@ BOOL freerdp_channel_send(rdpRdp* rdp, UINT16 channelId, const BYTE* data, size_
 			flags |= CHANNEL_FLAG_SHOW_PROTOCOL;
 		}
 
-		if (!freerdp_channel_send_packet(rdp, channelId, size, flags, data, chunkSize))
+		const BYTE* packet = data;
+		size_t packetSize = chunkSize;
+		UINT32 packetFlags = flags;
+		if (!freerdp_channel_compress_chunk(rdp, channel, &packet, &packetSize, &packetFlags))
+			return FALSE;
+
+		if (!freerdp_channel_send_packet(rdp, channelId, size, packetFlags, packet, packetSize))
 			return FALSE;
 
 		data += chunkSize;
@@ -144,8 +254,14 @@ BOOL freerdp_channel_process(freerdp* instance, wStream* s, UINT16 channelId, si
 		return FALSE;
 	}
 
-	IFCALLRET(instance->ReceiveChannelData, rc, instance, channelId, Stream_Pointer(s), chunkLength,
-	          flags, length);
+	const BYTE* data = Stream_ConstPointer(s);
+	size_t dataLength = chunkLength;
+	WINPR_ASSERT(instance->context);
+	if (!freerdp_channel_decompress_chunk(instance->context->rdp, &data, &dataLength, &flags))
+		return FALSE;
+
+	IFCALLRET(instance->ReceiveChannelData, rc, instance, channelId, data, dataLength, flags,
+	          length);
 	if (!rc)
 	{
 		WLog_WARN(TAG, "ReceiveChannelData returned %d", rc);
@@ -172,6 +288,14 @@ BOOL freerdp_channel_peer_process(freerdp_peer* client, wStream* s, UINT16 chann
 	if (chunkLength > UINT32_MAX)
 		return FALSE;
 
+	WINPR_ASSERT(client->context);
+	const BYTE* data = Stream_ConstPointer(s);
+	size_t dataLength = chunkLength;
+	if (!freerdp_channel_decompress_chunk(client->context->rdp, &data, &dataLength, &flags))
+		return FALSE;
+	if (dataLength > UINT32_MAX)
+		return FALSE;
+
 	if (client->VirtualChannelRead)
 	{
 		int rc = 0;
@@ -195,14 +319,15 @@ BOOL freerdp_channel_peer_process(freerdp_peer* client, wStream* s, UINT16 chann
 		if (!found)
 			return FALSE;
 
-		rc = client->VirtualChannelRead(client, hChannel, Stream_Pointer(s), (UINT32)chunkLength);
+		rc = client->VirtualChannelRead(client, hChannel, WINPR_CAST_CONST_PTR_AWAY(data, BYTE*),
+		                                (UINT32)dataLength);
 		if (rc < 0)
 			return FALSE;
 	}
 	else if (client->ReceiveChannelData)
 	{
-		BOOL rc = client->ReceiveChannelData(client, channelId, Stream_Pointer(s),
-		                                     (UINT32)chunkLength, flags, length);
+		BOOL rc = client->ReceiveChannelData(client, channelId, data, (UINT32)dataLength, flags,
+		                                     length);
 		if (!rc)
 			return FALSE;
 	}
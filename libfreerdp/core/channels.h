@@ -23,6 +23,13 @@
 #include <freerdp/api.h>
 #include "client.h"
 
+/* [MS-RDPBCGR] 2.2.6.1.1 Channel PDU Header, bulk compression flags shifted by 16 */
+#define CHANNEL_PACKET_COMPRESSED 0x00200000
+#define CHANNEL_PACKET_AT_FRONT 0x00400000
+#define CHANNEL_PACKET_FLUSHED 0x00800000
+#define CHANNEL_PACKET_COMPRESSION_MASK 0x00EF0000
+#define CHANNEL_PACKET_COMPRESSION_SHIFT 16
+
 FREERDP_LOCAL BOOL freerdp_channel_send(rdpRdp* rdp, UINT16 channelId, const BYTE* data,
                                         size_t size);
 FREERDP_LOCAL BOOL freerdp_channel_send_packet(rdpRdp* rdp, UINT16 channelId, size_t totalSize,
@@ -30,5 +37,8 @@ FREERDP_LOCAL BOOL freerdp_channel_send_packet(rdpRdp* rdp, UINT16 channelId, si
 FREERDP_LOCAL BOOL freerdp_channel_process(freerdp* instance, wStream* s, UINT16 channelId,
                                            size_t packetLength);
 FREERDP_LOCAL BOOL freerdp_channel_peer_process(freerdp_peer* client, wStream* s, UINT16 channelId);
+FREERDP_LOCAL BOOL freerdp_channel_compress_chunk(rdpRdp* rdp, const rdpMcsChannel* channel,
+                                                 const BYTE** pData, size_t* pChunkSize,
+                                                 UINT32* pFlags);
 
 #endif /* FREERDP_LIB_CORE_CHANNELS_H */
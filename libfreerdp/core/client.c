@@ -690,14 +690,18 @@ fail:
 static BOOL freerdp_channels_process_sync(rdpChannels* channels, freerdp* instance)
 {
 	BOOL status = TRUE;
-	wMessage message = { 0 };
+	size_t count = 0;
+	wMessage messages[32] = { 0 };
 
 	WINPR_ASSERT(channels);
 
-	while (MessageQueue_Peek(channels->queue, &message, TRUE))
+	while ((count = MessageQueue_DrainBatch(channels->queue, messages, ARRAYSIZE(messages))) > 0)
 	{
-		if (!freerdp_channels_process_message(instance, &message))
-			status = FALSE;
+		for (size_t x = 0; x < count; x++)
+		{
+			if (!freerdp_channels_process_message(instance, &messages[x]))
+				status = FALSE;
+		}
 	}
 
 	return status;
@@ -850,6 +854,12 @@ SSIZE_T freerdp_client_channel_get_registered_event_handles(rdpChannels* channel
 	return rc;
 }
 
+BOOL freerdp_client_channel_is_registered_event_handle(rdpChannels* channels, HANDLE handle)
+{
+	WINPR_ASSERT(channels);
+	return HashTable_Contains(channels->channelEvents, handle);
+}
+
 UINT freerdp_channels_disconnect(rdpChannels* channels, freerdp* instance)
 {
 	UINT error = CHANNEL_RC_OK;
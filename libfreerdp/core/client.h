@@ -128,4 +128,7 @@ FREERDP_LOCAL SSIZE_T freerdp_client_channel_get_registered_event_handles(rdpCha
                                                                           HANDLE* events,
                                                                           DWORD count);
 
+FREERDP_LOCAL BOOL freerdp_client_channel_is_registered_event_handle(rdpChannels* channels,
+                                                                     HANDLE handle);
+
 #endif /* FREERDP_LIB_CORE_CLIENT_H */
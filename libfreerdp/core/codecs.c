@@ -95,10 +95,14 @@ static void codecs_free_int(rdpCodecs* codecs, UINT32 flags)
 			codecs->interleaved = NULL;
 		}
 	}
+
+	codecs->LazyFlags &= ~flags;
 }
-BOOL freerdp_client_codecs_prepare(rdpCodecs* codecs, UINT32 flags, UINT32 width, UINT32 height)
+
+static BOOL codecs_new_int(rdpCodecs* codecs, UINT32 flags)
 {
-	codecs_free_int(codecs, flags);
+	WINPR_ASSERT(codecs);
+
 	if ((flags & FREERDP_CODEC_INTERLEAVED))
 	{
 		if (!(codecs->interleaved = bitmap_interleaved_context_new(FALSE)))
@@ -167,13 +171,56 @@ BOOL freerdp_client_codecs_prepare(rdpCodecs* codecs, UINT32 flags, UINT32 width
 	}
 #endif
 
+	return TRUE;
+}
+
+BOOL freerdp_client_codecs_prepare(rdpCodecs* codecs, UINT32 flags, UINT32 width, UINT32 height)
+{
+	codecs_free_int(codecs, flags);
+	if (!codecs_new_int(codecs, flags))
+		return FALSE;
+
 	return freerdp_client_codecs_reset(codecs, flags, width, height);
 }
 
+BOOL freerdp_client_codecs_prepare_lazy(rdpCodecs* codecs, UINT32 flags, UINT32 width,
+                                        UINT32 height)
+{
+	if (!codecs)
+		return FALSE;
+
+	codecs_free_int(codecs, flags);
+	codecs->LazyFlags |= flags;
+	codecs->Width = width;
+	codecs->Height = height;
+	return TRUE;
+}
+
+BOOL freerdp_client_codecs_ensure(rdpCodecs* codecs, UINT32 flags)
+{
+	if (!codecs)
+		return FALSE;
+
+	const UINT32 pending = codecs->LazyFlags & flags;
+	if (pending == 0)
+		return TRUE;
+
+	/* Clear the flags first, a failing codec is not retried for every PDU */
+	codecs->LazyFlags &= ~pending;
+	if (!codecs_new_int(codecs, pending))
+		return FALSE;
+
+	return freerdp_client_codecs_reset(codecs, pending, codecs->Width, codecs->Height);
+}
+
 BOOL freerdp_client_codecs_reset(rdpCodecs* codecs, UINT32 flags, UINT32 width, UINT32 height)
 {
 	BOOL rc = TRUE;
 
+	WINPR_ASSERT(codecs);
+	codecs->Width = width;
+	codecs->Height = height;
+
 	if (flags & FREERDP_CODEC_INTERLEAVED)
 	{
 		if (codecs->interleaved)
@@ -214,15 +214,17 @@ static BOOL rdp_client_reset_codecs(rdpContext* context)
 		if (!context->codecs)
 			return FALSE;
 
-		if (!freerdp_client_codecs_prepare(context->codecs,
-		                                   freerdp_settings_get_codecs_flags(settings),
-		                                   settings->DesktopWidth, settings->DesktopHeight))
+		/* Codec contexts are created on first use, most sessions only need a few of them */
+		if (!freerdp_client_codecs_prepare_lazy(context->codecs,
+		                                        freerdp_settings_get_codecs_flags(settings),
+		                                        settings->DesktopWidth, settings->DesktopHeight))
 			return FALSE;
 
 /* Runtime H264 detection. (only available if dynamic backend loading is defined)
  * If no backend is available disable it before the channel is loaded.
  */
 #if defined(WITH_GFX_H264) && defined(WITH_OPENH264_LOADING)
+		freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_AVC420 | FREERDP_CODEC_AVC444);
 		if (!context->codecs->h264)
 		{
 			settings->GfxH264 = FALSE;
@@ -310,7 +310,7 @@ static BOOL fastpath_recv_update_common(rdpFastPath* fastpath, wStream* s)
 				return FALSE;
 
 			rc = IFCALLRESULT(defaultReturn, update->BitmapUpdate, context, bitmap_update);
-			free_bitmap_update(context, bitmap_update);
+			free_bitmap_update_view(context, bitmap_update);
 		}
 		break;
 
@@ -434,7 +434,7 @@ static int fastpath_recv_update(rdpFastPath* fastpath, BYTE updateCode, wStream*
 			if (pointer_color)
 			{
 				rc = IFCALLRESULT(defaultReturn, pointer->PointerColor, context, pointer_color);
-				free_pointer_color_update(context, pointer_color);
+				free_pointer_color_update_view(context, pointer_color);
 			}
 		}
 		break;
@@ -458,7 +458,7 @@ static int fastpath_recv_update(rdpFastPath* fastpath, BYTE updateCode, wStream*
 			if (pointer_new)
 			{
 				rc = IFCALLRESULT(defaultReturn, pointer->PointerNew, context, pointer_new);
-				free_pointer_new_update(context, pointer_new);
+				free_pointer_new_update_view(context, pointer_new);
 			}
 		}
 		break;
@@ -470,7 +470,7 @@ static int fastpath_recv_update(rdpFastPath* fastpath, BYTE updateCode, wStream*
 			if (pointer_large)
 			{
 				rc = IFCALLRESULT(defaultReturn, pointer->PointerLarge, context, pointer_large);
-				free_pointer_large_update(context, pointer_large);
+				free_pointer_large_update_view(context, pointer_large);
 			}
 		}
 		break;
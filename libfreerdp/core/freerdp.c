@@ -450,41 +450,125 @@ static BOOL freerdp_prevent_session_lock(rdpContext* context)
 	return TRUE;
 }
 
-BOOL freerdp_check_event_handles(rdpContext* context)
+/* Handles owned by the core are manual reset events or sockets, probing them does not change
+ * their state. Registered channel handles might be auto reset events that the channel waits on
+ * itself, these must not be probed. */
+static UINT32 freerdp_classify_event_handle(rdpContext* context, HANDLE handle,
+                                            const HANDLE* rdpEvents, size_t rdpCount, BOOL* probe)
 {
 	WINPR_ASSERT(context);
+	WINPR_ASSERT(probe);
 
-	BOOL status = freerdp_check_fds(context->instance);
+	*probe = TRUE;
+	if (handle == freerdp_channels_get_event_handle(context->instance))
+		return FREERDP_EVENT_SOURCE_CHANNELS;
+	if (handle == getChannelErrorEventHandle(context))
+		return FREERDP_EVENT_SOURCE_CHANNEL_ERROR;
 
-	if (!status)
+	for (size_t x = 0; x < rdpCount; x++)
 	{
-		if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
-			WLog_Print(context->log, WLOG_ERROR, "freerdp_check_fds() failed - %" PRIi32 "",
-			           status);
+		if (handle == rdpEvents[x])
+			return FREERDP_EVENT_SOURCE_TRANSPORT;
+	}
 
-		return FALSE;
+	*probe = FALSE;
+	if (freerdp_client_channel_is_registered_event_handle(context->channels, handle))
+		return FREERDP_EVENT_SOURCE_CHANNELS;
+
+	/* not one of ours, e.g. a client specific input event */
+	return FREERDP_EVENT_SOURCE_NONE;
+}
+
+UINT32 freerdp_get_ready_event_sources(rdpContext* context, const HANDLE* events, DWORD count,
+                                       DWORD waitStatus)
+{
+	HANDLE rdpEvents[MAXIMUM_WAIT_OBJECTS] = { 0 };
+
+	WINPR_ASSERT(context);
+	WINPR_ASSERT(context->rdp);
+	WINPR_ASSERT(events || (count == 0));
+
+	if (waitStatus == WAIT_TIMEOUT)
+		return FREERDP_EVENT_SOURCE_NONE;
+
+	/* WAIT_ABANDONED, WAIT_IO_COMPLETION, ... we do not know what happened, check everything */
+	if ((waitStatus < WAIT_OBJECT_0) || (waitStatus - WAIT_OBJECT_0 >= count))
+		return FREERDP_EVENT_SOURCE_ALL;
+
+	const size_t rdpCount = rdp_get_event_handles(context->rdp, rdpEvents, ARRAYSIZE(rdpEvents));
+	if (rdpCount == 0)
+		return FREERDP_EVENT_SOURCE_ALL;
+
+	UINT32 sources = FREERDP_EVENT_SOURCE_NONE;
+	const DWORD first = waitStatus - WAIT_OBJECT_0;
+
+	/* WaitForMultipleObjects reports the lowest signaled index, everything before is not ready */
+	for (DWORD x = first; x < count; x++)
+	{
+		BOOL probe = FALSE;
+		const UINT32 source =
+		    freerdp_classify_event_handle(context, events[x], rdpEvents, rdpCount, &probe);
+		if ((sources & source) == source)
+			continue;
+
+		/* a handle that can not be probed might be ready, let the source check it */
+		if ((x != first) && probe && (WaitForSingleObject(events[x], 0) != WAIT_OBJECT_0))
+			continue;
+
+		sources |= source;
+		if (sources == FREERDP_EVENT_SOURCE_ALL)
+			break;
 	}
 
-	status = freerdp_channels_check_fds(context->channels, context->instance);
+	return sources;
+}
 
-	if (!status)
+BOOL freerdp_check_event_sources(rdpContext* context, UINT32 sources)
+{
+	WINPR_ASSERT(context);
+
+	BOOL status = TRUE;
+
+	if (sources & FREERDP_EVENT_SOURCE_TRANSPORT)
 	{
-		if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
-			WLog_Print(context->log, WLOG_ERROR,
-			           "freerdp_channels_check_fds() failed - %" PRIi32 "", status);
+		status = freerdp_check_fds(context->instance);
 
-		return FALSE;
+		if (!status)
+		{
+			if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
+				WLog_Print(context->log, WLOG_ERROR, "freerdp_check_fds() failed - %" PRIi32 "",
+				           status);
+
+			return FALSE;
+		}
 	}
 
-	status = checkChannelErrorEvent(context);
+	if (sources & FREERDP_EVENT_SOURCE_CHANNELS)
+	{
+		status = freerdp_channels_check_fds(context->channels, context->instance);
 
-	if (!status)
+		if (!status)
+		{
+			if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
+				WLog_Print(context->log, WLOG_ERROR,
+				           "freerdp_channels_check_fds() failed - %" PRIi32 "", status);
+
+			return FALSE;
+		}
+	}
+
+	if (sources & FREERDP_EVENT_SOURCE_CHANNEL_ERROR)
 	{
-		if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
-			WLog_Print(context->log, WLOG_ERROR, "checkChannelErrorEvent() failed - %" PRIi32 "",
-			           status);
+		status = checkChannelErrorEvent(context);
 
-		return FALSE;
+		if (!status)
+		{
+			if (freerdp_get_last_error(context) == FREERDP_ERROR_SUCCESS)
+				WLog_Print(context->log, WLOG_ERROR,
+				           "checkChannelErrorEvent() failed - %" PRIi32 "", status);
+
+			return FALSE;
+		}
 	}
 
 	status = freerdp_prevent_session_lock(context);
@@ -492,6 +576,11 @@ BOOL freerdp_check_event_handles(rdpContext* context)
 	return status;
 }
 
+BOOL freerdp_check_event_handles(rdpContext* context)
+{
+	return freerdp_check_event_sources(context, FREERDP_EVENT_SOURCE_ALL);
+}
+
 wMessageQueue* freerdp_get_message_queue(freerdp* instance, DWORD id)
 {
 	wMessageQueue* queue = NULL;
@@ -1264,6 +1353,13 @@ ULONG freerdp_get_transport_sent(rdpContext* context, BOOL resetCount)
 	return WINPR_CXX_COMPAT_CAST(ULONG, MIN(rc, UINT32_MAX));
 }
 
+size_t freerdp_get_transport_unsent(rdpContext* context)
+{
+	WINPR_ASSERT(context);
+	WINPR_ASSERT(context->rdp);
+	return transport_get_unsent_bytes(context->rdp->transport);
+}
+
 BOOL freerdp_nla_impersonate(rdpContext* context)
 {
 	rdpNla* nla = NULL;
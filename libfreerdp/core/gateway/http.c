@@ -1127,6 +1127,51 @@ static int print_bio_error(const char* str, size_t len, void* bp)
 	return (int)len;
 }
 
+void http_chunked_context_init(http_encoding_chunked_context* encodingContext, BOOL readAhead)
+{
+	WINPR_ASSERT(encodingContext);
+
+	encodingContext->nextOffset = 0;
+	encodingContext->headerFooterPos = 0;
+	encodingContext->state = ChunkStateLenghHeader;
+	encodingContext->readAhead = readAhead;
+	encodingContext->readOffset = 0;
+	encodingContext->readLength = 0;
+}
+
+/* Refill the read ahead buffer if it is empty. Without read ahead at most required bytes,
+ * which are known to belong to the chunked body, are read.
+ * Returns the number of buffered bytes or the BIO_read status if nothing is available */
+static int http_chunked_fill(BIO* bio, http_encoding_chunked_context* encodingContext,
+                             size_t required)
+{
+	WINPR_ASSERT(encodingContext);
+	WINPR_ASSERT(required > 0);
+
+	if (encodingContext->readOffset < encodingContext->readLength)
+		return (int)(encodingContext->readLength - encodingContext->readOffset);
+
+	encodingContext->readOffset = 0;
+	encodingContext->readLength = 0;
+
+	size_t rd = sizeof(encodingContext->readBuffer);
+	if (!encodingContext->readAhead)
+		rd = MIN(rd, required);
+
+	ERR_clear_error();
+	const int status = BIO_read(bio, encodingContext->readBuffer, (int)rd);
+	if (status > 0)
+		encodingContext->readLength = (size_t)status;
+	return status;
+}
+
+static BYTE http_chunked_next_byte(http_encoding_chunked_context* encodingContext)
+{
+	WINPR_ASSERT(encodingContext);
+	WINPR_ASSERT(encodingContext->readOffset < encodingContext->readLength);
+	return encodingContext->readBuffer[encodingContext->readOffset++];
+}
+
 int http_chuncked_read(BIO* bio, BYTE* pBuffer, size_t size,
                        http_encoding_chunked_context* encodingContext)
 {
@@ -1136,77 +1181,100 @@ int http_chuncked_read(BIO* bio, BYTE* pBuffer, size_t size,
 	WINPR_ASSERT(pBuffer);
 	WINPR_ASSERT(encodingContext != NULL);
 	WINPR_ASSERT(size <= INT32_MAX);
-	while (TRUE)
+
+	/* Chunk framing is parsed from a read ahead buffer so that length lines and
+	 * CRLF footers do not cost a BIO_read each. Payload larger than the read ahead
+	 * buffer bypasses it and is read directly into the caller buffer. */
+	while (size > 0)
 	{
 		switch (encodingContext->state)
 		{
 			case ChunkStateData:
 			{
-				const size_t rd =
-				    (size > encodingContext->nextOffset ? encodingContext->nextOffset : size);
-				if (rd > INT32_MAX)
-					return -1;
+				size_t rd = MIN(size, encodingContext->nextOffset);
+				const size_t buffered = encodingContext->readLength - encodingContext->readOffset;
 
-				ERR_clear_error();
-				status = BIO_read(bio, pBuffer, (int)rd);
-				if (status <= 0)
-					return (effectiveDataLen > 0 ? effectiveDataLen : status);
+				if (buffered > 0)
+				{
+					rd = MIN(rd, buffered);
+					memcpy(pBuffer, &encodingContext->readBuffer[encodingContext->readOffset],
+					       rd);
+					encodingContext->readOffset += rd;
+				}
+				else if (rd >= sizeof(encodingContext->readBuffer))
+				{
+					rd = MIN(rd, INT32_MAX);
+					ERR_clear_error();
+					status = BIO_read(bio, pBuffer, (int)rd);
+					if (status <= 0)
+						return (effectiveDataLen > 0 ? effectiveDataLen : status);
+					rd = (size_t)status;
+				}
+				else
+				{
+					status = http_chunked_fill(bio, encodingContext, rd);
+					if (status <= 0)
+						return (effectiveDataLen > 0 ? effectiveDataLen : status);
+					continue;
+				}
 
-				encodingContext->nextOffset -= WINPR_ASSERTING_INT_CAST(uint32_t, status);
+				encodingContext->nextOffset -= rd;
 				if (encodingContext->nextOffset == 0)
 				{
 					encodingContext->state = ChunkStateFooter;
 					encodingContext->headerFooterPos = 0;
 				}
-				effectiveDataLen += status;
-
-				if ((size_t)status == size)
-					return effectiveDataLen;
-
-				pBuffer += status;
-				size -= (size_t)status;
+				effectiveDataLen += (int)rd;
+				pBuffer += rd;
+				size -= rd;
 			}
 			break;
 			case ChunkStateFooter:
 			{
-				char _dummy[2] = { 0 };
 				WINPR_ASSERT(encodingContext->nextOffset == 0);
 				WINPR_ASSERT(encodingContext->headerFooterPos < 2);
-				ERR_clear_error();
-				status = BIO_read(bio, _dummy, (int)(2 - encodingContext->headerFooterPos));
-				if (status >= 0)
+				status = http_chunked_fill(bio, encodingContext,
+				                           2 - encodingContext->headerFooterPos);
+				if (status <= 0)
+					return (effectiveDataLen > 0 ? effectiveDataLen : status);
+
+				while ((encodingContext->headerFooterPos < 2) &&
+				       (encodingContext->readOffset < encodingContext->readLength))
 				{
-					encodingContext->headerFooterPos += (size_t)status;
-					if (encodingContext->headerFooterPos == 2)
-					{
-						encodingContext->state = ChunkStateLenghHeader;
-						encodingContext->headerFooterPos = 0;
-					}
+					(void)http_chunked_next_byte(encodingContext);
+					encodingContext->headerFooterPos++;
+				}
+
+				if (encodingContext->headerFooterPos == 2)
+				{
+					encodingContext->state = ChunkStateLenghHeader;
+					encodingContext->headerFooterPos = 0;
 				}
-				else
-					return (effectiveDataLen > 0 ? effectiveDataLen : status);
 			}
 			break;
 			case ChunkStateLenghHeader:
 			{
 				BOOL _haveNewLine = FALSE;
-				char* dst = &encodingContext->lenBuffer[encodingContext->headerFooterPos];
 				WINPR_ASSERT(encodingContext->nextOffset == 0);
-				while (encodingContext->headerFooterPos < 10 && !_haveNewLine)
+				while (!_haveNewLine)
 				{
-					ERR_clear_error();
-					status = BIO_read(bio, dst, 1);
-					if (status >= 0)
+					status = http_chunked_fill(bio, encodingContext, 1);
+					if (status <= 0)
+						return (effectiveDataLen > 0 ? effectiveDataLen : status);
+
+					while (!_haveNewLine &&
+					       (encodingContext->readOffset < encodingContext->readLength))
 					{
-						if (*dst == '\n')
+						const char c = (char)http_chunked_next_byte(encodingContext);
+						if (c == '\n')
 							_haveNewLine = TRUE;
-						encodingContext->headerFooterPos += (size_t)status;
-						dst += status;
+						/* keep the hex length, skip chunk extensions exceeding the buffer */
+						if (encodingContext->headerFooterPos < 10)
+							encodingContext->lenBuffer[encodingContext->headerFooterPos++] = c;
 					}
-					else
-						return (effectiveDataLen > 0 ? effectiveDataLen : status);
 				}
-				*dst = '\0';
+				encodingContext->lenBuffer[encodingContext->headerFooterPos] = '\0';
+				encodingContext->headerFooterPos = 0;
 				/* strtoul is tricky, error are reported via errno, we also need
 				 * to ensure the result does not overflow */
 				errno = 0;
@@ -1222,11 +1290,34 @@ int http_chuncked_read(BIO* bio, BYTE* pBuffer, size_t size,
 				encodingContext->state = ChunkStateData;
 
 				if (encodingContext->nextOffset == 0)
-				{ /* end of stream */
-					WLog_DBG(TAG, "chunked encoding end of stream received");
+				{ /* last chunk, followed by optional trailer fields */
 					encodingContext->headerFooterPos = 0;
-					encodingContext->state = ChunkStateEnd;
-					return (effectiveDataLen > 0 ? effectiveDataLen : 0);
+					encodingContext->state = ChunkStateTrailer;
+				}
+			}
+			break;
+			case ChunkStateTrailer:
+			{
+				/* headerFooterPos is set while the current trailer line is not empty */
+				status = http_chunked_fill(bio, encodingContext, 1);
+				if (status <= 0)
+					return (effectiveDataLen > 0 ? effectiveDataLen : status);
+
+				while (encodingContext->readOffset < encodingContext->readLength)
+				{
+					const char c = (char)http_chunked_next_byte(encodingContext);
+					if (c == '\n')
+					{
+						if (encodingContext->headerFooterPos == 0)
+						{ /* end of stream */
+							WLog_DBG(TAG, "chunked encoding end of stream received");
+							encodingContext->state = ChunkStateEnd;
+							return effectiveDataLen;
+						}
+						encodingContext->headerFooterPos = 0;
+					}
+					else if (c != '\r')
+						encodingContext->headerFooterPos = 1;
 				}
 			}
 			break;
@@ -1235,6 +1326,8 @@ int http_chuncked_read(BIO* bio, BYTE* pBuffer, size_t size,
 				return -1;
 		}
 	}
+
+	return effectiveDataLen;
 }
 
 #define sleep_or_timeout(tls, startMS, timeoutMS) \
@@ -1272,6 +1365,25 @@ static BOOL sleep_or_timeout_(rdpTls* tls, UINT64 startMS, UINT32 timeoutMS, con
 	return FALSE;
 }
 
+/* Bytes that can be read without consuming anything past the terminating \r\n\r\n.
+ * Data following the header belongs to the body or to the protocol running on top
+ * of the connection (websocket, chunked RDG stream) and must stay in the BIO. */
+static size_t http_response_header_read_size(const wStream* s)
+{
+	const char terminator[] = "\r\n\r\n";
+	const size_t terminatorLength = sizeof(terminator) - 1;
+	const size_t position = Stream_GetPosition(s);
+	const BYTE* end = Stream_ConstPointer(s);
+
+	for (size_t match = MIN(terminatorLength - 1, position); match > 0; match--)
+	{
+		if (memcmp(end - match, terminator, match) == 0)
+			return terminatorLength - match;
+	}
+
+	return terminatorLength;
+}
+
 static SSIZE_T http_response_recv_line(rdpTls* tls, HttpResponse* response)
 {
 	WINPR_ASSERT(tls);
@@ -1291,7 +1403,8 @@ static SSIZE_T http_response_recv_line(rdpTls* tls, HttpResponse* response)
 		/* Read until we encounter \r\n\r\n */
 		ERR_clear_error();
 
-		status = BIO_read(tls->bio, Stream_Pointer(response->data), 1);
+		const size_t rd = http_response_header_read_size(response->data);
+		status = BIO_read(tls->bio, Stream_Pointer(response->data), (int)rd);
 		if (status <= 0)
 		{
 			if (sleep_or_timeout(tls, startMS, timeoutMS))
@@ -1344,10 +1457,9 @@ static BOOL http_response_recv_body(rdpTls* tls, HttpResponse* response, BOOL re
 
 	if ((response->TransferEncoding == TransferEncodingChunked) && readContentLength)
 	{
+		/* no read ahead, data after the body belongs to the next response */
 		http_encoding_chunked_context ctx = { 0 };
-		ctx.state = ChunkStateLenghHeader;
-		ctx.nextOffset = 0;
-		ctx.headerFooterPos = 0;
+		http_chunked_context_init(&ctx, FALSE);
 		int full_len = 0;
 		do
 		{
@@ -1356,16 +1468,18 @@ static BOOL http_response_recv_body(rdpTls* tls, HttpResponse* response, BOOL re
 
 			int status = http_chuncked_read(tls->bio, Stream_Pointer(response->data),
 			                                Stream_GetRemainingCapacity(response->data), &ctx);
-			if (status <= 0)
-			{
-				if (sleep_or_timeout(tls, startMS, timeoutMS))
-					goto out_error;
-			}
-			else
+			if (status > 0)
 			{
 				Stream_Seek(response->data, (size_t)status);
 				full_len += status;
 			}
+			else if (ctx.state == ChunkStateEnd)
+			{
+				if (status < 0)
+					goto out_error;
+			}
+			else if (sleep_or_timeout(tls, startMS, timeoutMS))
+				goto out_error;
 		} while (ctx.state != ChunkStateEnd);
 		response->BodyLength = WINPR_ASSERTING_INT_CAST(uint32_t, full_len);
 		if (response->BodyLength > 0)
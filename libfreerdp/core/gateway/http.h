@@ -39,15 +39,24 @@ typedef enum
 	ChunkStateLenghHeader,
 	ChunkStateData,
 	ChunkStateFooter,
+	ChunkStateTrailer,
 	ChunkStateEnd
 } CHUNK_STATE;
 
+#define HTTP_CHUNKED_READ_AHEAD_SIZE 8192
+
 typedef struct
 {
 	size_t nextOffset;
 	size_t headerFooterPos;
 	CHUNK_STATE state;
 	char lenBuffer[11];
+	BOOL readAhead;
+
+	/* data read from the BIO but not yet consumed by the decoder */
+	size_t readOffset;
+	size_t readLength;
+	BYTE readBuffer[HTTP_CHUNKED_READ_AHEAD_SIZE];
 } http_encoding_chunked_context;
 
 /* HTTP context */
@@ -131,7 +140,9 @@ FREERDP_LOCAL void http_response_log_error_status_(wLog* log, DWORD level,
                                                    const HttpResponse* response, const char* file,
                                                    size_t line, const char* fkt);
 
-/* chunked read helper */
+/* chunked read helper, without readAhead nothing past the end of the body is read from the BIO */
+FREERDP_LOCAL void http_chunked_context_init(http_encoding_chunked_context* encodingContext,
+                                             BOOL readAhead);
 FREERDP_LOCAL int http_chuncked_read(BIO* bio, BYTE* pBuffer, size_t size,
                                      http_encoding_chunked_context* encodingContext);
 
@@ -1495,9 +1495,7 @@ static BOOL rdg_establish_data_connection(rdpRdg* rdg, rdpTls* tls, const char*
 		if (encoding == TransferEncodingChunked)
 		{
 			rdg->transferEncoding.httpTransferEncoding = TransferEncodingChunked;
-			rdg->transferEncoding.context.chunked.nextOffset = 0;
-			rdg->transferEncoding.context.chunked.headerFooterPos = 0;
-			rdg->transferEncoding.context.chunked.state = ChunkStateLenghHeader;
+			http_chunked_context_init(&rdg->transferEncoding.context.chunked, TRUE);
 		}
 		if (!rdg_skip_seed_payload(rdg->context, tls, bodyLength, &rdg->transferEncoding))
 		{
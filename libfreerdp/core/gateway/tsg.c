@@ -2833,12 +2833,27 @@ static int tsg_read(rdpTsg* tsg, BYTE* data, size_t length)
 
 		if (transport_get_blocking(rpc->transport))
 		{
+			rdpContext* context = transport_get_context(rpc->transport);
+
 			while (WaitForSingleObject(rpc->client->PipeEvent, 0) != WAIT_OBJECT_0)
 			{
+				HANDLE events[MAXIMUM_WAIT_OBJECTS] = { 0 };
+
 				if (!tsg_check_event_handles(tsg))
 					return -1;
 
-				(void)WaitForSingleObject(rpc->client->PipeEvent, 100);
+				/* Sleep until one of the channels has data, recycling may replace them */
+				const DWORD nCount = tsg_get_event_handles(tsg, events, ARRAYSIZE(events) - 1);
+				if (nCount == 0)
+					return -1;
+
+				events[nCount] = freerdp_abort_event(context);
+				const DWORD rc = WaitForMultipleObjects(nCount + 1, events, FALSE, INFINITE);
+				if ((rc == WAIT_FAILED) || (rc == WAIT_OBJECT_0 + nCount))
+				{
+					WLog_Print(tsg->log, WLOG_DEBUG, "tsg_read aborted");
+					return -1;
+				}
 			}
 		}
 	} while (transport_get_blocking(rpc->transport));
@@ -39,6 +39,7 @@
 
 #include "rdp.h"
 #include "peer.h"
+#include "channels.h"
 #include "multitransport.h"
 
 #define TAG FREERDP_TAG("core.peer")
@@ -181,16 +182,25 @@ static int freerdp_peer_virtual_channel_write(freerdp_peer* client, HANDLE hChan
 		if (mcsChannel->options & CHANNEL_OPTION_SHOW_PROTOCOL)
 			flags |= CHANNEL_FLAG_SHOW_PROTOCOL;
 
+		const BYTE* packet = buffer;
+		size_t packetSize = chunkSize;
+		UINT32 packetFlags = flags;
+		if (!freerdp_channel_compress_chunk(rdp, mcsChannel, &packet, &packetSize, &packetFlags))
+		{
+			Stream_Release(s);
+			return -1;
+		}
+
 		Stream_Write_UINT32(s, totalLength);
-		Stream_Write_UINT32(s, flags);
+		Stream_Write_UINT32(s, packetFlags);
 
-		if (!Stream_EnsureRemainingCapacity(s, chunkSize))
+		if (!Stream_EnsureRemainingCapacity(s, packetSize))
 		{
 			Stream_Release(s);
 			return -1;
 		}
 
-		Stream_Write(s, buffer, chunkSize);
+		Stream_Write(s, packet, packetSize);
 
 		WINPR_ASSERT(peerChannel->channelId <= UINT16_MAX);
 		if (!rdp_send(rdp, s, (UINT16)peerChannel->channelId, sec_flags))
@@ -316,7 +326,15 @@ static DWORD freerdp_peer_get_event_handles(freerdp_peer* client, HANDLE* events
 	WINPR_ASSERT(client);
 	WINPR_ASSERT(client->context);
 	WINPR_ASSERT(client->context->rdp);
-	return transport_get_event_handles(client->context->rdp->transport, events, count);
+
+	rdpRdp* rdp = client->context->rdp;
+	DWORD nCount = transport_get_event_handles(rdp->transport, events, count);
+	if ((nCount == 0) || (nCount >= count))
+		return nCount;
+
+	/* Timers run from CheckFileDescriptor, wake up for them instead of polling */
+	events[nCount++] = freerdp_timer_get_event(rdp->timer);
+	return nCount;
 }
 
 static BOOL freerdp_peer_check_fds(freerdp_peer* peer)
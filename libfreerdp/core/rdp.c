@@ -44,6 +44,8 @@
 
 #define RDP_TAG FREERDP_TAG("core.rdp")
 
+#define RDP_MAX_PDUS_PER_CHECK 16
+
 typedef struct
 {
 	const char* file;
@@ -2269,7 +2271,18 @@ int rdp_check_fds(rdpRdp* rdp)
 			return 1;
 	}
 
-	status = transport_check_fds(transport);
+	/* In active state drain up to RDP_MAX_PDUS_PER_CHECK complete PDUs per wakeup instead of
+	 * bouncing through the callers event loop once per PDU. */
+	for (size_t x = 0; x < RDP_MAX_PDUS_PER_CHECK; x++)
+	{
+		status = transport_check_fds(transport);
+		if (status != 0)
+			break;
+		if (!transport_have_more_bytes_to_read(transport) || transport_get_blocking(transport))
+			break;
+		if (!rdp_is_active_state(rdp) || freerdp_shall_disconnect_context(rdp->context))
+			break;
+	}
 
 	if (status == 1)
 	{
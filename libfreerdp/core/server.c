@@ -598,7 +598,7 @@ BOOL WTSVirtualChannelManagerOpen(HANDLE hServer)
 
 BOOL WTSVirtualChannelManagerCheckFileDescriptorEx(HANDLE hServer, BOOL autoOpen)
 {
-	wMessage message = { 0 };
+	wMessage messages[32] = { 0 };
 	BOOL status = TRUE;
 	WTSVirtualChannelManager* vcm = NULL;
 
@@ -613,26 +613,28 @@ BOOL WTSVirtualChannelManagerCheckFileDescriptorEx(HANDLE hServer, BOOL autoOpen
 			return FALSE;
 	}
 
-	while (MessageQueue_Peek(vcm->queue, &message, TRUE))
+	size_t count = 0;
+	while (status &&
+	       ((count = MessageQueue_DrainBatch(vcm->queue, messages, ARRAYSIZE(messages))) > 0))
 	{
-		BYTE* buffer = NULL;
-		UINT32 length = 0;
-		UINT16 channelId = 0;
-		channelId = (UINT16)(UINT_PTR)message.context;
-		buffer = (BYTE*)message.wParam;
-		length = (UINT32)(UINT_PTR)message.lParam;
-
-		WINPR_ASSERT(vcm->client);
-		WINPR_ASSERT(vcm->client->SendChannelData);
-		if (!vcm->client->SendChannelData(vcm->client, channelId, buffer, length))
+		for (size_t x = 0; x < count; x++)
 		{
-			status = FALSE;
-		}
+			const wMessage* message = &messages[x];
+			const UINT16 channelId = (UINT16)(UINT_PTR)message->context;
+			BYTE* buffer = (BYTE*)message->wParam;
+			const UINT32 length = (UINT32)(UINT_PTR)message->lParam;
 
-		free(buffer);
+			/* after a failure the remaining messages of the batch are only released */
+			if (status)
+			{
+				WINPR_ASSERT(vcm->client);
+				WINPR_ASSERT(vcm->client->SendChannelData);
+				if (!vcm->client->SendChannelData(vcm->client, channelId, buffer, length))
+					status = FALSE;
+			}
 
-		if (!status)
-			break;
+			free(buffer);
+		}
 	}
 
 	return status;
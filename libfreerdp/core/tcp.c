@@ -85,6 +85,10 @@
 #include "tcp.h"
 #include "../crypto/opensslcompat.h"
 
+#if defined(__linux__)
+#include <linux/sockios.h>
+#endif
+
 #if defined(HAVE_AF_VSOCK_H)
 #include <ctype.h>
 #include <linux/vm_sockets.h>
@@ -103,21 +107,11 @@ typedef struct
 static int transport_bio_simple_init(BIO* bio, SOCKET socket, int shutdown);
 static int transport_bio_simple_uninit(BIO* bio);
 
-static int transport_bio_simple_write(BIO* bio, const char* buf, int size)
+static int transport_bio_simple_write_status(BIO* bio, int status)
 {
-	int error = 0;
-	int status = 0;
-	WINPR_BIO_SIMPLE_SOCKET* ptr = (WINPR_BIO_SIMPLE_SOCKET*)BIO_get_data(bio);
-
-	if (!buf)
-		return 0;
-
-	BIO_clear_flags(bio, BIO_FLAGS_WRITE);
-	status = _send(ptr->socket, buf, size, 0);
-
 	if (status <= 0)
 	{
-		error = WSAGetLastError();
+		const int error = WSAGetLastError();
 
 		if ((error == WSAEWOULDBLOCK) || (error == WSAEINTR) || (error == WSAEINPROGRESS) ||
 		    (error == WSAEALREADY))
@@ -133,6 +127,78 @@ static int transport_bio_simple_write(BIO* bio, const char* buf, int size)
 	return status;
 }
 
+static int transport_bio_simple_write(BIO* bio, const char* buf, int size)
+{
+	int status = 0;
+	WINPR_BIO_SIMPLE_SOCKET* ptr = (WINPR_BIO_SIMPLE_SOCKET*)BIO_get_data(bio);
+
+	if (!buf)
+		return 0;
+
+	BIO_clear_flags(bio, BIO_FLAGS_WRITE);
+	status = _send(ptr->socket, buf, size, 0);
+	return transport_bio_simple_write_status(bio, status);
+}
+
+#define TRANSPORT_BIO_SIMPLE_MAX_CHUNKS 4
+
+static int transport_bio_simple_writev(BIO* bio, const DataChunk* chunks, size_t count)
+{
+	size_t total = 0;
+	int status = 0;
+	WINPR_BIO_SIMPLE_SOCKET* ptr = (WINPR_BIO_SIMPLE_SOCKET*)BIO_get_data(bio);
+
+	if (!chunks || (count == 0) || (count > TRANSPORT_BIO_SIMPLE_MAX_CHUNKS))
+		return -1;
+
+	BIO_clear_flags(bio, BIO_FLAGS_WRITE);
+
+#ifdef _WIN32
+	WSABUF buffers[TRANSPORT_BIO_SIMPLE_MAX_CHUNKS] = { 0 };
+	DWORD sent = 0;
+
+	for (size_t x = 0; x < count; x++)
+	{
+		if (chunks[x].size > UINT32_MAX - total)
+			return -1;
+		const BYTE* data = chunks[x].data;
+		buffers[x].buf = WINPR_CAST_CONST_PTR_AWAY(data, char*);
+		buffers[x].len = (ULONG)chunks[x].size;
+		total += chunks[x].size;
+	}
+
+	if (WSASend(ptr->socket, buffers, (DWORD)count, &sent, 0, NULL, NULL) != 0)
+		status = -1;
+	else
+		status = (int)MIN(sent, INT32_MAX);
+#else
+	struct iovec iov[TRANSPORT_BIO_SIMPLE_MAX_CHUNKS] = { 0 };
+
+	for (size_t x = 0; x < count; x++)
+	{
+		if (chunks[x].size > INT32_MAX - total)
+			return -1;
+		const BYTE* data = chunks[x].data;
+		iov[x].iov_base = WINPR_CAST_CONST_PTR_AWAY(data, void*);
+		iov[x].iov_len = chunks[x].size;
+		total += chunks[x].size;
+	}
+
+	struct msghdr msg = { 0 };
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+
+#ifdef MSG_NOSIGNAL
+	const ssize_t rc = sendmsg((int)ptr->socket, &msg, MSG_NOSIGNAL);
+#else
+	const ssize_t rc = sendmsg((int)ptr->socket, &msg, 0);
+#endif
+	status = (rc < 0) ? -1 : (int)rc;
+#endif
+
+	return transport_bio_simple_write_status(bio, status);
+}
+
 static int transport_bio_simple_read(BIO* bio, char* buf, int size)
 {
 	int error = 0;
@@ -183,6 +249,27 @@ static int transport_bio_simple_gets(WINPR_ATTR_UNUSED BIO* bio, WINPR_ATTR_UNUS
 	return 1;
 }
 
+static long transport_bio_simple_unsent(SOCKET socket)
+{
+	int unsent = 0;
+
+#if defined(SIOCOUTQNSD)
+	/* bytes not yet handed to the network, unlike SIOCOUTQ which includes unacknowledged data */
+	if (ioctl((int)socket, SIOCOUTQNSD, &unsent) != 0)
+		return 0;
+#elif defined(SIOCOUTQ)
+	if (ioctl((int)socket, SIOCOUTQ, &unsent) != 0)
+		return 0;
+#elif defined(FIONWRITE)
+	if (ioctl((int)socket, FIONWRITE, &unsent) != 0)
+		return 0;
+#else
+	WINPR_UNUSED(socket);
+#endif
+
+	return MAX(unsent, 0);
+}
+
 static long transport_bio_simple_ctrl(BIO* bio, int cmd, long arg1, void* arg2)
 {
 	int status = -1;
@@ -333,6 +420,18 @@ static long transport_bio_simple_ctrl(BIO* bio, int cmd, long arg1, void* arg2)
 			status = 1;
 			break;
 
+		case BIO_C_GET_UNSENT_BYTES:
+			if (!BIO_get_init(bio))
+				return 0;
+
+			return transport_bio_simple_unsent(ptr->socket);
+
+		case BIO_C_WRITEV:
+			if (!BIO_get_init(bio) || (arg1 < 0))
+				return -1;
+
+			return transport_bio_simple_writev(bio, arg2, (size_t)arg1);
+
 		case BIO_CTRL_FLUSH:
 		case BIO_CTRL_DUP:
 			status = 1;
@@ -456,14 +555,63 @@ typedef struct
 	RingBuffer xmitBuffer;
 } WINPR_BIO_BUFFERED_SOCKET;
 
+/* Write chunks to the next BIO, gathered into one call if it is a socket BIO.
+ * Returns the number of bytes written, 0 if the next BIO would block or -1 on error */
+static SSIZE_T transport_bio_buffered_write_chunks(BIO* bio, BIO* next_bio, DataChunk* chunks,
+                                                   size_t nchunks)
+{
+	size_t written = 0;
+	size_t index = 0;
+
+	while (index < nchunks)
+	{
+		int status = 0;
+
+		ERR_clear_error();
+		if (BIO_method_type(next_bio) == BIO_TYPE_SIMPLE)
+			status = (int)BIO_writev(next_bio, &chunks[index], (long)(nchunks - index));
+		else
+		{
+			const size_t wr = MIN(INT32_MAX, chunks[index].size);
+			status = BIO_write(next_bio, chunks[index].data, (int)wr);
+		}
+
+		if (status <= 0)
+		{
+			if (!BIO_should_retry(next_bio))
+			{
+				BIO_clear_flags(bio, BIO_FLAGS_SHOULD_RETRY);
+				return -1; /* fatal error */
+			}
+
+			if (BIO_should_write(next_bio))
+				BIO_set_flags(bio, BIO_FLAGS_WRITE);
+			break; /* EWOULDBLOCK */
+		}
+
+		written += (size_t)status;
+
+		size_t consumed = (size_t)status;
+		while ((index < nchunks) && (consumed >= chunks[index].size))
+		{
+			consumed -= chunks[index].size;
+			index++;
+		}
+
+		if (index < nchunks)
+		{
+			chunks[index].data += consumed;
+			chunks[index].size -= consumed;
+		}
+	}
+
+	return (SSIZE_T)written;
+}
+
 static int transport_bio_buffered_write(BIO* bio, const char* buf, int num)
 {
-	int ret = num;
-	int nchunks = 0;
-	size_t committedBytes = 0;
-	DataChunk chunks[2] = { 0 };
+	DataChunk chunks[3] = { 0 };
 	WINPR_BIO_BUFFERED_SOCKET* ptr = (WINPR_BIO_BUFFERED_SOCKET*)BIO_get_data(bio);
-	BIO* next_bio = NULL;
 
 	WINPR_ASSERT(bio);
 	WINPR_ASSERT(ptr);
@@ -473,55 +621,45 @@ static int transport_bio_buffered_write(BIO* bio, const char* buf, int num)
 	ptr->writeBlocked = FALSE;
 	BIO_clear_flags(bio, BIO_FLAGS_WRITE);
 
-	/* we directly append extra bytes in the xmit buffer, this could be prevented
-	 * but for now it makes the code more simple.
-	 */
-	if (buf && (num > 0) && !ringbuffer_write(&ptr->xmitBuffer, (const BYTE*)buf, (size_t)num))
-	{
-		WLog_ERR(TAG, "an error occurred when writing (num: %d)", num);
+	/* Send whatever is still pending in the xmit buffer together with the new data,
+	 * only the part the socket did not accept is copied into the buffer. */
+	const size_t pending = ringbuffer_used(&ptr->xmitBuffer);
+	const int npending = ringbuffer_peek(&ptr->xmitBuffer, chunks, pending);
+	if (npending < 0)
 		return -1;
-	}
 
-	nchunks = ringbuffer_peek(&ptr->xmitBuffer, chunks, ringbuffer_used(&ptr->xmitBuffer));
-	next_bio = BIO_next(bio);
-
-	for (int i = 0; i < nchunks; i++)
+	size_t nchunks = (size_t)npending;
+	const size_t size = buf ? (size_t)num : 0;
+	if (size > 0)
 	{
-		while (chunks[i].size)
-		{
-			ERR_clear_error();
+		chunks[nchunks].data = (const BYTE*)buf;
+		chunks[nchunks].size = size;
+		nchunks++;
+	}
 
-			const size_t wr = MIN(INT32_MAX, chunks[i].size);
-			const int status = BIO_write(next_bio, chunks[i].data, (int)wr);
+	const SSIZE_T status =
+	    transport_bio_buffered_write_chunks(bio, BIO_next(bio), chunks, nchunks);
+	if (status < 0)
+		return -1;
 
-			if (status <= 0)
-			{
-				if (!BIO_should_retry(next_bio))
-				{
-					BIO_clear_flags(bio, BIO_FLAGS_SHOULD_RETRY);
-					ret = -1; /* fatal error */
-					goto out;
-				}
+	const size_t written = (size_t)status;
+	const size_t committedBytes = MIN(written, pending);
+	ringbuffer_commit_read_bytes(&ptr->xmitBuffer, committedBytes);
 
-				if (BIO_should_write(next_bio))
-				{
-					BIO_set_flags(bio, BIO_FLAGS_WRITE);
-					ptr->writeBlocked = TRUE;
-					goto out; /* EWOULDBLOCK */
-				}
-			}
-			else
-			{
-				committedBytes += (size_t)status;
-				chunks[i].size -= (size_t)status;
-				chunks[i].data += status;
-			}
+	const size_t sent = written - committedBytes;
+	if (sent < size)
+	{
+		if (!ringbuffer_write(&ptr->xmitBuffer, (const BYTE*)&buf[sent], size - sent))
+		{
+			WLog_ERR(TAG, "an error occurred when writing (num: %d)", num);
+			return -1;
 		}
 	}
 
-out:
-	ringbuffer_commit_read_bytes(&ptr->xmitBuffer, committedBytes);
-	return ret;
+	if (ringbuffer_used(&ptr->xmitBuffer) > 0)
+		ptr->writeBlocked = TRUE;
+
+	return num;
 }
 
 static int transport_bio_buffered_read(BIO* bio, char* buf, int size)
@@ -599,6 +737,15 @@ static long transport_bio_buffered_ctrl(BIO* bio, int cmd, long arg1, void* arg2
 			status = (int)ptr->writeBlocked;
 			break;
 
+		case BIO_C_GET_UNSENT_BYTES:
+		{
+			const long next = BIO_ctrl(BIO_next(bio), cmd, arg1, arg2);
+			status = WINPR_ASSERTING_INT_CAST(long, ringbuffer_used(&ptr->xmitBuffer));
+			if (next > 0)
+				status += next;
+		}
+		break;
+
 		default:
 			status = BIO_ctrl(BIO_next(bio), cmd, arg1, arg2);
 			break;
@@ -1054,6 +1201,26 @@ BOOL freerdp_tcp_set_keep_alive_mode(const rdpSettings* settings, int sockfd)
 	return TRUE;
 }
 
+BOOL freerdp_tcp_set_notsent_lowat(const rdpSettings* settings, int sockfd)
+{
+#ifdef TCP_NOTSENT_LOWAT
+	const UINT32 optval = freerdp_settings_get_uint32(settings, FreeRDP_TcpNotSentLowWatermark);
+
+	if (optval == 0)
+		return TRUE;
+
+	if (setsockopt(sockfd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, (const void*)&optval,
+	               sizeof(optval)) < 0)
+	{
+		WLog_WARN(TAG, "setsockopt() IPPROTO_TCP, TCP_NOTSENT_LOWAT");
+	}
+#else
+	WINPR_UNUSED(settings);
+	WINPR_UNUSED(sockfd);
+#endif
+	return TRUE;
+}
+
 int freerdp_tcp_connect(rdpContext* context, const char* hostname, int port, DWORD timeout)
 {
 	rdpTransport* transport = NULL;
@@ -1498,6 +1665,8 @@ rdpTransportLayer* freerdp_tcp_connect_layer(rdpContext* context, const char* ho
 		goto fail;
 	if (!freerdp_tcp_set_keep_alive_mode(settings, sockfd))
 		goto fail;
+	if (!freerdp_tcp_set_notsent_lowat(settings, sockfd))
+		goto fail;
 
 	layer = transport_layer_new(freerdp_get_transport(context), sizeof(rdpTcpLayer));
 	if (!layer)
@@ -53,6 +53,8 @@
 #define BIO_C_WAIT_READ 1107
 #define BIO_C_WAIT_WRITE 1108
 #define BIO_C_SET_HANDLE 1109
+#define BIO_C_GET_UNSENT_BYTES 1110
+#define BIO_C_WRITEV 1111
 
 static INLINE long BIO_set_socket(BIO* b, SOCKET s, long c)
 {
@@ -92,10 +94,23 @@ static INLINE long BIO_wait_write(BIO* b, long c)
 	return BIO_ctrl(b, BIO_C_WAIT_WRITE, c, NULL);
 }
 
+/** @brief gather write of \b count chunks, returns the number of bytes written like BIO_write */
+static INLINE long BIO_writev(BIO* b, const DataChunk* chunks, long count)
+{
+	return BIO_ctrl(b, BIO_C_WRITEV, count, WINPR_CAST_CONST_PTR_AWAY(chunks, void*));
+}
+
+/** @brief bytes accepted by the BIO chain (buffers and kernel send queue) but not yet sent */
+static INLINE long BIO_get_unsent_bytes(BIO* b)
+{
+	return BIO_ctrl(b, BIO_C_GET_UNSENT_BYTES, 0, NULL);
+}
+
 FREERDP_LOCAL BIO_METHOD* BIO_s_simple_socket(void);
 FREERDP_LOCAL BIO_METHOD* BIO_s_buffered_socket(void);
 
 FREERDP_LOCAL BOOL freerdp_tcp_set_keep_alive_mode(const rdpSettings* settings, int sockfd);
+FREERDP_LOCAL BOOL freerdp_tcp_set_notsent_lowat(const rdpSettings* settings, int sockfd);
 
 FREERDP_LOCAL int freerdp_tcp_connect(rdpContext* context, const char* hostname, int port,
                                       DWORD timeout);
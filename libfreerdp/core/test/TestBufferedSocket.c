@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#include <winpr/crt.h>
+#include <winpr/winsock.h>
+
+#include "../tcp.h"
+
+/* the initial size of the xmit ring buffer of the buffered socket BIO */
+#define TEST_RING_SIZE 0x10000
+#define TEST_SEND_BUFFER 4096
+
+typedef struct
+{
+	BIO* bio;
+	int peer;
+	BYTE* data;
+	size_t size;
+	size_t written;
+	size_t received;
+	size_t ringIn;
+	size_t partial;
+} test_socket_state;
+
+static BYTE test_byte(size_t offset)
+{
+	return (BYTE)(offset % 251);
+}
+
+/* Reads everything the socket accepted so far and checks it continues the written data */
+static BOOL test_drain(test_socket_state* test, size_t* accepted)
+{
+	BYTE buffer[4096] = { 0 };
+
+	*accepted = 0;
+	for (;;)
+	{
+		const ssize_t rc = recv(test->peer, buffer, sizeof(buffer), 0);
+		if (rc < 0)
+			return (errno == EAGAIN) || (errno == EWOULDBLOCK);
+		if (rc == 0)
+			return FALSE;
+
+		for (size_t x = 0; x < (size_t)rc; x++)
+		{
+			if (buffer[x] != test_byte(test->received + x))
+			{
+				printf("byte %" PRIuz " is out of order\n", test->received + x);
+				return FALSE;
+			}
+		}
+
+		test->received += (size_t)rc;
+		*accepted += (size_t)rc;
+	}
+}
+
+/* Writes num bytes (or flushes if num is 0) and accounts for what went into the ring buffer.
+ * The socket sends pending data first, new data only bypasses the ring once that is gone. */
+static BOOL test_write(test_socket_state* test, size_t num, BOOL drain, size_t* accepted)
+{
+	const size_t pending = (size_t)BIO_wpending(test->bio);
+
+	if (test->written + num > test->size)
+		return FALSE;
+
+	if (num > 0)
+	{
+		if (BIO_write(test->bio, &test->data[test->written], (int)num) != (int)num)
+			return FALSE;
+	}
+	else if (BIO_flush(test->bio) != 1)
+		return FALSE;
+	test->written += num;
+
+	*accepted = 0;
+	if (!drain)
+		return TRUE;
+
+	if (!test_drain(test, accepted))
+		return FALSE;
+
+	/* everything the peer did not receive is buffered, there is no other data in flight */
+	if ((size_t)BIO_wpending(test->bio) != test->written - test->received)
+		return FALSE;
+
+	const size_t sentNew = (*accepted > pending) ? *accepted - pending : 0;
+	test->ringIn += num - sentNew;
+
+	/* buffered and new data gathered in one call, the socket took only part of it */
+	if ((pending > 0) && (num > 0) && (*accepted > 0) && (*accepted < pending + num))
+		test->partial++;
+	return TRUE;
+}
+
+static BOOL test_setup(test_socket_state* test)
+{
+	int sv[2] = { -1, -1 };
+	const int sndbuf = TEST_SEND_BUFFER;
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+		return FALSE;
+	test->peer = sv[1];
+
+	if ((setsockopt(sv[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) != 0) ||
+	    (fcntl(test->peer, F_SETFL, fcntl(test->peer, F_GETFL) | O_NONBLOCK) != 0))
+	{
+		close(sv[0]);
+		return FALSE;
+	}
+
+	BIO* simple = BIO_new(BIO_s_simple_socket());
+	if (!simple)
+	{
+		close(sv[0]);
+		return FALSE;
+	}
+	BIO_set_socket(simple, (SOCKET)sv[0], BIO_CLOSE);
+
+	test->bio = BIO_new(BIO_s_buffered_socket());
+	if (!test->bio)
+	{
+		BIO_free_all(simple);
+		return FALSE;
+	}
+	test->bio = BIO_push(test->bio, simple);
+
+	test->size = 16ull * TEST_RING_SIZE;
+	test->data = malloc(test->size);
+	if (!test->data)
+		return FALSE;
+
+	for (size_t x = 0; x < test->size; x++)
+		test->data[x] = test_byte(x);
+	return TRUE;
+}
+
+static BOOL test_buffered_socket(test_socket_state* test)
+{
+	size_t accepted = 0;
+
+	/* a write larger than the socket accepts, the remainder is buffered */
+	if (!test_write(test, TEST_RING_SIZE / 4, FALSE, &accepted) ||
+	    (BIO_wpending(test->bio) == 0) || !BIO_write_blocked(test->bio))
+		return FALSE;
+
+	/* the socket is still full, the next write hits EAGAIN and is buffered completely */
+	const long pending = BIO_wpending(test->bio);
+	if (!test_write(test, 1000, FALSE, &accepted) || (BIO_wpending(test->bio) != pending + 1000))
+		return FALSE;
+
+	/* once the peer read, the next write sends the buffered remainder first */
+	if (!test_drain(test, &accepted) || !test_write(test, 3000, TRUE, &accepted) ||
+	    (accepted == 0))
+		return FALSE;
+
+	/* uneven writes, each larger than what the socket took last time, and flushes keep
+	 * data in the ring until it wrapped a few times without growing it */
+	for (size_t round = 0; test->ringIn < 3ull * TEST_RING_SIZE; round++)
+	{
+		const size_t num = accepted + 1000 + (round * 2357) % 7000;
+		const BOOL flush = (size_t)BIO_wpending(test->bio) + num >= TEST_RING_SIZE / 2;
+
+		if (!test_write(test, flush ? 0 : num, TRUE, &accepted))
+			return FALSE;
+	}
+
+	/* flush the rest */
+	while (BIO_wpending(test->bio) > 0)
+	{
+		if (!test_write(test, 0, TRUE, &accepted))
+			return FALSE;
+	}
+
+	if ((test->received != test->written) || (test->partial == 0))
+		return FALSE;
+
+	return TRUE;
+}
+
+int TestBufferedSocket(int argc, char* argv[])
+{
+	int rc = -1;
+	test_socket_state test = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	test.peer = -1;
+	if (!test_setup(&test))
+		goto fail;
+
+	if (!test_buffered_socket(&test))
+	{
+		printf("TestBufferedSocket: failed after %" PRIuz " of %" PRIuz " bytes\n", test.received,
+		       test.written);
+		goto fail;
+	}
+
+	rc = 0;
+fail:
+	BIO_free_all(test.bio);
+	if (test.peer >= 0)
+		close(test.peer);
+	free(test.data);
+	return rc;
+}
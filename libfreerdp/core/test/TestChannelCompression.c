@@ -0,0 +1,220 @@
+#include <stdio.h>
+
+#include <winpr/stream.h>
+#include <winpr/crypto.h>
+
+#include <freerdp/freerdp.h>
+#include <freerdp/svc.h>
+
+#include "../rdp.h"
+#include "../mcs.h"
+#include "../channels.h"
+
+#define TEST_CHANNEL_ID 1004
+
+typedef struct
+{
+	wStream* received;
+	size_t compressed;
+	size_t flushed;
+} test_channel_state;
+
+static test_channel_state state = { 0 };
+
+static BOOL test_receive(freerdp* instance, UINT16 channelId, const BYTE* data, size_t size,
+                         UINT32 flags, size_t totalSize)
+{
+	WINPR_UNUSED(instance);
+	WINPR_UNUSED(totalSize);
+
+	if (channelId != TEST_CHANNEL_ID)
+		return FALSE;
+
+	/* the compression bits must not be passed on to channel consumers */
+	if (flags & CHANNEL_PACKET_COMPRESSION_MASK)
+		return FALSE;
+
+	if (!Stream_EnsureRemainingCapacity(state.received, size))
+		return FALSE;
+	Stream_Write(state.received, data, size);
+	return TRUE;
+}
+
+static freerdp* test_instance_new(void)
+{
+	freerdp* instance = freerdp_new();
+	if (!instance)
+		return NULL;
+
+	if (!freerdp_context_new(instance))
+	{
+		freerdp_free(instance);
+		return NULL;
+	}
+
+	instance->ReceiveChannelData = test_receive;
+	return instance;
+}
+
+static void test_instance_free(freerdp* instance)
+{
+	if (!instance)
+		return;
+	freerdp_context_free(instance);
+	freerdp_free(instance);
+}
+
+/* Split a channel packet into chunks like freerdp_channel_send, compress each chunk and feed the
+ * result to the receiving side. */
+static BOOL test_send_packet(freerdp* sender, freerdp* receiver, const rdpMcsChannel* channel,
+                             const BYTE* data, size_t size)
+{
+	BOOL rc = FALSE;
+	UINT32 flags = CHANNEL_FLAG_FIRST;
+	size_t left = size;
+	wStream* s = Stream_New(NULL, CHANNEL_CHUNK_LENGTH + 8);
+
+	if (!s)
+		return FALSE;
+
+	while (left > 0)
+	{
+		size_t chunkSize = CHANNEL_CHUNK_LENGTH;
+		if (left <= chunkSize)
+		{
+			chunkSize = left;
+			flags |= CHANNEL_FLAG_LAST;
+		}
+
+		const BYTE* chunk = data;
+		size_t chunkLength = chunkSize;
+		UINT32 chunkFlags = flags;
+		if (!freerdp_channel_compress_chunk(sender->context->rdp, channel, &chunk, &chunkLength,
+		                                    &chunkFlags))
+			goto fail;
+
+		if (chunkFlags & CHANNEL_PACKET_COMPRESSED)
+			state.compressed++;
+		if (chunkFlags & CHANNEL_PACKET_FLUSHED)
+			state.flushed++;
+
+		Stream_SetPosition(s, 0);
+		if (!Stream_EnsureCapacity(s, chunkLength + 8))
+			goto fail;
+		Stream_Write_UINT32(s, (UINT32)size);
+		Stream_Write_UINT32(s, chunkFlags);
+		Stream_Write(s, chunk, chunkLength);
+		Stream_SealLength(s);
+		Stream_SetPosition(s, 0);
+
+		if (!freerdp_channel_process(receiver, s, TEST_CHANNEL_ID, chunkLength + 8))
+			goto fail;
+
+		data += chunkSize;
+		left -= chunkSize;
+		flags = 0;
+	}
+
+	rc = TRUE;
+fail:
+	Stream_Free(s, TRUE);
+	return rc;
+}
+
+static void test_fill_text(BYTE* data, size_t size, size_t seed)
+{
+	for (size_t x = 0; x < size;)
+	{
+		char line[64] = { 0 };
+		const int len =
+		    _snprintf(line, sizeof(line), "clipboard format %" PRIuz " data line\n", seed++ % 97);
+		const size_t count = MIN(size - x, (size_t)len);
+		memcpy(&data[x], line, count);
+		x += count;
+	}
+}
+
+static BOOL test_round_trip(freerdp* sender, freerdp* receiver, const rdpMcsChannel* channel)
+{
+	BOOL rc = FALSE;
+	/* text larger than the 8K history to force flushes, random data that does not compress and
+	 * text again to check the history is in sync after the flushes */
+	const size_t sizes[] = { 32 * 1024, 4000, 1000, 5000 };
+	BYTE* packets[ARRAYSIZE(sizes)] = { 0 };
+
+	for (size_t x = 0; x < ARRAYSIZE(sizes); x++)
+	{
+		packets[x] = malloc(sizes[x]);
+		if (!packets[x])
+			goto fail;
+
+		if (x == 1)
+			winpr_RAND(packets[x], sizes[x]);
+		else
+			test_fill_text(packets[x], sizes[x], x);
+	}
+
+	for (size_t x = 0; x < ARRAYSIZE(sizes); x++)
+	{
+		Stream_SetPosition(state.received, 0);
+		if (!test_send_packet(sender, receiver, channel, packets[x], sizes[x]))
+		{
+			(void)fprintf(stderr, "[%s] packet %" PRIuz " could not be processed\n", __func__,
+			              x);
+			goto fail;
+		}
+
+		if ((Stream_GetPosition(state.received) != sizes[x]) ||
+		    (memcmp(Stream_Buffer(state.received), packets[x], sizes[x]) != 0))
+		{
+			(void)fprintf(stderr, "[%s] packet %" PRIuz " mismatch\n", __func__, x);
+			goto fail;
+		}
+	}
+
+	if ((state.compressed == 0) || (state.flushed < 2))
+	{
+		(void)fprintf(stderr, "[%s] expected compressed and flushed chunks, got %" PRIuz
+		                      " compressed, %" PRIuz " flushed\n",
+		              __func__, state.compressed, state.flushed);
+		goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	for (size_t x = 0; x < ARRAYSIZE(packets); x++)
+		free(packets[x]);
+	return rc;
+}
+
+int TestChannelCompression(int argc, char* argv[])
+{
+	int rc = -1;
+	rdpMcsChannel channel = { .Name = "test",
+		                      .options = CHANNEL_OPTION_INITIALIZED | CHANNEL_OPTION_COMPRESS,
+		                      .ChannelId = TEST_CHANNEL_ID };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	freerdp* sender = test_instance_new();
+	freerdp* receiver = test_instance_new();
+	state.received = Stream_New(NULL, 1024);
+	if (!sender || !receiver || !state.received)
+		goto fail;
+
+	/* client to server compression as negotiated in the virtual channel capability set */
+	if (!freerdp_settings_set_uint32(sender->context->settings, FreeRDP_VCFlags,
+	                                 VCCAPS_COMPR_CS_8K))
+		goto fail;
+
+	if (!test_round_trip(sender, receiver, &channel))
+		goto fail;
+
+	rc = 0;
+fail:
+	Stream_Free(state.received, TRUE);
+	test_instance_free(sender);
+	test_instance_free(receiver);
+	return rc;
+}
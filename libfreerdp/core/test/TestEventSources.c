@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include <winpr/crt.h>
+#include <winpr/synch.h>
+
+#include <freerdp/freerdp.h>
+#include <freerdp/channels/channels.h>
+
+#include "../rdp.h"
+#include "../connection.h"
+#include "../transport.h"
+
+/* more than rdp_check_fds handles in one call */
+#define TEST_PDUS 20
+#define TEST_PDU_LIMIT 16
+
+static state_run_t test_recv(WINPR_ATTR_UNUSED rdpTransport* transport,
+                             WINPR_ATTR_UNUSED wStream* s, void* extra)
+{
+	size_t* received = extra;
+
+	WINPR_ASSERT(received);
+	(*received)++;
+	return STATE_RUN_SUCCESS;
+}
+
+static UINT test_channel_handle(WINPR_ATTR_UNUSED HANDLE handle, WINPR_ATTR_UNUSED void* userdata)
+{
+	return CHANNEL_RC_OK;
+}
+
+/* Writes TEST_PDUS small TPKT PDUs the server sent at once */
+static BOOL test_send_pdus(int peer)
+{
+	const BYTE pdu[] = { 0x03, 0x00, 0x00, 0x08, 0x01, 0x02, 0x03, 0x04 };
+
+	for (size_t x = 0; x < TEST_PDUS; x++)
+	{
+		if (send(peer, pdu, sizeof(pdu), 0) != (ssize_t)sizeof(pdu))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static BOOL test_check_fds(rdpRdp* rdp, size_t* received, size_t expected)
+{
+	const size_t before = *received;
+
+	if (rdp_check_fds(rdp) < 0)
+		return FALSE;
+
+	if (*received - before != expected)
+	{
+		printf("rdp_check_fds: handled %" PRIuz " PDUs, expected %" PRIuz "\n",
+		       *received - before, expected);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Outside of the active state one PDU is handled per call, afterwards up to the limit */
+static BOOL test_drain_limit(rdpContext* context)
+{
+	size_t received = 0;
+	rdpRdp* rdp = context->rdp;
+	rdpTransport* transport = freerdp_get_transport(context);
+
+	if (!transport_set_recv_callbacks(transport, test_recv, &received) ||
+	    !transport_set_blocking_mode(transport, FALSE))
+		return FALSE;
+
+	if (!test_check_fds(rdp, &received, 1) || !transport_have_more_bytes_to_read(transport))
+		return FALSE;
+
+	if (!rdp_client_transition_to_state(rdp, CONNECTION_STATE_ACTIVE))
+		return FALSE;
+
+	/* the limit was reached, the reread event brings the caller back */
+	if (!test_check_fds(rdp, &received, TEST_PDU_LIMIT) ||
+	    !transport_have_more_bytes_to_read(transport))
+		return FALSE;
+
+	/* the rest is handled until no complete PDU is left */
+	if (!test_check_fds(rdp, &received, TEST_PDUS - TEST_PDU_LIMIT - 1) ||
+	    transport_have_more_bytes_to_read(transport))
+		return FALSE;
+
+	return test_check_fds(rdp, &received, 0);
+}
+
+/* A signaled auto reset channel handle after the reported index must not be consumed */
+static BOOL test_ready_sources(rdpContext* context)
+{
+	BOOL rc = FALSE;
+	HANDLE events[MAXIMUM_WAIT_OBJECTS] = { 0 };
+	LARGE_INTEGER due = { 0 };
+	HANDLE handle = CreateWaitableTimer(NULL, FALSE, NULL);
+	if (!handle)
+		return FALSE;
+
+	if (!freerdp_client_channel_register(context->channels, handle, test_channel_handle, NULL))
+		goto fail;
+
+	const DWORD count = freerdp_get_event_handles(context, events, ARRAYSIZE(events));
+	if ((count == 0) || (events[count - 1] != handle))
+		goto fail;
+
+	/* waiting for the timer would reset it, give it time to expire instead */
+	due.QuadPart = -1;
+	if (!SetWaitableTimer(handle, &due, 0, NULL, NULL, FALSE))
+		goto fail;
+	Sleep(10);
+
+	/* nothing but the first handle was signaled */
+	if (freerdp_get_ready_event_sources(context, events, count - 1, WAIT_OBJECT_0) !=
+	    FREERDP_EVENT_SOURCE_TRANSPORT)
+		goto fail;
+
+	if (freerdp_get_ready_event_sources(context, events, count, WAIT_OBJECT_0) !=
+	    (FREERDP_EVENT_SOURCE_TRANSPORT | FREERDP_EVENT_SOURCE_CHANNELS))
+		goto fail;
+
+	if (freerdp_get_ready_event_sources(context, events, count, WAIT_TIMEOUT) !=
+	    FREERDP_EVENT_SOURCE_NONE)
+		goto fail;
+
+	/* the channel still sees its event */
+	rc = (WaitForSingleObject(handle, 0) == WAIT_OBJECT_0);
+fail:
+	(void)freerdp_client_channel_unregister(context->channels, handle);
+	(void)CloseHandle(handle);
+	return rc;
+}
+
+int TestEventSources(int argc, char* argv[])
+{
+	int rc = -1;
+	int sv[2] = { -1, -1 };
+	freerdp* instance = freerdp_new();
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	if (!instance || !freerdp_context_new(instance))
+		goto fail;
+
+	if ((socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) ||
+	    !transport_attach(freerdp_get_transport(instance->context), sv[0]))
+		goto fail;
+	sv[0] = -1;
+
+	if (!test_ready_sources(instance->context))
+	{
+		printf("TestEventSources: channel handle was consumed while probing\n");
+		goto fail;
+	}
+
+	if (!test_send_pdus(sv[1]) || !test_drain_limit(instance->context))
+	{
+		printf("TestEventSources: PDU drain limit failed\n");
+		goto fail;
+	}
+
+	rc = 0;
+fail:
+	if (instance)
+	{
+		freerdp_context_free(instance);
+		freerdp_free(instance);
+	}
+	for (size_t x = 0; x < ARRAYSIZE(sv); x++)
+	{
+		if (sv[x] >= 0)
+			close(sv[x]);
+	}
+	return rc;
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/stream.h>
+
+#include <openssl/bio.h>
+
+#include "../gateway/http.h"
+
+/* larger than the read ahead buffer, read directly into the caller buffer */
+#define TEST_LARGE_CHUNK 10000
+
+static const char test_next[] = "HTTP/1.1 200 OK\r\n";
+
+static BOOL test_chunk(wStream* encoded, wStream* expected, const char* header, const BYTE* data,
+                       size_t length)
+{
+	const size_t headerLength = strlen(header);
+
+	if (!Stream_EnsureRemainingCapacity(encoded, headerLength + length + 2) ||
+	    !Stream_EnsureRemainingCapacity(expected, length))
+		return FALSE;
+
+	Stream_Write(encoded, header, headerLength);
+	Stream_Write(encoded, data, length);
+	Stream_Write(encoded, "\r\n", 2);
+	Stream_Write(expected, data, length);
+	return TRUE;
+}
+
+/* A chunked body with chunk extensions, a chunk larger than the read ahead buffer and
+ * trailer fields */
+static BOOL test_encode(wStream* encoded, wStream* expected)
+{
+	const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+	const char last[] = "0\r\nX-Trailer: one\r\nX-Other: two\r\n\r\n";
+	char header[32] = { 0 };
+	BYTE* large = malloc(TEST_LARGE_CHUNK);
+	if (!large)
+		return FALSE;
+
+	for (size_t x = 0; x < TEST_LARGE_CHUNK; x++)
+		large[x] = (BYTE)(x * 7);
+	(void)_snprintf(header, sizeof(header), "%x\r\n", TEST_LARGE_CHUNK);
+
+	const BOOL rc =
+	    test_chunk(encoded, expected, "5;name=value\r\n", (const BYTE*)"hello", 5) &&
+	    test_chunk(encoded, expected, "1a;an-extension-longer-than-the-length-buffer=1\r\n",
+	               (const BYTE*)alphabet, strlen(alphabet)) &&
+	    test_chunk(encoded, expected, header, large, TEST_LARGE_CHUNK) &&
+	    test_chunk(encoded, expected, "3\r\n", (const BYTE*)"end", 3) &&
+	    Stream_EnsureRemainingCapacity(encoded, sizeof(last));
+	free(large);
+	if (!rc)
+		return FALSE;
+
+	Stream_Write(encoded, last, strlen(last));
+	Stream_SealLength(encoded);
+	Stream_SealLength(expected);
+	return TRUE;
+}
+
+/* Reads until the BIO runs dry or the end of the body is reached */
+static BOOL test_read(BIO* bio, http_encoding_chunked_context* ctx, wStream* decoded,
+                      size_t readSize)
+{
+	BYTE buffer[2 * HTTP_CHUNKED_READ_AHEAD_SIZE] = { 0 };
+
+	WINPR_ASSERT(readSize <= sizeof(buffer));
+	while (ctx->state != ChunkStateEnd)
+	{
+		const int status = http_chuncked_read(bio, buffer, readSize, ctx);
+		if (status < 0)
+			return BIO_should_retry(bio) && (ctx->state != ChunkStateEnd);
+		if ((status == 0) && (ctx->state != ChunkStateEnd))
+			return FALSE;
+
+		if (!Stream_EnsureRemainingCapacity(decoded, (size_t)status))
+			return FALSE;
+		Stream_Write(decoded, buffer, (size_t)status);
+	}
+
+	return TRUE;
+}
+
+/* Feeds the encoded body in pieces of step bytes, followed by the next response */
+static BOOL test_decode(wStream* encoded, wStream* expected, size_t step, size_t readSize,
+                        BOOL readAhead)
+{
+	BOOL rc = FALSE;
+	char next[sizeof(test_next)] = { 0 };
+	const size_t total = Stream_Length(encoded);
+	const BYTE* data = Stream_Buffer(encoded);
+	BIO* bio = BIO_new(BIO_s_mem());
+	wStream* decoded = Stream_New(NULL, Stream_Length(expected));
+	http_encoding_chunked_context* ctx = calloc(1, sizeof(http_encoding_chunked_context));
+	if (!bio || !decoded || !ctx)
+		goto fail;
+
+	BIO_set_mem_eof_return(bio, -1);
+	http_chunked_context_init(ctx, readAhead);
+
+	for (size_t written = 0; ctx->state != ChunkStateEnd;)
+	{
+		/* the decoder did not detect the end of the body */
+		if (written == total)
+			goto fail;
+
+		const size_t length = MIN(step, total - written);
+		if (BIO_write(bio, &data[written], (int)length) != (int)length)
+			goto fail;
+		written += length;
+
+		if ((written == total) &&
+		    (BIO_write(bio, test_next, (int)strlen(test_next)) != (int)strlen(test_next)))
+			goto fail;
+
+		if (!test_read(bio, ctx, decoded, readSize))
+			goto fail;
+	}
+
+	if ((Stream_GetPosition(decoded) != Stream_Length(expected)) ||
+	    (memcmp(Stream_Buffer(decoded), Stream_Buffer(expected), Stream_Length(expected)) != 0))
+		goto fail;
+
+	/* everything after the body, including read ahead, must be left in the BIO */
+	if (!readAhead)
+	{
+		if ((BIO_read(bio, next, sizeof(next)) != (int)strlen(test_next)) ||
+		    (strcmp(next, test_next) != 0))
+			goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	if (!rc)
+		printf("decoding failed: step %" PRIuz ", read size %" PRIuz ", read ahead %d\n", step,
+		       readSize, readAhead);
+	free(ctx);
+	Stream_Free(decoded, TRUE);
+	BIO_free_all(bio);
+	return rc;
+}
+
+int TestHttpChunked(int argc, char* argv[])
+{
+	int rc = -1;
+	const size_t readSizes[] = { 1, 5, HTTP_CHUNKED_READ_AHEAD_SIZE / 2,
+		                         2 * HTTP_CHUNKED_READ_AHEAD_SIZE };
+	wStream* encoded = Stream_New(NULL, 1024);
+	wStream* expected = Stream_New(NULL, 1024);
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	if (!encoded || !expected || !test_encode(encoded, expected))
+		goto fail;
+
+	/* length lines, footers and trailers split across BIO writes */
+	const size_t steps[] = { 1, 2, 3, 7, 64, Stream_Length(encoded) };
+	for (size_t x = 0; x < ARRAYSIZE(steps); x++)
+	{
+		for (size_t y = 0; y < ARRAYSIZE(readSizes); y++)
+		{
+			if (!test_decode(encoded, expected, steps[x], readSizes[y], FALSE) ||
+			    !test_decode(encoded, expected, steps[x], readSizes[y], TRUE))
+				goto fail;
+		}
+	}
+
+	rc = 0;
+fail:
+	Stream_Free(encoded, TRUE);
+	Stream_Free(expected, TRUE);
+	return rc;
+}
@@ -339,6 +339,7 @@ static const size_t uint32_list_indices[] = {
 	FreeRDP_TcpKeepAliveDelay,
 	FreeRDP_TcpKeepAliveInterval,
 	FreeRDP_TcpKeepAliveRetries,
+	FreeRDP_TcpNotSentLowWatermark,
 	FreeRDP_ThreadingFlags,
 	FreeRDP_TlsSecLevel,
 	FreeRDP_VCChunkSize,
@@ -188,6 +188,9 @@ static BOOL transport_default_attach(rdpTransport* transport, int sockfd)
 		if (!freerdp_tcp_set_keep_alive_mode(settings, sockfd))
 			goto fail;
 
+		if (!freerdp_tcp_set_notsent_lowat(settings, sockfd))
+			goto fail;
+
 		socketBio = BIO_new(BIO_s_simple_socket());
 
 		if (!socketBio)
@@ -1833,6 +1836,22 @@ UINT64 transport_get_bytes_sent(rdpTransport* transport, BOOL resetCount)
 	return rc;
 }
 
+size_t transport_get_unsent_bytes(rdpTransport* transport)
+{
+	long rc = 0;
+
+	WINPR_ASSERT(transport);
+
+	EnterCriticalSection(&(transport->WriteLock));
+	if (transport->frontBio)
+		rc = BIO_get_unsent_bytes(transport->frontBio);
+	LeaveCriticalSection(&(transport->WriteLock));
+
+	if (rc < 0)
+		return 0;
+	return (size_t)rc;
+}
+
 TRANSPORT_LAYER transport_get_layer(rdpTransport* transport)
 {
 	WINPR_ASSERT(transport);
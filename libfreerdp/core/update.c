@@ -135,14 +135,10 @@ static BOOL update_read_bitmap_data(rdpUpdate* update, wStream* s, BITMAP_DATA*
 	if (!Stream_CheckAndLogRequiredLength(TAG, s, bitmapData->bitmapLength))
 		return FALSE;
 
+	/* The bitmap data is borrowed from the PDU, see free_bitmap_update_view */
 	if (bitmapData->bitmapLength > 0)
 	{
-		bitmapData->bitmapDataStream = malloc(bitmapData->bitmapLength);
-
-		if (!bitmapData->bitmapDataStream)
-			return FALSE;
-
-		memcpy(bitmapData->bitmapDataStream, Stream_ConstPointer(s), bitmapData->bitmapLength);
+		bitmapData->bitmapDataStream = Stream_Pointer(s);
 		Stream_Seek(s, bitmapData->bitmapLength);
 	}
 
@@ -229,6 +225,33 @@ static BOOL update_write_bitmap_data(rdpUpdate* update_pub, wStream* s, BITMAP_D
 	return TRUE;
 }
 
+void free_bitmap_update_view(WINPR_ATTR_UNUSED rdpContext* context, BITMAP_UPDATE* update)
+{
+	if (!update)
+		return;
+
+	free(update->rectangles);
+	free(update);
+}
+
+void free_pointer_color_update_view(WINPR_ATTR_UNUSED rdpContext* context,
+                                    POINTER_COLOR_UPDATE* pointer)
+{
+	free(pointer);
+}
+
+void free_pointer_large_update_view(WINPR_ATTR_UNUSED rdpContext* context,
+                                    POINTER_LARGE_UPDATE* pointer)
+{
+	free(pointer);
+}
+
+void free_pointer_new_update_view(WINPR_ATTR_UNUSED rdpContext* context,
+                                  POINTER_NEW_UPDATE* pointer)
+{
+	free(pointer);
+}
+
 BITMAP_UPDATE* update_read_bitmap_update(rdpUpdate* update, wStream* s)
 {
 	BITMAP_UPDATE* bitmapUpdate = calloc(1, sizeof(BITMAP_UPDATE));
@@ -259,7 +282,7 @@ BITMAP_UPDATE* update_read_bitmap_update(rdpUpdate* update, wStream* s)
 fail:
 	WINPR_PRAGMA_DIAG_PUSH
 	WINPR_PRAGMA_DIAG_IGNORED_MISMATCHED_DEALLOC
-	free_bitmap_update(update->context, bitmapUpdate);
+	free_bitmap_update_view(update->context, bitmapUpdate);
 	WINPR_PRAGMA_DIAG_POP
 	return NULL;
 }
@@ -406,7 +429,6 @@ fail:
 static BOOL s_update_read_pointer_color(wStream* s, POINTER_COLOR_UPDATE* pointer_color,
                                         BYTE xorBpp, UINT32 flags)
 {
-	BYTE* newMask = NULL;
 	UINT32 scanlineSize = 0;
 	UINT32 max = 32;
 
@@ -483,13 +505,8 @@ static BOOL s_update_read_pointer_color(wStream* s, POINTER_COLOR_UPDATE* pointe
 			goto fail;
 		}
 
-		newMask = realloc(pointer_color->xorMaskData, pointer_color->lengthXorMask);
-
-		if (!newMask)
-			goto fail;
-
-		pointer_color->xorMaskData = newMask;
-		Stream_Read(s, pointer_color->xorMaskData, pointer_color->lengthXorMask);
+		pointer_color->xorMaskData = Stream_Pointer(s);
+		Stream_Seek(s, pointer_color->lengthXorMask);
 	}
 
 	if (pointer_color->lengthAndMask > 0)
@@ -514,13 +531,8 @@ static BOOL s_update_read_pointer_color(wStream* s, POINTER_COLOR_UPDATE* pointe
 			goto fail;
 		}
 
-		newMask = realloc(pointer_color->andMaskData, pointer_color->lengthAndMask);
-
-		if (!newMask)
-			goto fail;
-
-		pointer_color->andMaskData = newMask;
-		Stream_Read(s, pointer_color->andMaskData, pointer_color->lengthAndMask);
+		pointer_color->andMaskData = Stream_Pointer(s);
+		Stream_Seek(s, pointer_color->lengthAndMask);
 	}
 
 	if (Stream_GetRemainingLength(s) > 0)
@@ -548,14 +560,13 @@ POINTER_COLOR_UPDATE* update_read_pointer_color(rdpUpdate* update, wStream* s, B
 fail:
 	WINPR_PRAGMA_DIAG_PUSH
 	WINPR_PRAGMA_DIAG_IGNORED_MISMATCHED_DEALLOC
-	free_pointer_color_update(update->context, pointer_color);
+	free_pointer_color_update_view(update->context, pointer_color);
 	WINPR_PRAGMA_DIAG_POP
 	return NULL;
 }
 
 static BOOL s_update_read_pointer_large(wStream* s, POINTER_LARGE_UPDATE* pointer)
 {
-	BYTE* newMask = NULL;
 	UINT32 scanlineSize = 0;
 
 	if (!pointer)
@@ -613,13 +624,8 @@ static BOOL s_update_read_pointer_large(wStream* s, POINTER_LARGE_UPDATE* pointe
 			goto fail;
 		}
 
-		newMask = realloc(pointer->xorMaskData, pointer->lengthXorMask);
-
-		if (!newMask)
-			goto fail;
-
-		pointer->xorMaskData = newMask;
-		Stream_Read(s, pointer->xorMaskData, pointer->lengthXorMask);
+		pointer->xorMaskData = Stream_Pointer(s);
+		Stream_Seek(s, pointer->lengthXorMask);
 	}
 
 	if (pointer->lengthAndMask > 0)
@@ -644,13 +650,8 @@ static BOOL s_update_read_pointer_large(wStream* s, POINTER_LARGE_UPDATE* pointe
 			goto fail;
 		}
 
-		newMask = realloc(pointer->andMaskData, pointer->lengthAndMask);
-
-		if (!newMask)
-			goto fail;
-
-		pointer->andMaskData = newMask;
-		Stream_Read(s, pointer->andMaskData, pointer->lengthAndMask);
+		pointer->andMaskData = Stream_Pointer(s);
+		Stream_Seek(s, pointer->lengthAndMask);
 	}
 
 	if (Stream_GetRemainingLength(s) > 0)
@@ -677,7 +678,7 @@ POINTER_LARGE_UPDATE* update_read_pointer_large(rdpUpdate* update, wStream* s)
 fail:
 	WINPR_PRAGMA_DIAG_PUSH
 	WINPR_PRAGMA_DIAG_IGNORED_MISMATCHED_DEALLOC
-	free_pointer_large_update(update->context, pointer);
+	free_pointer_large_update_view(update->context, pointer);
 	WINPR_PRAGMA_DIAG_POP
 	return NULL;
 }
@@ -712,7 +713,7 @@ POINTER_NEW_UPDATE* update_read_pointer_new(rdpUpdate* update, wStream* s)
 fail:
 	WINPR_PRAGMA_DIAG_PUSH
 	WINPR_PRAGMA_DIAG_IGNORED_MISMATCHED_DEALLOC
-	free_pointer_new_update(update->context, pointer_new);
+	free_pointer_new_update_view(update->context, pointer_new);
 	WINPR_PRAGMA_DIAG_POP
 	return NULL;
 }
@@ -788,7 +789,7 @@ BOOL update_recv_pointer(rdpUpdate* update, wStream* s)
 			if (pointer_color)
 			{
 				rc = IFCALLRESULT(FALSE, pointer->PointerColor, context, pointer_color);
-				free_pointer_color_update(context, pointer_color);
+				free_pointer_color_update_view(context, pointer_color);
 			}
 		}
 		break;
@@ -800,7 +801,7 @@ BOOL update_recv_pointer(rdpUpdate* update, wStream* s)
 			if (pointer_large)
 			{
 				rc = IFCALLRESULT(FALSE, pointer->PointerLarge, context, pointer_large);
-				free_pointer_large_update(context, pointer_large);
+				free_pointer_large_update_view(context, pointer_large);
 			}
 		}
 		break;
@@ -812,7 +813,7 @@ BOOL update_recv_pointer(rdpUpdate* update, wStream* s)
 			if (pointer_new)
 			{
 				rc = IFCALLRESULT(FALSE, pointer->PointerNew, context, pointer_new);
-				free_pointer_new_update(context, pointer_new);
+				free_pointer_new_update_view(context, pointer_new);
 			}
 		}
 		break;
@@ -871,7 +872,7 @@ BOOL update_recv(rdpUpdate* update, wStream* s)
 			}
 
 			rc = IFCALLRESULT(FALSE, update->BitmapUpdate, context, bitmap_update);
-			free_bitmap_update(context, bitmap_update);
+			free_bitmap_update_view(context, bitmap_update);
 		}
 		break;
 
@@ -185,7 +185,21 @@ FREERDP_LOCAL BOOL update_recv_play_sound(rdpUpdate* update, wStream* s);
 FREERDP_LOCAL BOOL update_recv_pointer(rdpUpdate* update, wStream* s);
 FREERDP_LOCAL BOOL update_recv(rdpUpdate* update, wStream* s);
 
-WINPR_ATTR_MALLOC(free_bitmap_update, 2)
+/**
+ * The bitmap and pointer updates returned by the parsers below borrow their payload
+ * (bitmapDataStream, xorMaskData, andMaskData) from the stream they were read from.
+ * They are only valid as long as that stream is and must be released with the matching
+ * free_*_view function. Consumers keeping the data beyond the update callback must copy it,
+ * e.g. with copy_bitmap_update or copy_pointer_*_update.
+ */
+FREERDP_LOCAL void free_bitmap_update_view(rdpContext* context, BITMAP_UPDATE* update);
+FREERDP_LOCAL void free_pointer_color_update_view(rdpContext* context,
+                                                  POINTER_COLOR_UPDATE* pointer);
+FREERDP_LOCAL void free_pointer_large_update_view(rdpContext* context,
+                                                  POINTER_LARGE_UPDATE* pointer);
+FREERDP_LOCAL void free_pointer_new_update_view(rdpContext* context, POINTER_NEW_UPDATE* pointer);
+
+WINPR_ATTR_MALLOC(free_bitmap_update_view, 2)
 FREERDP_LOCAL BITMAP_UPDATE* update_read_bitmap_update(rdpUpdate* update, wStream* s);
 
 WINPR_ATTR_MALLOC(free_palette_update, 2)
@@ -197,14 +211,14 @@ FREERDP_LOCAL POINTER_SYSTEM_UPDATE* update_read_pointer_system(rdpUpdate* updat
 WINPR_ATTR_MALLOC(free_pointer_position_update, 2)
 FREERDP_LOCAL POINTER_POSITION_UPDATE* update_read_pointer_position(rdpUpdate* update, wStream* s);
 
-WINPR_ATTR_MALLOC(free_pointer_color_update, 2)
+WINPR_ATTR_MALLOC(free_pointer_color_update_view, 2)
 FREERDP_LOCAL POINTER_COLOR_UPDATE* update_read_pointer_color(rdpUpdate* update, wStream* s,
                                                               BYTE xorBpp);
 
-WINPR_ATTR_MALLOC(free_pointer_large_update, 2)
+WINPR_ATTR_MALLOC(free_pointer_large_update_view, 2)
 FREERDP_LOCAL POINTER_LARGE_UPDATE* update_read_pointer_large(rdpUpdate* update, wStream* s);
 
-WINPR_ATTR_MALLOC(free_pointer_new_update, 2)
+WINPR_ATTR_MALLOC(free_pointer_new_update_view, 2)
 FREERDP_LOCAL POINTER_NEW_UPDATE* update_read_pointer_new(rdpUpdate* update, wStream* s);
 
 WINPR_ATTR_MALLOC(free_pointer_cached_update, 2)
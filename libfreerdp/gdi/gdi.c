@@ -1089,6 +1089,9 @@ static BOOL gdi_surface_bits(rdpContext* context, const SURFACE_BITS_COMMAND* cm
 	{
 		case RDP_CODEC_ID_REMOTEFX:
 		case RDP_CODEC_ID_IMAGE_REMOTEFX:
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_REMOTEFX))
+				goto out;
+
 			if (!rfx_process_message(context->codecs->rfx, cmd->bmp.bitmapData,
 			                         cmd->bmp.bitmapDataLength, cmdRect.left, cmdRect.top,
 			                         gdi->primary_buffer, gdi->dstFormat, gdi->stride,
@@ -1103,6 +1106,9 @@ static BOOL gdi_surface_bits(rdpContext* context, const SURFACE_BITS_COMMAND* cm
 		case RDP_CODEC_ID_NSCODEC:
 			format = gdi->dstFormat;
 
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_NSCODEC))
+				goto out;
+
 			if (!nsc_process_message(
 			        context->codecs->nsc, cmd->bmp.bpp, cmd->bmp.width, cmd->bmp.height,
 			        cmd->bmp.bitmapData, cmd->bmp.bitmapDataLength, gdi->primary_buffer, format,
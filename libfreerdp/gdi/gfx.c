@@ -225,6 +225,9 @@ static UINT gdi_OutputUpdate(rdpGdi* gdi, gdiGfxSurface* surface)
 	rc = CHANNEL_RC_OK;
 fail:
 
+	if (gdi->inGfxFrame)
+		gdi->gfxFramePainted = TRUE;
+
 	if (!update_end_paint(update))
 		rc = ERROR_INTERNAL_ERROR;
 
@@ -302,6 +305,7 @@ static UINT gdi_StartFrame(RdpgfxClientContext* context, const RDPGFX_START_FRAM
 	gdi = (rdpGdi*)context->custom;
 	WINPR_ASSERT(gdi);
 	gdi->inGfxFrame = TRUE;
+	gdi->gfxFramePainted = FALSE;
 	gdi->frameId = startFrame->frameId;
 	return CHANNEL_RC_OK;
 }
@@ -317,15 +321,28 @@ static UINT gdi_call_update_surfaces(RdpgfxClientContext* context)
  *
  * @return 0 on success, otherwise a Win32 error code
  */
-static UINT gdi_EndFrame(RdpgfxClientContext* context,
-                         WINPR_ATTR_UNUSED const RDPGFX_END_FRAME_PDU* endFrame)
+static UINT gdi_EndFrame(RdpgfxClientContext* context, const RDPGFX_END_FRAME_PDU* endFrame)
 {
 	WINPR_ASSERT(context);
 	WINPR_ASSERT(endFrame);
 
 	rdpGdi* gdi = (rdpGdi*)context->custom;
 	WINPR_ASSERT(gdi);
-	const UINT status = gdi_call_update_surfaces(context);
+	UINT status = gdi_call_update_surfaces(context);
+
+	/* Nothing was handed to the client for presentation. Acknowledging right away would also
+	 * acknowledge earlier frames the client did not present yet, so pass an empty paint for
+	 * this frame instead. The client acknowledges it behind the frames already queued. */
+	if ((status == CHANNEL_RC_OK) && context->DeferFrameAcknowledge && !gdi->gfxFramePainted)
+	{
+		rdpUpdate* update = gdi->context->update;
+		WINPR_ASSERT(update);
+
+		const BOOL begin = update_begin_paint(update);
+		if (!update_end_paint(update) || !begin)
+			status = ERROR_INTERNAL_ERROR;
+	}
+
 	gdi->inGfxFrame = FALSE;
 	return status;
 }
@@ -427,6 +444,9 @@ static UINT gdi_SurfaceCommand_RemoteFX(rdpGdi* gdi, RdpgfxClientContext* contex
 	}
 
 	WINPR_ASSERT(surface->codecs);
+	if (!freerdp_client_codecs_ensure(surface->codecs, FREERDP_CODEC_REMOTEFX))
+		return ERROR_INTERNAL_ERROR;
+
 	rfx_context_set_pixel_format(surface->codecs->rfx, cmd->format);
 	region16_init(&invalidRegion);
 
@@ -482,6 +502,9 @@ static UINT gdi_SurfaceCommand_ClearCodec(rdpGdi* gdi, RdpgfxClientContext* cont
 	}
 
 	WINPR_ASSERT(surface->codecs);
+	if (!freerdp_client_codecs_ensure(surface->codecs, FREERDP_CODEC_CLEARCODEC))
+		return ERROR_INTERNAL_ERROR;
+
 	rc = clear_decompress(surface->codecs->clear, cmd->data, cmd->length, cmd->width, cmd->height,
 	                      surface->data, surface->format, surface->scanline, cmd->left, cmd->top,
 	                      surface->width, surface->height, &gdi->palette);
@@ -540,6 +563,10 @@ static UINT gdi_SurfaceCommand_Planar(rdpGdi* gdi, RdpgfxClientContext* context,
 	if (!is_within_surface(surface, cmd))
 		return ERROR_INVALID_DATA;
 
+	WINPR_ASSERT(surface->codecs);
+	if (!freerdp_client_codecs_ensure(surface->codecs, FREERDP_CODEC_PLANAR))
+		return ERROR_INTERNAL_ERROR;
+
 	if (!planar_decompress(surface->codecs->planar, cmd->data, cmd->length, cmd->width, cmd->height,
 	                       DstData, surface->format, surface->scanline, cmd->left, cmd->top,
 	                       cmd->width, cmd->height, FALSE))
@@ -983,6 +1010,9 @@ static UINT gdi_SurfaceCommand_Progressive(rdpGdi* gdi, RdpgfxClientContext* con
 		return ERROR_INVALID_DATA;
 
 	WINPR_ASSERT(surface->codecs);
+	if (!freerdp_client_codecs_ensure(surface->codecs, FREERDP_CODEC_PROGRESSIVE))
+		return ERROR_INTERNAL_ERROR;
+
 	rc = progressive_create_surface_context(surface->codecs->progressive, surfaceId, surface->width,
 	                                        surface->height);
 
@@ -1891,7 +1921,11 @@ BOOL gdi_graphics_pipeline_init_ex(rdpGdi* gdi, RdpgfxClientContext* gfx,
 		gfx->codecs = freerdp_client_codecs_new(flags);
 		if (!gfx->codecs)
 			return FALSE;
-		if (!freerdp_client_codecs_prepare(gfx->codecs, FREERDP_CODEC_ALL, w, h))
+		/* Surfaces use their own H264 contexts, everything else is created on first use */
+		if (!freerdp_client_codecs_prepare_lazy(gfx->codecs,
+		                                        FREERDP_CODEC_ALL &
+		                                            ~(FREERDP_CODEC_AVC420 | FREERDP_CODEC_AVC444),
+		                                        w, h))
 			return FALSE;
 	}
 	InitializeCriticalSection(&gfx->mux);
@@ -161,6 +161,10 @@ static BOOL gdi_Bitmap_Decompress(rdpContext* context, rdpBitmap* bitmap, const
 		if ((codecId == RDP_CODEC_ID_REMOTEFX) || (codecId == RDP_CODEC_ID_IMAGE_REMOTEFX))
 		{
 			REGION16 invalidRegion = { 0 };
+
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_REMOTEFX))
+				return FALSE;
+
 			region16_init(&invalidRegion);
 
 			const BOOL rc =
@@ -177,6 +181,9 @@ static BOOL gdi_Bitmap_Decompress(rdpContext* context, rdpBitmap* bitmap, const
 		}
 		else if (codecId == RDP_CODEC_ID_NSCODEC)
 		{
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_NSCODEC))
+				return FALSE;
+
 			const int status = nsc_process_message(
 			    context->codecs->nsc, 32, DstWidth, DstHeight, pSrcData, SrcSize, bitmap->data,
 			    bitmap->format, 0, 0, 0, DstWidth, DstHeight, FREERDP_FLIP_VERTICAL);
@@ -193,6 +200,9 @@ static BOOL gdi_Bitmap_Decompress(rdpContext* context, rdpBitmap* bitmap, const
 		}
 		else if (bpp < 32)
 		{
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_INTERLEAVED))
+				return FALSE;
+
 			if (!interleaved_decompress(context->codecs->interleaved, pSrcData, SrcSize, DstWidth,
 			                            DstHeight, bpp, bitmap->data, bitmap->format, 0, 0, 0,
 			                            DstWidth, DstHeight, &gdi->palette))
@@ -205,6 +215,9 @@ static BOOL gdi_Bitmap_Decompress(rdpContext* context, rdpBitmap* bitmap, const
 		{
 			const BOOL fidelity =
 			    freerdp_settings_get_bool(context->settings, FreeRDP_DrawAllowDynamicColorFidelity);
+			if (!freerdp_client_codecs_ensure(context->codecs, FREERDP_CODEC_PLANAR))
+				return FALSE;
+
 			freerdp_planar_switch_bgr(context->codecs->planar, fidelity);
 			if (!planar_decompress(context->codecs->planar, pSrcData, SrcSize, DstWidth, DstHeight,
 			                       bitmap->data, bitmap->format, 0, 0, 0, DstWidth, DstHeight,
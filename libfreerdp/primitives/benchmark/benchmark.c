@@ -198,6 +198,39 @@ static BOOL primitives_RGB2444_benchmark_run(primitives_YUV_benchmark* bench, pr
 	return TRUE;
 }
 
+static BOOL primitives_yCbCr_benchmark_run(primitives_YUV_benchmark* bench, primitives_t* prims)
+{
+	/* RemoteFX and progressive convert one 64x64 tile at a time */
+	const prim_size_t roi = { 64, 64 };
+	const size_t tiles = (1ull * bench->roi.width * bench->roi.height) / (64ull * 64ull);
+	const INT16* channels[3] = { 0 };
+
+	for (size_t i = 0; i < 3; i++)
+		channels[i] = (const INT16*)bench->channels[i];
+
+	for (size_t x = 0; x < 10; x++)
+	{
+		pstatus_t status = PRIMITIVES_SUCCESS;
+		const UINT64 start = winpr_GetTickCount64NS();
+		for (size_t t = 0; (t < tiles) && (status == PRIMITIVES_SUCCESS); t++)
+			status = prims->yCbCrToRGB_16s8u_P3AC4R(channels, 64 * sizeof(INT16),
+			                                        bench->outputBuffer, 64 * 4,
+			                                        bench->testedFormat, &roi);
+		const UINT64 end = winpr_GetTickCount64NS();
+		if (status != PRIMITIVES_SUCCESS)
+		{
+			(void)fprintf(stderr, "Running yCbCrToRGB_16s8u_P3AC4R failed\n");
+			return FALSE;
+		}
+		const UINT64 diff = end - start;
+		char buffer[32] = { 0 };
+		printf("[%" PRIuz "] yCbCrToRGB_16s8u_P3AC4R %" PRIuz " 64x64 tiles took %sns\n", x,
+		       tiles, print_time(diff, buffer, sizeof(buffer)));
+	}
+
+	return TRUE;
+}
+
 int main(int argc, char* argv[])
 {
 	WINPR_UNUSED(argc);
@@ -245,6 +278,14 @@ int main(int argc, char* argv[])
 			goto fail;
 		}
 		printf("\n");
+
+		printf("Running YCbCr -> RGB tile benchmark on %s implementation:\n", hintstr);
+		if (!primitives_yCbCr_benchmark_run(&bench, prim))
+		{
+			(void)fprintf(stderr, "YCbCr -> RGB tile benchmark failed\n");
+			goto fail;
+		}
+		printf("\n");
 	}
 fail:
 	primitives_YUV_benchmark_free(&bench);
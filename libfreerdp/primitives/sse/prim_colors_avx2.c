@@ -0,0 +1,141 @@
+/* FreeRDP: A Remote Desktop Protocol Client
+ * Optimized Color conversion operations.
+ * vi:ts=4 sw=4:
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License. You may obtain
+ * a copy of the License at http://www.apache.org/licenses/LICENSE-2.0.
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <freerdp/config.h>
+
+#include <freerdp/types.h>
+#include <freerdp/primitives.h>
+#include <winpr/assert.h>
+#include <winpr/sysinfo.h>
+
+#include "prim_colors.h"
+
+#include "prim_internal.h"
+
+#if defined(SSE_AVX_INTRINSICS_ENABLED)
+#include <immintrin.h>
+
+/* The SSE2 version if the CPU supports it, the generic one otherwise */
+static fn_yCbCrToRGB_16s8u_P3AC4R_t fallback_yCbCrToRGB_16s8u_P3AC4R = NULL;
+
+/* Converts 16 pixels per iteration with the same fixed point arithmetic as the SSE2 version,
+ * see sse2_yCbCrToRGB_16s8u_P3AC4R_BGRX for the derivation of the factors. */
+static inline pstatus_t avx2_yCbCrToRGB_16s8u_P3AC4R_X(const INT16* WINPR_RESTRICT pSrc[3],
+                                                       UINT32 srcStep, BYTE* WINPR_RESTRICT pDst,
+                                                       UINT32 dstStep, UINT32 DstFormat,
+                                                       const prim_size_t* WINPR_RESTRICT roi,
+                                                       BOOL rgb)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i max = _mm256_set1_epi16(255);
+	const __m256i alpha = _mm256_set1_epi16(255);
+	const __m256i r_cr = _mm256_set1_epi16(22987);  /*  1.403 << 14 */
+	const __m256i g_cb = _mm256_set1_epi16(-5636);  /* -0.344 << 14 */
+	const __m256i g_cr = _mm256_set1_epi16(-11698); /* -0.714 << 14 */
+	const __m256i b_cb = _mm256_set1_epi16(29000);  /*  1.770 << 14 */
+	const __m256i c4096 = _mm256_set1_epi16(4096);
+	const UINT32 pad = roi->width % 16;
+	const UINT32 width = roi->width - pad;
+
+	for (UINT32 yp = 0; yp < roi->height; yp++)
+	{
+		const INT16* y_buf = (const INT16*)((const BYTE*)pSrc[0] + 1ULL * yp * srcStep);
+		const INT16* cb_buf = (const INT16*)((const BYTE*)pSrc[1] + 1ULL * yp * srcStep);
+		const INT16* cr_buf = (const INT16*)((const BYTE*)pSrc[2] + 1ULL * yp * srcStep);
+		BYTE* d_buf = &pDst[1ULL * yp * dstStep];
+
+		for (UINT32 x = 0; x < width; x += 16)
+		{
+			/* y = (y + 4096) >> 2 */
+			__m256i y = _mm256_loadu_si256((const __m256i*)&y_buf[x]);
+			y = _mm256_srai_epi16(_mm256_add_epi16(y, c4096), 2);
+			const __m256i cb = _mm256_loadu_si256((const __m256i*)&cb_buf[x]);
+			const __m256i cr = _mm256_loadu_si256((const __m256i*)&cr_buf[x]);
+
+			/* (y + HIWORD(cr*22987)) >> 3 */
+			__m256i r = _mm256_add_epi16(y, _mm256_mulhi_epi16(cr, r_cr));
+			r = _mm256_min_epi16(max, _mm256_max_epi16(_mm256_srai_epi16(r, 3), zero));
+			/* (y + HIWORD(cb*-5636) + HIWORD(cr*-11698)) >> 3 */
+			__m256i g = _mm256_add_epi16(y, _mm256_mulhi_epi16(cb, g_cb));
+			g = _mm256_add_epi16(g, _mm256_mulhi_epi16(cr, g_cr));
+			g = _mm256_min_epi16(max, _mm256_max_epi16(_mm256_srai_epi16(g, 3), zero));
+			/* (y + HIWORD(cb*29000)) >> 3 */
+			__m256i b = _mm256_add_epi16(y, _mm256_mulhi_epi16(cb, b_cb));
+			b = _mm256_min_epi16(max, _mm256_max_epi16(_mm256_srai_epi16(b, 3), zero));
+
+			/* The pack and unpack instructions work on 128 bit lanes:
+			 * c0 = B0..B7 R0..R7    | B8..B15 R8..R15  (R and B swapped for RGBX)
+			 * c1 = G0..G7 FF..FF    | G8..G15 FF..FF
+			 * bg = B0G0..B7G7       | B8G8..B15G15
+			 * ra = R0FF..R7FF       | R8FF..R15FF
+			 * q0 = pixels 0..3      | pixels 8..11
+			 * q1 = pixels 4..7      | pixels 12..15 */
+			const __m256i c0 = rgb ? _mm256_packus_epi16(r, b) : _mm256_packus_epi16(b, r);
+			const __m256i c1 = _mm256_packus_epi16(g, alpha);
+			const __m256i bg = _mm256_unpacklo_epi8(c0, c1);
+			const __m256i ra = _mm256_unpackhi_epi8(c0, c1);
+			const __m256i q0 = _mm256_unpacklo_epi16(bg, ra);
+			const __m256i q1 = _mm256_unpackhi_epi16(bg, ra);
+			_mm256_storeu_si256((__m256i*)&d_buf[4ULL * x],
+			                    _mm256_permute2x128_si256(q0, q1, 0x20));
+			_mm256_storeu_si256((__m256i*)&d_buf[4ULL * x + 32],
+			                    _mm256_permute2x128_si256(q0, q1, 0x31));
+		}
+	}
+
+	if (pad == 0)
+		return PRIMITIVES_SUCCESS;
+
+	const INT16* pPad[3] = { pSrc[0] + width, pSrc[1] + width, pSrc[2] + width };
+	const prim_size_t padRoi = { pad, roi->height };
+	return fallback_yCbCrToRGB_16s8u_P3AC4R(pPad, srcStep, &pDst[4ULL * width], dstStep,
+	                                        DstFormat, &padRoi);
+}
+
+static pstatus_t avx2_yCbCrToRGB_16s8u_P3AC4R(const INT16* WINPR_RESTRICT pSrc[3], UINT32 srcStep,
+                                              BYTE* WINPR_RESTRICT pDst, UINT32 dstStep,
+                                              UINT32 DstFormat,
+                                              const prim_size_t* WINPR_RESTRICT roi)
+{
+	switch (DstFormat)
+	{
+		case PIXEL_FORMAT_BGRA32:
+		case PIXEL_FORMAT_BGRX32:
+			return avx2_yCbCrToRGB_16s8u_P3AC4R_X(pSrc, srcStep, pDst, dstStep, DstFormat, roi,
+			                                      FALSE);
+
+		case PIXEL_FORMAT_RGBA32:
+		case PIXEL_FORMAT_RGBX32:
+			return avx2_yCbCrToRGB_16s8u_P3AC4R_X(pSrc, srcStep, pDst, dstStep, DstFormat, roi,
+			                                      TRUE);
+
+		default:
+			return fallback_yCbCrToRGB_16s8u_P3AC4R(pSrc, srcStep, pDst, dstStep, DstFormat, roi);
+	}
+}
+#endif
+
+void primitives_init_colors_avx2_int(primitives_t* WINPR_RESTRICT prims)
+{
+#if defined(SSE_AVX_INTRINSICS_ENABLED)
+	fallback_yCbCrToRGB_16s8u_P3AC4R = prims->yCbCrToRGB_16s8u_P3AC4R;
+	WINPR_ASSERT(fallback_yCbCrToRGB_16s8u_P3AC4R);
+
+	WLog_VRB(PRIM_TAG, "AVX2 optimizations");
+	prims->yCbCrToRGB_16s8u_P3AC4R = avx2_yCbCrToRGB_16s8u_P3AC4R;
+#else
+	WLog_VRB(PRIM_TAG, "undefined WITH_SIMD or WITH_AVX2 or AVX2 intrinsics not available");
+	WINPR_UNUSED(prims);
+#endif
+}
@@ -145,6 +145,79 @@ static BOOL test_RGBToRGB_16s8u_P3AC4R_speed(void)
 	return TRUE;
 }
 
+/* ========================================================================= */
+static void fill_ycbcr_plane(INT16* plane, size_t count)
+{
+	winpr_RAND(plane, count * sizeof(INT16));
+
+	/* decoded coefficients are 11.5 fixed point values in [-128.0, 127.0] */
+	for (size_t i = 0; i < count; i++)
+		plane[i] = (INT16)((plane[i] & 0x1FFF) - 4096);
+}
+
+static BOOL test_yCbCrToRGB_16s8u_P3AC4R_func(prim_size_t roi, DWORD DstFormat)
+{
+	BOOL failed = TRUE;
+	INT16* planes[3] = { 0 };
+	const UINT32 srcStride = roi.width * 2;
+	const UINT32 dstStride = roi.width * 4;
+	BYTE* out1 = winpr_aligned_calloc(1, 1ULL * dstStride * roi.height, 32);
+	BYTE* out2 = winpr_aligned_calloc(1, 1ULL * dstStride * roi.height, 32);
+
+	if (!out1 || !out2)
+		goto fail;
+
+	for (size_t x = 0; x < ARRAYSIZE(planes); x++)
+	{
+		planes[x] = winpr_aligned_calloc(1, 1ULL * srcStride * roi.height, 32);
+		if (!planes[x])
+			goto fail;
+		fill_ycbcr_plane(planes[x], 1ULL * roi.width * roi.height);
+	}
+
+	const INT16* ptrs[3] = { planes[0], planes[1], planes[2] };
+	if (generic->yCbCrToRGB_16s8u_P3AC4R(ptrs, srcStride, out1, dstStride, DstFormat, &roi) !=
+	    PRIMITIVES_SUCCESS)
+		goto fail;
+	if (optimized->yCbCrToRGB_16s8u_P3AC4R(ptrs, srcStride, out2, dstStride, DstFormat, &roi) !=
+	    PRIMITIVES_SUCCESS)
+		goto fail;
+
+	/* the optimized versions use 16 bit fixed point factors, allow rounding differences */
+	failed = FALSE;
+	for (size_t i = 0; i < 1ULL * roi.width * roi.height; i++)
+	{
+		BYTE c1[3] = { 0 };
+		BYTE c2[3] = { 0 };
+		const UINT32 o1 = FreeRDPReadColor(&out1[4 * i], DstFormat);
+		const UINT32 o2 = FreeRDPReadColor(&out2[4 * i], DstFormat);
+
+		FreeRDPSplitColor(o1, DstFormat, &c1[0], &c1[1], &c1[2], NULL, NULL);
+		FreeRDPSplitColor(o2, DstFormat, &c2[0], &c2[1], &c2[2], NULL, NULL);
+		for (size_t c = 0; c < ARRAYSIZE(c1); c++)
+		{
+			const int diff = c1[c] - c2[c];
+			if ((diff > 2) || (diff < -2))
+				failed = TRUE;
+		}
+
+		if (failed)
+		{
+			printf("yCbCrToRGB_16s8u_P3AC4R FAIL [%s] %" PRIu32 "x%" PRIu32 ": out1[%" PRIuz
+			       "]=0x%08" PRIx32 " out2[%" PRIuz "]=0x%08" PRIx32 "\n",
+			       FreeRDPGetColorFormatName(DstFormat), roi.width, roi.height, i, o1, i, o2);
+			break;
+		}
+	}
+
+fail:
+	for (size_t x = 0; x < ARRAYSIZE(planes); x++)
+		winpr_aligned_free(planes[x]);
+	winpr_aligned_free(out1);
+	winpr_aligned_free(out2);
+	return !failed;
+}
+
 /* ========================================================================= */
 static BOOL test_yCbCrToRGB_16s16s_P3P3_func(void)
 {
@@ -268,6 +341,18 @@ int TestPrimitivesColors(int argc, char* argv[])
 				return 1;
 		}
 
+		if (!test_yCbCrToRGB_16s8u_P3AC4R_func(roi, formats[x]))
+			return 1;
+
+		/* RemoteFX tiles and a width that leaves a remainder for every vector size */
+		const prim_size_t tile = { 64, 64 };
+		if (!test_yCbCrToRGB_16s8u_P3AC4R_func(tile, formats[x]))
+			return 1;
+
+		const prim_size_t odd = { 53, 7 };
+		if (!test_yCbCrToRGB_16s8u_P3AC4R_func(odd, formats[x]))
+			return 1;
+
 		if (!test_yCbCrToRGB_16s16s_P3P3_func())
 			return 1;
 
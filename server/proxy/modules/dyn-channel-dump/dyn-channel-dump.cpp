@@ -21,10 +21,8 @@
  * limitations under the License.
  */
 
-#include <fstream>
 #include <iostream>
 #include <regex>
-#include <limits>
 #include <utility>
 #include <vector>
 #include <sstream>
@@ -46,6 +44,7 @@ namespace fs = std::experimental::filesystem;
 
 #include <freerdp/server/proxy/proxy_modules_api.h>
 #include <freerdp/server/proxy/proxy_context.h>
+#include <freerdp/server/proxy/proxy_capture.h>
 
 #include <freerdp/channels/drdynvc.h>
 #include <freerdp/channels/rdpgfx.h>
@@ -71,7 +70,8 @@ static constexpr char key_channels[] = "channels";
 class PluginData
 {
   public:
-	explicit PluginData(proxyPluginsManager* mgr) : _mgr(mgr)
+	explicit PluginData(proxyPluginsManager* mgr)
+	    : _mgr(mgr), _sink(pf_capture_sink_new(0), pf_capture_sink_free)
 	{
 	}
 
@@ -80,6 +80,11 @@ class PluginData
 		return _mgr;
 	}
 
+	[[nodiscard]] proxyCaptureSink* sink() const
+	{
+		return _sink.get();
+	}
+
 	uint64_t session()
 	{
 		return _sessionid++;
@@ -88,38 +93,48 @@ class PluginData
   private:
 	proxyPluginsManager* _mgr;
 	uint64_t _sessionid{ 0 };
+	std::unique_ptr<proxyCaptureSink, decltype(&pf_capture_sink_free)> _sink;
 };
 
 class ChannelData
 {
   public:
-	ChannelData(const std::string& base, std::vector<std::string> list, uint64_t sessionid)
-	    : _base(base), _channels_to_dump(std::move(list)), _session_id(sessionid)
+	ChannelData(const std::string& base, std::vector<std::string> list, uint64_t sessionid,
+	            proxyCaptureSink* sink)
+	    : _base(base), _channels_to_dump(std::move(list)), _session_id(sessionid), _sink(sink)
 	{
 		char str[64] = {};
 		(void)_snprintf(str, sizeof(str), "session-%016" PRIx64, _session_id);
 		_base /= str;
 	}
 
-	bool add(const std::string& name, WINPR_ATTR_UNUSED bool back)
+	~ChannelData()
 	{
 		std::lock_guard<std::mutex> guard(_mux);
-		if (_map.find(name) == _map.end())
-		{
-			WLog_INFO(TAG, "adding '%s' to dump list", name.c_str());
-			_map.insert({ name, 0 });
-		}
-		return true;
+		for (const auto& file : _map)
+			(void)pf_capture_sink_close(_sink, file.second.c_str());
 	}
 
-	std::ofstream stream(const std::string& name, bool back)
+	ChannelData(const ChannelData& other) = delete;
+	ChannelData(ChannelData&& other) = delete;
+	ChannelData& operator=(const ChannelData& other) = delete;
+	ChannelData& operator=(ChannelData&& other) = delete;
+
+	bool add(const std::string& name, bool back)
 	{
 		std::lock_guard<std::mutex> guard(_mux);
-		auto& atom = _map[name];
-		auto count = atom++;
-		auto path = filepath(name, back, count);
-		WLog_DBG(TAG, "[%s] writing file '%s'", name.c_str(), path.c_str());
-		return std::ofstream(path);
+		return !filename(name, back).empty();
+	}
+
+	/* The file is kept open by the capture sink, which writes it asynchronously. */
+	bool write(const std::string& name, bool back, const BYTE* data, size_t length)
+	{
+		std::lock_guard<std::mutex> guard(_mux);
+		const auto& path = filename(name, back);
+		if (path.empty())
+			return false;
+
+		return pf_capture_sink_write(_sink, path.c_str(), data, length);
 	}
 
 	[[nodiscard]] bool dump_enabled(const std::string& name) const
@@ -174,15 +189,18 @@ class ChannelData
 	}
 
   private:
-	[[nodiscard]] fs::path filepath(const std::string& channel, bool back, uint64_t count) const
+	const std::string& filename(const std::string& channel, bool back)
 	{
-		auto name = idstr(channel, back);
-		char cstr[32] = {};
-		(void)_snprintf(cstr, sizeof(cstr), "%016" PRIx64 "-", count);
-		auto path = _base / cstr;
-		path += name;
-		path += ".dump";
-		return path;
+		auto id = idstr(channel, back);
+		auto it = _map.find(id);
+		if (it == _map.end())
+		{
+			auto path = _base / id;
+			path += ".dump";
+			WLog_INFO(TAG, "[%s] dumping to file '%s'", channel.c_str(), path.string().c_str());
+			it = _map.insert({ id, path.string() }).first;
+		}
+		return it->second;
 	}
 
 	[[nodiscard]] static std::string idstr(const std::string& name, bool back)
@@ -200,8 +218,9 @@ class ChannelData
 	std::vector<std::string> _channels_to_dump;
 
 	std::mutex _mux;
-	std::map<std::string, uint64_t> _map;
+	std::map<std::string, std::string> _map;
 	uint64_t _session_id;
+	proxyCaptureSink* _sink;
 };
 
 static PluginData* dump_get_plugin_data(proxyPlugin* plugin)
@@ -324,29 +343,12 @@ static BOOL dump_dyn_channel_intercept(proxyPlugin* plugin, proxyData* pdata, vo
 			return FALSE;
 		}
 
-		if (!cdata->ensure_path_exists())
-			return FALSE;
-
-		auto stream = cdata->stream(data->name, data->isBackData);
-		auto buffer = reinterpret_cast<const char*>(Stream_ConstBuffer(data->data));
-		if (!stream.is_open() || !stream.good())
+		if (!cdata->write(data->name, data->isBackData, Stream_ConstBuffer(data->data),
+		                  Stream_Length(data->data)))
 		{
 			WLog_ERR(TAG, "Could not write to stream");
 			return FALSE;
 		}
-		const auto s = Stream_Length(data->data);
-		if (s > std::numeric_limits<std::streamsize>::max())
-		{
-			WLog_ERR(TAG, "Stream length %" PRIuz " exceeds std::streamsize::max", s);
-			return FALSE;
-		}
-		stream.write(buffer, static_cast<std::streamsize>(s));
-		if (stream.fail())
-		{
-			WLog_ERR(TAG, "Could not write to stream");
-			return FALSE;
-		}
-		stream.flush();
 	}
 
 	return TRUE;
@@ -390,7 +392,7 @@ static BOOL dump_session_started(proxyPlugin* plugin, proxyData* pdata, void* /*
 	std::string path(cpath);
 	std::string channels(cchannels);
 	std::vector<std::string> list = split(channels, "[;,]");
-	auto cfg = new ChannelData(path, std::move(list), custom->session());
+	auto cfg = new ChannelData(path, std::move(list), custom->session(), custom->sink());
 	if (!cfg || !cfg->create())
 	{
 		delete cfg;
@@ -441,9 +443,13 @@ BOOL proxy_module_entry_point(proxyPluginsManager* plugins_manager, void* userda
 	plugin.DynChannelToIntercept = dump_dyn_channel_intercept_list;
 	plugin.DynChannelIntercept = dump_dyn_channel_intercept;
 
-	plugin.custom = new PluginData(plugins_manager);
-	if (!plugin.custom)
+	auto custom = new PluginData(plugins_manager);
+	if (!custom->sink())
+	{
+		delete custom;
 		return FALSE;
+	}
+	plugin.custom = custom;
 	plugin.userdata = userdata;
 
 	return plugins_manager->RegisterPlugin(plugins_manager, &plugin);
@@ -0,0 +1,308 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ * FreeRDP Proxy Server
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include <winpr/assert.h>
+#include <winpr/collections.h>
+#include <winpr/endian.h>
+#include <winpr/file.h>
+#include <winpr/string.h>
+#include <winpr/synch.h>
+#include <winpr/thread.h>
+
+#include <freerdp/server/proxy/proxy_capture.h>
+#include <freerdp/server/proxy/proxy_log.h>
+
+#define TAG PROXY_TAG("capture")
+
+#define PF_CAPTURE_DEFAULT_QUEUE_SIZE (16ull * 1024ull * 1024ull)
+#define PF_CAPTURE_FILE_BUFFER_SIZE (64ull * 1024ull)
+
+typedef struct s_capture_record
+{
+	struct s_capture_record* next;
+	BOOL close;
+	char* path;
+	size_t length;
+	BYTE data[];
+} capture_record;
+
+struct proxy_capture_sink
+{
+	CRITICAL_SECTION lock;
+	HANDLE thread;
+	HANDLE data_event;
+	HANDLE space_event;
+
+	capture_record* head;
+	capture_record* tail;
+	size_t queued;
+	size_t max_queued;
+	BOOL stop;
+
+	/* path -> FILE*, only used by the writer thread */
+	wHashTable* files;
+};
+
+static void pf_capture_file_close(void* obj)
+{
+	FILE* fp = obj;
+	if (fp)
+		(void)fclose(fp);
+}
+
+static BOOL pf_capture_file_flush(WINPR_ATTR_UNUSED const void* key, void* value,
+                                  WINPR_ATTR_UNUSED void* arg)
+{
+	FILE* fp = value;
+	if (fflush(fp) != 0)
+		WLog_WARN(TAG, "failed to flush capture file '%s'", (const char*)key);
+	return TRUE;
+}
+
+static FILE* pf_capture_file_get(proxyCaptureSink* sink, const char* path)
+{
+	WINPR_ASSERT(sink);
+	WINPR_ASSERT(path);
+
+	FILE* fp = HashTable_GetItemValue(sink->files, path);
+	if (fp)
+		return fp;
+
+	fp = winpr_fopen(path, "ab");
+	if (!fp)
+	{
+		WLog_ERR(TAG, "failed to open capture file '%s'", path);
+		return NULL;
+	}
+
+	(void)setvbuf(fp, NULL, _IOFBF, PF_CAPTURE_FILE_BUFFER_SIZE);
+
+	if (!HashTable_Insert(sink->files, path, fp))
+	{
+		(void)fclose(fp);
+		return NULL;
+	}
+	return fp;
+}
+
+static void pf_capture_process(proxyCaptureSink* sink, const capture_record* record)
+{
+	WINPR_ASSERT(sink);
+	WINPR_ASSERT(record);
+
+	if (record->close)
+	{
+		HashTable_Remove(sink->files, record->path);
+		return;
+	}
+
+	FILE* fp = pf_capture_file_get(sink, record->path);
+	if (!fp)
+		return;
+
+	if (fwrite(record->data, 1, record->length, fp) != record->length)
+		WLog_ERR(TAG, "failed to write %" PRIuz " bytes to capture file '%s'", record->length,
+		         record->path);
+}
+
+static DWORD WINAPI pf_capture_thread(LPVOID arg)
+{
+	proxyCaptureSink* sink = arg;
+	WINPR_ASSERT(sink);
+
+	for (;;)
+	{
+		if (WaitForSingleObject(sink->data_event, INFINITE) != WAIT_OBJECT_0)
+			break;
+
+		/* Take the whole queue at once, writers may continue while the batch is written */
+		EnterCriticalSection(&sink->lock);
+		capture_record* batch = sink->head;
+		const BOOL stop = sink->stop;
+		sink->head = NULL;
+		sink->tail = NULL;
+		sink->queued = 0;
+		if (!stop)
+			(void)ResetEvent(sink->data_event);
+		(void)SetEvent(sink->space_event);
+		LeaveCriticalSection(&sink->lock);
+
+		if (!batch && stop)
+			break;
+
+		while (batch)
+		{
+			capture_record* next = batch->next;
+			pf_capture_process(sink, batch);
+			free(batch);
+			batch = next;
+		}
+
+		HashTable_Foreach(sink->files, pf_capture_file_flush, NULL);
+	}
+
+	ExitThread(0);
+	return 0;
+}
+
+static BOOL pf_capture_enqueue(proxyCaptureSink* sink, const char* path, BOOL close,
+                               const BYTE* data, size_t length)
+{
+	WINPR_ASSERT(sink);
+	WINPR_ASSERT(path);
+	WINPR_ASSERT(data || (length == 0));
+
+	/* the length prefix and the data are queued as one record, so writers sharing a file
+	 * can not interleave them */
+	const size_t prefix = close ? 0 : sizeof(UINT64);
+	const size_t pathlen = strlen(path) + 1;
+	if (length > SIZE_MAX - sizeof(capture_record) - prefix - pathlen)
+		return FALSE;
+
+	capture_record* record = calloc(1, sizeof(capture_record) + prefix + length + pathlen);
+	if (!record)
+		return FALSE;
+
+	record->close = close;
+	record->length = prefix + length;
+	record->path = (char*)&record->data[record->length];
+	if (prefix > 0)
+		winpr_Data_Write_UINT64(record->data, length);
+	if (length > 0)
+		memcpy(&record->data[prefix], data, length);
+	memcpy(record->path, path, pathlen);
+
+	EnterCriticalSection(&sink->lock);
+
+	/* A record larger than the queue is accepted once the queue is empty */
+	while (!sink->stop && (sink->queued > 0) && (sink->queued + record->length > sink->max_queued))
+	{
+		(void)ResetEvent(sink->space_event);
+		LeaveCriticalSection(&sink->lock);
+		(void)WaitForSingleObject(sink->space_event, INFINITE);
+		EnterCriticalSection(&sink->lock);
+	}
+
+	if (sink->stop)
+	{
+		LeaveCriticalSection(&sink->lock);
+		free(record);
+		return FALSE;
+	}
+
+	if (sink->tail)
+		sink->tail->next = record;
+	else
+		sink->head = record;
+	sink->tail = record;
+	sink->queued += record->length;
+	(void)SetEvent(sink->data_event);
+
+	LeaveCriticalSection(&sink->lock);
+	return TRUE;
+}
+
+BOOL pf_capture_sink_write(proxyCaptureSink* sink, const char* path, const BYTE* data,
+                           size_t length)
+{
+	return pf_capture_enqueue(sink, path, FALSE, data, length);
+}
+
+BOOL pf_capture_sink_close(proxyCaptureSink* sink, const char* path)
+{
+	return pf_capture_enqueue(sink, path, TRUE, NULL, 0);
+}
+
+proxyCaptureSink* pf_capture_sink_new(size_t max_queued)
+{
+	proxyCaptureSink* sink = calloc(1, sizeof(proxyCaptureSink));
+	if (!sink)
+		return NULL;
+
+	InitializeCriticalSection(&sink->lock);
+	sink->max_queued = (max_queued > 0) ? max_queued : PF_CAPTURE_DEFAULT_QUEUE_SIZE;
+
+	sink->files = HashTable_New(FALSE);
+	if (!sink->files)
+		goto fail;
+	if (!HashTable_SetHashFunction(sink->files, HashTable_StringHash))
+		goto fail;
+
+	wObject* obj = HashTable_KeyObject(sink->files);
+	WINPR_ASSERT(obj);
+	obj->fnObjectEquals = HashTable_StringCompare;
+	obj->fnObjectNew = winpr_ObjectStringClone;
+	obj->fnObjectFree = winpr_ObjectStringFree;
+
+	obj = HashTable_ValueObject(sink->files);
+	WINPR_ASSERT(obj);
+	obj->fnObjectFree = pf_capture_file_close;
+
+	sink->data_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!sink->data_event)
+		goto fail;
+
+	sink->space_event = CreateEvent(NULL, TRUE, TRUE, NULL);
+	if (!sink->space_event)
+		goto fail;
+
+	sink->thread = CreateThread(NULL, 0, pf_capture_thread, sink, 0, NULL);
+	if (!sink->thread)
+		goto fail;
+
+	return sink;
+fail:
+	pf_capture_sink_free(sink);
+	return NULL;
+}
+
+void pf_capture_sink_free(proxyCaptureSink* sink)
+{
+	if (!sink)
+		return;
+
+	if (sink->thread)
+	{
+		EnterCriticalSection(&sink->lock);
+		sink->stop = TRUE;
+		(void)SetEvent(sink->data_event);
+		(void)SetEvent(sink->space_event);
+		LeaveCriticalSection(&sink->lock);
+
+		(void)WaitForSingleObject(sink->thread, INFINITE);
+		(void)CloseHandle(sink->thread);
+	}
+
+	/* only left over if the thread could not be started */
+	while (sink->head)
+	{
+		capture_record* next = sink->head->next;
+		free(sink->head);
+		sink->head = next;
+	}
+
+	HashTable_Free(sink->files);
+
+	if (sink->space_event)
+		(void)CloseHandle(sink->space_event);
+	if (sink->data_event)
+		(void)CloseHandle(sink->data_event);
+	DeleteCriticalSection(&sink->lock);
+	free(sink);
+}
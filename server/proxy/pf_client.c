@@ -40,6 +40,7 @@
 
 #include "pf_client.h"
 #include "pf_channel.h"
+#include "pf_dial.h"
 #include <freerdp/server/proxy/proxy_context.h>
 #include "pf_update.h"
 #include "pf_input.h"
@@ -186,6 +187,58 @@ static BOOL pf_client_use_proxy_smartcard_auth(const rdpSettings* settings)
 	return TRUE;
 }
 
+static int pf_client_tcp_connect(rdpContext* context, rdpSettings* settings, const char* hostname,
+                                 int port, DWORD timeout)
+{
+	pClientContext* pc = (pClientContext*)context;
+
+	WINPR_ASSERT(pc);
+	WINPR_ASSERT(pc->pdata);
+	WINPR_ASSERT(pc->client_tcp_connect_original);
+
+	if (hostname && (port > 0) && (port <= UINT16_MAX))
+	{
+		/* reuse the socket dialed while the front end was still connecting */
+		const SOCKET sockfd = pf_dial_take(pc->pdata->early_dial, hostname, (UINT16)port);
+		if (sockfd != INVALID_SOCKET)
+		{
+			/* the transport takes an external socket in place of the port */
+			if (sockfd > INT32_MAX)
+			{
+				closesocket(sockfd);
+				return pc->client_tcp_connect_original(context, settings, hostname, port,
+				                                       timeout);
+			}
+
+			PROXY_LOG_DBG(TAG, pc, "using early connection to %s:%d", hostname, port);
+			return pc->client_tcp_connect_original(context, settings, "|",
+			                                       WINPR_ASSERTING_INT_CAST(int, sockfd),
+			                                       timeout);
+		}
+	}
+
+	return pc->client_tcp_connect_original(context, settings, hostname, port, timeout);
+}
+
+static BOOL pf_client_register_tcp_connect(pClientContext* pc)
+{
+	WINPR_ASSERT(pc);
+
+	if (!pc->pdata->early_dial)
+		return TRUE;
+
+	const rdpTransportIo* dfl = freerdp_get_io_callbacks(&pc->context);
+	WINPR_ASSERT(dfl);
+
+	if (dfl->TCPConnect == pf_client_tcp_connect)
+		return TRUE;
+
+	rdpTransportIo io = *dfl;
+	pc->client_tcp_connect_original = dfl->TCPConnect;
+	io.TCPConnect = pf_client_tcp_connect;
+	return freerdp_set_io_callbacks(&pc->context, &io);
+}
+
 static BOOL pf_client_pre_connect(freerdp* instance)
 {
 	pClientContext* pc = NULL;
@@ -286,6 +339,9 @@ static BOOL pf_client_pre_connect(freerdp* instance)
 	if (!pf_client_use_peer_load_balance_info(pc))
 		return FALSE;
 
+	if (!pf_client_register_tcp_connect(pc))
+		return FALSE;
+
 	return pf_modules_run_hook(pc->pdata->module, HOOK_TYPE_CLIENT_PRE_CONNECT, pc->pdata, pc);
 }
 
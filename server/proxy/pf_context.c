@@ -29,6 +29,7 @@
 #include <freerdp/channels/drdynvc.h>
 
 #include "pf_client.h"
+#include "pf_dial.h"
 #include "pf_utils.h"
 #include "proxy_modules.h"
 
@@ -399,6 +400,8 @@ void proxy_data_free(proxyData* pdata)
 	if (pdata->modules_info)
 		HashTable_Free(pdata->modules_info);
 
+	pf_dial_free(pdata->early_dial);
+
 	if (pdata->pc)
 		freerdp_client_context_free(&pdata->pc->context);
 
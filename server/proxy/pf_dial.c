@@ -0,0 +1,286 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ * FreeRDP Proxy Server
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <winpr/assert.h>
+#include <winpr/string.h>
+#include <winpr/synch.h>
+#include <winpr/thread.h>
+#include <winpr/sysinfo.h>
+#include <winpr/winsock.h>
+
+#include <freerdp/server/proxy/proxy_log.h>
+
+#include "pf_dial.h"
+#include "proxy_modules.h"
+
+#define TAG PROXY_TAG("dial")
+
+/* granularity used to check for cancellation while a connect is pending */
+#define PF_DIAL_POLL_INTERVAL_MS 100
+
+struct p_early_dial
+{
+	char* hostname;
+	UINT16 port;
+	DWORD timeout;
+
+	HANDLE thread;
+	HANDLE cancel_event;
+	HANDLE abort_event;
+
+	SOCKET sockfd;
+};
+
+static BOOL pf_dial_cancelled(const proxyEarlyDial* dial)
+{
+	WINPR_ASSERT(dial);
+
+	if (WaitForSingleObject(dial->cancel_event, 0) == WAIT_OBJECT_0)
+		return TRUE;
+	if (dial->abort_event && (WaitForSingleObject(dial->abort_event, 0) == WAIT_OBJECT_0))
+		return TRUE;
+	return FALSE;
+}
+
+static BOOL pf_dial_set_blocking(SOCKET sockfd, BOOL blocking)
+{
+	u_long arg = blocking ? 0 : 1;
+	return _ioctlsocket(sockfd, FIONBIO, &arg) == 0;
+}
+
+static BOOL pf_dial_wait_connected(proxyEarlyDial* dial, SOCKET sockfd)
+{
+	const UINT64 start = GetTickCount64();
+
+	WINPR_ASSERT(dial);
+
+	while (!pf_dial_cancelled(dial))
+	{
+		fd_set wfds;
+		fd_set efds;
+		struct timeval tv = { 0, PF_DIAL_POLL_INTERVAL_MS * 1000 };
+
+		FD_ZERO(&wfds);
+		FD_ZERO(&efds);
+		FD_SET(sockfd, &wfds);
+		FD_SET(sockfd, &efds);
+
+		const int status = select((int)sockfd + 1, NULL, &wfds, &efds, &tv);
+		if (status < 0)
+			return FALSE;
+
+		if (status > 0)
+		{
+			int error = 0;
+			socklen_t len = sizeof(error);
+
+			if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, (void*)&error, &len) != 0)
+				return FALSE;
+			return error == 0;
+		}
+
+		if ((dial->timeout > 0) && (GetTickCount64() - start >= dial->timeout))
+			return FALSE;
+	}
+
+	return FALSE;
+}
+
+static SOCKET pf_dial_connect_addr(proxyEarlyDial* dial, const struct addrinfo* addr)
+{
+	WINPR_ASSERT(dial);
+	WINPR_ASSERT(addr);
+
+	SOCKET sockfd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+	if (sockfd == INVALID_SOCKET)
+		return INVALID_SOCKET;
+
+	if (!pf_dial_set_blocking(sockfd, FALSE))
+		goto fail;
+
+	if (connect(sockfd, addr->ai_addr, (int)addr->ai_addrlen) != 0)
+	{
+		const int error = WSAGetLastError();
+		if ((error != WSAEINPROGRESS) && (error != WSAEWOULDBLOCK))
+			goto fail;
+		if (!pf_dial_wait_connected(dial, sockfd))
+			goto fail;
+	}
+
+	if (!pf_dial_set_blocking(sockfd, TRUE))
+		goto fail;
+
+	/* the transport does not touch options of externally provided sockets */
+	const UINT32 optval = 1;
+	if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (const void*)&optval, sizeof(optval)) < 0)
+		WLog_WARN(TAG, "unable to set TCP_NODELAY");
+
+	return sockfd;
+
+fail:
+	closesocket(sockfd);
+	return INVALID_SOCKET;
+}
+
+static DWORD WINAPI pf_dial_thread(LPVOID arg)
+{
+	proxyEarlyDial* dial = arg;
+	struct addrinfo hints = { 0 };
+	struct addrinfo* result = NULL;
+	char service[16] = { 0 };
+
+	WINPR_ASSERT(dial);
+
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	(void)_snprintf(service, sizeof(service), "%" PRIu16, dial->port);
+
+	if (getaddrinfo(dial->hostname, service, &hints, &result) != 0)
+	{
+		WLog_DBG(TAG, "failed to resolve %s", dial->hostname);
+		ExitThread(0);
+		return 0;
+	}
+
+	for (const struct addrinfo* addr = result; addr && !pf_dial_cancelled(dial);
+	     addr = addr->ai_next)
+	{
+		dial->sockfd = pf_dial_connect_addr(dial, addr);
+		if (dial->sockfd != INVALID_SOCKET)
+			break;
+	}
+
+	freeaddrinfo(result);
+
+	if (dial->sockfd == INVALID_SOCKET)
+		WLog_DBG(TAG, "early connect to %s:%" PRIu16 " failed", dial->hostname, dial->port);
+
+	ExitThread(0);
+	return 0;
+}
+
+static void pf_dial_join(proxyEarlyDial* dial)
+{
+	WINPR_ASSERT(dial);
+
+	if (!dial->thread)
+		return;
+
+	(void)WaitForSingleObject(dial->thread, INFINITE);
+	(void)CloseHandle(dial->thread);
+	dial->thread = NULL;
+}
+
+proxyEarlyDial* pf_dial_start(const char* hostname, UINT16 port, DWORD timeout,
+                              HANDLE abort_event)
+{
+	WINPR_ASSERT(hostname);
+
+	proxyEarlyDial* dial = calloc(1, sizeof(proxyEarlyDial));
+	if (!dial)
+		return NULL;
+
+	dial->sockfd = INVALID_SOCKET;
+	dial->port = port;
+	dial->timeout = timeout;
+	dial->abort_event = abort_event;
+
+	dial->hostname = _strdup(hostname);
+	if (!dial->hostname)
+		goto fail;
+
+	dial->cancel_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!dial->cancel_event)
+		goto fail;
+
+	dial->thread = CreateThread(NULL, 0, pf_dial_thread, dial, 0, NULL);
+	if (!dial->thread)
+		goto fail;
+
+	return dial;
+
+fail:
+	pf_dial_free(dial);
+	return NULL;
+}
+
+SOCKET pf_dial_take(proxyEarlyDial* dial, const char* hostname, UINT16 port)
+{
+	WINPR_ASSERT(hostname);
+
+	if (!dial)
+		return INVALID_SOCKET;
+
+	pf_dial_join(dial);
+
+	SOCKET sockfd = dial->sockfd;
+	dial->sockfd = INVALID_SOCKET;
+
+	if (sockfd == INVALID_SOCKET)
+		return INVALID_SOCKET;
+
+	if ((port != dial->port) || (_stricmp(hostname, dial->hostname) != 0))
+	{
+		WLog_DBG(TAG, "early connect to %s:%" PRIu16 " does not match target %s:%" PRIu16,
+		         dial->hostname, dial->port, hostname, port);
+		closesocket(sockfd);
+		return INVALID_SOCKET;
+	}
+
+	return sockfd;
+}
+
+void pf_dial_free(proxyEarlyDial* dial)
+{
+	if (!dial)
+		return;
+
+	if (dial->cancel_event)
+		(void)SetEvent(dial->cancel_event);
+
+	pf_dial_join(dial);
+
+	if (dial->sockfd != INVALID_SOCKET)
+		closesocket(dial->sockfd);
+
+	if (dial->cancel_event)
+		(void)CloseHandle(dial->cancel_event);
+
+	free(dial->hostname);
+	free(dial);
+}
+
+BOOL pf_dial_early_target(const proxyConfig* config, proxyModule* module, const char** hostname,
+                          UINT16* port)
+{
+	WINPR_ASSERT(config);
+	WINPR_ASSERT(hostname);
+	WINPR_ASSERT(port);
+
+	/* A target from the routing token is chosen by the unauthenticated client, it is only
+	 * checked by the FETCH_TARGET_ADDR filters after the client logged on. */
+	if (!config->FixedTarget || !config->TargetHost)
+		return FALSE;
+
+	/* Filters may deny or replace even the fixed target, but they only run after logon */
+	if (module && pf_modules_has_filter(module, FILTER_TYPE_SERVER_FETCH_TARGET_ADDR))
+		return FALSE;
+
+	*hostname = config->TargetHost;
+	*port = (config->TargetPort > 0) ? config->TargetPort : 3389;
+	return TRUE;
+}
@@ -0,0 +1,74 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ * FreeRDP Proxy Server
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERDP_SERVER_PROXY_PFDIAL_H
+#define FREERDP_SERVER_PROXY_PFDIAL_H
+
+#include <winpr/wtypes.h>
+
+#include <winpr/winsock.h>
+
+#include <freerdp/api.h>
+#include <freerdp/server/proxy/proxy_config.h>
+#include <freerdp/server/proxy/proxy_context.h>
+
+/* Only the TCP connection to the target is set up early. The TLS handshake follows the X.224
+ * negotiation with the target, and the protocols requested there as well as the NLA
+ * credentials are taken from the front end session once the client logged on. */
+
+FREERDP_LOCAL void pf_dial_free(proxyEarlyDial* dial);
+
+/**
+ * @brief pf_dial_start Resolves and connects a TCP socket to the target in a background thread.
+ *
+ * @param hostname The target host name. Must NOT be NULL.
+ * @param port The target port.
+ * @param timeout The connect timeout in milliseconds.
+ * @param abort_event An event that cancels the dial when set. May be NULL.
+ * @return A new dial handle or NULL on failure.
+ */
+WINPR_ATTR_MALLOC(pf_dial_free, 1)
+FREERDP_LOCAL proxyEarlyDial* pf_dial_start(const char* hostname, UINT16 port, DWORD timeout,
+                                            HANDLE abort_event);
+
+/**
+ * @brief pf_dial_take Waits for the dial to complete and takes ownership of the socket.
+ *
+ * @param dial The dial handle. May be NULL.
+ * @param hostname The host name the caller is about to connect to. Must NOT be NULL.
+ * @param port The port the caller is about to connect to.
+ * @return The connected socket if the dial succeeded and its target matches \b hostname and
+ *         \b port, INVALID_SOCKET otherwise. A socket not handed out is closed.
+ */
+FREERDP_LOCAL SOCKET pf_dial_take(proxyEarlyDial* dial, const char* hostname, UINT16 port);
+
+/**
+ * @brief pf_dial_early_target Gets the target that may be dialed before the client logged on.
+ *
+ * Only a fixed target from the configuration qualifies, and only if no module filters the
+ * target address. Targets requested by the client are never dialed early.
+ *
+ * @param config The proxy configuration. Must NOT be NULL.
+ * @param module The loaded modules. May be NULL.
+ * @param hostname Receives the host name to dial. Must NOT be NULL.
+ * @param port Receives the port to dial. Must NOT be NULL.
+ * @return TRUE if the target may be dialed early, FALSE otherwise.
+ */
+FREERDP_LOCAL BOOL pf_dial_early_target(const proxyConfig* config, proxyModule* module,
+                                        const char** hostname, UINT16* port);
+
+#endif /* FREERDP_SERVER_PROXY_PFDIAL_H */
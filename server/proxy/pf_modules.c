@@ -452,6 +452,77 @@ BOOL pf_modules_is_plugin_loaded(proxyModule* module, const char* plugin_name)
 	return rc;
 }
 
+static BOOL pf_modules_filter_ArrayList_ForEachFkt(void* data, size_t index, va_list ap)
+{
+	const proxyPlugin* plugin = (const proxyPlugin*)data;
+	BOOL found = FALSE;
+
+	WINPR_UNUSED(index);
+
+	PF_FILTER_TYPE type = va_arg(ap, PF_FILTER_TYPE);
+	BOOL* res = va_arg(ap, BOOL*);
+	WINPR_ASSERT(res);
+
+	switch (type)
+	{
+		case FILTER_TYPE_KEYBOARD:
+			found = plugin->KeyboardEvent != NULL;
+			break;
+		case FILTER_TYPE_UNICODE:
+			found = plugin->UnicodeEvent != NULL;
+			break;
+		case FILTER_TYPE_MOUSE:
+			found = plugin->MouseEvent != NULL;
+			break;
+		case FILTER_TYPE_MOUSE_EX:
+			found = plugin->MouseExEvent != NULL;
+			break;
+		case FILTER_TYPE_CLIENT_PASSTHROUGH_CHANNEL_DATA:
+			found = plugin->ClientChannelData != NULL;
+			break;
+		case FILTER_TYPE_SERVER_PASSTHROUGH_CHANNEL_DATA:
+			found = plugin->ServerChannelData != NULL;
+			break;
+		case FILTER_TYPE_CLIENT_PASSTHROUGH_CHANNEL_CREATE:
+			found = plugin->ChannelCreate != NULL;
+			break;
+		case FILTER_TYPE_CLIENT_PASSTHROUGH_DYN_CHANNEL_CREATE:
+			found = plugin->DynamicChannelCreate != NULL;
+			break;
+		case FILTER_TYPE_SERVER_FETCH_TARGET_ADDR:
+			found = plugin->ServerFetchTargetAddr != NULL;
+			break;
+		case FILTER_TYPE_SERVER_PEER_LOGON:
+			found = plugin->ServerPeerLogon != NULL;
+			break;
+		case FILTER_TYPE_INTERCEPT_CHANNEL:
+			found = plugin->DynChannelIntercept != NULL;
+			break;
+		case FILTER_TYPE_DYN_INTERCEPT_LIST:
+			found = plugin->DynChannelToIntercept != NULL;
+			break;
+		case FILTER_TYPE_STATIC_INTERCEPT_LIST:
+			found = plugin->StaticChannelToIntercept != NULL;
+			break;
+		case FILTER_LAST:
+		default:
+			break;
+	}
+
+	if (found)
+		*res = TRUE;
+	return TRUE;
+}
+
+BOOL pf_modules_has_filter(proxyModule* module, PF_FILTER_TYPE type)
+{
+	BOOL rc = FALSE;
+	WINPR_ASSERT(module);
+	if (!ArrayList_ForEach(module->plugins, pf_modules_filter_ArrayList_ForEachFkt, type, &rc))
+		return FALSE;
+	return rc;
+}
+
 static BOOL pf_modules_print_ArrayList_ForEachFkt(void* data, size_t index, va_list ap)
 {
 	proxyPlugin* plugin = (proxyPlugin*)data;
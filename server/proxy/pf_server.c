@@ -48,6 +48,7 @@
 #include "pf_channel.h"
 #include <freerdp/server/proxy/proxy_config.h>
 #include "pf_client.h"
+#include "pf_dial.h"
 #include <freerdp/server/proxy/proxy_context.h>
 #include "pf_update.h"
 #include "proxy_modules.h"
@@ -345,6 +346,57 @@ static BOOL pf_server_post_connect(freerdp_peer* peer)
 	return TRUE;
 }
 
+/**
+ * Starts connecting to the target while the client is still authenticating against the proxy.
+ *
+ * Only a fixed target no module can deny or replace is dialed, see pf_dial_early_target.
+ * The backend picks the socket up in pf_client if the final target matches, otherwise the
+ * socket is discarded and the backend connects as usual. TLS and NLA with the target still
+ * start from freerdp_connect.
+ */
+static void pf_server_start_early_dial(freerdp_peer* peer)
+{
+	UINT16 port = 0;
+	const char* hostname = NULL;
+
+	WINPR_ASSERT(peer);
+
+	pServerContext* ps = (pServerContext*)peer->context;
+	WINPR_ASSERT(ps);
+
+	proxyData* pdata = ps->pdata;
+	WINPR_ASSERT(pdata);
+
+	if (!pf_dial_early_target(pdata->config, pdata->module, &hostname, &port))
+		return;
+
+	const rdpSettings* frontSettings = peer->context->settings;
+	const DWORD timeout = freerdp_settings_get_uint32(frontSettings, FreeRDP_TcpConnectTimeout);
+
+	PROXY_LOG_DBG(TAG, ps, "early connect to %s:%" PRIu16, hostname, port);
+	pdata->early_dial = pf_dial_start(hostname, port, timeout, pdata->abort_event);
+}
+
+static BOOL pf_server_reached_state(freerdp_peer* peer, CONNECTION_STATE state)
+{
+	WINPR_ASSERT(peer);
+
+	pServerContext* ps = (pServerContext*)peer->context;
+	WINPR_ASSERT(ps);
+
+	proxyData* pdata = ps->pdata;
+	WINPR_ASSERT(pdata);
+
+	/* the fixed target is dialed while the client runs NLA and the MCS connect sequence */
+	if ((state > CONNECTION_STATE_NEGO) && !pdata->early_dial_attempted && !pdata->pc)
+	{
+		pdata->early_dial_attempted = TRUE;
+		pf_server_start_early_dial(peer);
+	}
+
+	return TRUE;
+}
+
 static BOOL pf_server_activate(freerdp_peer* peer)
 {
 	pServerContext* ps = NULL;
@@ -555,6 +607,7 @@ static BOOL pf_server_initialize_peer_connection(freerdp_peer* peer)
 	peer->Activate = pf_server_activate;
 	peer->Logon = pf_server_logon;
 	peer->AdjustMonitorsLayout = pf_server_adjust_monitor_layout;
+	peer->ReachedState = pf_server_reached_state;
 
 	/* virtual channels receive data hook */
 	pdata->server_receive_channel_data_original = peer->ReceiveChannelData;
@@ -1087,3 +1140,11 @@ BOOL pf_server_add_module(proxyServer* server, proxyModuleEntryPoint ep, void* u
 
 	return pf_modules_add(server->module, ep, userdata);
 }
+
+BOOL pf_server_get_early_dial_target(const proxyServer* server, const char** hostname,
+                                     UINT16* port)
+{
+	WINPR_ASSERT(server);
+
+	return pf_dial_early_target(server->config, server->module, hostname, port);
+}
@@ -88,6 +88,14 @@ extern "C"
 
 	BOOL pf_modules_run_filter(proxyModule* module, PF_FILTER_TYPE type, proxyData* pdata,
 	                           void* param);
+
+	/**
+	 * @brief pf_modules_has_filter Checks if a loaded plugin registered a filter of a type
+	 * @param module The modules to check, must NOT be NULL
+	 * @param type The filter type to look for
+	 * @return TRUE if at least one plugin has a filter of that type, FALSE otherwise
+	 */
+	BOOL pf_modules_has_filter(proxyModule* module, PF_FILTER_TYPE type);
 	BOOL pf_modules_run_hook(proxyModule* module, PF_HOOK_TYPE type, proxyData* pdata,
 	                         void* custom);
 
@@ -0,0 +1,197 @@
+
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/crypto.h>
+#include <winpr/endian.h>
+#include <winpr/file.h>
+#include <winpr/path.h>
+#include <winpr/thread.h>
+
+#include <freerdp/server/proxy/proxy_capture.h>
+
+#define TEST_WRITERS 4
+#define TEST_PACKETS 200
+#define TEST_HEADER_SIZE 5
+
+typedef struct
+{
+	proxyCaptureSink* sink;
+	const char* path;
+	BYTE id;
+	BOOL rc;
+} test_writer;
+
+static size_t test_packet_size(size_t index)
+{
+	return TEST_HEADER_SIZE + (index * 37) % 3000;
+}
+
+static BYTE test_packet_value(BYTE id, size_t index)
+{
+	return (BYTE)(id * 31 + index);
+}
+
+/* A packet starts with the writer id and the packet index, the rest is derived from both */
+static DWORD WINAPI test_writer_thread(LPVOID arg)
+{
+	test_writer* writer = arg;
+	BYTE packet[TEST_HEADER_SIZE + 3000] = { 0 };
+
+	for (size_t x = 0; x < TEST_PACKETS; x++)
+	{
+		const size_t size = test_packet_size(x);
+
+		packet[0] = writer->id;
+		winpr_Data_Write_UINT32(&packet[1], (UINT32)x);
+		memset(&packet[TEST_HEADER_SIZE], test_packet_value(writer->id, x),
+		       size - TEST_HEADER_SIZE);
+
+		if (!pf_capture_sink_write(writer->sink, writer->path, packet, size))
+			goto fail;
+	}
+
+	writer->rc = TRUE;
+fail:
+	ExitThread(0);
+	return 0;
+}
+
+static BOOL test_check_packet(const BYTE* packet, size_t size, size_t* next)
+{
+	if (size < TEST_HEADER_SIZE)
+		return FALSE;
+
+	const BYTE id = packet[0];
+	const size_t index = winpr_Data_Get_UINT32(&packet[1]);
+	if ((id >= TEST_WRITERS) || (index != next[id]) || (size != test_packet_size(index)))
+		return FALSE;
+
+	for (size_t x = TEST_HEADER_SIZE; x < size; x++)
+	{
+		if (packet[x] != test_packet_value(id, index))
+			return FALSE;
+	}
+
+	next[id]++;
+	return TRUE;
+}
+
+/* Parse the file as a sequence of 64 bit little endian lengths followed by the packet data */
+static BOOL test_parse(const char* path)
+{
+	BOOL rc = FALSE;
+	size_t next[TEST_WRITERS] = { 0 };
+	BYTE* packet = NULL;
+	FILE* fp = winpr_fopen(path, "rb");
+	if (!fp)
+		return FALSE;
+
+	for (;;)
+	{
+		BYTE prefix[8] = { 0 };
+		const size_t read = fread(prefix, 1, sizeof(prefix), fp);
+		if (read == 0)
+			break;
+		if (read != sizeof(prefix))
+			goto fail;
+
+		const UINT64 size = winpr_Data_Get_UINT64(prefix);
+		if (size > TEST_HEADER_SIZE + 3000)
+			goto fail;
+
+		BYTE* tmp = realloc(packet, size ? (size_t)size : 1);
+		if (!tmp)
+			goto fail;
+		packet = tmp;
+
+		if (fread(packet, 1, (size_t)size, fp) != size)
+			goto fail;
+		if (!test_check_packet(packet, (size_t)size, next))
+			goto fail;
+	}
+
+	for (size_t x = 0; x < TEST_WRITERS; x++)
+	{
+		if (next[x] != TEST_PACKETS)
+			goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	free(packet);
+	(void)fclose(fp);
+	return rc;
+}
+
+static BOOL test_round_trip(const char* path)
+{
+	BOOL rc = TRUE;
+	test_writer writers[TEST_WRITERS] = { 0 };
+	HANDLE threads[TEST_WRITERS] = { 0 };
+
+	/* a small queue, so that writers block and get woken while the file is written */
+	proxyCaptureSink* sink = pf_capture_sink_new(8192);
+	if (!sink)
+		return FALSE;
+
+	for (size_t x = 0; x < TEST_WRITERS; x++)
+	{
+		writers[x].sink = sink;
+		writers[x].path = path;
+		writers[x].id = (BYTE)x;
+		threads[x] = CreateThread(NULL, 0, test_writer_thread, &writers[x], 0, NULL);
+		if (!threads[x])
+			rc = FALSE;
+	}
+
+	for (size_t x = 0; x < TEST_WRITERS; x++)
+	{
+		if (!threads[x])
+			continue;
+		(void)WaitForSingleObject(threads[x], INFINITE);
+		(void)CloseHandle(threads[x]);
+		if (!writers[x].rc)
+			rc = FALSE;
+	}
+
+	/* writes all pending packets and closes the file */
+	pf_capture_sink_free(sink);
+
+	if (!rc)
+		return FALSE;
+	return test_parse(path);
+}
+
+int TestProxyCapture(int argc, char* argv[])
+{
+	int rc = -1;
+	BYTE tmp[16] = { 0 };
+	char name[64] = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	if (winpr_RAND(tmp, sizeof(tmp)) < 0)
+		return -1;
+
+	(void)_snprintf(name, sizeof(name), "TestProxyCapture-");
+	for (size_t x = 0; x < sizeof(tmp); x++)
+		(void)_snprintf(&name[17 + x * 2], sizeof(name) - 17 - 2 * x, "%02" PRIx8, tmp[x]);
+
+	char* path = GetKnownSubPath(KNOWN_PATH_TEMP, name);
+	if (!path)
+		return -1;
+
+	if (!test_round_trip(path))
+	{
+		printf("TestProxyCapture: written packets could not be parsed back\n");
+		goto fail;
+	}
+
+	rc = 0;
+fail:
+	(void)winpr_DeleteFile(path);
+	free(path);
+	return rc;
+}
@@ -0,0 +1,203 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <freerdp/config.h>
+
+#include <winpr/assert.h>
+
+#include <freerdp/log.h>
+#include <freerdp/codec/color.h>
+
+#include "pipewire_frame.h"
+
+#define TAG SERVER_TAG("shadow.pipewire")
+
+void pipewire_frame_init(pipewireFrameState* state)
+{
+	WINPR_ASSERT(state);
+
+	const pipewireFrameState empty = { 0 };
+	*state = empty;
+	region16_init(&state->damage);
+}
+
+void pipewire_frame_uninit(pipewireFrameState* state)
+{
+	WINPR_ASSERT(state);
+	region16_uninit(&state->damage);
+}
+
+void pipewire_frame_reset(pipewireFrameState* state, UINT32 width, UINT32 height)
+{
+	WINPR_ASSERT(state);
+
+	state->width = width;
+	state->height = height;
+	state->fullDamage = TRUE;
+	region16_clear(&state->damage);
+}
+
+BYTE* pipewire_frame_data(const pipewireFrameState* state, BYTE* data, UINT32 offset,
+                          INT32 stride, UINT32 maxsize, UINT32* step)
+{
+	WINPR_ASSERT(state);
+	WINPR_ASSERT(step);
+
+	if (!data || (state->width < 1) || (state->height < 1))
+		return NULL;
+
+	const UINT32 minStride = state->width * 4;
+	const UINT32 lineStep = (stride > 0) ? (UINT32)stride : minStride;
+	if (lineStep < minStride)
+		return NULL;
+
+	/* the last line only needs to hold the pixels, not a full stride */
+	if (1ull * offset + 1ull * lineStep * (state->height - 1) + minStride > maxsize)
+		return NULL;
+
+	*step = lineStep;
+	return &data[offset];
+}
+
+/* Without damage metadata or an empty list nothing tells what changed, the full frame is sent */
+void pipewire_frame_add_damage(pipewireFrameState* state, const pipewireFrameRect* rects,
+                               size_t count)
+{
+	size_t added = 0;
+
+	WINPR_ASSERT(state);
+
+	if (!rects)
+	{
+		state->fullDamage = TRUE;
+		return;
+	}
+
+	for (size_t x = 0; x < count; x++)
+	{
+		const pipewireFrameRect* cur = &rects[x];
+		const INT64 left = MAX(0, cur->x);
+		const INT64 top = MAX(0, cur->y);
+		const INT64 right = MIN((INT64)state->width, 1ll * cur->x + cur->width);
+		const INT64 bottom = MIN((INT64)state->height, 1ll * cur->y + cur->height);
+
+		if ((left >= right) || (top >= bottom))
+			continue;
+
+		const RECTANGLE_16 rect = { .left = (UINT16)left,
+			                        .top = (UINT16)top,
+			                        .right = (UINT16)right,
+			                        .bottom = (UINT16)bottom };
+		if (!region16_union_rect(&state->damage, &state->damage, &rect))
+		{
+			state->fullDamage = TRUE;
+			return;
+		}
+		added++;
+	}
+
+	if (added == 0)
+		state->fullDamage = TRUE;
+}
+
+static BOOL pipewire_frame_invalidate(const pipewireFrameState* state, rdpShadowSurface* surface)
+{
+	UINT32 count = 0;
+	const RECTANGLE_16 full = { .left = 0,
+		                        .top = 0,
+		                        .right = (UINT16)surface->width,
+		                        .bottom = (UINT16)surface->height };
+
+	if (state->fullDamage)
+		return region16_union_rect(&surface->invalidRegion, &surface->invalidRegion, &full);
+
+	const RECTANGLE_16* rects = region16_rects(&state->damage, &count);
+	for (UINT32 x = 0; x < count; x++)
+	{
+		if (!region16_union_rect(&surface->invalidRegion, &surface->invalidRegion, &rects[x]))
+			return region16_union_rect(&surface->invalidRegion, &surface->invalidRegion, &full);
+	}
+
+	return TRUE;
+}
+
+/* Instead of copying a frame the surface data points into it until the next one arrives.
+ * Returns FALSE if the frame does not match the surface, it must not be kept then. */
+BOOL pipewire_frame_attach(pipewireFrameState* state, rdpShadowSurface* surface, BYTE* data,
+                           UINT32 stride, BOOL invalidate, BOOL* update)
+{
+	WINPR_ASSERT(state);
+	WINPR_ASSERT(surface);
+	WINPR_ASSERT(update);
+
+	*update = FALSE;
+
+	EnterCriticalSection(&surface->lock);
+	const BOOL fits =
+	    data && (surface->width == state->width) && (surface->height == state->height);
+	if (fits)
+	{
+		if (!state->attached)
+		{
+			state->surfaceData = surface->data;
+			state->surfaceScanline = surface->scanline;
+			state->attached = TRUE;
+		}
+		surface->data = data;
+		surface->scanline = stride;
+
+		if (invalidate)
+			*update = pipewire_frame_invalidate(state, surface) &&
+			          !region16_is_empty(&surface->invalidRegion);
+	}
+	LeaveCriticalSection(&surface->lock);
+
+	if (fits)
+	{
+		region16_clear(&state->damage);
+		state->fullDamage = FALSE;
+	}
+	else
+		state->fullDamage = TRUE;
+
+	return fits;
+}
+
+/* Points the surface back at its own buffer, keeping the last frame for connected clients.
+ * Returns TRUE if a frame was attached and may be released now. */
+BOOL pipewire_frame_detach(pipewireFrameState* state, rdpShadowSurface* surface)
+{
+	WINPR_ASSERT(state);
+	WINPR_ASSERT(surface);
+
+	if (!state->attached)
+		return FALSE;
+
+	EnterCriticalSection(&surface->lock);
+	if (!freerdp_image_copy_no_overlap(state->surfaceData, surface->format,
+	                                   state->surfaceScanline, 0, 0, surface->width,
+	                                   surface->height, surface->data, surface->format,
+	                                   surface->scanline, 0, 0, NULL, FREERDP_FLIP_NONE))
+		WLog_WARN(TAG, "failed to keep the last frame");
+	surface->data = state->surfaceData;
+	surface->scanline = state->surfaceScanline;
+	LeaveCriticalSection(&surface->lock);
+
+	state->attached = FALSE;
+	state->surfaceData = NULL;
+	state->surfaceScanline = 0;
+	return TRUE;
+}
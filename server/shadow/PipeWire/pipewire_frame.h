@@ -0,0 +1,80 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERDP_SERVER_SHADOW_PIPEWIRE_FRAME_H
+#define FREERDP_SERVER_SHADOW_PIPEWIRE_FRAME_H
+
+#include <winpr/wtypes.h>
+
+#include <freerdp/api.h>
+#include <freerdp/server/shadow.h>
+#include <freerdp/codec/region.h>
+
+/* Frame import of the PipeWire subsystem, kept free of PipeWire types so it can be tested
+ * without a PipeWire daemon. */
+
+typedef struct
+{
+	INT32 x;
+	INT32 y;
+	UINT32 width;
+	UINT32 height;
+} pipewireFrameRect;
+
+typedef struct
+{
+	/* negotiated stream size */
+	UINT32 width;
+	UINT32 height;
+
+	/* damage collected since the last frame handed to the surface */
+	REGION16 damage;
+	BOOL fullDamage;
+
+	/* buffer owned by the surface while its data points into a frame */
+	BOOL attached;
+	BYTE* surfaceData;
+	UINT32 surfaceScanline;
+} pipewireFrameState;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	FREERDP_LOCAL void pipewire_frame_init(pipewireFrameState* state);
+	FREERDP_LOCAL void pipewire_frame_uninit(pipewireFrameState* state);
+
+	FREERDP_LOCAL void pipewire_frame_reset(pipewireFrameState* state, UINT32 width,
+	                                        UINT32 height);
+
+	FREERDP_LOCAL BYTE* pipewire_frame_data(const pipewireFrameState* state, BYTE* data,
+	                                        UINT32 offset, INT32 stride, UINT32 maxsize,
+	                                        UINT32* step);
+
+	FREERDP_LOCAL void pipewire_frame_add_damage(pipewireFrameState* state,
+	                                             const pipewireFrameRect* rects, size_t count);
+
+	FREERDP_LOCAL BOOL pipewire_frame_attach(pipewireFrameState* state, rdpShadowSurface* surface,
+	                                         BYTE* data, UINT32 stride, BOOL invalidate,
+	                                         BOOL* update);
+	FREERDP_LOCAL BOOL pipewire_frame_detach(pipewireFrameState* state, rdpShadowSurface* surface);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERDP_SERVER_SHADOW_PIPEWIRE_FRAME_H */
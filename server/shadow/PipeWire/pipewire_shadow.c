@@ -0,0 +1,815 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <freerdp/config.h>
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <spa/buffer/meta.h>
+#include <spa/param/video/format-utils.h>
+#include <spa/utils/result.h>
+
+#include <winpr/assert.h>
+#include <winpr/cmdline.h>
+#include <winpr/collections.h>
+#include <winpr/crt.h>
+#include <winpr/synch.h>
+#include <winpr/thread.h>
+
+#include <freerdp/log.h>
+#include <freerdp/codec/color.h>
+
+#include "pipewire_shadow.h"
+
+#define TAG SERVER_TAG("shadow.pipewire")
+
+#define PIPEWIRE_DEFAULT_WIDTH 1920
+#define PIPEWIRE_DEFAULT_HEIGHT 1080
+#define PIPEWIRE_MAX_SIZE 8192
+#define PIPEWIRE_MAX_DAMAGE_RECTS 32
+/* nanoseconds to wait for the producer to agree on a video format */
+#define PIPEWIRE_NEGOTIATE_TIMEOUT (5ll * SPA_NSEC_PER_SEC)
+
+static BYTE* pipewire_shadow_buffer_data(const pipewireShadowSubsystem* subsystem,
+                                         struct pw_buffer* buffer, UINT32* stride)
+{
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(buffer);
+
+	const struct spa_buffer* buf = buffer->buffer;
+	if (!buf || (buf->n_datas < 1))
+		return NULL;
+
+	const struct spa_data* data = &buf->datas[0];
+	if (!data->chunk)
+		return NULL;
+
+	return pipewire_frame_data(&subsystem->frame, data->data, data->chunk->offset,
+	                           data->chunk->stride, data->maxsize, stride);
+}
+
+/* Adds the damage of a buffer to the pending damage, returns FALSE if it carries no frame */
+static BOOL pipewire_shadow_collect_damage(pipewireShadowSubsystem* subsystem,
+                                           struct pw_buffer* buffer)
+{
+	size_t count = 0;
+	struct spa_meta_region* region = NULL;
+	pipewireFrameRect rects[PIPEWIRE_MAX_DAMAGE_RECTS] = { 0 };
+
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(buffer);
+
+	struct spa_buffer* buf = buffer->buffer;
+	const struct spa_meta_header* header =
+	    spa_buffer_find_meta_data(buf, SPA_META_Header, sizeof(*header));
+	if (header && (header->flags & SPA_META_HEADER_FLAG_CORRUPTED))
+	{
+		pipewire_frame_add_damage(&subsystem->frame, NULL, 0);
+		return FALSE;
+	}
+
+	if ((buf->n_datas < 1) || !buf->datas[0].chunk)
+		return FALSE;
+
+	const struct spa_chunk* chunk = buf->datas[0].chunk;
+	if (chunk->flags & SPA_CHUNK_FLAG_CORRUPTED)
+	{
+		pipewire_frame_add_damage(&subsystem->frame, NULL, 0);
+		return FALSE;
+	}
+
+	/* cursor only updates come without frame data */
+	if (chunk->size == 0)
+		return FALSE;
+
+	struct spa_meta* meta = spa_buffer_find_meta(buf, SPA_META_VideoDamage);
+	if (!meta)
+	{
+		pipewire_frame_add_damage(&subsystem->frame, NULL, 0);
+		return TRUE;
+	}
+
+	spa_meta_for_each(region, meta)
+	{
+		if (!spa_meta_region_is_valid(region))
+			break;
+
+		/* more regions than requested, treat it as a full update */
+		if (count >= ARRAYSIZE(rects))
+		{
+			pipewire_frame_add_damage(&subsystem->frame, NULL, 0);
+			return TRUE;
+		}
+
+		rects[count].x = region->region.position.x;
+		rects[count].y = region->region.position.y;
+		rects[count].width = region->region.size.width;
+		rects[count].height = region->region.size.height;
+		count++;
+	}
+
+	pipewire_frame_add_damage(&subsystem->frame, rects, count);
+	return TRUE;
+}
+
+/* The thread loop must be locked */
+static void pipewire_shadow_release_surface(pipewireShadowSubsystem* subsystem, BOOL requeue)
+{
+	WINPR_ASSERT(subsystem);
+
+	rdpShadowSurface* surface = subsystem->base.server->surface;
+	WINPR_ASSERT(surface);
+
+	if (!pipewire_frame_detach(&subsystem->frame, surface))
+		return;
+
+	if (requeue && subsystem->current)
+		pw_stream_queue_buffer(subsystem->stream, subsystem->current);
+	subsystem->current = NULL;
+}
+
+static void pipewire_shadow_on_state_changed(void* data, enum pw_stream_state old,
+                                             enum pw_stream_state state, const char* error)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)data;
+	WINPR_ASSERT(subsystem);
+
+	WLog_DBG(TAG, "stream %s -> %s", pw_stream_state_as_string(old),
+	         pw_stream_state_as_string(state));
+
+	if (state == PW_STREAM_STATE_ERROR)
+	{
+		WLog_ERR(TAG, "stream failed: %s", error ? error : "unknown error");
+		subsystem->failed = TRUE;
+		pw_thread_loop_signal(subsystem->loop, false);
+	}
+}
+
+static void pipewire_shadow_on_param_changed(void* data, uint32_t id, const struct spa_pod* param)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)data;
+	uint32_t mediaType = 0;
+	uint32_t mediaSubtype = 0;
+	struct spa_video_info_raw info = { 0 };
+	uint8_t buffer[1024] = { 0 };
+	struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+	const struct spa_pod* params[3] = { 0 };
+
+	WINPR_ASSERT(subsystem);
+
+	if (!param || (id != SPA_PARAM_Format))
+		return;
+
+	if ((spa_format_parse(param, &mediaType, &mediaSubtype) < 0) ||
+	    (mediaType != SPA_MEDIA_TYPE_video) || (mediaSubtype != SPA_MEDIA_SUBTYPE_raw) ||
+	    (spa_format_video_raw_parse(param, &info) < 0))
+		return;
+
+	/* both match the memory layout of PIXEL_FORMAT_BGRX32, alpha is ignored */
+	if ((info.format != SPA_VIDEO_FORMAT_BGRx) && (info.format != SPA_VIDEO_FORMAT_BGRA))
+	{
+		WLog_ERR(TAG, "unsupported video format %" PRIu32, (UINT32)info.format);
+		subsystem->failed = TRUE;
+		pw_thread_loop_signal(subsystem->loop, false);
+		return;
+	}
+
+	if ((info.size.width < 1) || (info.size.width > PIPEWIRE_MAX_SIZE) ||
+	    (info.size.height < 1) || (info.size.height > PIPEWIRE_MAX_SIZE))
+	{
+		WLog_ERR(TAG, "unsupported video size %" PRIu32 "x%" PRIu32, info.size.width,
+		         info.size.height);
+		subsystem->failed = TRUE;
+		pw_thread_loop_signal(subsystem->loop, false);
+		return;
+	}
+
+	if (subsystem->negotiated && ((info.size.width != subsystem->frame.width) ||
+	                              (info.size.height != subsystem->frame.height)))
+		subsystem->resized = TRUE;
+
+	WLog_INFO(TAG, "streaming %" PRIu32 "x%" PRIu32 " %s", info.size.width, info.size.height,
+	          (info.format == SPA_VIDEO_FORMAT_BGRA) ? "BGRA" : "BGRx");
+
+	pipewire_frame_reset(&subsystem->frame, info.size.width, info.size.height);
+	subsystem->negotiated = TRUE;
+
+	/* mappable buffers only, one of them is used as surface data while it is the newest */
+	params[0] = spa_pod_builder_add_object(
+	    &builder, SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers, SPA_PARAM_BUFFERS_buffers,
+	    SPA_POD_CHOICE_RANGE_Int(4, 3, 16), SPA_PARAM_BUFFERS_blocks, SPA_POD_Int(1),
+	    SPA_PARAM_BUFFERS_dataType,
+	    SPA_POD_CHOICE_FLAGS_Int((1 << SPA_DATA_MemFd) | (1 << SPA_DATA_MemPtr)));
+	params[1] = spa_pod_builder_add_object(
+	    &builder, SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta, SPA_PARAM_META_type,
+	    SPA_POD_Id(SPA_META_Header), SPA_PARAM_META_size,
+	    SPA_POD_Int(sizeof(struct spa_meta_header)));
+	params[2] = spa_pod_builder_add_object(
+	    &builder, SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta, SPA_PARAM_META_type,
+	    SPA_POD_Id(SPA_META_VideoDamage), SPA_PARAM_META_size,
+	    SPA_POD_CHOICE_RANGE_Int(sizeof(struct spa_meta_region) * PIPEWIRE_MAX_DAMAGE_RECTS,
+	                             sizeof(struct spa_meta_region),
+	                             sizeof(struct spa_meta_region) * PIPEWIRE_MAX_DAMAGE_RECTS));
+
+	if (pw_stream_update_params(subsystem->stream, params, ARRAYSIZE(params)) < 0)
+		WLog_WARN(TAG, "failed to request buffer metadata, falling back to full frames");
+
+	pw_thread_loop_signal(subsystem->loop, false);
+	if (subsystem->resized)
+		(void)SetEvent(subsystem->frameEvent);
+}
+
+static void pipewire_shadow_on_remove_buffer(void* data, struct pw_buffer* buffer)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)data;
+	WINPR_ASSERT(subsystem);
+
+	if (buffer == subsystem->pending)
+	{
+		subsystem->pending = NULL;
+		pipewire_frame_add_damage(&subsystem->frame, NULL, 0);
+	}
+
+	if (buffer == subsystem->current)
+		pipewire_shadow_release_surface(subsystem, FALSE);
+}
+
+/* Keeps only the newest frame, the damage of the skipped ones is merged into it */
+static void pipewire_shadow_on_process(void* data)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)data;
+	struct pw_buffer* newest = NULL;
+	struct pw_buffer* buffer = NULL;
+
+	WINPR_ASSERT(subsystem);
+
+	while ((buffer = pw_stream_dequeue_buffer(subsystem->stream)))
+	{
+		if (!pipewire_shadow_collect_damage(subsystem, buffer))
+		{
+			pw_stream_queue_buffer(subsystem->stream, buffer);
+			continue;
+		}
+
+		if (newest)
+			pw_stream_queue_buffer(subsystem->stream, newest);
+		newest = buffer;
+	}
+
+	if (!newest)
+		return;
+
+	if (subsystem->pending)
+		pw_stream_queue_buffer(subsystem->stream, subsystem->pending);
+	subsystem->pending = newest;
+	(void)SetEvent(subsystem->frameEvent);
+}
+
+static const struct pw_stream_events pipewire_shadow_stream_events = {
+	.version = PW_VERSION_STREAM_EVENTS,
+	.state_changed = pipewire_shadow_on_state_changed,
+	.param_changed = pipewire_shadow_on_param_changed,
+	.remove_buffer = pipewire_shadow_on_remove_buffer,
+	.process = pipewire_shadow_on_process,
+};
+
+static void pipewire_shadow_set_monitor(pipewireShadowSubsystem* subsystem, UINT32 width,
+                                        UINT32 height)
+{
+	WINPR_ASSERT(subsystem);
+
+	MONITOR_DEF* monitor = &subsystem->base.monitors[0];
+	monitor->left = 0;
+	monitor->top = 0;
+	monitor->right = (INT32)width - 1;
+	monitor->bottom = (INT32)height - 1;
+	monitor->flags = 1;
+
+	subsystem->base.numMonitors = 1;
+	subsystem->base.selectedMonitor = 0;
+	subsystem->base.virtualScreen = *monitor;
+}
+
+static BOOL pipewire_shadow_check_resize(pipewireShadowSubsystem* subsystem)
+{
+	BOOL resized = FALSE;
+	UINT32 width = 0;
+	UINT32 height = 0;
+
+	pw_thread_loop_lock(subsystem->loop);
+	if (subsystem->resized)
+	{
+		pipewire_shadow_release_surface(subsystem, TRUE);
+		subsystem->resized = FALSE;
+		width = subsystem->frame.width;
+		height = subsystem->frame.height;
+		resized = TRUE;
+	}
+	pw_thread_loop_unlock(subsystem->loop);
+
+	if (!resized)
+		return TRUE;
+
+	pipewire_shadow_set_monitor(subsystem, width, height);
+	return shadow_screen_resize(subsystem->base.server->screen);
+}
+
+/* Hands the newest frame to the surface, changes are taken from the damage the compositor
+ * attached to the buffers */
+static int pipewire_shadow_handle_frame(pipewireShadowSubsystem* subsystem)
+{
+	BOOL update = FALSE;
+
+	WINPR_ASSERT(subsystem);
+
+	rdpShadowServer* server = subsystem->base.server;
+	WINPR_ASSERT(server);
+
+	rdpShadowSurface* surface = server->surface;
+	WINPR_ASSERT(surface);
+
+	if (!pipewire_shadow_check_resize(subsystem))
+		return -1;
+
+	pw_thread_loop_lock(subsystem->loop);
+	struct pw_buffer* buffer = subsystem->pending;
+	subsystem->pending = NULL;
+
+	if (buffer)
+	{
+		UINT32 stride = 0;
+		BYTE* data = pipewire_shadow_buffer_data(subsystem, buffer, &stride);
+
+		/* without clients only the surface data is kept up to date, new clients start with a
+		 * full refresh anyway */
+		const BOOL invalidate = ArrayList_Count(server->clients) > 0;
+		if (pipewire_frame_attach(&subsystem->frame, surface, data, stride, invalidate, &update))
+		{
+			if (subsystem->current)
+				pw_stream_queue_buffer(subsystem->stream, subsystem->current);
+			subsystem->current = buffer;
+		}
+		else
+		{
+			WLog_DBG(TAG, "dropping a frame not matching the surface");
+			pw_stream_queue_buffer(subsystem->stream, buffer);
+		}
+	}
+	pw_thread_loop_unlock(subsystem->loop);
+
+	if (update)
+	{
+		shadow_subsystem_frame_update(&subsystem->base);
+
+		EnterCriticalSection(&surface->lock);
+		region16_clear(&surface->invalidRegion);
+		LeaveCriticalSection(&surface->lock);
+	}
+
+	return 1;
+}
+
+static int pipewire_shadow_subsystem_process_message(pipewireShadowSubsystem* subsystem,
+                                                     wMessage* message)
+{
+	switch (message->id)
+	{
+		case SHADOW_MSG_IN_REFRESH_REQUEST_ID:
+			shadow_subsystem_frame_update(&subsystem->base);
+			break;
+
+		default:
+			WLog_ERR(TAG, "Unknown message id: %" PRIu32 "", message->id);
+			break;
+	}
+
+	if (message->Free)
+		message->Free(message);
+
+	return 1;
+}
+
+static DWORD WINAPI pipewire_shadow_subsystem_thread(LPVOID arg)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+	wMessage message = { 0 };
+
+	WINPR_ASSERT(subsystem);
+
+	wMessagePipe* MsgPipe = subsystem->base.MsgPipe;
+	WINPR_ASSERT(MsgPipe);
+
+	HANDLE events[] = { MessageQueue_Event(MsgPipe->In), subsystem->frameEvent };
+
+	while (1)
+	{
+		const DWORD status = WaitForMultipleObjects(ARRAYSIZE(events), events, FALSE, INFINITE);
+		if (status == WAIT_FAILED)
+			break;
+
+		if (WaitForSingleObject(events[0], 0) == WAIT_OBJECT_0)
+		{
+			if (MessageQueue_Peek(MsgPipe->In, &message, TRUE))
+			{
+				if (message.id == WMQ_QUIT)
+					break;
+
+				pipewire_shadow_subsystem_process_message(subsystem, &message);
+			}
+		}
+
+		if (WaitForSingleObject(subsystem->frameEvent, 0) == WAIT_OBJECT_0)
+		{
+			(void)ResetEvent(subsystem->frameEvent);
+			if (pipewire_shadow_handle_frame(subsystem) < 0)
+			{
+				WLog_ERR(TAG, "failed to update the surface");
+				break;
+			}
+		}
+	}
+
+	ExitThread(0);
+	return 0;
+}
+
+static BOOL pipewire_shadow_parse_uint(const char* value, unsigned long max, UINT32* result)
+{
+	char* end = NULL;
+
+	errno = 0;
+	const unsigned long val = strtoul(value, &end, 0);
+	if ((errno != 0) || (end == value) || (*end != '\0') || (val > max))
+		return FALSE;
+
+	*result = (UINT32)val;
+	return TRUE;
+}
+
+static BOOL pipewire_shadow_parse_option(pipewireShadowSubsystem* subsystem, const char* option)
+{
+	const char* value = strchr(option, ':');
+	if (!value)
+		return FALSE;
+	value++;
+
+	if (strncmp(option, "node:", 5) == 0)
+		return pipewire_shadow_parse_uint(value, UINT32_MAX, &subsystem->nodeId);
+
+	if (strncmp(option, "fd:", 3) == 0)
+	{
+		UINT32 fd = 0;
+		if (!pipewire_shadow_parse_uint(value, INT32_MAX, &fd))
+			return FALSE;
+		subsystem->fd = (int)fd;
+		return TRUE;
+	}
+
+	if (strncmp(option, "target:", 7) == 0)
+	{
+		free(subsystem->target);
+		subsystem->target = _strdup(value);
+		return subsystem->target != NULL;
+	}
+
+	return FALSE;
+}
+
+static BOOL pipewire_shadow_parse_options(pipewireShadowSubsystem* subsystem, const char* options)
+{
+	BOOL rc = TRUE;
+	size_t count = 0;
+
+	WINPR_ASSERT(subsystem);
+
+	if (!options)
+		return TRUE;
+
+	char** list = CommandLineParseCommaSeparatedValues(options, &count);
+	if (!list)
+		return FALSE;
+
+	for (size_t x = 0; x < count; x++)
+	{
+		if (!pipewire_shadow_parse_option(subsystem, list[x]))
+		{
+			WLog_ERR(TAG, "invalid option '%s', expected node:<id>,fd:<remote fd>,target:<name>",
+			         list[x]);
+			rc = FALSE;
+			break;
+		}
+	}
+
+	CommandLineParserFree(list);
+	return rc;
+}
+
+/* The thread loop must be locked */
+static BOOL pipewire_shadow_connect(pipewireShadowSubsystem* subsystem)
+{
+	uint8_t buffer[1024] = { 0 };
+	struct spa_pod_builder builder = SPA_POD_BUILDER_INIT(buffer, sizeof(buffer));
+	const struct spa_pod* params[1] = { 0 };
+
+	WINPR_ASSERT(subsystem);
+
+	/* a remote handed out by a screencast portal, the core takes ownership of it */
+	if (subsystem->fd >= 0)
+	{
+		subsystem->core = pw_context_connect_fd(subsystem->context, subsystem->fd, NULL, 0);
+		subsystem->fd = -1;
+	}
+	else
+		subsystem->core = pw_context_connect(subsystem->context, NULL, 0);
+
+	if (!subsystem->core)
+	{
+		WLog_ERR(TAG, "failed to connect to PipeWire: %s", strerror(errno));
+		return FALSE;
+	}
+
+	struct pw_properties* props =
+	    pw_properties_new(PW_KEY_MEDIA_TYPE, "Video", PW_KEY_MEDIA_CATEGORY, "Capture",
+	                      PW_KEY_MEDIA_ROLE, "Screen", NULL);
+	if (!props)
+		return FALSE;
+	if (subsystem->target)
+		pw_properties_set(props, PW_KEY_TARGET_OBJECT, subsystem->target);
+
+	subsystem->stream = pw_stream_new(subsystem->core, "freerdp-shadow", props);
+	if (!subsystem->stream)
+	{
+		WLog_ERR(TAG, "failed to create stream: %s", strerror(errno));
+		return FALSE;
+	}
+
+	pw_stream_add_listener(subsystem->stream, &subsystem->listener,
+	                       &pipewire_shadow_stream_events, subsystem);
+
+	params[0] = spa_pod_builder_add_object(
+	    &builder, SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat, SPA_FORMAT_mediaType,
+	    SPA_POD_Id(SPA_MEDIA_TYPE_video), SPA_FORMAT_mediaSubtype,
+	    SPA_POD_Id(SPA_MEDIA_SUBTYPE_raw), SPA_FORMAT_VIDEO_format,
+	    SPA_POD_CHOICE_ENUM_Id(3, SPA_VIDEO_FORMAT_BGRx, SPA_VIDEO_FORMAT_BGRx,
+	                           SPA_VIDEO_FORMAT_BGRA),
+	    SPA_FORMAT_VIDEO_size,
+	    SPA_POD_CHOICE_RANGE_Rectangle(
+	        &SPA_RECTANGLE(PIPEWIRE_DEFAULT_WIDTH, PIPEWIRE_DEFAULT_HEIGHT), &SPA_RECTANGLE(1, 1),
+	        &SPA_RECTANGLE(PIPEWIRE_MAX_SIZE, PIPEWIRE_MAX_SIZE)),
+	    SPA_FORMAT_VIDEO_framerate,
+	    SPA_POD_CHOICE_RANGE_Fraction(&SPA_FRACTION(30, 1), &SPA_FRACTION(0, 1),
+	                                  &SPA_FRACTION(1000, 1)));
+
+	const int status = pw_stream_connect(subsystem->stream, PW_DIRECTION_INPUT, subsystem->nodeId,
+	                                     PW_STREAM_FLAG_AUTOCONNECT | PW_STREAM_FLAG_MAP_BUFFERS,
+	                                     params, ARRAYSIZE(params));
+	if (status < 0)
+	{
+		WLog_ERR(TAG, "failed to connect stream: %s", spa_strerror(status));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static UINT32 pipewire_shadow_enum_monitors(MONITOR_DEF* monitors, UINT32 maxMonitors)
+{
+	if (!monitors || (maxMonitors < 1))
+		return 0;
+
+	/* the stream size is only known once the format is negotiated during init */
+	const MONITOR_DEF monitor = { .left = 0,
+		                          .top = 0,
+		                          .right = PIPEWIRE_DEFAULT_WIDTH - 1,
+		                          .bottom = PIPEWIRE_DEFAULT_HEIGHT - 1,
+		                          .flags = 1 };
+	monitors[0] = monitor;
+	return 1;
+}
+
+static int pipewire_shadow_subsystem_uninit(rdpShadowSubsystem* arg)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return -1;
+
+	if (subsystem->loop)
+		pw_thread_loop_stop(subsystem->loop);
+
+	if (subsystem->stream)
+	{
+		pw_stream_destroy(subsystem->stream);
+		subsystem->stream = NULL;
+	}
+
+	if (subsystem->core)
+	{
+		pw_core_disconnect(subsystem->core);
+		subsystem->core = NULL;
+	}
+
+	if (subsystem->context)
+	{
+		pw_context_destroy(subsystem->context);
+		subsystem->context = NULL;
+	}
+
+	if (subsystem->loop)
+	{
+		pw_thread_loop_destroy(subsystem->loop);
+		subsystem->loop = NULL;
+	}
+
+	if (subsystem->fd >= 0)
+	{
+		close(subsystem->fd);
+		subsystem->fd = -1;
+	}
+
+	if (subsystem->initialized)
+	{
+		pw_deinit();
+		subsystem->initialized = FALSE;
+	}
+
+	subsystem->pending = NULL;
+	subsystem->current = NULL;
+	subsystem->negotiated = FALSE;
+	return 1;
+}
+
+static int pipewire_shadow_subsystem_init(rdpShadowSubsystem* arg)
+{
+	BOOL rc = FALSE;
+	UINT32 width = 0;
+	UINT32 height = 0;
+	struct timespec deadline = { 0 };
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(subsystem->base.server);
+
+	if (!pipewire_shadow_parse_options(subsystem, subsystem->base.server->SubsystemOptions))
+		return -1;
+
+	pw_init(NULL, NULL);
+	subsystem->initialized = TRUE;
+
+	subsystem->loop = pw_thread_loop_new("freerdp-shadow", NULL);
+	if (!subsystem->loop)
+		goto fail;
+
+	subsystem->context = pw_context_new(pw_thread_loop_get_loop(subsystem->loop), NULL, 0);
+	if (!subsystem->context)
+		goto fail;
+
+	if (pw_thread_loop_start(subsystem->loop) < 0)
+		goto fail;
+
+	pw_thread_loop_lock(subsystem->loop);
+	rc = pipewire_shadow_connect(subsystem);
+	if (rc)
+	{
+		pw_thread_loop_get_time(subsystem->loop, &deadline, PIPEWIRE_NEGOTIATE_TIMEOUT);
+		while (!subsystem->negotiated && !subsystem->failed)
+		{
+			if (pw_thread_loop_timed_wait_full(subsystem->loop, &deadline) < 0)
+				break;
+		}
+		rc = subsystem->negotiated && !subsystem->failed;
+	}
+	width = subsystem->frame.width;
+	height = subsystem->frame.height;
+	pw_thread_loop_unlock(subsystem->loop);
+
+	if (!rc)
+	{
+		WLog_ERR(TAG, "no video stream available");
+		goto fail;
+	}
+
+	pipewire_shadow_set_monitor(subsystem, width, height);
+	return 1;
+
+fail:
+	pipewire_shadow_subsystem_uninit(arg);
+	return -1;
+}
+
+static int pipewire_shadow_subsystem_start(rdpShadowSubsystem* arg)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return -1;
+
+	if (!(subsystem->thread = CreateThread(NULL, 0, pipewire_shadow_subsystem_thread,
+	                                       (void*)subsystem, 0, NULL)))
+	{
+		WLog_ERR(TAG, "Failed to create thread");
+		return -1;
+	}
+
+	return 1;
+}
+
+static int pipewire_shadow_subsystem_stop(rdpShadowSubsystem* arg)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return -1;
+
+	if (subsystem->thread)
+	{
+		if (MessageQueue_PostQuit(subsystem->base.MsgPipe->In, 0))
+			(void)WaitForSingleObject(subsystem->thread, INFINITE);
+
+		(void)CloseHandle(subsystem->thread);
+		subsystem->thread = NULL;
+	}
+
+	/* the surface is freed before the subsystem, it must not point into a buffer anymore */
+	if (subsystem->loop)
+	{
+		pw_thread_loop_lock(subsystem->loop);
+		pipewire_shadow_release_surface(subsystem, TRUE);
+		if (subsystem->pending)
+		{
+			pw_stream_queue_buffer(subsystem->stream, subsystem->pending);
+			subsystem->pending = NULL;
+		}
+		pw_thread_loop_unlock(subsystem->loop);
+	}
+
+	return 1;
+}
+
+static void pipewire_shadow_subsystem_free(rdpShadowSubsystem* arg)
+{
+	pipewireShadowSubsystem* subsystem = (pipewireShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return;
+
+	pipewire_shadow_subsystem_uninit(arg);
+	pipewire_frame_uninit(&subsystem->frame);
+	(void)CloseHandle(subsystem->frameEvent);
+	free(subsystem->target);
+	free(subsystem);
+}
+
+static rdpShadowSubsystem* pipewire_shadow_subsystem_new(void)
+{
+	pipewireShadowSubsystem* subsystem =
+	    (pipewireShadowSubsystem*)calloc(1, sizeof(pipewireShadowSubsystem));
+
+	if (!subsystem)
+		return NULL;
+
+	subsystem->frameEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!subsystem->frameEvent)
+	{
+		free(subsystem);
+		return NULL;
+	}
+
+	subsystem->nodeId = PW_ID_ANY;
+	subsystem->fd = -1;
+	pipewire_frame_init(&subsystem->frame);
+	return &subsystem->base;
+}
+
+const char* pipewire_shadow_subsystem_name(void)
+{
+	return "PipeWire";
+}
+
+int pipewire_shadow_subsystem_entry(RDP_SHADOW_ENTRY_POINTS* pEntryPoints)
+{
+	if (!pEntryPoints)
+		return -1;
+
+	pEntryPoints->New = pipewire_shadow_subsystem_new;
+	pEntryPoints->Free = pipewire_shadow_subsystem_free;
+	pEntryPoints->Init = pipewire_shadow_subsystem_init;
+	pEntryPoints->Uninit = pipewire_shadow_subsystem_uninit;
+	pEntryPoints->Start = pipewire_shadow_subsystem_start;
+	pEntryPoints->Stop = pipewire_shadow_subsystem_stop;
+	pEntryPoints->EnumMonitors = pipewire_shadow_enum_monitors;
+	return 1;
+}
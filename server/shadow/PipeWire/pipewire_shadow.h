@@ -0,0 +1,69 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERDP_SERVER_SHADOW_PIPEWIRE_H
+#define FREERDP_SERVER_SHADOW_PIPEWIRE_H
+
+#include <freerdp/server/shadow.h>
+
+#include <pipewire/pipewire.h>
+
+#include "pipewire_frame.h"
+
+typedef struct pipewire_shadow_subsystem pipewireShadowSubsystem;
+
+struct pipewire_shadow_subsystem
+{
+	rdpShadowSubsystem base;
+
+	HANDLE thread;
+	HANDLE frameEvent;
+
+	UINT32 nodeId;
+	int fd;
+	char* target;
+
+	BOOL initialized;
+	struct pw_thread_loop* loop;
+	struct pw_context* context;
+	struct pw_core* core;
+	struct pw_stream* stream;
+	struct spa_hook listener;
+
+	/* everything below is guarded by the thread loop lock */
+	BOOL negotiated;
+	BOOL resized;
+	BOOL failed;
+	pipewireFrameState frame;
+
+	/* newest frame not handed to the surface yet and the frame currently used as surface data */
+	struct pw_buffer* pending;
+	struct pw_buffer* current;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	FREERDP_LOCAL const char* pipewire_shadow_subsystem_name(void);
+	FREERDP_LOCAL int pipewire_shadow_subsystem_entry(RDP_SHADOW_ENTRY_POINTS* pEntryPoints);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERDP_SERVER_SHADOW_PIPEWIRE_H */
@@ -0,0 +1,657 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <freerdp/config.h>
+
+#include <errno.h>
+
+#include <winpr/assert.h>
+#include <winpr/cmdline.h>
+#include <winpr/collections.h>
+#include <winpr/crt.h>
+#include <winpr/synch.h>
+#include <winpr/sysinfo.h>
+#include <winpr/thread.h>
+
+#include <freerdp/log.h>
+#include <freerdp/codec/color.h>
+#include <freerdp/codec/region.h>
+
+#include "synthetic_shadow.h"
+
+#define TAG SERVER_TAG("shadow.synthetic")
+
+#define SYNTHETIC_DEFAULT_WIDTH 1920
+#define SYNTHETIC_DEFAULT_HEIGHT 1080
+#define SYNTHETIC_DEFAULT_FPS 30
+#define SYNTHETIC_MIN_SIZE 64
+#define SYNTHETIC_MAX_SIZE 8192
+#define SYNTHETIC_MAX_FPS 1000
+
+#define SYNTHETIC_LINE_HEIGHT 16
+#define SYNTHETIC_GLYPH_WIDTH 8
+#define SYNTHETIC_CURSOR_SIZE 32
+#define SYNTHETIC_FLIP_TILE 64
+#define SYNTHETIC_STATS_INTERVAL 5000
+
+static const char* const synthetic_pattern_names[] = { "scroll", "noise", "cursor", "flip" };
+
+/* xorshift32, the state must not be 0 */
+static UINT32 synthetic_rand(UINT32* state)
+{
+	UINT32 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/* Each frame and text line gets its own generator, the output does not depend on timing */
+static UINT32 synthetic_seed(const syntheticShadowSubsystem* subsystem, UINT64 index)
+{
+	UINT64 z = ((UINT64)subsystem->seed << 32) + index * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	z ^= z >> 31;
+
+	const UINT32 state = (UINT32)z;
+	return state ? state : 1;
+}
+
+static UINT32 synthetic_background(const rdpShadowSurface* surface, UINT32 x, UINT32 y)
+{
+	const BYTE r = (BYTE)(x * 255ull / surface->width);
+	const BYTE g = (BYTE)(y * 255ull / surface->height);
+	const BYTE b = (BYTE)(((x + y) / 4) & 0xFF);
+	return FreeRDPGetColor(surface->format, r, g, b, 0xFF);
+}
+
+static void synthetic_fill(rdpShadowSurface* surface, const RECTANGLE_16* rect, UINT32 color)
+{
+	for (UINT32 y = rect->top; y < rect->bottom; y++)
+	{
+		UINT32* line = (UINT32*)&surface->data[1ull * y * surface->scanline];
+		for (UINT32 x = rect->left; x < rect->right; x++)
+			line[x] = color;
+	}
+}
+
+static void synthetic_fill_background(rdpShadowSurface* surface, const RECTANGLE_16* rect)
+{
+	for (UINT32 y = rect->top; y < rect->bottom; y++)
+	{
+		UINT32* line = (UINT32*)&surface->data[1ull * y * surface->scanline];
+		for (UINT32 x = rect->left; x < rect->right; x++)
+			line[x] = synthetic_background(surface, x, y);
+	}
+}
+
+static BOOL synthetic_invalidate(rdpShadowSurface* surface, const RECTANGLE_16* rect)
+{
+	return region16_union_rect(&surface->invalidRegion, &surface->invalidRegion, rect);
+}
+
+/* A line of text: runs of 4x8 pixel glyphs with random bitmaps on a white background */
+static void synthetic_draw_text_line(const syntheticShadowSubsystem* subsystem,
+                                     rdpShadowSurface* surface, INT64 top, UINT64 index)
+{
+	static const BYTE palette[][3] = {
+		{ 0x20, 0x20, 0x20 }, { 0x20, 0x20, 0x20 }, { 0x00, 0x00, 0xA0 }, { 0x00, 0x80, 0x00 }
+	};
+	UINT32 state = synthetic_seed(subsystem, ~index);
+	const BYTE* ink = palette[synthetic_rand(&state) % ARRAYSIZE(palette)];
+	const UINT32 color = FreeRDPGetColor(surface->format, ink[0], ink[1], ink[2], 0xFF);
+	const UINT32 paper = FreeRDPGetColor(surface->format, 0xFF, 0xFF, 0xFF, 0xFF);
+	const UINT32 columns = surface->width / SYNTHETIC_GLYPH_WIDTH;
+	const UINT32 indent = synthetic_rand(&state) % 8;
+	const UINT32 length = MIN(columns, indent + synthetic_rand(&state) % columns);
+
+	for (UINT32 y = 0; y < SYNTHETIC_LINE_HEIGHT; y++)
+	{
+		const INT64 row = top + y;
+		if ((row < 0) || (row >= surface->height))
+			continue;
+
+		UINT32* line = (UINT32*)&surface->data[1ull * (UINT64)row * surface->scanline];
+		for (UINT32 x = 0; x < surface->width; x++)
+			line[x] = paper;
+	}
+
+	for (UINT32 column = indent; column < length; column++)
+	{
+		const UINT32 glyph = synthetic_rand(&state);
+
+		/* every eighth cell is a space */
+		if ((glyph >> 29) == 0)
+			continue;
+
+		for (UINT32 y = 0; y < 8; y++)
+		{
+			const INT64 row = top + 4 + y;
+			if ((row < 0) || (row >= surface->height))
+				continue;
+
+			UINT32* line = (UINT32*)&surface->data[1ull * (UINT64)row * surface->scanline];
+			for (UINT32 x = 0; x < 4; x++)
+			{
+				if (glyph & (1u << (y * 4 + x)))
+					line[column * SYNTHETIC_GLYPH_WIDTH + 2 + x] = color;
+			}
+		}
+	}
+}
+
+static BOOL synthetic_draw_scroll(const syntheticShadowSubsystem* subsystem,
+                                  rdpShadowSurface* surface, const RECTANGLE_16* full)
+{
+	const UINT64 lines = (surface->height + SYNTHETIC_LINE_HEIGHT - 1) / SYNTHETIC_LINE_HEIGHT;
+
+	if ((subsystem->frame == 0) || (surface->height <= SYNTHETIC_LINE_HEIGHT))
+	{
+		/* fill the screen bottom up, the newest line is always at the bottom */
+		for (UINT64 k = 0; k < lines; k++)
+		{
+			const INT64 top = (INT64)surface->height - (INT64)((k + 1) * SYNTHETIC_LINE_HEIGHT);
+			synthetic_draw_text_line(subsystem, surface, top, lines - 1 - k);
+		}
+	}
+	else
+	{
+		const size_t step = 1ull * SYNTHETIC_LINE_HEIGHT * surface->scanline;
+		memmove(surface->data, &surface->data[step],
+		        1ull * (surface->height - SYNTHETIC_LINE_HEIGHT) * surface->scanline);
+		synthetic_draw_text_line(subsystem, surface,
+		                         (INT64)surface->height - SYNTHETIC_LINE_HEIGHT,
+		                         lines - 1 + subsystem->frame);
+	}
+
+	return synthetic_invalidate(surface, full);
+}
+
+/* A video sized area of random pixels in the middle of the screen */
+static BOOL synthetic_draw_noise(const syntheticShadowSubsystem* subsystem,
+                                 rdpShadowSurface* surface, const RECTANGLE_16* full)
+{
+	const RECTANGLE_16 video = { .left = (UINT16)(surface->width / 4),
+		                         .top = (UINT16)(surface->height / 4),
+		                         .right = (UINT16)(surface->width / 4 + surface->width / 2),
+		                         .bottom = (UINT16)(surface->height / 4 + surface->height / 2) };
+	UINT32 state = synthetic_seed(subsystem, subsystem->frame);
+
+	if (subsystem->frame == 0)
+	{
+		synthetic_fill_background(surface, full);
+		if (!synthetic_invalidate(surface, full))
+			return FALSE;
+	}
+
+	for (UINT32 y = video.top; y < video.bottom; y++)
+	{
+		UINT32* line = (UINT32*)&surface->data[1ull * y * surface->scanline];
+		for (UINT32 x = video.left; x < video.right; x++)
+		{
+			const UINT32 value = synthetic_rand(&state);
+			line[x] = FreeRDPGetColor(surface->format, value & 0xFF, (value >> 8) & 0xFF,
+			                          (value >> 16) & 0xFF, 0xFF);
+		}
+	}
+
+	return synthetic_invalidate(surface, &video);
+}
+
+static UINT32 synthetic_bounce(UINT64 value, UINT32 range)
+{
+	if (range == 0)
+		return 0;
+
+	const UINT64 pos = value % (2ull * range);
+	return (UINT32)((pos < range) ? pos : 2ull * range - pos);
+}
+
+/* A cursor sized block moving over a static background */
+static BOOL synthetic_draw_cursor(syntheticShadowSubsystem* subsystem, rdpShadowSurface* surface,
+                                  const RECTANGLE_16* full)
+{
+	const UINT32 size = MIN(SYNTHETIC_CURSOR_SIZE, MIN(surface->width, surface->height));
+	const UINT32 x = synthetic_bounce(subsystem->frame * 5, surface->width - size);
+	const UINT32 y = synthetic_bounce(subsystem->frame * 3, surface->height - size);
+	const RECTANGLE_16 cursor = { .left = (UINT16)x,
+		                          .top = (UINT16)y,
+		                          .right = (UINT16)(x + size),
+		                          .bottom = (UINT16)(y + size) };
+	const RECTANGLE_16 inner = { .left = (UINT16)(x + 2),
+		                         .top = (UINT16)(y + 2),
+		                         .right = (UINT16)(x + size - 2),
+		                         .bottom = (UINT16)(y + size - 2) };
+
+	if (subsystem->frame == 0)
+	{
+		synthetic_fill_background(surface, full);
+		if (!synthetic_invalidate(surface, full))
+			return FALSE;
+	}
+	else
+	{
+		synthetic_fill_background(surface, &subsystem->cursor);
+		if (!synthetic_invalidate(surface, &subsystem->cursor))
+			return FALSE;
+	}
+
+	synthetic_fill(surface, &cursor, FreeRDPGetColor(surface->format, 0xFF, 0xFF, 0xFF, 0xFF));
+	synthetic_fill(surface, &inner, FreeRDPGetColor(surface->format, 0x00, 0x00, 0x00, 0xFF));
+	subsystem->cursor = cursor;
+	return synthetic_invalidate(surface, &cursor);
+}
+
+/* Alternates between the background and a checkerboard with new colors every time */
+static BOOL synthetic_draw_flip(const syntheticShadowSubsystem* subsystem,
+                                rdpShadowSurface* surface, const RECTANGLE_16* full)
+{
+	if ((subsystem->frame % 2) == 0)
+		synthetic_fill_background(surface, full);
+	else
+	{
+		UINT32 state = synthetic_seed(subsystem, subsystem->frame);
+		const UINT32 a = synthetic_rand(&state);
+		const UINT32 b = synthetic_rand(&state);
+		const UINT32 colors[] = {
+			FreeRDPGetColor(surface->format, a & 0xFF, (a >> 8) & 0xFF, (a >> 16) & 0xFF, 0xFF),
+			FreeRDPGetColor(surface->format, b & 0xFF, (b >> 8) & 0xFF, (b >> 16) & 0xFF, 0xFF)
+		};
+
+		for (UINT32 y = 0; y < surface->height; y++)
+		{
+			UINT32* line = (UINT32*)&surface->data[1ull * y * surface->scanline];
+			for (UINT32 x = 0; x < surface->width; x++)
+				line[x] = colors[((x / SYNTHETIC_FLIP_TILE) + (y / SYNTHETIC_FLIP_TILE)) % 2];
+		}
+	}
+
+	return synthetic_invalidate(surface, full);
+}
+
+/* Reports the rate frames were delivered at, the frame update waits for all clients */
+static void synthetic_shadow_log_stats(syntheticShadowSubsystem* subsystem)
+{
+	const UINT64 now = GetTickCount64();
+
+	if (subsystem->statsTime == 0)
+	{
+		subsystem->statsTime = now;
+		subsystem->statsFrame = subsystem->frame;
+		return;
+	}
+
+	const UINT64 elapsed = now - subsystem->statsTime;
+	if (elapsed < SYNTHETIC_STATS_INTERVAL)
+		return;
+
+	const UINT64 frames = subsystem->frame - subsystem->statsFrame;
+	WLog_INFO(TAG, "%" PRIu64 " frames in %" PRIu64 " ms, %" PRIu64 ".%02" PRIu64 " fps", frames,
+	          elapsed, frames * 1000 / elapsed, (frames * 100000 / elapsed) % 100);
+
+	subsystem->statsTime = now;
+	subsystem->statsFrame = subsystem->frame;
+}
+
+int synthetic_shadow_generate_frame(syntheticShadowSubsystem* subsystem)
+{
+	BOOL rc = FALSE;
+
+	WINPR_ASSERT(subsystem);
+
+	rdpShadowServer* server = subsystem->base.server;
+	WINPR_ASSERT(server);
+
+	/* Like with a real desktop nothing is generated without clients */
+	if (ArrayList_Count(server->clients) < 1)
+		return 1;
+
+	rdpShadowSurface* surface = server->surface;
+	WINPR_ASSERT(surface);
+	WINPR_ASSERT(FreeRDPGetBytesPerPixel(surface->format) == 4);
+
+	EnterCriticalSection(&surface->lock);
+	const RECTANGLE_16 full = { .left = 0,
+		                        .top = 0,
+		                        .right = (UINT16)surface->width,
+		                        .bottom = (UINT16)surface->height };
+
+	switch (subsystem->pattern)
+	{
+		case SYNTHETIC_PATTERN_SCROLL:
+			rc = synthetic_draw_scroll(subsystem, surface, &full);
+			break;
+		case SYNTHETIC_PATTERN_NOISE:
+			rc = synthetic_draw_noise(subsystem, surface, &full);
+			break;
+		case SYNTHETIC_PATTERN_CURSOR:
+			rc = synthetic_draw_cursor(subsystem, surface, &full);
+			break;
+		case SYNTHETIC_PATTERN_FLIP:
+			rc = synthetic_draw_flip(subsystem, surface, &full);
+			break;
+		default:
+			break;
+	}
+
+	const BOOL empty = region16_is_empty(&surface->invalidRegion);
+	LeaveCriticalSection(&surface->lock);
+
+	if (!rc)
+		return -1;
+
+	subsystem->frame++;
+
+	if (!empty)
+	{
+		shadow_subsystem_frame_update(&subsystem->base);
+
+		EnterCriticalSection(&surface->lock);
+		region16_clear(&surface->invalidRegion);
+		LeaveCriticalSection(&surface->lock);
+	}
+
+	synthetic_shadow_log_stats(subsystem);
+	return 1;
+}
+
+static int synthetic_shadow_subsystem_process_message(syntheticShadowSubsystem* subsystem,
+                                                      wMessage* message)
+{
+	switch (message->id)
+	{
+		case SHADOW_MSG_IN_REFRESH_REQUEST_ID:
+			shadow_subsystem_frame_update(&subsystem->base);
+			break;
+
+		default:
+			WLog_ERR(TAG, "Unknown message id: %" PRIu32 "", message->id);
+			break;
+	}
+
+	if (message->Free)
+		message->Free(message);
+
+	return 1;
+}
+
+static DWORD WINAPI synthetic_shadow_subsystem_thread(LPVOID arg)
+{
+	syntheticShadowSubsystem* subsystem = (syntheticShadowSubsystem*)arg;
+	wMessage message = { 0 };
+
+	WINPR_ASSERT(subsystem);
+
+	wMessagePipe* MsgPipe = subsystem->base.MsgPipe;
+	WINPR_ASSERT(MsgPipe);
+
+	/* Frames are scheduled relative to the start to avoid drift, frames missed because
+	 * encoding took too long are skipped instead of being sent in a burst */
+	const UINT64 start = GetTickCount64();
+	UINT64 ticks = 0;
+
+	while (1)
+	{
+		const UINT64 due = start + (ticks + 1) * 1000ull / subsystem->fps;
+		const UINT64 now = GetTickCount64();
+		const DWORD timeout = (now >= due) ? 0 : (DWORD)MIN(UINT32_MAX, due - now);
+
+		if (WaitForSingleObject(MessageQueue_Event(MsgPipe->In), timeout) == WAIT_OBJECT_0)
+		{
+			if (MessageQueue_Peek(MsgPipe->In, &message, TRUE))
+			{
+				if (message.id == WMQ_QUIT)
+					break;
+
+				synthetic_shadow_subsystem_process_message(subsystem, &message);
+			}
+		}
+
+		if (GetTickCount64() < due)
+			continue;
+
+		if (synthetic_shadow_generate_frame(subsystem) < 0)
+		{
+			WLog_ERR(TAG, "failed to generate frame %" PRIu64, subsystem->frame);
+			break;
+		}
+
+		ticks = MAX(ticks + 1, (GetTickCount64() - start) * subsystem->fps / 1000ull);
+	}
+
+	ExitThread(0);
+	return 0;
+}
+
+static BOOL synthetic_shadow_parse_uint(const char* value, unsigned long min, unsigned long max,
+                                        char terminator, UINT32* result, const char** next)
+{
+	char* end = NULL;
+
+	errno = 0;
+	const unsigned long val = strtoul(value, &end, 0);
+	if ((errno != 0) || (end == value) || (*end != terminator) || (val < min) || (val > max))
+		return FALSE;
+
+	*result = (UINT32)val;
+	if (next)
+		*next = end;
+	return TRUE;
+}
+
+static BOOL synthetic_shadow_parse_option(syntheticShadowSubsystem* subsystem, const char* option)
+{
+	const char* value = strchr(option, ':');
+	if (!value)
+		return FALSE;
+	value++;
+
+	if (strncmp(option, "pattern:", 8) == 0)
+	{
+		for (size_t x = 0; x < ARRAYSIZE(synthetic_pattern_names); x++)
+		{
+			if (_stricmp(value, synthetic_pattern_names[x]) == 0)
+			{
+				subsystem->pattern = (SYNTHETIC_PATTERN)x;
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
+	if (strncmp(option, "size:", 5) == 0)
+	{
+		const char* height = NULL;
+		if (!synthetic_shadow_parse_uint(value, SYNTHETIC_MIN_SIZE, SYNTHETIC_MAX_SIZE, 'x',
+		                                 &subsystem->width, &height))
+			return FALSE;
+		return synthetic_shadow_parse_uint(height + 1, SYNTHETIC_MIN_SIZE, SYNTHETIC_MAX_SIZE,
+		                                   '\0', &subsystem->height, NULL);
+	}
+
+	if (strncmp(option, "fps:", 4) == 0)
+		return synthetic_shadow_parse_uint(value, 1, SYNTHETIC_MAX_FPS, '\0', &subsystem->fps,
+		                                   NULL);
+
+	if (strncmp(option, "seed:", 5) == 0)
+		return synthetic_shadow_parse_uint(value, 0, UINT32_MAX, '\0', &subsystem->seed, NULL);
+
+	return FALSE;
+}
+
+BOOL synthetic_shadow_parse_options(syntheticShadowSubsystem* subsystem, const char* options)
+{
+	BOOL rc = TRUE;
+	size_t count = 0;
+
+	WINPR_ASSERT(subsystem);
+
+	if (!options)
+		return TRUE;
+
+	char** list = CommandLineParseCommaSeparatedValues(options, &count);
+	if (!list)
+		return FALSE;
+
+	for (size_t x = 0; x < count; x++)
+	{
+		if (!synthetic_shadow_parse_option(subsystem, list[x]))
+		{
+			WLog_ERR(TAG, "invalid option '%s', expected pattern:<scroll|noise|cursor|flip>,"
+			              "size:<width>x<height>,fps:<1-1000>,seed:<number>",
+			         list[x]);
+			rc = FALSE;
+			break;
+		}
+	}
+
+	CommandLineParserFree(list);
+	return rc;
+}
+
+static UINT32 synthetic_shadow_enum_monitors(MONITOR_DEF* monitors, UINT32 maxMonitors)
+{
+	if (!monitors || (maxMonitors < 1))
+		return 0;
+
+	/* the size selected with the subsystem options is only known after init */
+	const MONITOR_DEF monitor = { .left = 0,
+		                          .top = 0,
+		                          .right = SYNTHETIC_DEFAULT_WIDTH - 1,
+		                          .bottom = SYNTHETIC_DEFAULT_HEIGHT - 1,
+		                          .flags = 1 };
+	monitors[0] = monitor;
+	return 1;
+}
+
+static int synthetic_shadow_subsystem_init(rdpShadowSubsystem* arg)
+{
+	syntheticShadowSubsystem* subsystem = (syntheticShadowSubsystem*)arg;
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(subsystem->base.server);
+
+	if (!synthetic_shadow_parse_options(subsystem, subsystem->base.server->SubsystemOptions))
+		return -1;
+
+	MONITOR_DEF* monitor = &subsystem->base.monitors[0];
+	monitor->left = 0;
+	monitor->top = 0;
+	monitor->right = (INT32)subsystem->width - 1;
+	monitor->bottom = (INT32)subsystem->height - 1;
+	monitor->flags = 1;
+
+	subsystem->base.numMonitors = 1;
+	subsystem->base.selectedMonitor = 0;
+	subsystem->base.virtualScreen = *monitor;
+	subsystem->base.captureFrameRate = subsystem->fps;
+
+	WLog_INFO(TAG,
+	          "generating '%s' frames at %" PRIu32 "x%" PRIu32 ", %" PRIu32 " fps, seed %" PRIu32,
+	          synthetic_pattern_names[subsystem->pattern], subsystem->width, subsystem->height,
+	          subsystem->fps, subsystem->seed);
+	return 1;
+}
+
+static int synthetic_shadow_subsystem_uninit(rdpShadowSubsystem* arg)
+{
+	if (!arg)
+		return -1;
+
+	return 1;
+}
+
+static int synthetic_shadow_subsystem_start(rdpShadowSubsystem* arg)
+{
+	syntheticShadowSubsystem* subsystem = (syntheticShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return -1;
+
+	if (!(subsystem->thread = CreateThread(NULL, 0, synthetic_shadow_subsystem_thread,
+	                                       (void*)subsystem, 0, NULL)))
+	{
+		WLog_ERR(TAG, "Failed to create thread");
+		return -1;
+	}
+
+	return 1;
+}
+
+static int synthetic_shadow_subsystem_stop(rdpShadowSubsystem* arg)
+{
+	syntheticShadowSubsystem* subsystem = (syntheticShadowSubsystem*)arg;
+
+	if (!subsystem)
+		return -1;
+
+	if (subsystem->thread)
+	{
+		if (MessageQueue_PostQuit(subsystem->base.MsgPipe->In, 0))
+			(void)WaitForSingleObject(subsystem->thread, INFINITE);
+
+		(void)CloseHandle(subsystem->thread);
+		subsystem->thread = NULL;
+	}
+
+	return 1;
+}
+
+static void synthetic_shadow_subsystem_free(rdpShadowSubsystem* arg)
+{
+	if (!arg)
+		return;
+
+	synthetic_shadow_subsystem_uninit(arg);
+	free(arg);
+}
+
+static rdpShadowSubsystem* synthetic_shadow_subsystem_new(void)
+{
+	syntheticShadowSubsystem* subsystem =
+	    (syntheticShadowSubsystem*)calloc(1, sizeof(syntheticShadowSubsystem));
+
+	if (!subsystem)
+		return NULL;
+
+	subsystem->pattern = SYNTHETIC_PATTERN_SCROLL;
+	subsystem->width = SYNTHETIC_DEFAULT_WIDTH;
+	subsystem->height = SYNTHETIC_DEFAULT_HEIGHT;
+	subsystem->fps = SYNTHETIC_DEFAULT_FPS;
+	subsystem->seed = 1;
+	return &subsystem->base;
+}
+
+const char* synthetic_shadow_subsystem_name(void)
+{
+	return "Synthetic";
+}
+
+int synthetic_shadow_subsystem_entry(RDP_SHADOW_ENTRY_POINTS* pEntryPoints)
+{
+	if (!pEntryPoints)
+		return -1;
+
+	pEntryPoints->New = synthetic_shadow_subsystem_new;
+	pEntryPoints->Free = synthetic_shadow_subsystem_free;
+	pEntryPoints->Init = synthetic_shadow_subsystem_init;
+	pEntryPoints->Uninit = synthetic_shadow_subsystem_uninit;
+	pEntryPoints->Start = synthetic_shadow_subsystem_start;
+	pEntryPoints->Stop = synthetic_shadow_subsystem_stop;
+	pEntryPoints->EnumMonitors = synthetic_shadow_enum_monitors;
+	return 1;
+}
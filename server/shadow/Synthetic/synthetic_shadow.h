@@ -0,0 +1,67 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERDP_SERVER_SHADOW_SYNTHETIC_H
+#define FREERDP_SERVER_SHADOW_SYNTHETIC_H
+
+#include <freerdp/server/shadow.h>
+
+typedef enum
+{
+	SYNTHETIC_PATTERN_SCROLL = 0,
+	SYNTHETIC_PATTERN_NOISE,
+	SYNTHETIC_PATTERN_CURSOR,
+	SYNTHETIC_PATTERN_FLIP
+} SYNTHETIC_PATTERN;
+
+typedef struct synthetic_shadow_subsystem syntheticShadowSubsystem;
+
+struct synthetic_shadow_subsystem
+{
+	rdpShadowSubsystem base;
+
+	HANDLE thread;
+
+	SYNTHETIC_PATTERN pattern;
+	UINT32 width;
+	UINT32 height;
+	UINT32 fps;
+	UINT32 seed;
+
+	/* number of frames generated while clients were connected */
+	UINT64 frame;
+	UINT64 statsFrame;
+	UINT64 statsTime;
+	RECTANGLE_16 cursor;
+};
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	FREERDP_LOCAL const char* synthetic_shadow_subsystem_name(void);
+	FREERDP_LOCAL int synthetic_shadow_subsystem_entry(RDP_SHADOW_ENTRY_POINTS* pEntryPoints);
+
+	FREERDP_LOCAL BOOL synthetic_shadow_parse_options(syntheticShadowSubsystem* subsystem,
+	                                                  const char* options);
+	FREERDP_LOCAL int synthetic_shadow_generate_frame(syntheticShadowSubsystem* subsystem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERDP_SERVER_SHADOW_SYNTHETIC_H */
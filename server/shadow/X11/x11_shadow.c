@@ -198,6 +198,189 @@ static int x11_shadow_pam_authenticate(rdpShadowSubsystem* subsystem, rdpShadowC
 
 #endif
 
+#ifdef WITH_XTEST
+/* Queue an input event for the subsystem thread. Pointer motion is merged with a motion still
+ * waiting in the queue, only the latest position (or the sum of the deltas) is injected. */
+static BOOL x11_shadow_input_enqueue(x11ShadowSubsystem* subsystem, x11ShadowInputType type,
+                                     UINT16 flags, INT32 x, INT32 y)
+{
+	BOOL rc = FALSE;
+
+	WINPR_ASSERT(subsystem);
+
+	EnterCriticalSection(&subsystem->inputLock);
+	if (subsystem->inputQueueCount > 0)
+	{
+		x11ShadowInputEvent* last = &subsystem->inputQueue[subsystem->inputQueueCount - 1];
+		if ((last->type == type) && (last->flags == PTR_FLAGS_MOVE) && (flags == PTR_FLAGS_MOVE))
+		{
+			if (type == X11_SHADOW_INPUT_MOUSE)
+			{
+				last->x = x;
+				last->y = y;
+				rc = TRUE;
+				goto out;
+			}
+			else if (type == X11_SHADOW_INPUT_REL_MOUSE)
+			{
+				last->x += x;
+				last->y += y;
+				rc = TRUE;
+				goto out;
+			}
+		}
+	}
+
+	if (subsystem->inputQueueCount >= subsystem->inputQueueSize)
+	{
+		const size_t size = MAX(64, subsystem->inputQueueSize * 2);
+		x11ShadowInputEvent* tmp =
+		    realloc(subsystem->inputQueue, size * sizeof(x11ShadowInputEvent));
+		if (!tmp)
+			goto out;
+		subsystem->inputQueue = tmp;
+		subsystem->inputQueueSize = size;
+	}
+
+	x11ShadowInputEvent* cur = &subsystem->inputQueue[subsystem->inputQueueCount++];
+	cur->type = type;
+	cur->flags = flags;
+	cur->x = x;
+	cur->y = y;
+	rc = SetEvent(subsystem->inputEvent);
+
+out:
+	LeaveCriticalSection(&subsystem->inputLock);
+	return rc;
+}
+
+static void x11_shadow_input_inject(x11ShadowSubsystem* subsystem, const x11ShadowInputEvent* event)
+{
+	unsigned int button = 0;
+	BOOL down = FALSE;
+	const UINT16 flags = event->flags;
+	Display* display = subsystem->display;
+
+	switch (event->type)
+	{
+		case X11_SHADOW_INPUT_KEYBOARD:
+			XTestFakeKeyEvent(display, (unsigned int)event->x,
+			                  (flags & KBD_FLAGS_RELEASE) ? False : True, CurrentTime);
+			break;
+
+		case X11_SHADOW_INPUT_MOUSE:
+			if (flags & (PTR_FLAGS_WHEEL | PTR_FLAGS_HWHEEL))
+			{
+				const BOOL negative = (flags & PTR_FLAGS_WHEEL_NEGATIVE) ? TRUE : FALSE;
+
+				if (flags & PTR_FLAGS_WHEEL)
+					button = (negative) ? 5 : 4;
+				else
+					button = (negative) ? 7 : 6;
+				XTestFakeButtonEvent(display, button, True, (unsigned long)CurrentTime);
+				XTestFakeButtonEvent(display, button, False, (unsigned long)CurrentTime);
+				break;
+			}
+
+			if (flags & PTR_FLAGS_MOVE)
+				XTestFakeMotionEvent(display, 0, event->x, event->y, CurrentTime);
+
+			if (flags & PTR_FLAGS_BUTTON1)
+				button = 1;
+			else if (flags & PTR_FLAGS_BUTTON2)
+				button = 3;
+			else if (flags & PTR_FLAGS_BUTTON3)
+				button = 2;
+
+			if (flags & PTR_FLAGS_DOWN)
+				down = TRUE;
+
+			if (button)
+				XTestFakeButtonEvent(display, button, down, CurrentTime);
+			break;
+
+		case X11_SHADOW_INPUT_REL_MOUSE:
+			if (flags & PTR_FLAGS_MOVE)
+				XTestFakeRelativeMotionEvent(display, event->x, event->y, 0);
+
+			if (flags & PTR_FLAGS_BUTTON1)
+				button = 1;
+			else if (flags & PTR_FLAGS_BUTTON2)
+				button = 3;
+			else if (flags & PTR_FLAGS_BUTTON3)
+				button = 2;
+			else if (flags & PTR_XFLAGS_BUTTON1)
+				button = 4;
+			else if (flags & PTR_XFLAGS_BUTTON2)
+				button = 5;
+
+			if (flags & PTR_FLAGS_DOWN)
+				down = TRUE;
+
+			if (button)
+				XTestFakeButtonEvent(display, button, down, CurrentTime);
+			break;
+
+		case X11_SHADOW_INPUT_EXTENDED_MOUSE:
+			XTestFakeMotionEvent(display, 0, event->x, event->y, CurrentTime);
+
+			if (flags & PTR_XFLAGS_BUTTON1)
+				button = 8;
+			else if (flags & PTR_XFLAGS_BUTTON2)
+				button = 9;
+
+			if (flags & PTR_XFLAGS_DOWN)
+				down = TRUE;
+
+			if (button)
+				XTestFakeButtonEvent(display, button, down, CurrentTime);
+			break;
+
+		default:
+			break;
+	}
+}
+#endif
+
+/* Inject all queued input events with a single display lock and flush */
+static void x11_shadow_input_drain(x11ShadowSubsystem* subsystem)
+{
+	WINPR_ASSERT(subsystem);
+
+	EnterCriticalSection(&subsystem->inputLock);
+	x11ShadowInputEvent* batch = subsystem->inputQueue;
+	const size_t batchSize = subsystem->inputQueueSize;
+	const size_t count = subsystem->inputQueueCount;
+
+	/* swap the buffers so the clients can continue to queue while the batch is injected.
+	 * The batch buffer is only touched by the subsystem thread. */
+	subsystem->inputQueue = subsystem->inputBatch;
+	subsystem->inputQueueSize = subsystem->inputBatchSize;
+	subsystem->inputQueueCount = 0;
+	subsystem->inputBatch = batch;
+	subsystem->inputBatchSize = batchSize;
+	(void)ResetEvent(subsystem->inputEvent);
+	LeaveCriticalSection(&subsystem->inputLock);
+
+#ifdef WITH_XTEST
+	if (count > 0)
+	{
+		XLockDisplay(subsystem->display);
+		XTestGrabControl(subsystem->display, True);
+
+		for (size_t x = 0; x < count; x++)
+			x11_shadow_input_inject(subsystem, &batch[x]);
+
+		XTestGrabControl(subsystem->display, False);
+		XFlush(subsystem->display);
+		XUnlockDisplay(subsystem->display);
+	}
+#else
+	WINPR_UNUSED(batch);
+	WINPR_UNUSED(count);
+#endif
+}
+
 static BOOL x11_shadow_input_synchronize_event(WINPR_ATTR_UNUSED rdpShadowSubsystem* subsystem,
                                                WINPR_ATTR_UNUSED rdpShadowClient* client,
                                                WINPR_ATTR_UNUSED UINT32 flags)
@@ -235,19 +418,7 @@ static BOOL x11_shadow_input_keyboard_event(rdpShadowSubsystem* subsystem, rdpSh
 	keycode = GetKeycodeFromVirtualKeyCode(vkcode, WINPR_KEYCODE_TYPE_XKB);
 
 	if (keycode != 0)
-	{
-		XLockDisplay(x11->display);
-		XTestGrabControl(x11->display, True);
-
-		if (flags & KBD_FLAGS_RELEASE)
-			XTestFakeKeyEvent(x11->display, keycode, False, CurrentTime);
-		else
-			XTestFakeKeyEvent(x11->display, keycode, True, CurrentTime);
-
-		XTestGrabControl(x11->display, False);
-		XFlush(x11->display);
-		XUnlockDisplay(x11->display);
-	}
+		return x11_shadow_input_enqueue(x11, X11_SHADOW_INPUT_KEYBOARD, flags, (INT32)keycode, 0);
 #else
 	WLog_WARN(TAG, "KeyboardEvent not supported by backend, ignoring");
 #endif
@@ -269,8 +440,6 @@ static BOOL x11_shadow_input_mouse_event(rdpShadowSubsystem* subsystem, rdpShado
 {
 #ifdef WITH_XTEST
 	x11ShadowSubsystem* x11 = (x11ShadowSubsystem*)subsystem;
-	unsigned int button = 0;
-	BOOL down = FALSE;
 	rdpShadowServer* server = NULL;
 	rdpShadowSurface* surface = NULL;
 
@@ -288,55 +457,8 @@ static BOOL x11_shadow_input_mouse_event(rdpShadowSubsystem* subsystem, rdpShado
 		return FALSE;
 
 	x11->lastMouseClient = client;
-	x += surface->x;
-	y += surface->y;
-	XLockDisplay(x11->display);
-	XTestGrabControl(x11->display, True);
-
-	if (flags & PTR_FLAGS_WHEEL)
-	{
-		BOOL negative = FALSE;
-
-		if (flags & PTR_FLAGS_WHEEL_NEGATIVE)
-			negative = TRUE;
-
-		button = (negative) ? 5 : 4;
-		XTestFakeButtonEvent(x11->display, button, True, (unsigned long)CurrentTime);
-		XTestFakeButtonEvent(x11->display, button, False, (unsigned long)CurrentTime);
-	}
-	else if (flags & PTR_FLAGS_HWHEEL)
-	{
-		BOOL negative = FALSE;
-
-		if (flags & PTR_FLAGS_WHEEL_NEGATIVE)
-			negative = TRUE;
-
-		button = (negative) ? 7 : 6;
-		XTestFakeButtonEvent(x11->display, button, True, (unsigned long)CurrentTime);
-		XTestFakeButtonEvent(x11->display, button, False, (unsigned long)CurrentTime);
-	}
-	else
-	{
-		if (flags & PTR_FLAGS_MOVE)
-			XTestFakeMotionEvent(x11->display, 0, x, y, CurrentTime);
-
-		if (flags & PTR_FLAGS_BUTTON1)
-			button = 1;
-		else if (flags & PTR_FLAGS_BUTTON2)
-			button = 3;
-		else if (flags & PTR_FLAGS_BUTTON3)
-			button = 2;
-
-		if (flags & PTR_FLAGS_DOWN)
-			down = TRUE;
-
-		if (button)
-			XTestFakeButtonEvent(x11->display, button, down, CurrentTime);
-	}
-
-	XTestGrabControl(x11->display, False);
-	XFlush(x11->display);
-	XUnlockDisplay(x11->display);
+	return x11_shadow_input_enqueue(x11, X11_SHADOW_INPUT_MOUSE, flags, x + surface->x,
+	                                y + surface->y);
 #else
 	WLog_WARN(TAG, "MouseEvent not supported by backend, ignoring");
 #endif
@@ -350,9 +472,6 @@ static BOOL x11_shadow_input_rel_mouse_event(rdpShadowSubsystem* subsystem, rdpS
 	x11ShadowSubsystem* x11 = (x11ShadowSubsystem*)subsystem;
 	WINPR_ASSERT(x11);
 
-	unsigned int button = 0;
-	BOOL down = FALSE;
-
 	if (!subsystem || !client)
 		return FALSE;
 
@@ -367,33 +486,7 @@ static BOOL x11_shadow_input_rel_mouse_event(rdpShadowSubsystem* subsystem, rdpS
 		return FALSE;
 
 	x11->lastMouseClient = client;
-
-	XLockDisplay(x11->display);
-	XTestGrabControl(x11->display, True);
-
-	if (flags & PTR_FLAGS_MOVE)
-		XTestFakeRelativeMotionEvent(x11->display, xDelta, yDelta, 0);
-
-	if (flags & PTR_FLAGS_BUTTON1)
-		button = 1;
-	else if (flags & PTR_FLAGS_BUTTON2)
-		button = 3;
-	else if (flags & PTR_FLAGS_BUTTON3)
-		button = 2;
-	else if (flags & PTR_XFLAGS_BUTTON1)
-		button = 4;
-	else if (flags & PTR_XFLAGS_BUTTON2)
-		button = 5;
-
-	if (flags & PTR_FLAGS_DOWN)
-		down = TRUE;
-
-	if (button)
-		XTestFakeButtonEvent(x11->display, button, down, CurrentTime);
-
-	XTestGrabControl(x11->display, False);
-	XFlush(x11->display);
-	XUnlockDisplay(x11->display);
+	return x11_shadow_input_enqueue(x11, X11_SHADOW_INPUT_REL_MOUSE, flags, xDelta, yDelta);
 #else
 	WLog_WARN(TAG, "RelMouseEvent not supported by backend, ignoring");
 #endif
@@ -406,8 +499,6 @@ static BOOL x11_shadow_input_extended_mouse_event(rdpShadowSubsystem* subsystem,
 {
 #ifdef WITH_XTEST
 	x11ShadowSubsystem* x11 = (x11ShadowSubsystem*)subsystem;
-	UINT button = 0;
-	BOOL down = FALSE;
 	rdpShadowServer* server = NULL;
 	rdpShadowSurface* surface = NULL;
 
@@ -425,26 +516,8 @@ static BOOL x11_shadow_input_extended_mouse_event(rdpShadowSubsystem* subsystem,
 		return FALSE;
 
 	x11->lastMouseClient = client;
-	x += surface->x;
-	y += surface->y;
-	XLockDisplay(x11->display);
-	XTestGrabControl(x11->display, True);
-	XTestFakeMotionEvent(x11->display, 0, x, y, CurrentTime);
-
-	if (flags & PTR_XFLAGS_BUTTON1)
-		button = 8;
-	else if (flags & PTR_XFLAGS_BUTTON2)
-		button = 9;
-
-	if (flags & PTR_XFLAGS_DOWN)
-		down = TRUE;
-
-	if (button)
-		XTestFakeButtonEvent(x11->display, button, down, CurrentTime);
-
-	XTestGrabControl(x11->display, False);
-	XFlush(x11->display);
-	XUnlockDisplay(x11->display);
+	return x11_shadow_input_enqueue(x11, X11_SHADOW_INPUT_EXTENDED_MOUSE, flags, x + surface->x,
+	                                y + surface->y);
 #else
 	WLog_WARN(TAG, "ExtendedMouseEvent not supported by backend, ignoring");
 #endif
@@ -792,21 +865,163 @@ static int x11_shadow_error_handler_for_capture(Display* display, XErrorEvent* e
 	return 0;
 }
 
+static void x11_shadow_capture_buffer_free(x11ShadowSubsystem* subsystem)
+{
+	WINPR_ASSERT(subsystem);
+
+	if (subsystem->capture_image)
+	{
+		subsystem->capture_image->data = NULL;
+		XDestroyImage(subsystem->capture_image);
+	}
+	free(subsystem->capture_buffer);
+
+	subsystem->capture_image = NULL;
+	subsystem->capture_buffer = NULL;
+	subsystem->capture_width = 0;
+	subsystem->capture_height = 0;
+	subsystem->capture_scanline = 0;
+}
+
+/* Prepares the spare buffer matching the surface buffer. Only possible if the X server
+ * delivers pixels in the surface format, otherwise frames are converted while copying. */
+static BOOL x11_shadow_capture_buffer_check(x11ShadowSubsystem* subsystem,
+                                            const rdpShadowSurface* surface)
+{
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(surface);
+
+	if ((subsystem->bpp != 32) ||
+	    !FreeRDPAreColorFormatsEqualNoAlpha(subsystem->format, surface->format))
+		return FALSE;
+
+	if (subsystem->capture_image && (subsystem->capture_width == surface->width) &&
+	    (subsystem->capture_height == surface->height) &&
+	    (subsystem->capture_scanline == surface->scanline))
+		return TRUE;
+
+	x11_shadow_capture_buffer_free(subsystem);
+
+	/* allocated like the surface buffer, the two are swapped and freed by either side */
+	const size_t lines = (surface->height + 31ull) & ~31ull;
+	subsystem->capture_buffer = calloc(lines, surface->scanline);
+	if (!subsystem->capture_buffer)
+		return FALSE;
+
+	subsystem->capture_image = XCreateImage(
+	    subsystem->display, subsystem->visual, subsystem->depth, ZPixmap, 0,
+	    (char*)subsystem->capture_buffer, surface->width, surface->height, 32,
+	    WINPR_ASSERTING_INT_CAST(int, surface->scanline));
+	if (!subsystem->capture_image)
+	{
+		x11_shadow_capture_buffer_free(subsystem);
+		return FALSE;
+	}
+
+	subsystem->capture_width = surface->width;
+	subsystem->capture_height = surface->height;
+	subsystem->capture_scanline = surface->scanline;
+	return TRUE;
+}
+
+/* Split the surface in independent capture areas. These are the monitors covered by the
+ * surface or, if there is only one, horizontal bands so the comparison scales with cores. */
+static UINT32 x11_shadow_capture_areas(const x11ShadowSubsystem* subsystem,
+                                       const rdpShadowSurface* surface, RECTANGLE_16* areas,
+                                       UINT32 maxAreas)
+{
+	UINT32 count = 0;
+
+	WINPR_ASSERT(subsystem);
+	WINPR_ASSERT(surface);
+	WINPR_ASSERT(areas);
+	WINPR_ASSERT(maxAreas > 0);
+
+	const RECTANGLE_16 surfaceRect = { .left = 0,
+		                               .top = 0,
+		                               .right = WINPR_ASSERTING_INT_CAST(UINT16, surface->width),
+		                               .bottom =
+		                                   WINPR_ASSERTING_INT_CAST(UINT16, surface->height) };
+
+	for (UINT32 x = 0; x < subsystem->common.numMonitors; x++)
+	{
+		const MONITOR_DEF* monitor = &subsystem->common.monitors[x];
+		const INT64 left = MAX(0, (INT64)monitor->left - surface->x);
+		const INT64 top = MAX(0, (INT64)monitor->top - surface->y);
+		const INT64 right = MAX(0, (INT64)monitor->right + 1 - surface->x);
+		const INT64 bottom = MAX(0, (INT64)monitor->bottom + 1 - surface->y);
+		const RECTANGLE_16 rect = { .left = (UINT16)MIN(UINT16_MAX, left),
+			                        .top = (UINT16)MIN(UINT16_MAX, top),
+			                        .right = (UINT16)MIN(UINT16_MAX, right),
+			                        .bottom = (UINT16)MIN(UINT16_MAX, bottom) };
+
+		RECTANGLE_16 area = { 0 };
+		if (!rectangles_intersection(&rect, &surfaceRect, &area))
+			continue;
+
+		/* mirrored monitors, capture the surface as a whole */
+		for (UINT32 y = 0; y < count; y++)
+		{
+			if (rectangles_intersects(&areas[y], &area))
+			{
+				count = 0;
+				goto bands;
+			}
+		}
+
+		/* more monitors than areas, capture the surface as a whole instead of dropping some */
+		if (count >= maxAreas)
+		{
+			count = 0;
+			goto bands;
+		}
+
+		areas[count++] = area;
+	}
+
+	if (count > 1)
+		return count;
+
+bands:
+{
+	SYSTEM_INFO sysinfo = { 0 };
+	GetNativeSystemInfo(&sysinfo);
+
+	const UINT32 height = surfaceRect.bottom;
+	UINT32 nbands = MIN(maxAreas, MIN(sysinfo.dwNumberOfProcessors, height / 64));
+	if (nbands < 1)
+		nbands = 1;
+
+	/* keep bands aligned to the 16x16 tiles of the comparison */
+	const UINT32 bandHeight = ((height / nbands) + 15) & ~15u;
+	count = 0;
+	for (UINT32 y = 0; (y < height) && (count < nbands); y += bandHeight)
+	{
+		RECTANGLE_16* area = &areas[count++];
+		area->left = 0;
+		area->right = surfaceRect.right;
+		area->top = (UINT16)y;
+		area->bottom = (UINT16)MIN(height, y + bandHeight);
+	}
+	if (count > 0)
+		areas[count - 1].bottom = surfaceRect.bottom;
+}
+	return count;
+}
+
 static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 {
 	int rc = 0;
 	size_t count = 0;
 	int status = -1;
-	int x = 0;
-	int y = 0;
-	int width = 0;
-	int height = 0;
+	BOOL swap = FALSE;
 	XImage* image = NULL;
+	const BYTE* pSrcData = NULL;
 	rdpShadowServer* server = NULL;
 	rdpShadowSurface* surface = NULL;
-	RECTANGLE_16 invalidRect;
 	RECTANGLE_16 surfaceRect;
-	const RECTANGLE_16* extents = NULL;
+	RECTANGLE_16 areas[16] = { 0 };
+	UINT32 numAreas = 0;
 	server = subsystem->common.server;
 	surface = server->surface;
 	count = ArrayList_Count(server->clients);
@@ -820,6 +1035,7 @@ static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 
 	surfaceRect.right = WINPR_ASSERTING_INT_CAST(UINT16, surface->width);
 	surfaceRect.bottom = WINPR_ASSERTING_INT_CAST(UINT16, surface->height);
+	numAreas = x11_shadow_capture_areas(subsystem, surface, areas, ARRAYSIZE(areas));
 	LeaveCriticalSection(&surface->lock);
 
 	XLockDisplay(subsystem->display);
@@ -835,28 +1051,34 @@ static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 		XCopyArea(subsystem->display, subsystem->root_window, subsystem->fb_pixmap,
 		          subsystem->xshm_gc, 0, 0, subsystem->width, subsystem->height, 0, 0);
 
-		EnterCriticalSection(&surface->lock);
-		status = shadow_capture_compare_with_format(
-		    surface->data, surface->format, surface->scanline, surface->width, surface->height,
-		    (BYTE*)&(image->data[surface->width * 4ull]), subsystem->format,
-		    WINPR_ASSERTING_INT_CAST(UINT32, image->bytes_per_line), &invalidRect);
-		LeaveCriticalSection(&surface->lock);
+		/* the shared memory image covers the whole root window */
+		pSrcData = (const BYTE*)&image->data[1ull * surface->y *
+		                                         WINPR_ASSERTING_INT_CAST(UINT32,
+		                                                                  image->bytes_per_line) +
+		                                     4ull * surface->x];
 	}
 	else
 #endif
+	    if (x11_shadow_capture_buffer_check(subsystem, surface))
+	{
+		/* Only this thread writes the surface buffer and its size, the clients just read it
+		 * while holding the lock. */
+		image = XGetSubImage(subsystem->display, subsystem->root_window, surface->x, surface->y,
+		                     surface->width, surface->height, AllPlanes, ZPixmap,
+		                     subsystem->capture_image, 0, 0);
+		if (!image)
+			goto fail_capture;
+
+		swap = TRUE;
+		pSrcData = (const BYTE*)image->data;
+	}
+	else
 	{
 		EnterCriticalSection(&surface->lock);
 		image = XGetImage(subsystem->display, subsystem->root_window, surface->x, surface->y,
 		                  surface->width, surface->height, AllPlanes, ZPixmap);
-
-		if (image)
-		{
-			status = shadow_capture_compare_with_format(
-			    surface->data, surface->format, surface->scanline, surface->width, surface->height,
-			    (BYTE*)image->data, subsystem->format,
-			    WINPR_ASSERTING_INT_CAST(UINT32, image->bytes_per_line), &invalidRect);
-		}
 		LeaveCriticalSection(&surface->lock);
+
 		if (!image)
 		{
 			/*
@@ -865,6 +1087,48 @@ static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 			 */
 			goto fail_capture;
 		}
+		pSrcData = (const BYTE*)image->data;
+	}
+
+	if (swap)
+	{
+		/* Compare the new frame with the previous one outside of the lock and hand the
+		 * captured buffer to the clients instead of copying the changes over */
+		REGION16 invalid = { 0 };
+		region16_init(&invalid);
+		status = shadow_capture_diff_areas_with_format(
+		    surface->data, surface->format, surface->scanline, pSrcData, surface->format,
+		    surface->scanline, areas, numAreas, &invalid);
+
+		if (status > 0)
+		{
+			EnterCriticalSection(&surface->lock);
+			BYTE* previous = surface->data;
+			surface->data = subsystem->capture_buffer;
+			subsystem->capture_buffer = previous;
+			subsystem->capture_image->data = (char*)previous;
+
+			UINT32 nbRects = 0;
+			const RECTANGLE_16* rects = region16_rects(&invalid, &nbRects);
+			for (UINT32 x = 0; x < nbRects; x++)
+			{
+				if (!region16_union_rect(&surface->invalidRegion, &surface->invalidRegion,
+				                         &rects[x]))
+					status = -1;
+			}
+			LeaveCriticalSection(&surface->lock);
+		}
+		region16_uninit(&invalid);
+	}
+	else
+	{
+		/* Compare and copy the changed parts of all capture areas in parallel */
+		EnterCriticalSection(&surface->lock);
+		status = shadow_capture_compare_areas_with_format(
+		    surface->data, surface->format, surface->scanline, pSrcData, subsystem->format,
+		    WINPR_ASSERTING_INT_CAST(UINT32, image->bytes_per_line), areas, numAreas,
+		    &surface->invalidRegion);
+		LeaveCriticalSection(&surface->lock);
 	}
 
 	/* Restore the default error handler */
@@ -872,43 +1136,28 @@ static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 	XSync(subsystem->display, False);
 	XUnlockDisplay(subsystem->display);
 
-	if (status)
+	if (status < 0)
+	{
+		rc = -1;
+		goto fail_release;
+	}
+
+	if (status > 0)
 	{
 		BOOL empty = 0;
 		EnterCriticalSection(&surface->lock);
-		region16_union_rect(&(surface->invalidRegion), &(surface->invalidRegion), &invalidRect);
 		region16_intersect_rect(&(surface->invalidRegion), &(surface->invalidRegion), &surfaceRect);
 		empty = region16_is_empty(&(surface->invalidRegion));
 		LeaveCriticalSection(&surface->lock);
 
 		if (!empty)
 		{
-			BOOL success = 0;
-			EnterCriticalSection(&surface->lock);
-			extents = region16_extents(&(surface->invalidRegion));
-			x = extents->left;
-			y = extents->top;
-			width = extents->right - extents->left;
-			height = extents->bottom - extents->top;
-			WINPR_ASSERT(image);
-			WINPR_ASSERT(image->bytes_per_line >= 0);
-			WINPR_ASSERT(width >= 0);
-			WINPR_ASSERT(height >= 0);
-			success = freerdp_image_copy_no_overlap(
-			    surface->data, surface->format, surface->scanline,
-			    WINPR_ASSERTING_INT_CAST(uint32_t, x), WINPR_ASSERTING_INT_CAST(uint32_t, y),
-			    WINPR_ASSERTING_INT_CAST(uint32_t, width),
-			    WINPR_ASSERTING_INT_CAST(uint32_t, height), (BYTE*)image->data, subsystem->format,
-			    WINPR_ASSERTING_INT_CAST(uint32_t, image->bytes_per_line),
-			    WINPR_ASSERTING_INT_CAST(UINT32, x), WINPR_ASSERTING_INT_CAST(UINT32, y), NULL,
-			    FREERDP_FLIP_NONE);
-			LeaveCriticalSection(&surface->lock);
-			if (!success)
-				goto fail_capture;
-
 #if defined(USE_SHADOW_BLEND_CURSOR)
 			if (x11_shadow_blend_cursor(subsystem) < 0)
-				goto fail_capture;
+			{
+				rc = -1;
+				goto fail_release;
+			}
 #endif
 			count = ArrayList_Count(server->clients);
 			shadow_subsystem_frame_update(&subsystem->common);
@@ -930,17 +1179,15 @@ static int x11_shadow_screen_grab(x11ShadowSubsystem* subsystem)
 	}
 
 	rc = 1;
-fail_capture:
-	if (!subsystem->use_xshm && image)
+fail_release:
+	if (!subsystem->use_xshm && !swap && image)
 		XDestroyImage(image);
+	return rc;
 
-	if (rc != 1)
-	{
-		XSetErrorHandler(NULL);
-		XSync(subsystem->display, False);
-		XUnlockDisplay(subsystem->display);
-	}
-
+fail_capture:
+	XSetErrorHandler(NULL);
+	XSync(subsystem->display, False);
+	XUnlockDisplay(subsystem->display);
 	return rc;
 }
 
@@ -978,6 +1225,7 @@ static DWORD WINAPI x11_shadow_subsystem_thread(LPVOID arg)
 	nCount = 0;
 	events[nCount++] = subsystem->common.event;
 	events[nCount++] = MessageQueue_Event(MsgPipe->In);
+	events[nCount++] = subsystem->inputEvent;
 	subsystem->common.captureFrameRate = 16;
 	dwInterval = 1000 / subsystem->common.captureFrameRate;
 	frameTime = GetTickCount64() + dwInterval;
@@ -1000,6 +1248,9 @@ static DWORD WINAPI x11_shadow_subsystem_thread(LPVOID arg)
 			}
 		}
 
+		if (WaitForSingleObject(subsystem->inputEvent, 0) == WAIT_OBJECT_0)
+			x11_shadow_input_drain(subsystem);
+
 		if (WaitForSingleObject(subsystem->common.event, 0) == WAIT_OBJECT_0)
 		{
 			XLockDisplay(subsystem->display);
@@ -1470,6 +1721,8 @@ static int x11_shadow_subsystem_uninit(rdpShadowSubsystem* sub)
 	if (!subsystem)
 		return -1;
 
+	x11_shadow_capture_buffer_free(subsystem);
+
 	if (subsystem->display)
 	{
 		XCloseDisplay(subsystem->display);
@@ -1527,6 +1780,21 @@ static int x11_shadow_subsystem_stop(rdpShadowSubsystem* sub)
 	return 1;
 }
 
+static void x11_shadow_subsystem_free(rdpShadowSubsystem* subsystem)
+{
+	if (!subsystem)
+		return;
+
+	x11ShadowSubsystem* x11 = (x11ShadowSubsystem*)subsystem;
+	x11_shadow_subsystem_uninit(subsystem);
+	if (x11->inputEvent)
+		(void)CloseHandle(x11->inputEvent);
+	DeleteCriticalSection(&x11->inputLock);
+	free(x11->inputQueue);
+	free(x11->inputBatch);
+	free(subsystem);
+}
+
 static rdpShadowSubsystem* x11_shadow_subsystem_new(void)
 {
 	x11ShadowSubsystem* subsystem = NULL;
@@ -1535,6 +1803,19 @@ static rdpShadowSubsystem* x11_shadow_subsystem_new(void)
 	if (!subsystem)
 		return NULL;
 
+	if (!InitializeCriticalSectionAndSpinCount(&subsystem->inputLock, 4000))
+	{
+		free(subsystem);
+		return NULL;
+	}
+
+	subsystem->inputEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (!subsystem->inputEvent)
+	{
+		x11_shadow_subsystem_free((rdpShadowSubsystem*)subsystem);
+		return NULL;
+	}
+
 #ifdef WITH_PAM
 	subsystem->common.Authenticate = x11_shadow_pam_authenticate;
 #endif
@@ -1552,15 +1833,6 @@ static rdpShadowSubsystem* x11_shadow_subsystem_new(void)
 	return (rdpShadowSubsystem*)subsystem;
 }
 
-static void x11_shadow_subsystem_free(rdpShadowSubsystem* subsystem)
-{
-	if (!subsystem)
-		return;
-
-	x11_shadow_subsystem_uninit(subsystem);
-	free(subsystem);
-}
-
 FREERDP_ENTRY_POINT(FREERDP_API const char* ShadowSubsystemName(void))
 {
 	return "X11";
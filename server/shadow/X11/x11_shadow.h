@@ -51,6 +51,22 @@ typedef struct x11_shadow_subsystem x11ShadowSubsystem;
 #include <X11/extensions/Xinerama.h>
 #endif
 
+typedef enum
+{
+	X11_SHADOW_INPUT_KEYBOARD,
+	X11_SHADOW_INPUT_MOUSE,
+	X11_SHADOW_INPUT_REL_MOUSE,
+	X11_SHADOW_INPUT_EXTENDED_MOUSE
+} x11ShadowInputType;
+
+typedef struct
+{
+	x11ShadowInputType type;
+	UINT16 flags;
+	INT32 x; /* keycode for keyboard events */
+	INT32 y;
+} x11ShadowInputEvent;
+
 struct x11_shadow_subsystem
 {
 	rdpShadowSubsystem common;
@@ -80,6 +96,13 @@ struct x11_shadow_subsystem
 	Window root_window;
 	XShmSegmentInfo fb_shm_info;
 
+	/* spare frame buffer the next frame is captured into, swapped with the surface buffer */
+	BYTE* capture_buffer;
+	XImage* capture_image;
+	UINT32 capture_width;
+	UINT32 capture_height;
+	UINT32 capture_scanline;
+
 	UINT32 cursorHotX;
 	UINT32 cursorHotY;
 	UINT32 cursorWidth;
@@ -90,6 +113,15 @@ struct x11_shadow_subsystem
 	UINT32 cursorMaxHeight;
 	rdpShadowClient* lastMouseClient;
 
+	/* input received from the clients, injected in batches by the subsystem thread */
+	CRITICAL_SECTION inputLock;
+	HANDLE inputEvent;
+	x11ShadowInputEvent* inputQueue;
+	size_t inputQueueCount;
+	size_t inputQueueSize;
+	x11ShadowInputEvent* inputBatch;
+	size_t inputBatchSize;
+
 #ifdef WITH_XDAMAGE
 	GC xshm_gc;
 	Damage xdamage;
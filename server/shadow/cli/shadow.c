@@ -99,12 +99,25 @@ int main(int argc, char** argv)
 		  "Allow GFX RFX codec" },
 		{ "gfx-planar", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueTrue, NULL, -1, NULL,
 		  "Allow GFX planar codec" },
+		{ "gfx-mixed", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueFalse, NULL, -1, NULL,
+		  "Encode text and UI with the GFX planar codec and images with AVC420, RFX or "
+		  "progressive" },
+		{ "subsystem", COMMAND_LINE_VALUE_REQUIRED, "<name>", NULL, NULL, -1, NULL,
+		  "Select the capture subsystem, Synthetic generates test frames, PipeWire (if built) "
+		  "shares a screencast stream" },
+		{ "subsystem-options", COMMAND_LINE_VALUE_REQUIRED, "<option>[,<option>...]", NULL, NULL,
+		  -1, NULL,
+		  "Subsystem specific options, for Synthetic: "
+		  "pattern:<scroll|noise|cursor|flip>,size:<width>x<height>,fps:<n>,seed:<n>, "
+		  "for PipeWire: node:<id>,target:<name>,fd:<fd>" },
 		{ "gfx-avc420", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueTrue, NULL, -1, NULL,
 		  "Allow GFX AVC420 codec" },
 		{ "gfx-avc444", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueTrue, NULL, -1, NULL,
 		  "Allow GFX AVC444 codec" },
 		{ "bitmap-compat", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueFalse, NULL, -1, NULL,
 		  "Limit BitmapUpdate to 1 rectangle (fixes broken windows 11 24H2 clients)" },
+		{ "vc-compression", COMMAND_LINE_VALUE_BOOL, NULL, BoolValueFalse, NULL, -1, NULL,
+		  "Compress static virtual channel data" },
 		{ "version", COMMAND_LINE_VALUE_FLAG | COMMAND_LINE_PRINT_VERSION, NULL, NULL, NULL, -1,
 		  NULL, "Print version" },
 		{ "buildconfig", COMMAND_LINE_VALUE_FLAG | COMMAND_LINE_PRINT_BUILDCONFIG, NULL, NULL, NULL,
@@ -114,7 +127,7 @@ int main(int argc, char** argv)
 		{ NULL, 0, NULL, NULL, NULL, -1, NULL, NULL }
 	};
 
-	shadow_subsystem_set_entry_builtin(NULL);
+	(void)shadow_subsystem_set_entry_builtin_ex(NULL);
 
 	rdpShadowServer* server = shadow_server_new();
 
@@ -158,6 +171,15 @@ int main(int argc, char** argv)
 		goto fail;
 	}
 
+	{
+		const COMMAND_LINE_ARGUMENT_A* arg = CommandLineFindArgumentA(shadow_args, "subsystem");
+		if (arg && (arg->Flags & COMMAND_LINE_VALUE_PRESENT))
+		{
+			if ((status = shadow_subsystem_set_entry_builtin_ex(arg->Value)) < 0)
+				goto fail;
+		}
+	}
+
 	if ((status = shadow_server_init(server)) < 0)
 	{
 		WLog_ERR(TAG, "Server initialization failed.");
@@ -20,6 +20,7 @@
 
 #include <winpr/crt.h>
 #include <winpr/print.h>
+#include <winpr/pool.h>
 
 #include <freerdp/log.h>
 
@@ -310,6 +311,167 @@ int shadow_capture_compare_with_format(const BYTE* WINPR_RESTRICT pData1, UINT32
 	return 1;
 }
 
+typedef struct
+{
+	BYTE* pData1;
+	UINT32 format1;
+	UINT32 nStep1;
+	const BYTE* pData2;
+	UINT32 format2;
+	UINT32 nStep2;
+	RECTANGLE_16 area;
+	RECTANGLE_16 invalid;
+	BOOL copy;
+	int status;
+} SHADOW_CAPTURE_AREA;
+
+static void shadow_capture_area(SHADOW_CAPTURE_AREA* cur)
+{
+	WINPR_ASSERT(cur);
+
+	const size_t bpp1 = FreeRDPGetBytesPerPixel(cur->format1);
+	const size_t bpp2 = FreeRDPGetBytesPerPixel(cur->format2);
+	const RECTANGLE_16* area = &cur->area;
+	const UINT32 width = area->right - area->left;
+	const UINT32 height = area->bottom - area->top;
+
+	cur->status = shadow_capture_compare_with_format(
+	    &cur->pData1[area->top * 1ull * cur->nStep1 + area->left * bpp1], cur->format1,
+	    cur->nStep1, width, height, &cur->pData2[area->top * 1ull * cur->nStep2 + area->left * bpp2],
+	    cur->format2, cur->nStep2, &cur->invalid);
+	if (cur->status <= 0)
+		return;
+
+	cur->invalid.left += area->left;
+	cur->invalid.top += area->top;
+	cur->invalid.right += area->left;
+	cur->invalid.bottom += area->top;
+
+	if (!cur->copy)
+		return;
+
+	const RECTANGLE_16* rect = &cur->invalid;
+	if (!freerdp_image_copy_no_overlap(cur->pData1, cur->format1, cur->nStep1, rect->left,
+	                                   rect->top, rect->right - rect->left,
+	                                   rect->bottom - rect->top, cur->pData2, cur->format2,
+	                                   cur->nStep2, rect->left, rect->top, NULL, FREERDP_FLIP_NONE))
+		cur->status = -1;
+}
+
+static void CALLBACK shadow_capture_area_work_callback(PTP_CALLBACK_INSTANCE instance,
+                                                       void* context, PTP_WORK work)
+{
+	WINPR_UNUSED(instance);
+	WINPR_UNUSED(work);
+
+	shadow_capture_area(context);
+}
+
+static int shadow_capture_compare_areas(BYTE* WINPR_RESTRICT pData1, UINT32 format1,
+                                        UINT32 nStep1, const BYTE* WINPR_RESTRICT pData2,
+                                        UINT32 format2, UINT32 nStep2,
+                                        const RECTANGLE_16* WINPR_RESTRICT areas, UINT32 numAreas,
+                                        REGION16* WINPR_RESTRICT region, BOOL copy)
+{
+	int rc = -1;
+	int changed = 0;
+	PTP_WORK* work = NULL;
+
+	if (!pData1 || !pData2 || !areas || (numAreas == 0) || !region)
+		return -1;
+
+	SHADOW_CAPTURE_AREA* params = calloc(numAreas, sizeof(SHADOW_CAPTURE_AREA));
+	if (!params)
+		return -1;
+
+	for (UINT32 x = 0; x < numAreas; x++)
+	{
+		SHADOW_CAPTURE_AREA* cur = &params[x];
+		cur->pData1 = pData1;
+		cur->format1 = format1;
+		cur->nStep1 = nStep1;
+		cur->pData2 = pData2;
+		cur->format2 = format2;
+		cur->nStep2 = nStep2;
+		cur->area = areas[x];
+		cur->copy = copy;
+	}
+
+	/* Areas (usually monitors) are independent of each other, compare and copy them on the
+	 * default thread pool. The last one is processed by the calling thread. */
+	if (numAreas > 1)
+	{
+		work = calloc(numAreas - 1, sizeof(PTP_WORK));
+		if (!work)
+			goto fail;
+
+		for (UINT32 x = 0; x < numAreas - 1; x++)
+		{
+			work[x] = CreateThreadpoolWork(shadow_capture_area_work_callback, &params[x], NULL);
+			if (work[x])
+				SubmitThreadpoolWork(work[x]);
+			else
+				shadow_capture_area(&params[x]);
+		}
+	}
+
+	shadow_capture_area(&params[numAreas - 1]);
+
+	if (work)
+	{
+		for (UINT32 x = 0; x < numAreas - 1; x++)
+		{
+			if (!work[x])
+				continue;
+			WaitForThreadpoolWorkCallbacks(work[x], FALSE);
+			CloseThreadpoolWork(work[x]);
+		}
+	}
+
+	for (UINT32 x = 0; x < numAreas; x++)
+	{
+		const SHADOW_CAPTURE_AREA* cur = &params[x];
+		if (cur->status < 0)
+			goto fail;
+		if (cur->status == 0)
+			continue;
+		if (!region16_union_rect(region, region, &cur->invalid))
+			goto fail;
+		changed++;
+	}
+
+	rc = changed;
+fail:
+	free(work);
+	free(params);
+	return rc;
+}
+
+int shadow_capture_compare_areas_with_format(BYTE* WINPR_RESTRICT pData1, UINT32 format1,
+                                             UINT32 nStep1, const BYTE* WINPR_RESTRICT pData2,
+                                             UINT32 format2, UINT32 nStep2,
+                                             const RECTANGLE_16* WINPR_RESTRICT areas,
+                                             UINT32 numAreas, REGION16* WINPR_RESTRICT region)
+{
+	return shadow_capture_compare_areas(pData1, format1, nStep1, pData2, format2, nStep2, areas,
+	                                    numAreas, region, TRUE);
+}
+
+int shadow_capture_diff_areas_with_format(const BYTE* WINPR_RESTRICT pData1, UINT32 format1,
+                                          UINT32 nStep1, const BYTE* WINPR_RESTRICT pData2,
+                                          UINT32 format2, UINT32 nStep2,
+                                          const RECTANGLE_16* WINPR_RESTRICT areas,
+                                          UINT32 numAreas, REGION16* WINPR_RESTRICT region)
+{
+	/* image 1 is only written to if copying was requested */
+	WINPR_PRAGMA_DIAG_PUSH
+	WINPR_PRAGMA_DIAG_IGNORED_QUALIFIERS
+	BYTE* data1 = (BYTE*)pData1;
+	WINPR_PRAGMA_DIAG_POP
+	return shadow_capture_compare_areas(data1, format1, nStep1, pData2, format2, nStep2, areas,
+	                                    numAreas, region, FALSE);
+}
+
 rdpShadowCapture* shadow_capture_new(rdpShadowServer* server)
 {
 	WINPR_ASSERT(server);
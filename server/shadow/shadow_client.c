@@ -25,6 +25,7 @@
 #include <winpr/cast.h>
 #include <winpr/file.h>
 #include <winpr/path.h>
+#include <winpr/pool.h>
 #include <winpr/synch.h>
 #include <winpr/thread.h>
 #include <winpr/sysinfo.h>
@@ -37,12 +38,43 @@
 
 #define TAG CLIENT_TAG("shadow")
 
+/* Interval to retry sending a frame that was deferred because the send queue was full */
+#define SHADOW_CLIENT_RETRY_INTERVAL 16
+
+/* Maximum number of GFX surfaces, one for each monitor of the shared desktop */
+#define SHADOW_CLIENT_MAX_GFX_OUTPUTS 16
+
+typedef struct
+{
+	RECTANGLE_16 rect; /* area of the shared desktop, relative to its origin */
+	UINT16 surfaceId;
+	rdpShadowEncoder* encoder; /* own codec state, NULL to use the client encoder */
+} SHADOW_GFX_OUTPUT;
+
 typedef struct
 {
 	BOOL gfxOpened;
 	BOOL gfxSurfaceCreated;
+	UINT32 numOutputs;
+	SHADOW_GFX_OUTPUT outputs[SHADOW_CLIENT_MAX_GFX_OUTPUTS];
+	/* outputs are encoded in parallel, their frames are sent one after the other */
+	CRITICAL_SECTION sendLock;
 } SHADOW_GFX_STATUS;
 
+typedef struct
+{
+	rdpShadowClient* client;
+	SHADOW_GFX_STATUS* status;
+	const SHADOW_GFX_OUTPUT* output;
+	UINT32 frameId;
+	const BYTE* pSrcData;
+	UINT32 nSrcStep;
+	UINT32 SrcFormat;
+	RECTANGLE_16* damageRects;
+	UINT32 numDamageRects;
+	BOOL success;
+} SHADOW_GFX_ENCODE;
+
 /* See https://github.com/FreeRDP/FreeRDP/issues/10413
  *
  * Microsoft ditched support for RFX and multiple rectangles in BitmapUpdate for
@@ -108,67 +140,173 @@ static BOOL BitmapUpdateProxyEx(rdpShadowClient* client, const BITMAP_UPDATE* bi
 	return TRUE;
 }
 
-static INLINE BOOL shadow_client_rdpgfx_new_surface(rdpShadowClient* client)
+UINT32 shadow_client_gfx_outputs(const MONITOR_DEF* monitors, UINT32 numMonitors,
+                                 const RECTANGLE_16* desktop, RECTANGLE_16* outputs,
+                                 UINT32 maxOutputs)
 {
-	UINT error = CHANNEL_RC_OK;
-	RDPGFX_CREATE_SURFACE_PDU createSurface;
-	RDPGFX_MAP_SURFACE_TO_OUTPUT_PDU surfaceToOutput;
+	UINT32 count = 0;
+
+	WINPR_ASSERT(monitors || (numMonitors == 0));
+	WINPR_ASSERT(desktop);
+	WINPR_ASSERT(outputs);
+	WINPR_ASSERT(maxOutputs > 0);
+
+	for (UINT32 x = 0; x < numMonitors; x++)
+	{
+		const MONITOR_DEF* monitor = &monitors[x];
+		const INT64 left = MAX((INT64)monitor->left, (INT64)desktop->left);
+		const INT64 top = MAX((INT64)monitor->top, (INT64)desktop->top);
+		const INT64 right = MIN((INT64)monitor->right + 1, (INT64)desktop->right);
+		const INT64 bottom = MIN((INT64)monitor->bottom + 1, (INT64)desktop->bottom);
+
+		if ((left >= right) || (top >= bottom))
+			continue;
+
+		const RECTANGLE_16 rect = { .left = (UINT16)(left - desktop->left),
+			                        .top = (UINT16)(top - desktop->top),
+			                        .right = (UINT16)(right - desktop->left),
+			                        .bottom = (UINT16)(bottom - desktop->top) };
+
+		/* mirrored monitors, show the desktop as a whole */
+		for (UINT32 y = 0; y < count; y++)
+		{
+			if (rectangles_intersects(&outputs[y], &rect))
+				goto single;
+		}
+
+		if (count >= maxOutputs)
+			goto single;
+
+		outputs[count++] = rect;
+	}
+
+	if (count > 1)
+		return count;
+
+single:
+	outputs[0].left = 0;
+	outputs[0].top = 0;
+	outputs[0].right = desktop->right - desktop->left;
+	outputs[0].bottom = desktop->bottom - desktop->top;
+	return 1;
+}
+
+static BOOL shadow_client_rdpgfx_release_surface(rdpShadowClient* client,
+                                                 SHADOW_GFX_STATUS* pStatus)
+{
+	BOOL rc = TRUE;
 	RdpgfxServerContext* context = NULL;
-	rdpSettings* settings = NULL;
 
 	WINPR_ASSERT(client);
+	WINPR_ASSERT(pStatus);
+
 	context = client->rdpgfx;
 	WINPR_ASSERT(context);
-	settings = ((rdpContext*)client)->settings;
-	WINPR_ASSERT(settings);
-
-	WINPR_ASSERT(freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth) <= UINT16_MAX);
-	WINPR_ASSERT(freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight) <= UINT16_MAX);
-	createSurface.width = (UINT16)freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
-	createSurface.height = (UINT16)freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
-	createSurface.pixelFormat = GFX_PIXEL_FORMAT_XRGB_8888;
-	createSurface.surfaceId = client->surfaceId;
-	surfaceToOutput.outputOriginX = 0;
-	surfaceToOutput.outputOriginY = 0;
-	surfaceToOutput.surfaceId = client->surfaceId;
-	surfaceToOutput.reserved = 0;
-	IFCALLRET(context->CreateSurface, error, context, &createSurface);
 
-	if (error)
+	for (UINT32 x = 0; x < pStatus->numOutputs; x++)
 	{
-		WLog_ERR(TAG, "CreateSurface failed with error %" PRIu32 "", error);
-		return FALSE;
-	}
+		UINT error = CHANNEL_RC_OK;
+		SHADOW_GFX_OUTPUT* output = &pStatus->outputs[x];
+		RDPGFX_DELETE_SURFACE_PDU pdu = { 0 };
 
-	IFCALLRET(context->MapSurfaceToOutput, error, context, &surfaceToOutput);
+		pdu.surfaceId = client->surfaceId++;
+		IFCALLRET(context->DeleteSurface, error, context, &pdu);
 
-	if (error)
-	{
-		WLog_ERR(TAG, "MapSurfaceToOutput failed with error %" PRIu32 "", error);
-		return FALSE;
+		if (error)
+		{
+			WLog_ERR(TAG, "DeleteSurface failed with error %" PRIu32 "", error);
+			rc = FALSE;
+		}
+
+		shadow_encoder_free(output->encoder);
+		output->encoder = NULL;
 	}
 
-	return TRUE;
+	pStatus->numOutputs = 0;
+	return rc;
 }
 
-static INLINE BOOL shadow_client_rdpgfx_release_surface(rdpShadowClient* client)
+/* Creates one surface per monitor of the shared desktop, mapped to the position of the monitor */
+static BOOL shadow_client_rdpgfx_new_surface(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                             const rdpShadowSurface* surface)
 {
-	UINT error = CHANNEL_RC_OK;
-	RDPGFX_DELETE_SURFACE_PDU pdu;
+	RECTANGLE_16 rects[SHADOW_CLIENT_MAX_GFX_OUTPUTS] = { 0 };
 	RdpgfxServerContext* context = NULL;
+	rdpSettings* settings = NULL;
+	rdpShadowServer* server = NULL;
 
 	WINPR_ASSERT(client);
-
+	WINPR_ASSERT(pStatus);
+	WINPR_ASSERT(surface);
 	context = client->rdpgfx;
 	WINPR_ASSERT(context);
+	settings = ((rdpContext*)client)->settings;
+	WINPR_ASSERT(settings);
+	server = client->server;
+	WINPR_ASSERT(server);
+
+	WINPR_ASSERT(freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth) <= UINT16_MAX);
+	WINPR_ASSERT(freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight) <= UINT16_MAX);
+	const UINT16 width = (UINT16)freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
+	const UINT16 height = (UINT16)freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
+	const UINT16 left = surface->x + (server->shareSubRect ? server->subRect.left : 0);
+	const UINT16 top = surface->y + (server->shareSubRect ? server->subRect.top : 0);
+	const RECTANGLE_16 desktop = { .left = left,
+		                           .top = top,
+		                           .right = (UINT16)MIN(UINT16_MAX, 1ul * left + width),
+		                           .bottom = (UINT16)MIN(UINT16_MAX, 1ul * top + height) };
+
+	const UINT32 count =
+	    shadow_client_gfx_outputs(client->subsystem->monitors, client->subsystem->numMonitors,
+	                              &desktop, rects, ARRAYSIZE(rects));
+
+	WINPR_ASSERT(pStatus->numOutputs == 0);
+	for (UINT32 x = 0; x < count; x++)
+	{
+		UINT error = CHANNEL_RC_OK;
+		SHADOW_GFX_OUTPUT* output = &pStatus->outputs[x];
+		RDPGFX_CREATE_SURFACE_PDU createSurface = { 0 };
+		RDPGFX_MAP_SURFACE_TO_OUTPUT_PDU surfaceToOutput = { 0 };
+
+		output->rect = rects[x];
+		output->surfaceId = (UINT16)(client->surfaceId + x);
+		output->encoder = NULL;
+
+		createSurface.width = output->rect.right - output->rect.left;
+		createSurface.height = output->rect.bottom - output->rect.top;
+		createSurface.pixelFormat = GFX_PIXEL_FORMAT_XRGB_8888;
+		createSurface.surfaceId = output->surfaceId;
+		surfaceToOutput.outputOriginX = output->rect.left;
+		surfaceToOutput.outputOriginY = output->rect.top;
+		surfaceToOutput.surfaceId = output->surfaceId;
+		surfaceToOutput.reserved = 0;
+		IFCALLRET(context->CreateSurface, error, context, &createSurface);
 
-	pdu.surfaceId = client->surfaceId++;
-	IFCALLRET(context->DeleteSurface, error, context, &pdu);
+		if (error)
+		{
+			WLog_ERR(TAG, "CreateSurface failed with error %" PRIu32 "", error);
+			return FALSE;
+		}
 
-	if (error)
-	{
-		WLog_ERR(TAG, "DeleteSurface failed with error %" PRIu32 "", error);
-		return FALSE;
+		/* created surfaces are deleted again on failure */
+		pStatus->numOutputs = x + 1;
+
+		IFCALLRET(context->MapSurfaceToOutput, error, context, &surfaceToOutput);
+
+		if (error)
+		{
+			WLog_ERR(TAG, "MapSurfaceToOutput failed with error %" PRIu32 "", error);
+			return FALSE;
+		}
+
+		/* the codecs keep state per surface, every monitor needs its own */
+		if (count > 1)
+		{
+			output->encoder =
+			    shadow_encoder_new_area(client, createSurface.width, createSurface.height);
+			if (!output->encoder)
+				return FALSE;
+		}
 	}
 
 	return TRUE;
@@ -306,6 +444,10 @@ static BOOL shadow_client_context_new(freerdp_peer* peer, rdpContext* context)
 		return FALSE;
 	if (!freerdp_settings_set_uint32(settings, FreeRDP_CompressionLevel, PACKET_COMPR_TYPE_RDP8))
 		return FALSE;
+	/* updates and virtual channel data are both sent from the client thread */
+	if (!freerdp_settings_set_uint32(settings, FreeRDP_VCFlags,
+	                                 freerdp_settings_get_uint32(srvSettings, FreeRDP_VCFlags)))
+		return FALSE;
 
 	if (server->ipcSocket && (strncmp(bind_address, server->ipcSocket,
 	                                  strnlen(bind_address, sizeof(bind_address))) != 0))
@@ -1140,14 +1282,322 @@ static INLINE UINT32 rdpgfx_estimate_h264_avc420(RDPGFX_AVC420_BITMAP_STREAM* ha
 	       havc420->length;
 }
 
+/* Sends a complete frame holding a single command */
+static UINT shadow_client_send_gfx_frame(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                         const RDPGFX_SURFACE_COMMAND* cmd,
+                                         const RDPGFX_START_FRAME_PDU* cmdstart,
+                                         const RDPGFX_END_FRAME_PDU* cmdend)
+{
+	UINT error = CHANNEL_RC_OK;
+
+	WINPR_ASSERT(client);
+	WINPR_ASSERT(pStatus);
+
+	EnterCriticalSection(&pStatus->sendLock);
+	IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, cmd, cmdstart, cmdend);
+	LeaveCriticalSection(&pStatus->sendLock);
+	return error;
+}
+
+/* Starts the frame with the first command, the send lock is held until the frame is ended */
+static BOOL shadow_client_send_gfx_command(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                           const RDPGFX_SURFACE_COMMAND* cmd,
+                                           const RDPGFX_START_FRAME_PDU* cmdstart, BOOL* started)
+{
+	UINT error = CHANNEL_RC_OK;
+
+	WINPR_ASSERT(client);
+	WINPR_ASSERT(pStatus);
+	WINPR_ASSERT(started);
+
+	if (!*started)
+	{
+		EnterCriticalSection(&pStatus->sendLock);
+		IFCALLRET(client->rdpgfx->StartFrame, error, client->rdpgfx, cmdstart);
+		if (error)
+		{
+			LeaveCriticalSection(&pStatus->sendLock);
+			WLog_ERR(TAG, "StartFrame failed with error %" PRIu32 "", error);
+			return FALSE;
+		}
+		*started = TRUE;
+	}
+
+	IFCALLRET(client->rdpgfx->SurfaceCommand, error, client->rdpgfx, cmd);
+	if (error)
+	{
+		WLog_ERR(TAG, "SurfaceCommand failed with error %" PRIu32 "", error);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/* The lossy codec used next to planar for mixed content, 0 if content is not split */
+static UINT32 shadow_client_gfx_mixed_codec(rdpShadowClient* client, UINT32 SrcFormat)
+{
+	const rdpSettings* settings = client->context.settings;
+
+	if (!client->server->GfxMixedContent || (FreeRDPGetBytesPerPixel(SrcFormat) != 4))
+		return 0;
+	if (!freerdp_settings_get_bool(settings, FreeRDP_GfxPlanar))
+		return 0;
+
+#ifdef WITH_GFX_H264
+	/* AVC444 always encodes the complete frame */
+	if (freerdp_settings_get_bool(settings, FreeRDP_GfxAVC444) ||
+	    freerdp_settings_get_bool(settings, FreeRDP_GfxAVC444v2))
+		return 0;
+	if (freerdp_settings_get_bool(settings, FreeRDP_GfxH264))
+		return FREERDP_CODEC_AVC420;
+#endif
+	if (freerdp_settings_get_bool(settings, FreeRDP_RemoteFxCodec) &&
+	    (freerdp_settings_get_uint32(settings, FreeRDP_RemoteFxCodecId) != 0))
+		return FREERDP_CODEC_REMOTEFX;
+	if (freerdp_settings_get_bool(settings, FreeRDP_GfxProgressive))
+		return FREERDP_CODEC_PROGRESSIVE;
+	return 0;
+}
+
+static BOOL shadow_client_send_gfx_lossy(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                         rdpShadowEncoder* encoder, UINT32 codec,
+                                         const BYTE* pSrcData, UINT32 nSrcStep,
+                                         const RDPGFX_SURFACE_COMMAND* tmpl, const REGION16* region,
+                                         const RDPGFX_START_FRAME_PDU* cmdstart, BOOL* started)
+{
+	BOOL ret = FALSE;
+	RDPGFX_SURFACE_COMMAND cmd = *tmpl;
+	UINT32 numRects = 0;
+	const RECTANGLE_16* rects = region16_rects(region, &numRects);
+
+	if (shadow_encoder_prepare(encoder, codec) < 0)
+	{
+		WLog_ERR(TAG, "Failed to prepare encoder 0x%08" PRIx32, codec);
+		return FALSE;
+	}
+
+	switch (codec)
+	{
+#ifdef WITH_GFX_H264
+		case FREERDP_CODEC_AVC420:
+		{
+			RDPGFX_AVC420_BITMAP_STREAM avc420 = { 0 };
+			const INT32 rc = avc420_compress_region(
+			    encoder->h264, pSrcData, cmd.format, nSrcStep, cmd.width, cmd.height, rects,
+			    numRects, &avc420.data, &avc420.length, &avc420.meta);
+			if (rc < 0)
+			{
+				WLog_ERR(TAG, "avc420_compress failed");
+				break;
+			}
+
+			ret = TRUE;
+			if (rc > 0)
+			{
+				cmd.codecId = RDPGFX_CODECID_AVC420;
+				cmd.extra = (void*)&avc420;
+				ret = shadow_client_send_gfx_command(client, pStatus, &cmd, cmdstart, started);
+			}
+			free_h264_metablock(&avc420.meta);
+		}
+		break;
+#endif
+		case FREERDP_CODEC_REMOTEFX:
+		{
+			RFX_RECT* rfxRects = calloc(numRects, sizeof(RFX_RECT));
+			wStream* s = Stream_New(NULL, 1024);
+			if (!rfxRects || !s)
+			{
+				free(rfxRects);
+				Stream_Free(s, TRUE);
+				break;
+			}
+
+			for (UINT32 x = 0; x < numRects; x++)
+			{
+				rfxRects[x].x = rects[x].left;
+				rfxRects[x].y = rects[x].top;
+				rfxRects[x].width = rects[x].right - rects[x].left;
+				rfxRects[x].height = rects[x].bottom - rects[x].top;
+			}
+
+			if (!rfx_compose_message(encoder->rfx, s, rfxRects, numRects, pSrcData, cmd.width,
+			                         cmd.height, nSrcStep))
+				WLog_ERR(TAG, "rfx_compose_message failed");
+			else
+			{
+				const size_t pos = Stream_GetPosition(s);
+				WINPR_ASSERT(pos <= UINT32_MAX);
+
+				cmd.codecId = RDPGFX_CODECID_CAVIDEO;
+				cmd.data = Stream_Buffer(s);
+				cmd.length = (UINT32)pos;
+				ret = shadow_client_send_gfx_command(client, pStatus, &cmd, cmdstart, started);
+			}
+			free(rfxRects);
+			Stream_Free(s, TRUE);
+		}
+		break;
+		case FREERDP_CODEC_PROGRESSIVE:
+		{
+			const INT32 rc = progressive_compress(encoder->progressive, pSrcData,
+			                                      nSrcStep * cmd.height, cmd.format, cmd.width,
+			                                      cmd.height, nSrcStep, region, &cmd.data,
+			                                      &cmd.length);
+			if (rc < 0)
+			{
+				WLog_ERR(TAG, "progressive_compress failed");
+				break;
+			}
+
+			ret = TRUE;
+			if (rc > 0)
+			{
+				cmd.codecId = RDPGFX_CODECID_CAPROGRESSIVE;
+				ret = shadow_client_send_gfx_command(client, pStatus, &cmd, cmdstart, started);
+			}
+		}
+		break;
+		default:
+			break;
+	}
+
+	return ret;
+}
+
+static BOOL shadow_client_send_gfx_planar(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                          rdpShadowEncoder* encoder, const BYTE* pSrcData,
+                                          UINT32 nSrcStep, UINT32 SrcFormat,
+                                          const RDPGFX_SURFACE_COMMAND* tmpl,
+                                          const REGION16* region,
+                                          const RDPGFX_START_FRAME_PDU* cmdstart, BOOL* started)
+{
+	UINT32 maxWidth = 0;
+	UINT32 maxHeight = 0;
+	UINT32 numRects = 0;
+	const RECTANGLE_16* rects = region16_rects(region, &numRects);
+
+	if (shadow_encoder_prepare(encoder, FREERDP_CODEC_PLANAR) < 0)
+	{
+		WLog_ERR(TAG, "Failed to prepare encoder FREERDP_CODEC_PLANAR");
+		return FALSE;
+	}
+
+	for (UINT32 x = 0; x < numRects; x++)
+	{
+		maxWidth = MAX(maxWidth, (UINT32)(rects[x].right - rects[x].left));
+		maxHeight = MAX(maxHeight, (UINT32)(rects[x].bottom - rects[x].top));
+	}
+
+	if (!freerdp_bitmap_planar_context_reset(encoder->planar, maxWidth, maxHeight))
+		return FALSE;
+
+	freerdp_planar_topdown_image(encoder->planar, TRUE);
+
+	for (UINT32 x = 0; x < numRects; x++)
+	{
+		const RECTANGLE_16* rect = &rects[x];
+		RDPGFX_SURFACE_COMMAND cmd = *tmpl;
+		const BYTE* src = &pSrcData[1ull * rect->top * nSrcStep + 4ull * rect->left];
+
+		cmd.left = rect->left;
+		cmd.top = rect->top;
+		cmd.right = rect->right;
+		cmd.bottom = rect->bottom;
+		cmd.width = cmd.right - cmd.left;
+		cmd.height = cmd.bottom - cmd.top;
+		cmd.codecId = RDPGFX_CODECID_PLANAR;
+		cmd.data = freerdp_bitmap_compress_planar(encoder->planar, src, SrcFormat, cmd.width,
+		                                          cmd.height, nSrcStep, NULL, &cmd.length);
+		if (!cmd.data)
+		{
+			WLog_ERR(TAG, "freerdp_bitmap_compress_planar failed");
+			return FALSE;
+		}
+
+		const BOOL rc = shadow_client_send_gfx_command(client, pStatus, &cmd, cmdstart, started);
+		free(cmd.data);
+		if (!rc)
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * Splits the damaged area into text / UI and image tiles. The image tiles are sent with the
+ * lossy codec first, the text tiles with planar afterwards, both within a single frame.
+ */
+static BOOL shadow_client_send_surface_gfx_mixed(rdpShadowClient* client,
+                                                 SHADOW_GFX_STATUS* pStatus,
+                                                 rdpShadowEncoder* encoder, UINT32 codec,
+                                                 const BYTE* pSrcData, UINT32 nSrcStep,
+                                                 UINT32 SrcFormat,
+                                                 const RDPGFX_SURFACE_COMMAND* tmpl,
+                                                 const RDPGFX_START_FRAME_PDU* cmdstart,
+                                                 const RDPGFX_END_FRAME_PDU* cmdend,
+                                                 const RECTANGLE_16* damageRects,
+                                                 UINT32 numDamageRects)
+{
+	BOOL ret = FALSE;
+	BOOL started = FALSE;
+	REGION16 lossy = { 0 };
+	REGION16 lossless = { 0 };
+
+	region16_init(&lossy);
+	region16_init(&lossless);
+
+	if (!encoder->content)
+		encoder->content = shadow_content_new();
+	if (!encoder->content)
+		goto fail;
+
+	if (!shadow_content_classify(encoder->content, pSrcData, nSrcStep, tmpl->width, tmpl->height,
+	                             damageRects, numDamageRects, &lossy, &lossless))
+		goto fail;
+
+	if (!region16_is_empty(&lossy))
+	{
+		if (!shadow_client_send_gfx_lossy(client, pStatus, encoder, codec, pSrcData, nSrcStep,
+		                                  tmpl, &lossy, cmdstart, &started))
+			goto fail;
+	}
+
+	if (!region16_is_empty(&lossless))
+	{
+		if (!shadow_client_send_gfx_planar(client, pStatus, encoder, pSrcData, nSrcStep,
+		                                   SrcFormat, tmpl, &lossless, cmdstart, &started))
+			goto fail;
+	}
+
+	ret = TRUE;
+fail:
+	if (started)
+	{
+		UINT error = CHANNEL_RC_OK;
+		IFCALLRET(client->rdpgfx->EndFrame, error, client->rdpgfx, cmdend);
+		LeaveCriticalSection(&pStatus->sendLock);
+		if (error)
+		{
+			WLog_ERR(TAG, "EndFrame failed with error %" PRIu32 "", error);
+			ret = FALSE;
+		}
+	}
+	region16_uninit(&lossy);
+	region16_uninit(&lossless);
+	return ret;
+}
+
 /**
  * Function description
+ * Encode and send a frame of one GFX output, pSrcData points to the origin of the output
  *
  * @return TRUE on success
  */
-static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE* pSrcData,
-                                           UINT32 nSrcStep, UINT32 SrcFormat, UINT16 nXSrc,
-                                           UINT16 nYSrc, UINT16 nWidth, UINT16 nHeight)
+static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus,
+                                           const SHADOW_GFX_OUTPUT* output, UINT32 frameId,
+                                           const BYTE* pSrcData, UINT32 nSrcStep,
+                                           UINT32 SrcFormat, UINT16 nXSrc, UINT16 nYSrc,
+                                           UINT16 nWidth, UINT16 nHeight,
+                                           const RECTANGLE_16* damageRects, UINT32 numDamageRects)
 {
 	UINT32 id = 0;
 	UINT error = CHANNEL_RC_OK;
@@ -1159,27 +1609,21 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 	RDPGFX_END_FRAME_PDU cmdend = { 0 };
 	SYSTEMTIME sTime = { 0 };
 
-	if (!context || !pSrcData)
+	if (!context || !pSrcData || !pStatus || !output)
 		return FALSE;
 
 	settings = context->settings;
-	encoder = client->encoder;
+	encoder = output->encoder ? output->encoder : client->encoder;
 
 	if (!settings || !encoder)
 		return FALSE;
 
-	if (client->first_frame)
-	{
-		rfx_context_reset(encoder->rfx, nWidth, nHeight);
-		client->first_frame = FALSE;
-	}
-
-	cmdstart.frameId = shadow_encoder_create_frame_id(encoder);
+	cmdstart.frameId = frameId;
 	GetSystemTime(&sTime);
 	cmdstart.timestamp = (UINT32)(sTime.wHour << 22U | sTime.wMinute << 16U | sTime.wSecond << 10U |
 	                              sTime.wMilliseconds);
 	cmdend.frameId = cmdstart.frameId;
-	cmd.surfaceId = client->surfaceId;
+	cmd.surfaceId = output->surfaceId;
 	cmd.format = PIXEL_FORMAT_BGRX32;
 	cmd.left = nXSrc;
 	cmd.top = nYSrc;
@@ -1188,6 +1632,13 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 	cmd.width = nWidth;
 	cmd.height = nHeight;
 
+	const UINT32 mixedCodec = shadow_client_gfx_mixed_codec(client, SrcFormat);
+	if (mixedCodec != 0)
+		return shadow_client_send_surface_gfx_mixed(client, pStatus, encoder, mixedCodec,
+		                                            pSrcData, nSrcStep, SrcFormat, &cmd,
+		                                            &cmdstart, &cmdend, damageRects,
+		                                            numDamageRects);
+
 	id = freerdp_settings_get_uint32(settings, FreeRDP_RemoteFxCodecId);
 #ifdef WITH_GFX_H264
 	const BOOL GfxH264 = freerdp_settings_get_bool(settings, FreeRDP_GfxH264);
@@ -1231,8 +1682,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 			avc444.cbAvc420EncodedBitstream1 = rdpgfx_estimate_h264_avc420(&avc444.bitstream[0]);
 			cmd.codecId = GfxAVC444v2 ? RDPGFX_CODECID_AVC444v2 : RDPGFX_CODECID_AVC444;
 			cmd.extra = (void*)&avc444;
-			IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-			          &cmdend);
+			error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		}
 
 		free_h264_metablock(&avc444.bitstream[0].meta);
@@ -1247,7 +1697,6 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 	{
 		INT32 rc = 0;
 		RDPGFX_AVC420_BITMAP_STREAM avc420 = { 0 };
-		RECTANGLE_16 regionRect;
 
 		if (shadow_encoder_prepare(encoder, FREERDP_CODEC_AVC420) < 0)
 		{
@@ -1255,16 +1704,10 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 			return FALSE;
 		}
 
-		WINPR_ASSERT(cmd.left <= UINT16_MAX);
-		WINPR_ASSERT(cmd.top <= UINT16_MAX);
-		WINPR_ASSERT(cmd.right <= UINT16_MAX);
-		WINPR_ASSERT(cmd.bottom <= UINT16_MAX);
-		regionRect.left = (UINT16)cmd.left;
-		regionRect.top = (UINT16)cmd.top;
-		regionRect.right = (UINT16)cmd.right;
-		regionRect.bottom = (UINT16)cmd.bottom;
-		rc = avc420_compress(encoder->h264, pSrcData, cmd.format, nSrcStep, nWidth, nHeight,
-		                     &regionRect, &avc420.data, &avc420.length, &avc420.meta);
+		/* only convert the damaged areas, the encoder keeps the rest of the frame */
+		rc = avc420_compress_region(encoder->h264, pSrcData, cmd.format, nSrcStep, nWidth,
+		                            nHeight, damageRects, numDamageRects, &avc420.data,
+		                            &avc420.length, &avc420.meta);
 		if (rc < 0)
 		{
 			WLog_ERR(TAG, "avc420_compress failed");
@@ -1277,8 +1720,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 			cmd.codecId = RDPGFX_CODECID_AVC420;
 			cmd.extra = (void*)&avc420;
 
-			IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-			          &cmdend);
+			error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		}
 		free_h264_metablock(&avc420.meta);
 
@@ -1333,8 +1775,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 			cmd.data = Stream_Buffer(s);
 			cmd.length = (UINT32)pos;
 
-			IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-			          &cmdend);
+			error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		}
 
 		Stream_Free(s, TRUE);
@@ -1380,8 +1821,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 		{
 			cmd.codecId = RDPGFX_CODECID_CAPROGRESSIVE;
 
-			IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-			          &cmdend);
+			error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		}
 
 		if (error)
@@ -1414,8 +1854,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 
 		cmd.codecId = RDPGFX_CODECID_PLANAR;
 
-		IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-		          &cmdend);
+		error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		free(cmd.data);
 		if (error)
 		{
@@ -1445,8 +1884,7 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 		cmd.length = length;
 		cmd.codecId = RDPGFX_CODECID_UNCOMPRESSED;
 
-		IFCALLRET(client->rdpgfx->SurfaceFrameCommand, error, client->rdpgfx, &cmd, &cmdstart,
-		          &cmdend);
+		error = shadow_client_send_gfx_frame(client, pStatus, &cmd, &cmdstart, &cmdend);
 		free(data);
 		if (error)
 		{
@@ -1457,6 +1895,137 @@ static BOOL shadow_client_send_surface_gfx(rdpShadowClient* client, const BYTE*
 	return TRUE;
 }
 
+static void shadow_client_encode_output(SHADOW_GFX_ENCODE* cur)
+{
+	WINPR_ASSERT(cur);
+	WINPR_ASSERT(cur->output);
+
+	const RECTANGLE_16* rect = &cur->output->rect;
+	const BYTE* src = &cur->pSrcData[1ull * rect->top * cur->nSrcStep +
+	                                 1ull * rect->left * FreeRDPGetBytesPerPixel(cur->SrcFormat)];
+
+	cur->success = shadow_client_send_surface_gfx(
+	    cur->client, cur->status, cur->output, cur->frameId, src, cur->nSrcStep, cur->SrcFormat,
+	    0, 0, rect->right - rect->left, rect->bottom - rect->top, cur->damageRects,
+	    cur->numDamageRects);
+}
+
+static void CALLBACK shadow_client_encode_output_work_callback(PTP_CALLBACK_INSTANCE instance,
+                                                               void* context, PTP_WORK work)
+{
+	WINPR_UNUSED(instance);
+	WINPR_UNUSED(work);
+
+	shadow_client_encode_output(context);
+}
+
+/**
+ * Function description
+ * Send the damage of every GFX output. Each output has its own surface and codec state, the
+ * outputs with damage are encoded on the default thread pool while the frames are sent one
+ * after the other.
+ *
+ * @return TRUE on success
+ */
+static BOOL shadow_client_send_surface_gfx_outputs(rdpShadowClient* client,
+                                                   SHADOW_GFX_STATUS* pStatus,
+                                                   const BYTE* pSrcData, UINT32 nSrcStep,
+                                                   UINT32 SrcFormat,
+                                                   const RECTANGLE_16* damageRects,
+                                                   UINT32 numDamageRects)
+{
+	BOOL ret = FALSE;
+	UINT32 count = 0;
+	PTP_WORK work[SHADOW_CLIENT_MAX_GFX_OUTPUTS] = { 0 };
+	SHADOW_GFX_ENCODE params[SHADOW_CLIENT_MAX_GFX_OUTPUTS] = { 0 };
+
+	WINPR_ASSERT(client);
+	WINPR_ASSERT(pStatus);
+	WINPR_ASSERT(pStatus->numOutputs <= ARRAYSIZE(params));
+
+	for (UINT32 x = 0; x < pStatus->numOutputs; x++)
+	{
+		const SHADOW_GFX_OUTPUT* output = &pStatus->outputs[x];
+		SHADOW_GFX_ENCODE* cur = &params[count];
+
+		if (client->first_frame)
+		{
+			rdpShadowEncoder* encoder = output->encoder ? output->encoder : client->encoder;
+			rfx_context_reset(encoder->rfx, output->rect.right - output->rect.left,
+			                  output->rect.bottom - output->rect.top);
+		}
+
+		cur->damageRects = calloc(numDamageRects + 1ull, sizeof(RECTANGLE_16));
+		if (!cur->damageRects)
+			goto fail;
+
+		/* damage relative to the output */
+		for (UINT32 y = 0; y < numDamageRects; y++)
+		{
+			RECTANGLE_16 rect = { 0 };
+			if (!rectangles_intersection(&damageRects[y], &output->rect, &rect))
+				continue;
+
+			RECTANGLE_16* dst = &cur->damageRects[cur->numDamageRects++];
+			dst->left = rect.left - output->rect.left;
+			dst->top = rect.top - output->rect.top;
+			dst->right = rect.right - output->rect.left;
+			dst->bottom = rect.bottom - output->rect.top;
+		}
+
+		if (cur->numDamageRects == 0)
+		{
+			free(cur->damageRects);
+			cur->damageRects = NULL;
+			continue;
+		}
+
+		cur->client = client;
+		cur->status = pStatus;
+		cur->output = output;
+		cur->frameId = shadow_encoder_create_frame_id(client->encoder);
+		cur->pSrcData = pSrcData;
+		cur->nSrcStep = nSrcStep;
+		cur->SrcFormat = SrcFormat;
+		count++;
+	}
+
+	client->first_frame = FALSE;
+
+	/* the last output is encoded by the client thread */
+	for (UINT32 x = 0; x + 1 < count; x++)
+	{
+		work[x] = CreateThreadpoolWork(shadow_client_encode_output_work_callback, &params[x], NULL);
+		if (work[x])
+			SubmitThreadpoolWork(work[x]);
+		else
+			shadow_client_encode_output(&params[x]);
+	}
+
+	if (count > 0)
+		shadow_client_encode_output(&params[count - 1]);
+
+	for (UINT32 x = 0; x + 1 < count; x++)
+	{
+		if (!work[x])
+			continue;
+		WaitForThreadpoolWorkCallbacks(work[x], FALSE);
+		CloseThreadpoolWork(work[x]);
+	}
+
+	ret = TRUE;
+	for (UINT32 x = 0; x < count; x++)
+	{
+		if (!params[x].success)
+			ret = FALSE;
+	}
+
+fail:
+	for (UINT32 x = 0; x < ARRAYSIZE(params); x++)
+		free(params[x].damageRects);
+	return ret;
+}
+
 static BOOL stream_surface_bits_supported(const rdpSettings* settings)
 {
 	const UINT32 supported =
@@ -1966,15 +2535,18 @@ static BOOL shadow_client_send_surface_update(rdpShadowClient* client, SHADOW_GF
 			nWidth = freerdp_settings_get_uint32(settings, FreeRDP_DesktopWidth);
 			nHeight = freerdp_settings_get_uint32(settings, FreeRDP_DesktopHeight);
 
-			/* Create primary surface if have not */
+			/* Create the surfaces if have not */
 			if (!pStatus->gfxSurfaceCreated)
 			{
 				/* Only init surface when we have h264 supported */
 				if (!(ret = shadow_client_rdpgfx_reset_graphic(client)))
 					goto out;
 
-				if (!(ret = shadow_client_rdpgfx_new_surface(client)))
+				if (!(ret = shadow_client_rdpgfx_new_surface(client, pStatus, surface)))
+				{
+					(void)shadow_client_rdpgfx_release_surface(client, pStatus);
 					goto out;
+				}
 
 				pStatus->gfxSurfaceCreated = TRUE;
 			}
@@ -1983,8 +2555,30 @@ static BOOL shadow_client_send_surface_update(rdpShadowClient* client, SHADOW_GF
 			WINPR_ASSERT(nWidth <= UINT16_MAX);
 			WINPR_ASSERT(nHeight >= 0);
 			WINPR_ASSERT(nHeight <= UINT16_MAX);
-			ret = shadow_client_send_surface_gfx(client, pSrcData, nSrcStep, SrcFormat, 0, 0,
-			                                     (UINT16)nWidth, (UINT16)nHeight);
+
+			/* damage relative to pSrcData */
+			UINT32 numDamageRects = 0;
+			const RECTANGLE_16* invalidRects = region16_rects(&invalidRegion, &numDamageRects);
+			RECTANGLE_16* damageRects = calloc(numDamageRects + 1ull, sizeof(RECTANGLE_16));
+			if (!damageRects)
+			{
+				ret = FALSE;
+				goto out;
+			}
+
+			for (UINT32 x = 0; x < numDamageRects; x++)
+			{
+				const UINT16 subX = server->shareSubRect ? server->subRect.left : 0;
+				const UINT16 subY = server->shareSubRect ? server->subRect.top : 0;
+				damageRects[x].left = (UINT16)(invalidRects[x].left - subX);
+				damageRects[x].top = (UINT16)(invalidRects[x].top - subY);
+				damageRects[x].right = (UINT16)(invalidRects[x].right - subX);
+				damageRects[x].bottom = (UINT16)(invalidRects[x].bottom - subY);
+			}
+
+			ret = shadow_client_send_surface_gfx_outputs(client, pStatus, pSrcData, nSrcStep,
+			                                             SrcFormat, damageRects, numDamageRects);
+			free(damageRects);
 		}
 		else
 		{
@@ -2056,7 +2650,7 @@ static BOOL shadow_client_send_resize(rdpShadowClient* client, SHADOW_GFX_STATUS
 	/* Close Gfx surfaces */
 	if (pStatus->gfxSurfaceCreated)
 	{
-		if (!shadow_client_rdpgfx_release_surface(client))
+		if (!shadow_client_rdpgfx_release_surface(client, pStatus))
 			return FALSE;
 
 		pStatus->gfxSurfaceCreated = FALSE;
@@ -2111,6 +2705,88 @@ static INLINE BOOL shadow_client_no_surface_update(rdpShadowClient* client,
 	return rc;
 }
 
+BOOL shadow_client_send_queue_full(rdpShadowClient* client)
+{
+	WINPR_ASSERT(client);
+
+	rdpContext* context = &client->context;
+	const UINT32 limit =
+	    freerdp_settings_get_uint32(context->settings, FreeRDP_TcpNotSentLowWatermark);
+
+	if (limit == 0)
+		return FALSE;
+
+	return freerdp_get_transport_unsent(context) > limit;
+}
+
+SHADOW_CLIENT_UPDATE shadow_client_pace_update(BOOL active, BOOL frame, BOOL queueFull,
+                                               BOOL* pDeferred)
+{
+	WINPR_ASSERT(pDeferred);
+
+	/* The damage is kept until the client is activated or resumes output again */
+	if (!active)
+	{
+		*pDeferred = FALSE;
+		return frame ? SHADOW_CLIENT_UPDATE_MERGE : SHADOW_CLIENT_UPDATE_NONE;
+	}
+
+	if (queueFull)
+	{
+		if (!frame)
+			return SHADOW_CLIENT_UPDATE_NONE;
+
+		*pDeferred = TRUE;
+		return SHADOW_CLIENT_UPDATE_MERGE;
+	}
+
+	if (!frame && !*pDeferred)
+		return SHADOW_CLIENT_UPDATE_NONE;
+
+	*pDeferred = FALSE;
+	return SHADOW_CLIENT_UPDATE_SEND;
+}
+
+/**
+ * Function description
+ * Send or merge the surface damage as decided by shadow_client_pace_update
+ *
+ * @return TRUE on success
+ */
+static BOOL shadow_client_update(rdpShadowClient* client, SHADOW_GFX_STATUS* pStatus, BOOL frame,
+                                 BOOL* pDeferred)
+{
+	WINPR_ASSERT(client);
+
+	const BOOL active = client->activated && !client->suppressOutput;
+	const BOOL queueFull = active && shadow_client_send_queue_full(client);
+
+	switch (shadow_client_pace_update(active, frame, queueFull, pDeferred))
+	{
+		case SHADOW_CLIENT_UPDATE_MERGE:
+			if (!shadow_client_no_surface_update(client, pStatus))
+			{
+				WLog_ERR(TAG, "Failed to handle surface update");
+				return FALSE;
+			}
+			break;
+
+		case SHADOW_CLIENT_UPDATE_SEND:
+			if (!shadow_client_send_surface_update(client, pStatus))
+			{
+				WLog_ERR(TAG, "Failed to send surface update");
+				return FALSE;
+			}
+			break;
+
+		case SHADOW_CLIENT_UPDATE_NONE:
+		default:
+			break;
+	}
+
+	return TRUE;
+}
+
 static int shadow_client_subsystem_process_message(rdpShadowClient* client, wMessage* message)
 {
 	rdpContext* context = (rdpContext*)client;
@@ -2253,6 +2929,7 @@ static DWORD WINAPI shadow_client_thread(LPVOID arg)
 	wMessageQueue* MsgQueue = NULL;
 	/* This should only be visited in client thread */
 	SHADOW_GFX_STATUS gfxstatus = { 0 };
+	BOOL deferred = FALSE;
 	rdpUpdate* update = NULL;
 
 	WINPR_ASSERT(client);
@@ -2271,6 +2948,8 @@ static DWORD WINAPI shadow_client_thread(LPVOID arg)
 	settings = peer->context->settings;
 	WINPR_ASSERT(settings);
 
+	InitializeCriticalSection(&gfxstatus.sendLock);
+
 	peer->Capabilities = shadow_client_capabilities;
 	peer->PostConnect = shadow_client_post_connect;
 	peer->Activate = shadow_client_activate;
@@ -2336,7 +3015,8 @@ static DWORD WINAPI shadow_client_thread(LPVOID arg)
 			events[nCount++] = gfxevent;
 #endif
 
-		status = WaitForMultipleObjects(nCount, events, FALSE, INFINITE);
+		status = WaitForMultipleObjects(nCount, events, FALSE,
+		                                deferred ? SHADOW_CLIENT_RETRY_INTERVAL : INFINITE);
 
 		if (status == WAIT_FAILED)
 			goto fail;
@@ -2350,38 +3030,23 @@ static DWORD WINAPI shadow_client_thread(LPVOID arg)
 			 * (at shadow_multiclient_consume). As best practice, subsystem
 			 * implementation should invoke shadow_subsystem_frame_update which
 			 * triggers the event and then wait for completion */
-			if (client->activated && !client->suppressOutput)
+			if (client->activated && !client->suppressOutput &&
+			    shadow_client_recalc_desktop_size(client))
 			{
-				/* Send screen update or resize to this client */
-
-				/* Check resize */
-				if (shadow_client_recalc_desktop_size(client))
-				{
-					/* Screen size changed, do resize */
-					if (!shadow_client_send_resize(client, &gfxstatus))
-					{
-						WLog_ERR(TAG, "Failed to send resize message");
-						break;
-					}
-				}
-				else
+				/* Screen size changed, do resize. The activation refreshes the full screen */
+				deferred = FALSE;
+				if (!shadow_client_send_resize(client, &gfxstatus))
 				{
-					/* Send frame */
-					if (!shadow_client_send_surface_update(client, &gfxstatus))
-					{
-						WLog_ERR(TAG, "Failed to send surface update");
-						break;
-					}
+					WLog_ERR(TAG, "Failed to send resize message");
+					break;
 				}
 			}
 			else
 			{
-				/* Our client don't receive graphic updates. Just save the invalid region */
-				if (!shadow_client_no_surface_update(client, &gfxstatus))
-				{
-					WLog_ERR(TAG, "Failed to handle surface update");
+				/* Send the frame, or accumulate the invalid region if our client does not
+				 * receive graphic updates or the connection is backed up */
+				if (!shadow_client_update(client, &gfxstatus, TRUE, &deferred))
 					break;
-				}
 			}
 
 			/*
@@ -2390,6 +3055,13 @@ static DWORD WINAPI shadow_client_thread(LPVOID arg)
 			 */
 			(void)shadow_multiclient_consume(UpdateSubscriber);
 		}
+		else if (deferred && !shadow_client_recalc_desktop_size(client))
+		{
+			/* No new frame arrived, send the deferred one once the queue drained. A resize is
+			 * left to the next frame */
+			if (!shadow_client_update(client, &gfxstatus, FALSE, &deferred))
+				break;
+		}
 
 		WINPR_ASSERT(peer->CheckFileDescriptor);
 		if (!peer->CheckFileDescriptor(peer))
@@ -2563,7 +3235,7 @@ fail:
 	{
 		if (gfxstatus.gfxSurfaceCreated)
 		{
-			if (!shadow_client_rdpgfx_release_surface(client))
+			if (!shadow_client_rdpgfx_release_surface(client, &gfxstatus))
 				WLog_WARN(TAG, "GFX release surface failure!");
 		}
 
@@ -2587,6 +3259,7 @@ fail:
 	}
 
 out:
+	DeleteCriticalSection(&gfxstatus.sendLock);
 	WINPR_ASSERT(peer->Disconnect);
 	peer->Disconnect(peer);
 	freerdp_peer_context_free(peer);
@@ -19,6 +19,7 @@
 #ifndef FREERDP_SERVER_SHADOW_CLIENT_H
 #define FREERDP_SERVER_SHADOW_CLIENT_H
 
+#include <freerdp/api.h>
 #include <freerdp/server/shadow.h>
 
 #ifdef __cplusplus
@@ -26,8 +27,65 @@ extern "C"
 {
 #endif
 
+	typedef enum
+	{
+		SHADOW_CLIENT_UPDATE_NONE,
+		SHADOW_CLIENT_UPDATE_MERGE,
+		SHADOW_CLIENT_UPDATE_SEND
+	} SHADOW_CLIENT_UPDATE;
+
 	BOOL shadow_client_accepted(freerdp_listener* listener, freerdp_peer* peer);
 
+	/**
+	 * Decide what to do with the damage of the surface.
+	 *
+	 * While the send queue is full the damage of new frames is merged and the
+	 * frame is deferred. A deferred frame is sent as soon as the queue drained,
+	 * even if no new frame arrived in the meantime.
+	 *
+	 * @param active TRUE if the client is activated and receives graphic updates
+	 * @param frame TRUE if the subsystem signaled a new frame
+	 * @param queueFull TRUE if the send queue of the client is full
+	 * @param pDeferred Keeps track of a deferred frame, the client must retry while it is set
+	 *
+	 * @return What to do with the surface damage
+	 */
+	FREERDP_LOCAL SHADOW_CLIENT_UPDATE shadow_client_pace_update(BOOL active, BOOL frame,
+	                                                             BOOL queueFull, BOOL* pDeferred);
+
+	/**
+	 * Check if the transport holds more unsent data than the send queue limit.
+	 *
+	 * New frames would only queue up behind stale ones, so the damage is kept
+	 * and merged into a later frame instead.
+	 *
+	 * @param client The client to check
+	 *
+	 * @return TRUE if the frame should be skipped
+	 */
+	FREERDP_LOCAL BOOL shadow_client_send_queue_full(rdpShadowClient* client);
+
+	/**
+	 * Split the shared desktop into one GFX output per monitor.
+	 *
+	 * Each monitor showing a part of the desktop gets its own output, so the
+	 * monitors can be encoded independently. Overlapping (mirrored) monitors,
+	 * more monitors than outputs or a single monitor result in one output
+	 * covering the whole desktop.
+	 *
+	 * @param monitors The monitors of the subsystem in virtual screen coordinates
+	 * @param numMonitors The number of monitors
+	 * @param desktop The shared desktop in virtual screen coordinates
+	 * @param outputs Receives the outputs relative to the desktop origin
+	 * @param maxOutputs The number of entries in outputs
+	 *
+	 * @return The number of outputs, at least 1
+	 */
+	FREERDP_LOCAL UINT32 shadow_client_gfx_outputs(const MONITOR_DEF* monitors,
+	                                               UINT32 numMonitors,
+	                                               const RECTANGLE_16* desktop,
+	                                               RECTANGLE_16* outputs, UINT32 maxOutputs);
+
 #ifdef __cplusplus
 }
 #endif
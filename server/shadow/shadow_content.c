@@ -0,0 +1,324 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <freerdp/config.h>
+
+#include <winpr/assert.h>
+#include <winpr/crt.h>
+
+#include "shadow_content.h"
+
+#define SHADOW_CONTENT_TILE_SIZE 64
+/* tiles with up to this many distinct colors are considered text or flat UI */
+#define SHADOW_CONTENT_MAX_COLORS 48
+#define SHADOW_CONTENT_COLOR_SLOTS 128
+/* sum of channel differences between two neighbours counted as an edge */
+#define SHADOW_CONTENT_EDGE_THRESHOLD 128
+/* a tile damaged in this many frames with at most SHADOW_CONTENT_VIDEO_GAP frames in between
+ * is treated as video */
+#define SHADOW_CONTENT_VIDEO_STREAK 8
+#define SHADOW_CONTENT_VIDEO_GAP 2
+#define SHADOW_CONTENT_HYSTERESIS 2
+
+typedef enum
+{
+	SHADOW_CONTENT_UNKNOWN = 0,
+	SHADOW_CONTENT_LOSSLESS,
+	SHADOW_CONTENT_LOSSY
+} SHADOW_CONTENT_TYPE;
+
+typedef struct
+{
+	BYTE type;
+	BYTE sent;
+	BYTE pending;
+	BYTE streak;
+	UINT32 lastFrame;
+} SHADOW_CONTENT_TILE;
+
+struct s_shadow_content
+{
+	UINT32 width;
+	UINT32 height;
+	size_t tilesX;
+	size_t tilesY;
+	UINT32 frame;
+
+	SHADOW_CONTENT_TILE* tiles;
+	BYTE* damaged;
+};
+
+static UINT32 shadow_content_distance(UINT32 a, UINT32 b)
+{
+	UINT32 distance = 0;
+	for (size_t x = 0; x < 4; x++)
+	{
+		const BYTE ca = (a >> (x * 8)) & 0xFF;
+		const BYTE cb = (b >> (x * 8)) & 0xFF;
+		distance += (ca > cb) ? (ca - cb) : (cb - ca);
+	}
+	return distance;
+}
+
+/* Inserts a color into a small open addressing set, returns TRUE if it was not known yet */
+static BOOL shadow_content_add_color(UINT32* colors, BYTE* used, UINT32 color)
+{
+	size_t slot = (color * 2654435761u) % SHADOW_CONTENT_COLOR_SLOTS;
+	while (used[slot])
+	{
+		if (colors[slot] == color)
+			return FALSE;
+		slot = (slot + 1) % SHADOW_CONTENT_COLOR_SLOTS;
+	}
+
+	used[slot] = 1;
+	colors[slot] = color;
+	return TRUE;
+}
+
+/* Only every other line is sampled, that is enough to tell text from images */
+static SHADOW_CONTENT_TYPE shadow_content_analyze(const BYTE* pSrcData, UINT32 nSrcStep,
+                                                  const RECTANGLE_16* rect)
+{
+	UINT32 colors[SHADOW_CONTENT_COLOR_SLOTS] = { 0 };
+	BYTE used[SHADOW_CONTENT_COLOR_SLOTS] = { 0 };
+	size_t ncolors = 0;
+	size_t pairs = 0;
+	size_t equal = 0;
+	size_t edges = 0;
+
+	WINPR_ASSERT(pSrcData);
+	WINPR_ASSERT(rect);
+
+	const size_t width = rect->right - rect->left;
+	for (size_t y = rect->top; y < rect->bottom; y += 2)
+	{
+		const UINT32* line = (const UINT32*)&pSrcData[y * nSrcStep + rect->left * 4ull];
+		UINT32 prev = line[0];
+
+		for (size_t x = 0; x < width; x++)
+		{
+			const UINT32 color = line[x];
+			if ((ncolors <= SHADOW_CONTENT_MAX_COLORS) &&
+			    shadow_content_add_color(colors, used, color))
+				ncolors++;
+
+			if (x == 0)
+				continue;
+
+			pairs++;
+			if (color == prev)
+				equal++;
+			else if (shadow_content_distance(color, prev) > SHADOW_CONTENT_EDGE_THRESHOLD)
+				edges++;
+			prev = color;
+		}
+	}
+
+	/* few colors: flat UI or aliased text */
+	if (ncolors <= SHADOW_CONTENT_MAX_COLORS)
+		return SHADOW_CONTENT_LOSSLESS;
+
+	/* mostly flat with some gradients or anti-aliased text on it */
+	if (equal * 2 >= pairs)
+		return SHADOW_CONTENT_LOSSLESS;
+
+	/* dense text: many sharp edges between runs of equal pixels. Noise and detailed photos
+	 * have sharp edges as well, but hardly any runs. */
+	if ((edges * 4 >= pairs) && (equal * 4 >= pairs))
+		return SHADOW_CONTENT_LOSSLESS;
+
+	return SHADOW_CONTENT_LOSSY;
+}
+
+static void shadow_content_update_tile(SHADOW_CONTENT* content, SHADOW_CONTENT_TILE* tile,
+                                       const BYTE* pSrcData, UINT32 nSrcStep,
+                                       const RECTANGLE_16* rect, BOOL* lossy, BOOL* lossless)
+{
+	WINPR_ASSERT(content);
+	WINPR_ASSERT(tile);
+	WINPR_ASSERT(lossy);
+	WINPR_ASSERT(lossless);
+
+	if ((tile->type != SHADOW_CONTENT_UNKNOWN) &&
+	    (content->frame - tile->lastFrame <= SHADOW_CONTENT_VIDEO_GAP))
+	{
+		if (tile->streak < UINT8_MAX)
+			tile->streak++;
+	}
+	else
+		tile->streak = 0;
+	tile->lastFrame = content->frame;
+
+	const SHADOW_CONTENT_TYPE type = (tile->streak >= SHADOW_CONTENT_VIDEO_STREAK)
+	                                     ? SHADOW_CONTENT_LOSSY
+	                                     : shadow_content_analyze(pSrcData, nSrcStep, rect);
+
+	if ((tile->type == SHADOW_CONTENT_UNKNOWN) || (tile->type == type))
+	{
+		tile->type = (BYTE)type;
+		tile->pending = 0;
+	}
+	else if (++tile->pending >= SHADOW_CONTENT_HYSTERESIS)
+	{
+		tile->type = (BYTE)type;
+		tile->pending = 0;
+	}
+
+	*lossy = (tile->type == SHADOW_CONTENT_LOSSY);
+	*lossless = (tile->type == SHADOW_CONTENT_LOSSLESS) || (tile->sent == SHADOW_CONTENT_LOSSLESS);
+	tile->sent = tile->type;
+}
+
+static BOOL shadow_content_resize(SHADOW_CONTENT* content, UINT32 width, UINT32 height)
+{
+	WINPR_ASSERT(content);
+
+	if (content->tiles && (content->width == width) && (content->height == height))
+		return TRUE;
+
+	const size_t tilesX = (width + SHADOW_CONTENT_TILE_SIZE - 1ull) / SHADOW_CONTENT_TILE_SIZE;
+	const size_t tilesY = (height + SHADOW_CONTENT_TILE_SIZE - 1ull) / SHADOW_CONTENT_TILE_SIZE;
+
+	free(content->tiles);
+	free(content->damaged);
+	content->tiles = calloc(tilesX * tilesY, sizeof(SHADOW_CONTENT_TILE));
+	content->damaged = calloc(tilesX * tilesY, sizeof(BYTE));
+	if (!content->tiles || !content->damaged)
+	{
+		free(content->tiles);
+		free(content->damaged);
+		content->tiles = NULL;
+		content->damaged = NULL;
+		return FALSE;
+	}
+
+	content->width = width;
+	content->height = height;
+	content->tilesX = tilesX;
+	content->tilesY = tilesY;
+	return TRUE;
+}
+
+static BOOL shadow_content_run(const SHADOW_CONTENT* content, REGION16* region, size_t* start,
+                               size_t tx, size_t ty, BOOL active)
+{
+	WINPR_ASSERT(content);
+	WINPR_ASSERT(start);
+
+	if (active)
+	{
+		if (*start == SIZE_MAX)
+			*start = tx;
+		return TRUE;
+	}
+
+	if (*start == SIZE_MAX)
+		return TRUE;
+
+	const RECTANGLE_16 rect = {
+		.left = (UINT16)(*start * SHADOW_CONTENT_TILE_SIZE),
+		.top = (UINT16)(ty * SHADOW_CONTENT_TILE_SIZE),
+		.right = (UINT16)MIN(content->width, tx * SHADOW_CONTENT_TILE_SIZE),
+		.bottom = (UINT16)MIN(content->height, (ty + 1) * SHADOW_CONTENT_TILE_SIZE),
+	};
+	*start = SIZE_MAX;
+	return region16_union_rect(region, region, &rect);
+}
+
+BOOL shadow_content_classify(SHADOW_CONTENT* content, const BYTE* pSrcData, UINT32 nSrcStep,
+                             UINT32 width, UINT32 height, const RECTANGLE_16* damageRects,
+                             UINT32 numDamageRects, REGION16* lossy, REGION16* lossless)
+{
+	WINPR_ASSERT(content);
+	WINPR_ASSERT(pSrcData);
+	WINPR_ASSERT(damageRects || (numDamageRects == 0));
+	WINPR_ASSERT(lossy);
+	WINPR_ASSERT(lossless);
+
+	if ((width > UINT16_MAX) || (height > UINT16_MAX))
+		return FALSE;
+
+	if (!shadow_content_resize(content, width, height))
+		return FALSE;
+
+	content->frame++;
+	memset(content->damaged, 0, content->tilesX * content->tilesY);
+
+	for (UINT32 x = 0; x < numDamageRects; x++)
+	{
+		const RECTANGLE_16* rect = &damageRects[x];
+		const size_t right = MIN(content->tilesX, (rect->right + SHADOW_CONTENT_TILE_SIZE - 1ull) /
+		                                              SHADOW_CONTENT_TILE_SIZE);
+		const size_t bottom =
+		    MIN(content->tilesY,
+		        (rect->bottom + SHADOW_CONTENT_TILE_SIZE - 1ull) / SHADOW_CONTENT_TILE_SIZE);
+
+		for (size_t ty = rect->top / SHADOW_CONTENT_TILE_SIZE; ty < bottom; ty++)
+		{
+			for (size_t tx = rect->left / SHADOW_CONTENT_TILE_SIZE; tx < right; tx++)
+				content->damaged[ty * content->tilesX + tx] = 1;
+		}
+	}
+
+	/* merge horizontally adjacent tiles of the same kind to keep the regions small */
+	for (size_t ty = 0; ty < content->tilesY; ty++)
+	{
+		size_t lossyStart = SIZE_MAX;
+		size_t losslessStart = SIZE_MAX;
+
+		for (size_t tx = 0; tx <= content->tilesX; tx++)
+		{
+			BOOL toLossy = FALSE;
+			BOOL toLossless = FALSE;
+			const size_t k = ty * content->tilesX + tx;
+
+			if ((tx < content->tilesX) && content->damaged[k])
+			{
+				const RECTANGLE_16 rect = {
+					.left = (UINT16)(tx * SHADOW_CONTENT_TILE_SIZE),
+					.top = (UINT16)(ty * SHADOW_CONTENT_TILE_SIZE),
+					.right = (UINT16)MIN(width, (tx + 1) * SHADOW_CONTENT_TILE_SIZE),
+					.bottom = (UINT16)MIN(height, (ty + 1) * SHADOW_CONTENT_TILE_SIZE),
+				};
+				shadow_content_update_tile(content, &content->tiles[k], pSrcData, nSrcStep, &rect,
+				                           &toLossy, &toLossless);
+			}
+
+			if (!shadow_content_run(content, lossy, &lossyStart, tx, ty, toLossy))
+				return FALSE;
+			if (!shadow_content_run(content, lossless, &losslessStart, tx, ty, toLossless))
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+SHADOW_CONTENT* shadow_content_new(void)
+{
+	return calloc(1, sizeof(SHADOW_CONTENT));
+}
+
+void shadow_content_free(SHADOW_CONTENT* content)
+{
+	if (!content)
+		return;
+
+	free(content->tiles);
+	free(content->damaged);
+	free(content);
+}
@@ -0,0 +1,65 @@
+/**
+ * FreeRDP: A Remote Desktop Protocol Implementation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERDP_SERVER_SHADOW_CONTENT_H
+#define FREERDP_SERVER_SHADOW_CONTENT_H
+
+#include <winpr/wtypes.h>
+
+#include <freerdp/codec/region.h>
+
+typedef struct s_shadow_content SHADOW_CONTENT;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	void shadow_content_free(SHADOW_CONTENT* content);
+
+	WINPR_ATTR_MALLOC(shadow_content_free, 1)
+	SHADOW_CONTENT* shadow_content_new(void);
+
+	/**
+	 * @brief Sorts the damaged 64x64 tiles of a frame by content type.
+	 *
+	 * Tiles with few colors, large flat areas or dense edges (text, user interface) end up in
+	 * \b lossless, natural images and tiles changing every frame end up in \b lossy.
+	 * A tile changes its type only after it was classified differently twice in a row. A tile
+	 * that just moved from \b lossless to \b lossy is reported in both regions once, so that a
+	 * lossy encoder diffing against its own previous frame still refreshes it.
+	 *
+	 * @param content The classifier state, kept between frames.
+	 * @param pSrcData The frame, 32 bits per pixel.
+	 * @param nSrcStep The frame stride in bytes.
+	 * @param width The frame width in pixels.
+	 * @param height The frame height in pixels.
+	 * @param damageRects The damaged areas of the frame.
+	 * @param numDamageRects The number of damaged areas.
+	 * @param lossy Receives the tiles to encode with a lossy codec. Must be initialized.
+	 * @param lossless Receives the tiles to encode with a lossless codec. Must be initialized.
+	 *
+	 * @return TRUE on success, FALSE otherwise.
+	 */
+	BOOL shadow_content_classify(SHADOW_CONTENT* content, const BYTE* pSrcData, UINT32 nSrcStep,
+	                             UINT32 width, UINT32 height, const RECTANGLE_16* damageRects,
+	                             UINT32 numDamageRects, REGION16* lossy, REGION16* lossless);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERDP_SERVER_SHADOW_CONTENT_H */
@@ -285,8 +285,9 @@ fail:
 
 static int shadow_encoder_init(rdpShadowEncoder* encoder)
 {
-	encoder->width = encoder->server->screen->width;
-	encoder->height = encoder->server->screen->height;
+	encoder->width = encoder->areaWidth ? encoder->areaWidth : encoder->server->screen->width;
+	encoder->height =
+	    encoder->areaHeight ? encoder->areaHeight : encoder->server->screen->height;
 	encoder->maxTileWidth = 64;
 	encoder->maxTileHeight = 64;
 	shadow_encoder_init_grid(encoder);
@@ -394,6 +395,9 @@ static int shadow_encoder_uninit(rdpShadowEncoder* encoder)
 
 	shadow_encoder_uninit_progressive(encoder);
 
+	shadow_content_free(encoder->content);
+	encoder->content = NULL;
+
 	return 1;
 }
 
@@ -489,6 +493,11 @@ int shadow_encoder_prepare(rdpShadowEncoder* encoder, UINT32 codecs)
 }
 
 rdpShadowEncoder* shadow_encoder_new(rdpShadowClient* client)
+{
+	return shadow_encoder_new_area(client, 0, 0);
+}
+
+rdpShadowEncoder* shadow_encoder_new_area(rdpShadowClient* client, UINT32 width, UINT32 height)
 {
 	rdpShadowEncoder* encoder = NULL;
 	rdpShadowServer* server = client->server;
@@ -499,6 +508,8 @@ rdpShadowEncoder* shadow_encoder_new(rdpShadowClient* client)
 
 	encoder->client = client;
 	encoder->server = server;
+	encoder->areaWidth = width;
+	encoder->areaHeight = height;
 	encoder->fps = 16;
 	encoder->maxFps = 32;
 
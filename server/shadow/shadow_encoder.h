@@ -27,6 +27,8 @@
 
 #include <freerdp/server/shadow.h>
 
+#include "shadow_content.h"
+
 struct rdp_shadow_encoder
 {
 	rdpShadowClient* client;
@@ -36,6 +38,10 @@ struct rdp_shadow_encoder
 	UINT32 height;
 	UINT32 codecs;
 
+	/* size of the output area encoded, 0 for the whole screen */
+	UINT32 areaWidth;
+	UINT32 areaHeight;
+
 	BYTE** grid;
 	UINT32 gridWidth;
 	UINT32 gridHeight;
@@ -51,6 +57,7 @@ struct rdp_shadow_encoder
 	BITMAP_INTERLEAVED_CONTEXT* interleaved;
 	H264_CONTEXT* h264;
 	PROGRESSIVE_CONTEXT* progressive;
+	SHADOW_CONTENT* content;
 
 	UINT32 fps;
 	UINT32 maxFps;
@@ -74,6 +81,10 @@ extern "C"
 	WINPR_ATTR_MALLOC(shadow_encoder_free, 1)
 	rdpShadowEncoder* shadow_encoder_new(rdpShadowClient* client);
 
+	WINPR_ATTR_MALLOC(shadow_encoder_free, 1)
+	rdpShadowEncoder* shadow_encoder_new_area(rdpShadowClient* client, UINT32 width,
+	                                          UINT32 height);
+
 #ifdef __cplusplus
 }
 #endif
@@ -507,6 +507,13 @@ int shadow_server_parse_command_line(rdpShadowServer* server, int argc, char** a
 			                               arg->Value ? TRUE : FALSE))
 				return fail_at(arg, COMMAND_LINE_ERROR);
 		}
+		CommandLineSwitchCase(arg, "vc-compression")
+		{
+			if (!freerdp_settings_set_uint32(settings, FreeRDP_VCFlags,
+			                                 arg->Value ? (VCCAPS_COMPR_SC | VCCAPS_COMPR_CS_8K)
+			                                            : VCCAPS_NO_COMPR))
+				return fail_at(arg, COMMAND_LINE_ERROR);
+		}
 		CommandLineSwitchCase(arg, "gfx")
 		{
 			if (!freerdp_settings_set_bool(settings, FreeRDP_SupportGraphicsPipeline,
@@ -530,6 +537,17 @@ int shadow_server_parse_command_line(rdpShadowServer* server, int argc, char** a
 			if (!freerdp_settings_set_bool(settings, FreeRDP_GfxPlanar, arg->Value ? TRUE : FALSE))
 				return fail_at(arg, COMMAND_LINE_ERROR);
 		}
+		CommandLineSwitchCase(arg, "gfx-mixed")
+		{
+			server->GfxMixedContent = arg->Value ? TRUE : FALSE;
+		}
+		CommandLineSwitchCase(arg, "subsystem-options")
+		{
+			free(server->SubsystemOptions);
+			server->SubsystemOptions = _strdup(arg->Value);
+			if (!server->SubsystemOptions)
+				return fail_at(arg, COMMAND_LINE_ERROR);
+		}
 		CommandLineSwitchCase(arg, "gfx-avc420")
 		{
 			if (!freerdp_settings_set_bool(settings, FreeRDP_GfxH264, arg->Value ? TRUE : FALSE))
@@ -1084,6 +1102,8 @@ void shadow_server_free(rdpShadowServer* server)
 
 	free(server->ipcSocket);
 	server->ipcSocket = NULL;
+	free(server->SubsystemOptions);
+	server->SubsystemOptions = NULL;
 	freerdp_settings_free(server->settings);
 	server->settings = NULL;
 	free(server);
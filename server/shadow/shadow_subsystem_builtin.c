@@ -18,8 +18,19 @@
 
 #include <freerdp/config.h>
 
+#include <freerdp/log.h>
 #include <freerdp/server/shadow.h>
 
+#if defined(WITH_SHADOW_SYNTHETIC)
+#include "Synthetic/synthetic_shadow.h"
+#endif
+
+#if defined(WITH_SHADOW_PIPEWIRE)
+#include "PipeWire/pipewire_shadow.h"
+#endif
+
+#define TAG SERVER_TAG("shadow.subsystem")
+
 typedef struct
 {
 	const char* (*name)(void);
@@ -31,7 +42,13 @@ extern const char* ShadowSubsystemName(void);
 
 static const RDP_SHADOW_SUBSYSTEM g_Subsystems[] = {
 
-	{ ShadowSubsystemName, ShadowSubsystemEntry }
+	{ ShadowSubsystemName, ShadowSubsystemEntry },
+#if defined(WITH_SHADOW_SYNTHETIC)
+	{ synthetic_shadow_subsystem_name, synthetic_shadow_subsystem_entry },
+#endif
+#if defined(WITH_SHADOW_PIPEWIRE)
+	{ pipewire_shadow_subsystem_name, pipewire_shadow_subsystem_entry },
+#endif
 };
 
 static const size_t g_SubsystemCount = ARRAYSIZE(g_Subsystems);
@@ -64,10 +81,23 @@ static pfnShadowSubsystemEntry shadow_subsystem_load_static_entry(const char* na
 	return NULL;
 }
 
-void shadow_subsystem_set_entry_builtin(const char* name)
+int shadow_subsystem_set_entry_builtin_ex(const char* name)
 {
 	pfnShadowSubsystemEntry entry = shadow_subsystem_load_static_entry(name);
 
-	if (entry)
-		shadow_subsystem_set_entry(entry);
+	if (!entry)
+	{
+		WLog_ERR(TAG, "unknown shadow subsystem '%s'", name ? name : "default");
+		for (size_t index = 0; index < g_SubsystemCount; index++)
+			WLog_ERR(TAG, "available shadow subsystem: '%s'", g_Subsystems[index].name());
+		return -1;
+	}
+
+	shadow_subsystem_set_entry(entry);
+	return 0;
+}
+
+void shadow_subsystem_set_entry_builtin(const char* name)
+{
+	(void)shadow_subsystem_set_entry_builtin_ex(name);
 }
@@ -0,0 +1,148 @@
+
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/crypto.h>
+
+#include <freerdp/codec/color.h>
+#include <freerdp/codec/region.h>
+#include <freerdp/server/shadow.h>
+
+#define TEST_MONITOR_WIDTH 192
+#define TEST_MONITOR_HEIGHT 128
+#define TEST_MONITORS 3
+#define TEST_WIDTH (TEST_MONITOR_WIDTH * TEST_MONITORS)
+#define TEST_STEP (TEST_WIDTH * 4)
+#define TEST_SIZE (TEST_STEP * TEST_MONITOR_HEIGHT)
+
+static void test_fill(BYTE* data, const RECTANGLE_16* rect, BYTE value)
+{
+	for (UINT32 y = rect->top; y < rect->bottom; y++)
+		memset(&data[1ull * y * TEST_STEP + rect->left * 4ull], value,
+		       (rect->right - rect->left) * 4ull);
+}
+
+static BOOL test_rect_contains(const RECTANGLE_16* outer, const RECTANGLE_16* inner)
+{
+	return (outer->left <= inner->left) && (outer->top <= inner->top) &&
+	       (outer->right >= inner->right) && (outer->bottom >= inner->bottom);
+}
+
+/* Every changed rectangle must stay inside the monitor it was found in */
+static BOOL test_check_region(const REGION16* region, const RECTANGLE_16* monitors,
+                              const RECTANGLE_16* changes, size_t count)
+{
+	UINT32 nrects = 0;
+	const RECTANGLE_16* rects = region16_rects(region, &nrects);
+
+	if (nrects != count)
+		return FALSE;
+
+	for (size_t x = 0; x < count; x++)
+	{
+		BOOL found = FALSE;
+		for (UINT32 y = 0; y < nrects; y++)
+		{
+			if (!test_rect_contains(&rects[y], &changes[x]))
+				continue;
+
+			for (size_t m = 0; m < TEST_MONITORS; m++)
+			{
+				if (test_rect_contains(&monitors[m], &changes[x]))
+					found = test_rect_contains(&monitors[m], &rects[y]);
+			}
+		}
+
+		if (!found)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static BOOL test_compare_areas(BYTE* previous, BYTE* current, const RECTANGLE_16* monitors)
+{
+	BOOL rc = FALSE;
+	REGION16 region = { 0 };
+	const RECTANGLE_16 changes[] = { { 10, 10, 11, 11 }, { 400, 50, 420, 60 } };
+
+	region16_init(&region);
+	memcpy(current, previous, TEST_SIZE);
+
+	/* identical frames */
+	if (shadow_capture_compare_areas_with_format(previous, PIXEL_FORMAT_BGRX32, TEST_STEP,
+	                                             current, PIXEL_FORMAT_BGRX32, TEST_STEP,
+	                                             monitors, TEST_MONITORS, &region) != 0)
+		goto fail;
+	if (!region16_is_empty(&region))
+		goto fail;
+
+	/* changes on the first and the last monitor, the one in the middle stays untouched */
+	for (size_t x = 0; x < ARRAYSIZE(changes); x++)
+		test_fill(current, &changes[x], (BYTE)(0x10 + x));
+
+	if (shadow_capture_diff_areas_with_format(previous, PIXEL_FORMAT_BGRX32, TEST_STEP, current,
+	                                          PIXEL_FORMAT_BGRX32, TEST_STEP, monitors,
+	                                          TEST_MONITORS, &region) != 2)
+		goto fail;
+	if (!test_check_region(&region, monitors, changes, ARRAYSIZE(changes)))
+		goto fail;
+
+	/* diffing must not touch the previous frame */
+	if (memcmp(previous, current, TEST_SIZE) == 0)
+		goto fail;
+
+	region16_clear(&region);
+	if (shadow_capture_compare_areas_with_format(previous, PIXEL_FORMAT_BGRX32, TEST_STEP,
+	                                             current, PIXEL_FORMAT_BGRX32, TEST_STEP,
+	                                             monitors, TEST_MONITORS, &region) != 2)
+		goto fail;
+	if (!test_check_region(&region, monitors, changes, ARRAYSIZE(changes)))
+		goto fail;
+
+	/* the changed parts were copied */
+	if (memcmp(previous, current, TEST_SIZE) != 0)
+		goto fail;
+
+	rc = TRUE;
+fail:
+	region16_uninit(&region);
+	return rc;
+}
+
+int TestShadowCapture(int argc, char* argv[])
+{
+	int rc = -1;
+	RECTANGLE_16 monitors[TEST_MONITORS] = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	for (size_t x = 0; x < TEST_MONITORS; x++)
+	{
+		monitors[x].left = (UINT16)(x * TEST_MONITOR_WIDTH);
+		monitors[x].top = 0;
+		monitors[x].right = (UINT16)((x + 1) * TEST_MONITOR_WIDTH);
+		monitors[x].bottom = TEST_MONITOR_HEIGHT;
+	}
+
+	BYTE* previous = malloc(TEST_SIZE);
+	BYTE* current = malloc(TEST_SIZE);
+	if (!previous || !current)
+		goto fail;
+
+	if (winpr_RAND(previous, TEST_SIZE) < 0)
+		goto fail;
+
+	if (!test_compare_areas(previous, current, monitors))
+	{
+		printf("TestShadowCapture: comparing monitor areas failed\n");
+		goto fail;
+	}
+
+	rc = 0;
+fail:
+	free(previous);
+	free(current);
+	return rc;
+}
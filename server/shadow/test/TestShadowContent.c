@@ -0,0 +1,290 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+
+#include <freerdp/codec/region.h>
+
+#include "../shadow_content.h"
+
+#define TEST_TILE 64
+#define TEST_WIDTH (3 * TEST_TILE)
+#define TEST_HEIGHT TEST_TILE
+#define TEST_STEP (TEST_WIDTH * 4)
+
+typedef enum
+{
+	TEST_TEXT,
+	TEST_PHOTO,
+	TEST_NOISE,
+	TEST_FLAT
+} TEST_CONTENT;
+
+static const RECTANGLE_16 tiles[] = { { 0, 0, TEST_TILE, TEST_TILE },
+	                                  { TEST_TILE, 0, 2 * TEST_TILE, TEST_TILE },
+	                                  { 2 * TEST_TILE, 0, 3 * TEST_TILE, TEST_TILE } };
+
+static UINT32 test_rand(UINT32* state)
+{
+	UINT32 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+static void test_fill(BYTE* data, size_t tile, TEST_CONTENT content)
+{
+	UINT32 state = 0x12345678;
+
+	for (size_t y = 0; y < TEST_TILE; y++)
+	{
+		UINT32* line = (UINT32*)&data[y * TEST_STEP + tile * TEST_TILE * 4];
+		for (size_t x = 0; x < TEST_TILE; x++)
+		{
+			switch (content)
+			{
+				/* dark 4x8 glyphs with a pixel gap on a white background */
+				case TEST_TEXT:
+				{
+					const BOOL glyph = ((x % 6) < 4) && ((y % 12) < 8);
+					const BOOL ink = glyph && (((x * 7 + y * 3) % 5) < 3);
+					line[x] = ink ? 0xFF202020 : 0xFFFFFFFF;
+				}
+				break;
+				/* a smooth gradient, no two neighbours are equal */
+				case TEST_PHOTO:
+					line[x] = 0xFF000000 | (UINT32)((x * 4) << 16) | (UINT32)((y * 4) << 8) |
+					          (UINT32)((x + y) * 2);
+					break;
+				case TEST_NOISE:
+					line[x] = 0xFF000000 | (test_rand(&state) & 0xFFFFFF);
+					break;
+				case TEST_FLAT:
+				default:
+					line[x] = 0xFF3070A0;
+					break;
+			}
+		}
+	}
+}
+
+static BOOL test_region_equal(const char* what, const REGION16* region,
+                              const RECTANGLE_16* expected, size_t count)
+{
+	BOOL rc = FALSE;
+	REGION16 other = { 0 };
+
+	region16_init(&other);
+	for (size_t x = 0; x < count; x++)
+	{
+		if (!region16_union_rect(&other, &other, &expected[x]))
+			goto fail;
+	}
+
+	UINT32 na = 0;
+	UINT32 nb = 0;
+	const RECTANGLE_16* a = region16_rects(region, &na);
+	const RECTANGLE_16* b = region16_rects(&other, &nb);
+	if (na != nb)
+		goto fail;
+
+	for (UINT32 x = 0; x < na; x++)
+	{
+		if (!rectangles_equal(&a[x], &b[x]))
+			goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	if (!rc)
+		printf("%s: got %" PRIu32 " rectangles, expected %" PRIuz "\n", what, na, count);
+	region16_uninit(&other);
+	return rc;
+}
+
+/* Classifies one frame and checks the tiles reported as lossy and lossless */
+static BOOL test_classify(SHADOW_CONTENT* content, const BYTE* data, const RECTANGLE_16* damage,
+                          UINT32 numDamage, const RECTANGLE_16* lossy, size_t numLossy,
+                          const RECTANGLE_16* lossless, size_t numLossless)
+{
+	BOOL rc = FALSE;
+	REGION16 rlossy = { 0 };
+	REGION16 rlossless = { 0 };
+
+	region16_init(&rlossy);
+	region16_init(&rlossless);
+
+	if (!shadow_content_classify(content, data, TEST_STEP, TEST_WIDTH, TEST_HEIGHT, damage,
+	                             numDamage, &rlossy, &rlossless))
+		goto fail;
+
+	if (!test_region_equal("lossy", &rlossy, lossy, numLossy) ||
+	    !test_region_equal("lossless", &rlossless, lossless, numLossless))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	region16_uninit(&rlossy);
+	region16_uninit(&rlossless);
+	return rc;
+}
+
+static BOOL test_content_types(BYTE* data)
+{
+	BOOL rc = FALSE;
+	const RECTANGLE_16 full = { 0, 0, TEST_WIDTH, TEST_HEIGHT };
+	SHADOW_CONTENT* content = shadow_content_new();
+	if (!content)
+		return FALSE;
+
+	/* text and flat tiles are lossless, photos and noise lossy */
+	test_fill(data, 0, TEST_TEXT);
+	test_fill(data, 1, TEST_PHOTO);
+	test_fill(data, 2, TEST_FLAT);
+	{
+		const RECTANGLE_16 lossless[] = { tiles[0], tiles[2] };
+		if (!test_classify(content, data, &full, 1, &tiles[1], 1, lossless, ARRAYSIZE(lossless)))
+			goto fail;
+	}
+	shadow_content_free(content);
+
+	content = shadow_content_new();
+	if (!content)
+		return FALSE;
+
+	test_fill(data, 0, TEST_NOISE);
+	test_fill(data, 1, TEST_FLAT);
+	test_fill(data, 2, TEST_TEXT);
+	{
+		const RECTANGLE_16 lossless = { TEST_TILE, 0, 3 * TEST_TILE, TEST_TILE };
+		if (!test_classify(content, data, &full, 1, &tiles[0], 1, &lossless, 1))
+			goto fail;
+	}
+
+	/* undamaged tiles are not reported */
+	if (!test_classify(content, data, NULL, 0, NULL, 0, NULL, 0))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	shadow_content_free(content);
+	return rc;
+}
+
+static BOOL test_hysteresis(BYTE* data)
+{
+	BOOL rc = FALSE;
+	SHADOW_CONTENT* content = shadow_content_new();
+	if (!content)
+		return FALSE;
+
+	test_fill(data, 0, TEST_TEXT);
+	if (!test_classify(content, data, &tiles[0], 1, NULL, 0, &tiles[0], 1))
+		goto fail;
+
+	/* a single frame of different content does not switch the tile */
+	test_fill(data, 0, TEST_NOISE);
+	if (!test_classify(content, data, &tiles[0], 1, NULL, 0, &tiles[0], 1))
+		goto fail;
+
+	/* the second one does, the tile is refreshed in both regions once */
+	if (!test_classify(content, data, &tiles[0], 1, &tiles[0], 1, &tiles[0], 1))
+		goto fail;
+	if (!test_classify(content, data, &tiles[0], 1, &tiles[0], 1, NULL, 0))
+		goto fail;
+
+	/* a change back is delayed the same way */
+	test_fill(data, 0, TEST_TEXT);
+	if (!test_classify(content, data, &tiles[0], 1, &tiles[0], 1, NULL, 0))
+		goto fail;
+	if (!test_classify(content, data, &tiles[0], 1, NULL, 0, &tiles[0], 1))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	shadow_content_free(content);
+	return rc;
+}
+
+/* A tile damaged in every frame is video, even if its content looks like text */
+static BOOL test_streak(BYTE* data)
+{
+	BOOL rc = FALSE;
+	UINT32 frame = 0;
+	SHADOW_CONTENT* content = shadow_content_new();
+	if (!content)
+		return FALSE;
+
+	test_fill(data, 2, TEST_FLAT);
+
+	/* the streak starts with the second damaged frame, the switch needs two frames */
+	for (; frame < 9; frame++)
+	{
+		if (!test_classify(content, data, &tiles[2], 1, NULL, 0, &tiles[2], 1))
+			goto fail;
+	}
+
+	if (!test_classify(content, data, &tiles[2], 1, &tiles[2], 1, &tiles[2], 1))
+		goto fail;
+	if (!test_classify(content, data, &tiles[2], 1, &tiles[2], 1, NULL, 0))
+		goto fail;
+
+	/* short gaps keep the streak going */
+	if (!test_classify(content, data, NULL, 0, NULL, 0, NULL, 0) ||
+	    !test_classify(content, data, &tiles[2], 1, &tiles[2], 1, NULL, 0))
+		goto fail;
+
+	/* a longer pause ends it, the tile goes back to lossless after two frames */
+	for (size_t x = 0; x < 3; x++)
+	{
+		if (!test_classify(content, data, NULL, 0, NULL, 0, NULL, 0))
+			goto fail;
+	}
+
+	if (!test_classify(content, data, &tiles[2], 1, &tiles[2], 1, NULL, 0) ||
+	    !test_classify(content, data, &tiles[2], 1, NULL, 0, &tiles[2], 1))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	if (!rc)
+		printf("streak: failed after %" PRIu32 " frames\n", frame);
+	shadow_content_free(content);
+	return rc;
+}
+
+int TestShadowContent(int argc, char* argv[])
+{
+	int rc = -1;
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	BYTE* data = calloc(TEST_HEIGHT, TEST_STEP);
+	if (!data)
+		return -1;
+
+	if (!test_content_types(data))
+	{
+		printf("TestShadowContent: content types failed\n");
+		goto fail;
+	}
+
+	if (!test_hysteresis(data))
+	{
+		printf("TestShadowContent: hysteresis failed\n");
+		goto fail;
+	}
+
+	if (!test_streak(data))
+	{
+		printf("TestShadowContent: video streak failed\n");
+		goto fail;
+	}
+
+	rc = 0;
+fail:
+	free(data);
+	return rc;
+}
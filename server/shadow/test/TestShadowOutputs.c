@@ -0,0 +1,120 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+
+#include <freerdp/codec/region.h>
+
+#include "../shadow_client.h"
+
+#define TEST_MONITOR_WIDTH 192
+#define TEST_MONITOR_HEIGHT 128
+#define TEST_MAX_OUTPUTS 4
+
+static void test_monitor(MONITOR_DEF* monitor, INT32 left, INT32 top)
+{
+	monitor->left = left;
+	monitor->top = top;
+	monitor->right = left + TEST_MONITOR_WIDTH - 1;
+	monitor->bottom = top + TEST_MONITOR_HEIGHT - 1;
+	monitor->flags = 0;
+}
+
+static BOOL test_outputs(const char* name, const MONITOR_DEF* monitors, UINT32 numMonitors,
+                         const RECTANGLE_16* desktop, const RECTANGLE_16* expected, UINT32 count)
+{
+	RECTANGLE_16 outputs[TEST_MAX_OUTPUTS] = { 0 };
+
+	const UINT32 rc =
+	    shadow_client_gfx_outputs(monitors, numMonitors, desktop, outputs, ARRAYSIZE(outputs));
+	if (rc != count)
+	{
+		printf("%s: got %" PRIu32 " outputs, expected %" PRIu32 "\n", name, rc, count);
+		return FALSE;
+	}
+
+	for (UINT32 x = 0; x < count; x++)
+	{
+		if (!rectangles_equal(&outputs[x], &expected[x]))
+		{
+			printf("%s: output %" PRIu32 " is %" PRIu16 "x%" PRIu16 "-%" PRIu16 "x%" PRIu16 "\n",
+			       name, x, outputs[x].left, outputs[x].top, outputs[x].right,
+			       outputs[x].bottom);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+int TestShadowOutputs(int argc, char* argv[])
+{
+	MONITOR_DEF monitors[TEST_MAX_OUTPUTS + 1] = { 0 };
+	const RECTANGLE_16 all = { 0, 0, 3 * TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	for (UINT32 x = 0; x < 3; x++)
+		test_monitor(&monitors[x], (INT32)x * TEST_MONITOR_WIDTH, 0);
+
+	/* every monitor of the desktop gets its own output */
+	{
+		const RECTANGLE_16 expected[] = {
+			{ 0, 0, TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT },
+			{ TEST_MONITOR_WIDTH, 0, 2 * TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT },
+			{ 2 * TEST_MONITOR_WIDTH, 0, 3 * TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT }
+		};
+		if (!test_outputs("side by side", monitors, 3, &all, expected, ARRAYSIZE(expected)))
+			return -1;
+	}
+
+	/* sharing a single monitor */
+	{
+		const RECTANGLE_16 desktop = { TEST_MONITOR_WIDTH, 0, 2 * TEST_MONITOR_WIDTH,
+			                           TEST_MONITOR_HEIGHT };
+		const RECTANGLE_16 expected = { 0, 0, TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT };
+		if (!test_outputs("single monitor", monitors, 3, &desktop, &expected, 1))
+			return -1;
+	}
+
+	/* a shared sub rectangle spanning two monitors, outputs are relative to the desktop */
+	{
+		const RECTANGLE_16 desktop = { TEST_MONITOR_WIDTH / 2, 16, 3 * TEST_MONITOR_WIDTH / 2,
+			                           TEST_MONITOR_HEIGHT };
+		const RECTANGLE_16 expected[] = {
+			{ 0, 0, TEST_MONITOR_WIDTH / 2, TEST_MONITOR_HEIGHT - 16 },
+			{ TEST_MONITOR_WIDTH / 2, 0, TEST_MONITOR_WIDTH, TEST_MONITOR_HEIGHT - 16 }
+		};
+		if (!test_outputs("sub rectangle", monitors, 3, &desktop, expected, ARRAYSIZE(expected)))
+			return -1;
+	}
+
+	/* mirrored monitors are shown as a whole */
+	{
+		MONITOR_DEF mirrored[2] = { 0 };
+		const RECTANGLE_16 desktop = { 0, 0, TEST_MONITOR_WIDTH + 32, TEST_MONITOR_HEIGHT };
+		const RECTANGLE_16 expected = { 0, 0, TEST_MONITOR_WIDTH + 32, TEST_MONITOR_HEIGHT };
+
+		test_monitor(&mirrored[0], 0, 0);
+		test_monitor(&mirrored[1], 32, 0);
+		if (!test_outputs("mirrored", mirrored, ARRAYSIZE(mirrored), &desktop, &expected, 1))
+			return -1;
+	}
+
+	/* more monitors than outputs */
+	{
+		const RECTANGLE_16 desktop = { 0, 0, (TEST_MAX_OUTPUTS + 1) * TEST_MONITOR_WIDTH,
+			                           TEST_MONITOR_HEIGHT };
+
+		for (UINT32 x = 0; x < ARRAYSIZE(monitors); x++)
+			test_monitor(&monitors[x], (INT32)x * TEST_MONITOR_WIDTH, 0);
+		if (!test_outputs("too many", monitors, ARRAYSIZE(monitors), &desktop, &desktop, 1))
+			return -1;
+	}
+
+	/* no monitor information */
+	if (!test_outputs("no monitors", NULL, 0, &all, &all, 1))
+		return -1;
+
+	return 0;
+}
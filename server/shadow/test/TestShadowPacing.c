@@ -0,0 +1,345 @@
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include <winpr/crt.h>
+
+#include <freerdp/peer.h>
+#include <freerdp/transport_io.h>
+#include <freerdp/codec/region.h>
+
+#include "../shadow_client.h"
+
+#define TEST_FRAMES 10
+#define TEST_WATERMARK 16384
+#define TEST_PDU_SIZE 16384
+
+typedef struct
+{
+	BOOL deferred;
+	REGION16 pending;
+	REGION16 delivered;
+	size_t sent;
+} test_client;
+
+/* Handle the damage like the client thread, a frame without damage is a retry after a timeout */
+static BOOL test_update(test_client* client, const RECTANGLE_16* damage, BOOL queueFull)
+{
+	const BOOL frame = damage != NULL;
+
+	if (frame && !region16_union_rect(&client->pending, &client->pending, damage))
+		return FALSE;
+
+	switch (shadow_client_pace_update(TRUE, frame, queueFull, &client->deferred))
+	{
+		case SHADOW_CLIENT_UPDATE_SEND:
+		{
+			UINT32 count = 0;
+			const RECTANGLE_16* rects = region16_rects(&client->pending, &count);
+			for (UINT32 x = 0; x < count; x++)
+			{
+				if (!region16_union_rect(&client->delivered, &client->delivered, &rects[x]))
+					return FALSE;
+			}
+			region16_clear(&client->pending);
+			client->sent++;
+		}
+		break;
+
+		case SHADOW_CLIENT_UPDATE_MERGE:
+		case SHADOW_CLIENT_UPDATE_NONE:
+		default:
+			break;
+	}
+
+	return TRUE;
+}
+
+static BOOL test_region_contains(const REGION16* region, const RECTANGLE_16* rect)
+{
+	BOOL rc = FALSE;
+	REGION16 intersection = { 0 };
+
+	region16_init(&intersection);
+	if (region16_intersect_rect(&intersection, region, rect))
+	{
+		const RECTANGLE_16* extents = region16_extents(&intersection);
+		rc = (region16_n_rects(&intersection) == 1) && (extents->left == rect->left) &&
+		     (extents->top == rect->top) && (extents->right == rect->right) &&
+		     (extents->bottom == rect->bottom);
+	}
+	region16_uninit(&intersection);
+	return rc;
+}
+
+/* Frames arrive while the queue is full, then the subsystem goes idle and the queue drains */
+static BOOL test_drain(test_client* client)
+{
+	RECTANGLE_16 frames[TEST_FRAMES] = { 0 };
+
+	for (size_t x = 0; x < TEST_FRAMES; x++)
+	{
+		frames[x].left = (UINT16)(x * 20);
+		frames[x].top = (UINT16)(x * 10);
+		frames[x].right = frames[x].left + 16;
+		frames[x].bottom = frames[x].top + 8;
+
+		/* the first frame fills the queue */
+		if (!test_update(client, &frames[x], x > 0))
+			return FALSE;
+	}
+
+	if ((client->sent != 1) || !client->deferred)
+		return FALSE;
+
+	/* the retry timer fires while the queue is still full */
+	if (!test_update(client, NULL, TRUE) || (client->sent != 1) || !client->deferred)
+		return FALSE;
+
+	/* the queue drained, the deferred frames must go out without a new frame */
+	if (!test_update(client, NULL, FALSE) || (client->sent != 2) || client->deferred)
+		return FALSE;
+
+	if (!region16_is_empty(&client->pending))
+		return FALSE;
+
+	for (size_t x = 0; x < TEST_FRAMES; x++)
+	{
+		if (!test_region_contains(&client->delivered, &frames[x]))
+			return FALSE;
+	}
+
+	/* nothing is pending, no more retries */
+	return test_update(client, NULL, FALSE) && (client->sent == 2) && !client->deferred;
+}
+
+#ifndef _WIN32
+/* Connects a TCP socket pair over loopback, the reading side has a small receive window */
+static BOOL test_socket_pair(int* writer, int* reader)
+{
+	BOOL rc = FALSE;
+	struct sockaddr_in addr = { 0 };
+	socklen_t length = sizeof(addr);
+	const int rcvbuf = 4096;
+	const int listener = socket(AF_INET, SOCK_STREAM, 0);
+
+	*writer = -1;
+	*reader = socket(AF_INET, SOCK_STREAM, 0);
+	if ((listener < 0) || (*reader < 0))
+		goto fail;
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ((bind(listener, (const struct sockaddr*)&addr, sizeof(addr)) != 0) ||
+	    (listen(listener, 1) != 0) ||
+	    (getsockname(listener, (struct sockaddr*)&addr, &length) != 0))
+		goto fail;
+
+	if ((setsockopt(*reader, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf)) != 0) ||
+	    (connect(*reader, (const struct sockaddr*)&addr, sizeof(addr)) != 0))
+		goto fail;
+
+	*writer = accept(listener, NULL, NULL);
+	rc = (*writer >= 0);
+fail:
+	if (listener >= 0)
+		close(listener);
+	return rc;
+}
+
+/* Reads whatever arrives at the RDP client within a few milliseconds */
+static size_t test_receive(int reader)
+{
+	BYTE buffer[4096] = { 0 };
+	size_t received = 0;
+	struct pollfd pollset = { reader, POLLIN, 0 };
+
+	while (poll(&pollset, 1, 10) > 0)
+	{
+		const ssize_t rc = recv(reader, buffer, sizeof(buffer), 0);
+		if (rc <= 0)
+			break;
+		received += (size_t)rc;
+	}
+
+	return received;
+}
+
+/* Sends or defers a frame depending on the unsent data of a real transport */
+static BOOL test_transport_update(test_client* client, freerdp_peer* peer, wStream* s,
+                                  const RECTANGLE_16* damage, size_t* written)
+{
+	const size_t sent = client->sent;
+	const BOOL queueFull = shadow_client_send_queue_full((rdpShadowClient*)peer->context);
+
+	if (!test_update(client, damage, queueFull))
+		return FALSE;
+	if (client->sent == sent)
+		return TRUE;
+
+	/* the frame goes out as a PDU of a fixed size */
+	rdpTransport* transport = freerdp_get_transport(peer->context);
+	const rdpTransportIo* io = freerdp_get_io_callbacks(peer->context);
+	if (!transport || !io)
+		return FALSE;
+
+	Stream_SetPosition(s, 0);
+	Stream_Zero(s, TEST_PDU_SIZE);
+	if (io->WritePdu(transport, s) < 0)
+		return FALSE;
+
+	*written += TEST_PDU_SIZE;
+	return TRUE;
+}
+
+/* Frames are sent to an RDP client that does not read until the transport queue is full */
+static BOOL test_send_queue(test_client* client)
+{
+	BOOL rc = FALSE;
+	int writer = -1;
+	int reader = -1;
+	size_t written = 0;
+	size_t received = 0;
+	size_t sent = 0;
+	freerdp_peer* peer = NULL;
+	const RECTANGLE_16 damage = { 0, 0, 64, 64 };
+	wStream* s = Stream_New(NULL, TEST_PDU_SIZE);
+	rdpSettings* settings = freerdp_settings_new(FREERDP_SETTINGS_SERVER_MODE);
+	if (!s || !settings || !test_socket_pair(&writer, &reader))
+		goto fail;
+
+	/* the kernel keeps at most the watermark, the rest stays in the transport */
+	if (!freerdp_settings_set_uint32(settings, FreeRDP_TcpNotSentLowWatermark, TEST_WATERMARK) ||
+	    !freerdp_settings_set_bool(settings, FreeRDP_WaitForOutputBufferFlush, FALSE))
+		goto fail;
+
+	peer = freerdp_peer_new(writer);
+	if (!peer)
+		goto fail;
+	writer = -1;
+
+	peer->ContextSize = sizeof(rdpShadowClient);
+	if (!freerdp_peer_context_new_ex(peer, settings))
+		goto fail;
+
+	const rdpTransportIo* io = freerdp_get_io_callbacks(peer->context);
+	if (!io || !io->SetBlockingMode(freerdp_get_transport(peer->context), FALSE))
+		goto fail;
+
+	if (freerdp_get_transport_unsent(peer->context) != 0)
+		goto fail;
+
+	for (size_t x = 0; (x < 4 * TEST_FRAMES) && !client->deferred; x++)
+	{
+		if (!test_transport_update(client, peer, s, &damage, &written))
+			goto fail;
+	}
+
+	if (!client->deferred || (freerdp_get_transport_unsent(peer->context) <= TEST_WATERMARK))
+		goto fail;
+
+	/* the retry timer fires while the client did not read anything */
+	sent = client->sent;
+	if (!test_transport_update(client, peer, s, NULL, &written) || (client->sent != sent))
+		goto fail;
+
+	/* the client reads, the deferred frame goes out without a new frame once the queue drained */
+	for (size_t x = 0; (x < 1000) && client->deferred; x++)
+	{
+		received += test_receive(reader);
+		if (peer->DrainOutputBuffer(peer) < 0)
+			goto fail;
+		if (!test_transport_update(client, peer, s, NULL, &written))
+			goto fail;
+	}
+
+	if (client->deferred || (client->sent != sent + 1) || !region16_is_empty(&client->pending))
+		goto fail;
+
+	/* everything, including the deferred frame, arrives at the client */
+	for (size_t x = 0; (x < 1000) && (received < written); x++)
+	{
+		received += test_receive(reader);
+		if (peer->DrainOutputBuffer(peer) < 0)
+			goto fail;
+	}
+
+	rc = (received == written) && (freerdp_get_transport_unsent(peer->context) == 0);
+fail:
+	if (!rc)
+		printf("send queue: %" PRIuz " of %" PRIuz " bytes received\n", received, written);
+	if (peer)
+	{
+		freerdp_peer_context_free(peer);
+		freerdp_peer_free(peer);
+	}
+	if (writer >= 0)
+		close(writer);
+	if (reader >= 0)
+		close(reader);
+	freerdp_settings_free(settings);
+	Stream_Free(s, TRUE);
+	return rc;
+}
+#endif
+
+/* A client that stops receiving graphic updates keeps the damage without retrying */
+static BOOL test_inactive(void)
+{
+	BOOL deferred = TRUE;
+
+	if (shadow_client_pace_update(FALSE, TRUE, TRUE, &deferred) != SHADOW_CLIENT_UPDATE_MERGE)
+		return FALSE;
+	if (deferred)
+		return FALSE;
+
+	return shadow_client_pace_update(FALSE, FALSE, FALSE, &deferred) == SHADOW_CLIENT_UPDATE_NONE;
+}
+
+int TestShadowPacing(int argc, char* argv[])
+{
+	int rc = -1;
+	test_client client = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	region16_init(&client.pending);
+	region16_init(&client.delivered);
+
+	if (!test_drain(&client))
+	{
+		printf("TestShadowPacing: deferred frames were not delivered after the queue drained\n");
+		goto fail;
+	}
+
+	if (!test_inactive())
+	{
+		printf("TestShadowPacing: inactive client retries updates\n");
+		goto fail;
+	}
+
+#ifndef _WIN32
+	region16_clear(&client.pending);
+	region16_clear(&client.delivered);
+	client.deferred = FALSE;
+	client.sent = 0;
+	if (!test_send_queue(&client))
+	{
+		printf("TestShadowPacing: deferred frame was not sent after the transport drained\n");
+		goto fail;
+	}
+#endif
+
+	rc = 0;
+fail:
+	region16_uninit(&client.pending);
+	region16_uninit(&client.delivered);
+	return rc;
+}
@@ -0,0 +1,223 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+
+#include <freerdp/codec/region.h>
+
+#include "../shadow_surface.h"
+#include "../PipeWire/pipewire_frame.h"
+
+#define TEST_WIDTH 64
+#define TEST_HEIGHT 48
+#define TEST_STRIDE (TEST_WIDTH * 4 + 32)
+#define TEST_OFFSET 16
+#define TEST_SIZE (TEST_OFFSET + TEST_STRIDE * TEST_HEIGHT)
+
+static BOOL test_region_equal(const REGION16* region, const RECTANGLE_16* expected, size_t count)
+{
+	BOOL rc = FALSE;
+	REGION16 other = { 0 };
+
+	region16_init(&other);
+	for (size_t x = 0; x < count; x++)
+	{
+		if (!region16_union_rect(&other, &other, &expected[x]))
+			goto fail;
+	}
+
+	UINT32 na = 0;
+	UINT32 nb = 0;
+	const RECTANGLE_16* a = region16_rects(region, &na);
+	const RECTANGLE_16* b = region16_rects(&other, &nb);
+	if (na != nb)
+		goto fail;
+
+	for (UINT32 x = 0; x < na; x++)
+	{
+		if (!rectangles_equal(&a[x], &b[x]))
+			goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	region16_uninit(&other);
+	return rc;
+}
+
+static BOOL test_frame_data(void)
+{
+	BYTE buffer[TEST_SIZE] = { 0 };
+	UINT32 step = 0;
+	pipewireFrameState state = { 0 };
+
+	pipewire_frame_init(&state);
+	pipewire_frame_reset(&state, TEST_WIDTH, TEST_HEIGHT);
+
+	BOOL rc = FALSE;
+	if (pipewire_frame_data(&state, buffer, TEST_OFFSET, TEST_STRIDE, TEST_SIZE, &step) !=
+	        &buffer[TEST_OFFSET] ||
+	    (step != TEST_STRIDE))
+		goto fail;
+
+	/* producers may leave the stride out, lines are packed then */
+	if (!pipewire_frame_data(&state, buffer, 0, 0, TEST_SIZE, &step) ||
+	    (step != TEST_WIDTH * 4))
+		goto fail;
+
+	/* a line shorter than the frame */
+	if (pipewire_frame_data(&state, buffer, 0, TEST_WIDTH * 4 - 4, TEST_SIZE, &step))
+		goto fail;
+
+	/* the chunk does not hold the last line */
+	if (pipewire_frame_data(&state, buffer, TEST_OFFSET, TEST_STRIDE, TEST_SIZE - TEST_STRIDE,
+	                        &step))
+		goto fail;
+
+	/* unmapped buffer */
+	if (pipewire_frame_data(&state, NULL, 0, TEST_STRIDE, TEST_SIZE, &step))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	pipewire_frame_uninit(&state);
+	return rc;
+}
+
+static void test_fill(BYTE* data, BYTE value)
+{
+	for (size_t y = 0; y < TEST_HEIGHT; y++)
+		memset(&data[TEST_OFFSET + y * TEST_STRIDE], value, TEST_WIDTH * 4);
+}
+
+static BOOL test_import(pipewireFrameState* state, rdpShadowSurface* surface, BYTE* frame,
+                       const RECTANGLE_16* expected, size_t count)
+{
+	BOOL update = FALSE;
+	UINT32 step = 0;
+
+	BYTE* data = pipewire_frame_data(state, frame, TEST_OFFSET, TEST_STRIDE, TEST_SIZE, &step);
+	if (!pipewire_frame_attach(state, surface, data, step, TRUE, &update))
+		return FALSE;
+
+	if ((surface->data != data) || (surface->scanline != TEST_STRIDE))
+		return FALSE;
+
+	if (update != (count > 0))
+		return FALSE;
+
+	if (!test_region_equal(&surface->invalidRegion, expected, count))
+		return FALSE;
+
+	region16_clear(&surface->invalidRegion);
+	return !state->fullDamage && region16_is_empty(&state->damage);
+}
+
+static BOOL test_frames(void)
+{
+	BOOL rc = FALSE;
+	BOOL update = FALSE;
+	BYTE* own = NULL;
+	BYTE* frames[2] = { 0 };
+	pipewireFrameState state = { 0 };
+	const RECTANGLE_16 full = { 0, 0, TEST_WIDTH, TEST_HEIGHT };
+
+	pipewire_frame_init(&state);
+
+	rdpShadowSurface* surface = shadow_surface_new(NULL, 0, 0, TEST_WIDTH, TEST_HEIGHT);
+	if (!surface)
+		goto fail;
+
+	own = surface->data;
+	for (size_t x = 0; x < ARRAYSIZE(frames); x++)
+	{
+		frames[x] = calloc(1, TEST_SIZE);
+		if (!frames[x])
+			goto fail;
+		test_fill(frames[x], (BYTE)(0x40 + x));
+	}
+
+	/* the first frame after the format is negotiated is sent in full */
+	pipewire_frame_reset(&state, TEST_WIDTH, TEST_HEIGHT);
+	if (!test_import(&state, surface, frames[0], &full, 1))
+		goto fail;
+
+	/* damage of skipped frames is merged and clipped to the stream size */
+	{
+		const pipewireFrameRect skipped[] = { { 4, 4, 8, 8 } };
+		const pipewireFrameRect newest[] = { { -8, 40, 16, 16 }, { 100, 100, 4, 4 } };
+		const RECTANGLE_16 expected[] = { { 4, 4, 12, 12 }, { 0, 40, 8, 48 } };
+
+		pipewire_frame_add_damage(&state, skipped, ARRAYSIZE(skipped));
+		pipewire_frame_add_damage(&state, newest, ARRAYSIZE(newest));
+		if (!test_import(&state, surface, frames[1], expected, ARRAYSIZE(expected)))
+			goto fail;
+	}
+
+	/* damage entirely outside of the frame does not tell what changed */
+	{
+		const pipewireFrameRect outside[] = { { TEST_WIDTH, 0, 4, 4 } };
+
+		pipewire_frame_add_damage(&state, outside, ARRAYSIZE(outside));
+		if (!test_import(&state, surface, frames[0], &full, 1))
+			goto fail;
+	}
+
+	/* neither do buffers without damage metadata */
+	pipewire_frame_add_damage(&state, NULL, 0);
+	if (!test_import(&state, surface, frames[1], &full, 1))
+		goto fail;
+
+	/* frames of the old size are dropped after a resize, the next fitting one is sent in full */
+	pipewire_frame_reset(&state, TEST_WIDTH / 2, TEST_HEIGHT);
+	if (pipewire_frame_attach(&state, surface, &frames[0][TEST_OFFSET], TEST_STRIDE, TRUE,
+	                          &update) ||
+	    update || !state.fullDamage || (surface->data != &frames[1][TEST_OFFSET]))
+		goto fail;
+	pipewire_frame_reset(&state, TEST_WIDTH, TEST_HEIGHT);
+
+	/* the surface gets its own buffer back with the last frame in it */
+	if (!pipewire_frame_detach(&state, surface) || (surface->data != own))
+		goto fail;
+
+	for (size_t y = 0; y < TEST_HEIGHT; y++)
+	{
+		for (size_t x = 0; x < TEST_WIDTH * 4; x++)
+		{
+			if (surface->data[y * surface->scanline + x] != 0x41)
+				goto fail;
+		}
+	}
+
+	if (pipewire_frame_detach(&state, surface))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	if (surface && (surface->data != own))
+		(void)pipewire_frame_detach(&state, surface);
+	shadow_surface_free(surface);
+	for (size_t x = 0; x < ARRAYSIZE(frames); x++)
+		free(frames[x]);
+	pipewire_frame_uninit(&state);
+	return rc;
+}
+
+int TestShadowPipeWire(int argc, char* argv[])
+{
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	if (!test_frame_data())
+	{
+		printf("TestShadowPipeWire: frame buffer validation failed\n");
+		return -1;
+	}
+
+	if (!test_frames())
+	{
+		printf("TestShadowPipeWire: frame import failed\n");
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,185 @@
+#include <stdio.h>
+
+#include <winpr/crt.h>
+#include <winpr/collections.h>
+
+#include <freerdp/server/shadow.h>
+
+#include "../shadow_surface.h"
+#include "../Synthetic/synthetic_shadow.h"
+
+#define TEST_WIDTH 128
+#define TEST_HEIGHT 96
+#define TEST_FRAMES 6
+
+typedef struct
+{
+	rdpShadowServer server;
+	syntheticShadowSubsystem* subsystem;
+	RDP_SHADOW_ENTRY_POINTS ep;
+} TestSynthetic;
+
+static void test_synthetic_free(TestSynthetic* test)
+{
+	if (!test)
+		return;
+
+	if (test->subsystem)
+		test->ep.Free(&test->subsystem->base);
+	shadow_surface_free(test->server.surface);
+	ArrayList_Free(test->server.clients);
+	free(test);
+}
+
+static TestSynthetic* test_synthetic_new(const char* options)
+{
+	TestSynthetic* test = calloc(1, sizeof(TestSynthetic));
+	if (!test)
+		return NULL;
+
+	if (synthetic_shadow_subsystem_entry(&test->ep) < 0)
+		goto fail;
+
+	test->subsystem = (syntheticShadowSubsystem*)test->ep.New();
+	if (!test->subsystem)
+		goto fail;
+	test->subsystem->base.server = &test->server;
+
+	if (!synthetic_shadow_parse_options(test->subsystem, options))
+		goto fail;
+
+	/* frames are only generated while a client is connected */
+	test->server.clients = ArrayList_New(FALSE);
+	if (!test->server.clients || !ArrayList_Append(test->server.clients, test))
+		goto fail;
+
+	test->server.surface =
+	    shadow_surface_new(&test->server, 0, 0, test->subsystem->width, test->subsystem->height);
+	if (!test->server.surface)
+		goto fail;
+
+	return test;
+fail:
+	test_synthetic_free(test);
+	return NULL;
+}
+
+/* Generates frames 0 to TEST_FRAMES - 1 and returns a copy of the last one */
+static BYTE* test_synthetic_frames(const char* options)
+{
+	BYTE* frame = NULL;
+	TestSynthetic* test = test_synthetic_new(options);
+	if (!test)
+		return NULL;
+
+	for (size_t x = 0; x < TEST_FRAMES; x++)
+	{
+		if (synthetic_shadow_generate_frame(test->subsystem) < 0)
+			goto fail;
+	}
+
+	if (test->subsystem->frame != TEST_FRAMES)
+		goto fail;
+
+	const rdpShadowSurface* surface = test->server.surface;
+	frame = malloc(1ull * surface->scanline * surface->height);
+	if (frame)
+		memcpy(frame, surface->data, 1ull * surface->scanline * surface->height);
+
+fail:
+	test_synthetic_free(test);
+	return frame;
+}
+
+static BOOL test_deterministic(const char* pattern)
+{
+	BOOL rc = FALSE;
+	char options[128] = { 0 };
+	char other[128] = { 0 };
+	const size_t size = 1ull * TEST_WIDTH * 4 * TEST_HEIGHT;
+
+	(void)_snprintf(options, sizeof(options), "pattern:%s,size:%dx%d,seed:42", pattern, TEST_WIDTH,
+	                TEST_HEIGHT);
+	(void)_snprintf(other, sizeof(other), "pattern:%s,size:%dx%d,seed:43", pattern, TEST_WIDTH,
+	                TEST_HEIGHT);
+
+	BYTE* a = test_synthetic_frames(options);
+	BYTE* b = test_synthetic_frames(options);
+	BYTE* c = test_synthetic_frames(other);
+	if (!a || !b || !c)
+		goto fail;
+
+	if (memcmp(a, b, size) != 0)
+	{
+		printf("pattern '%s': frame %d differs with the same seed\n", pattern, TEST_FRAMES);
+		goto fail;
+	}
+
+	/* the cursor pattern does not use random data */
+	if ((strcmp(pattern, "cursor") != 0) && (memcmp(a, c, size) == 0))
+	{
+		printf("pattern '%s': frame %d does not depend on the seed\n", pattern, TEST_FRAMES);
+		goto fail;
+	}
+
+	rc = TRUE;
+fail:
+	free(a);
+	free(b);
+	free(c);
+	return rc;
+}
+
+static BOOL test_options(void)
+{
+	const char* valid[] = { NULL,         "pattern:noise",   "pattern:FLIP,fps:1",
+		                    "size:64x8192", "seed:4294967295", "fps:1000,seed:0x10" };
+	const char* invalid[] = { "size:63x64",      "size:64x8193", "size:640",     "size:640x",
+		                      "size:x480",       "size:640x480x1", "fps:0",      "fps:1001",
+		                      "fps:",            "fps:30hz",     "seed:",        "seed:-",
+		                      "seed:4294967296", "seed:1a",      "pattern:blur", "seed",
+		                      "colors:16" };
+
+	for (size_t x = 0; x < ARRAYSIZE(valid); x++)
+	{
+		TestSynthetic* test = test_synthetic_new(valid[x]);
+		if (!test)
+		{
+			printf("options '%s' were rejected\n", valid[x] ? valid[x] : "");
+			return FALSE;
+		}
+		test_synthetic_free(test);
+	}
+
+	for (size_t x = 0; x < ARRAYSIZE(invalid); x++)
+	{
+		TestSynthetic* test = test_synthetic_new(invalid[x]);
+		if (test)
+		{
+			printf("options '%s' were accepted\n", invalid[x]);
+			test_synthetic_free(test);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+int TestShadowSynthetic(int argc, char* argv[])
+{
+	const char* patterns[] = { "scroll", "noise", "cursor", "flip" };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	for (size_t x = 0; x < ARRAYSIZE(patterns); x++)
+	{
+		if (!test_deterministic(patterns[x]))
+			return -1;
+	}
+
+	if (!test_options())
+		return -1;
+
+	return 0;
+}
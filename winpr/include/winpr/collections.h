@@ -731,6 +731,20 @@ extern "C"
 	WINPR_API int MessageQueue_Get(wMessageQueue* queue, wMessage* message);
 	WINPR_API int MessageQueue_Peek(wMessageQueue* queue, wMessage* message, BOOL remove);
 
+	/*! \brief Remove up to \b count messages from the queue with a single lock round trip.
+	 *
+	 *  A WMQ_QUIT message is always the last message of a batch.
+	 *
+	 *  \param queue The queue to drain
+	 *  \param messages An array of at least \b count messages receiving the drained messages
+	 *  \param count The maximum number of messages to drain
+	 *
+	 *  \return The number of messages drained, \b 0 if the queue is empty
+	 *  \since version 3.16.0
+	 */
+	WINPR_API size_t MessageQueue_DrainBatch(wMessageQueue* queue, wMessage* messages,
+	                                         size_t count);
+
 	/*! \brief Clears all elements in a message queue.
 	 *
 	 *  \note If dynamically allocated data is part of the messages,
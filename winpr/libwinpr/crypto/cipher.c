@@ -21,6 +21,7 @@
 #include <winpr/crt.h>
 #include <winpr/assert.h>
 #include <winpr/crypto.h>
+#include <winpr/interlocked.h>
 
 #include "../log.h"
 #define TAG WINPR_TAG("crypto.cipher")
@@ -278,7 +279,7 @@ WINPR_CIPHER_TYPE winpr_cipher_type_from_string(const char* name)
 }
 
 #if defined(WITH_OPENSSL)
-static const EVP_CIPHER* winpr_openssl_get_evp_cipher(WINPR_CIPHER_TYPE cipher)
+static const EVP_CIPHER* winpr_openssl_lookup_evp_cipher(WINPR_CIPHER_TYPE cipher)
 {
 	const EVP_CIPHER* evp = NULL;
 
@@ -482,6 +483,42 @@ static const EVP_CIPHER* winpr_openssl_get_evp_cipher(WINPR_CIPHER_TYPE cipher)
 	return evp;
 }
 
+/* The resolved ciphers are kept for the lifetime of the process, see winpr_openssl_get_evp_md */
+static PVOID volatile s_evp_cipher_cache[WINPR_CIPHER_CAMELLIA_256_CCM + 1] = { 0 };
+
+static const EVP_CIPHER* winpr_openssl_get_evp_cipher(WINPR_CIPHER_TYPE cipher)
+{
+	if ((size_t)cipher >= ARRAYSIZE(s_evp_cipher_cache))
+		return winpr_openssl_lookup_evp_cipher(cipher);
+
+	PVOID volatile* slot = &s_evp_cipher_cache[cipher];
+	const EVP_CIPHER* evp = InterlockedCompareExchangePointer(slot, NULL, NULL);
+	if (evp)
+		return evp;
+
+	evp = winpr_openssl_lookup_evp_cipher(cipher);
+	if (!evp)
+		return NULL;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	/* An explicitly fetched cipher is not looked up again by EVP_CipherInit_ex */
+	EVP_CIPHER* fetched = EVP_CIPHER_fetch(NULL, EVP_CIPHER_get0_name(evp), NULL);
+	if (fetched)
+	{
+		void* cur = InterlockedCompareExchangePointer(slot, fetched, NULL);
+		if (!cur)
+			return fetched;
+
+		/* another thread was faster, use the cached object */
+		EVP_CIPHER_free(fetched);
+		return cur;
+	}
+#endif
+
+	(void)InterlockedCompareExchangePointer(slot, WINPR_CAST_CONST_PTR_AWAY(evp, void*), NULL);
+	return evp;
+}
+
 #elif defined(WITH_MBEDTLS)
 mbedtls_cipher_type_t winpr_mbedtls_get_cipher_type(int cipher)
 {
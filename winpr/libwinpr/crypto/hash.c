@@ -21,6 +21,7 @@
 #include <winpr/crt.h>
 #include <winpr/assert.h>
 #include <winpr/crypto.h>
+#include <winpr/interlocked.h>
 
 #ifdef WITH_OPENSSL
 #include <openssl/md4.h>
@@ -65,12 +66,91 @@ extern const EVP_MD* winpr_openssl_get_evp_md(WINPR_MD_TYPE md);
 #endif
 
 #ifdef WITH_OPENSSL
+/* Resolving an algorithm by name is not cheap, OpenSSL 3 even fetches it from the providers on
+ * every initialization. The resolved objects are kept for the lifetime of the process. */
+static PVOID volatile s_evp_md_cache[WINPR_MD_SHAKE256 + 1] = { 0 };
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+static PVOID volatile s_evp_mac_hmac = NULL;
+#if !defined(WITH_INTERNAL_MD5)
+static PVOID volatile s_evp_md5_non_fips = NULL;
+#endif
+
+static void* winpr_openssl_cache_fetched(PVOID volatile* slot, void* fetched,
+                                         void (*free_fkt)(void*))
+{
+	WINPR_ASSERT(slot);
+
+	if (!fetched)
+		return NULL;
+
+	void* cur = InterlockedCompareExchangePointer(slot, fetched, NULL);
+	if (!cur)
+		return fetched;
+
+	/* another thread was faster, use the cached object */
+	free_fkt(fetched);
+	return cur;
+}
+
+static void winpr_openssl_free_md(void* md)
+{
+	EVP_MD_free(md);
+}
+
+static void winpr_openssl_free_mac(void* mac)
+{
+	EVP_MAC_free(mac);
+}
+
+static EVP_MAC* winpr_openssl_get_evp_mac_hmac(void)
+{
+	void* mac = InterlockedCompareExchangePointer(&s_evp_mac_hmac, NULL, NULL);
+	if (mac)
+		return mac;
+
+	return winpr_openssl_cache_fetched(&s_evp_mac_hmac, EVP_MAC_fetch(NULL, "HMAC", NULL),
+	                                   winpr_openssl_free_mac);
+}
+
+#if !defined(WITH_INTERNAL_MD5)
+static const EVP_MD* winpr_openssl_get_evp_md5_non_fips(void)
+{
+	void* md = InterlockedCompareExchangePointer(&s_evp_md5_non_fips, NULL, NULL);
+	if (md)
+		return md;
+
+	return winpr_openssl_cache_fetched(&s_evp_md5_non_fips, EVP_MD_fetch(NULL, "MD5", "fips=no"),
+	                                   winpr_openssl_free_md);
+}
+#endif
+#endif
+
 const EVP_MD* winpr_openssl_get_evp_md(WINPR_MD_TYPE md)
 {
 	const char* name = winpr_md_type_to_string(md);
 	if (!name)
 		return NULL;
-	return EVP_get_digestbyname(name);
+
+	if ((size_t)md >= ARRAYSIZE(s_evp_md_cache))
+		return EVP_get_digestbyname(name);
+
+	PVOID volatile* slot = &s_evp_md_cache[md];
+	const EVP_MD* evp = InterlockedCompareExchangePointer(slot, NULL, NULL);
+	if (evp)
+		return evp;
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	/* An explicitly fetched digest is not looked up again by EVP_DigestInit_ex */
+	evp = winpr_openssl_cache_fetched(slot, EVP_MD_fetch(NULL, name, NULL), winpr_openssl_free_md);
+	if (evp)
+		return evp;
+#endif
+
+	evp = EVP_get_digestbyname(name);
+	if (evp)
+		(void)InterlockedCompareExchangePointer(slot, WINPR_CAST_CONST_PTR_AWAY(evp, void*), NULL);
+	return evp;
 }
 #endif
 
@@ -165,6 +245,7 @@ struct winpr_hmac_ctx_private_st
 #if defined(WITH_OPENSSL)
 #if OPENSSL_VERSION_NUMBER >= 0x30000000L
 	EVP_MAC_CTX* xhmac;
+	WINPR_MD_TYPE xhmac_md;
 #else
 	HMAC_CTX* hmac;
 #endif
@@ -191,11 +272,10 @@ WINPR_HMAC_CTX* winpr_HMAC_New(void)
 	if (!(ctx->hmac = HMAC_CTX_new()))
 		goto fail;
 #else
-	EVP_MAC* emac = EVP_MAC_fetch(NULL, "HMAC", NULL);
+	EVP_MAC* emac = winpr_openssl_get_evp_mac_hmac();
 	if (!emac)
 		goto fail;
 	ctx->xhmac = EVP_MAC_CTX_new(emac);
-	EVP_MAC_free(emac);
 	if (!ctx->xhmac)
 		goto fail;
 #endif
@@ -239,8 +319,14 @@ BOOL winpr_HMAC_Init(WINPR_HMAC_CTX* ctx, WINPR_MD_TYPE md, const void* key, siz
 	const OSSL_PARAM param[] = { OSSL_PARAM_construct_utf8_string(param_name, hash, 0),
 		                         OSSL_PARAM_construct_end() };
 
-	if (EVP_MAC_init(ctx->xhmac, key, keylen, param) == 1)
+	/* Setting the digest fetches it again, skip that when the context is reused */
+	const BOOL reuse = (ctx->xhmac_md == md) && (md != WINPR_MD_NONE);
+	if (EVP_MAC_init(ctx->xhmac, key, keylen, reuse ? NULL : param) == 1)
+	{
+		ctx->xhmac_md = md;
 		return TRUE;
+	}
+	ctx->xhmac_md = WINPR_MD_NONE;
 #else
 	HMAC_CTX* hmac = ctx->hmac;
 	const EVP_MD* evp = winpr_openssl_get_evp_md(md);
@@ -544,10 +630,8 @@ BOOL winpr_Digest_Init_Allow_FIPS(WINPR_DIGEST_CTX* ctx, WINPR_MD_TYPE md)
 #if !defined(WITH_INTERNAL_MD5)
 			if (md == WINPR_MD_MD5)
 			{
-				EVP_MD* md5 = EVP_MD_fetch(NULL, "MD5", "fips=no");
-				BOOL rc = winpr_Digest_Init_Internal(ctx, md5);
-				EVP_MD_free(md5);
-				return rc;
+				const EVP_MD* md5 = winpr_openssl_get_evp_md5_non_fips();
+				return winpr_Digest_Init_Internal(ctx, md5);
 			}
 #endif
 #endif
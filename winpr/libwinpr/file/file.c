@@ -45,6 +45,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 #ifdef ANDROID
 #include <sys/vfs.h>
@@ -110,6 +111,70 @@ static BOOL FileCloseHandle(HANDLE handle)
 	return FileCloseHandleInt(handle, FALSE);
 }
 
+static INT64 FileTell(WINPR_FILE* pFile)
+{
+	WINPR_ASSERT(pFile);
+
+	if (pFile->positional)
+		return pFile->offset;
+	return _ftelli64(pFile->fp);
+}
+
+static BOOL FileSeek(WINPR_FILE* pFile, INT64 offset, int whence)
+{
+	WINPR_ASSERT(pFile);
+
+	if (!pFile->positional)
+		return _fseeki64(pFile->fp, offset, whence) == 0;
+
+	/* Only the tracked offset moves, the next read or write passes it to the kernel */
+	INT64 base = 0;
+	switch (whence)
+	{
+		case SEEK_CUR:
+			base = pFile->offset;
+			break;
+		case SEEK_END:
+		{
+			struct stat st = { 0 };
+			if (fstat(fileno(pFile->fp), &st) != 0)
+				return FALSE;
+			base = st.st_size;
+		}
+		break;
+		default:
+			break;
+	}
+
+	if (((offset > 0) && (base > INT64_MAX - offset)) || (base + offset < 0))
+	{
+		errno = EINVAL;
+		return FALSE;
+	}
+
+	pFile->offset = base + offset;
+	return TRUE;
+}
+
+static void FileAdviseRead(WINPR_FILE* pFile, INT64 offset)
+{
+	WINPR_ASSERT(pFile);
+
+#if defined(WINPR_HAVE_POSIX_FADVISE)
+	/* Drive redirection reads large files in consecutive chunks, each at an explicit offset.
+	 * Let the kernel read ahead more aggressively while that is the case. */
+	const BOOL sequential = (offset == pFile->readEnd);
+	if (sequential != pFile->sequential)
+	{
+		pFile->sequential = sequential;
+		(void)posix_fadvise(fileno(pFile->fp), 0, 0,
+		                    sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL);
+	}
+#else
+	WINPR_UNUSED(offset);
+#endif
+}
+
 static BOOL FileSetEndOfFile(HANDLE hFile)
 {
 	WINPR_FILE* pFile = (WINPR_FILE*)hFile;
@@ -117,7 +182,7 @@ static BOOL FileSetEndOfFile(HANDLE hFile)
 	if (!hFile)
 		return FALSE;
 
-	const INT64 size = _ftelli64(pFile->fp);
+	const INT64 size = FileTell(pFile);
 	if (size < 0)
 		return FALSE;
 
@@ -169,7 +234,7 @@ static DWORD FileSetFilePointer(HANDLE hFile, LONG lDistanceToMove,
 			return INVALID_SET_FILE_POINTER;
 	}
 
-	if (_fseeki64(pFile->fp, offset, whence))
+	if (!FileSeek(pFile, offset, whence))
 	{
 		char ebuffer[256] = { 0 };
 		WLog_ERR(TAG, "_fseeki64(%s) failed with %s [0x%08X]", pFile->lpFileName,
@@ -178,7 +243,7 @@ static DWORD FileSetFilePointer(HANDLE hFile, LONG lDistanceToMove,
 		return INVALID_SET_FILE_POINTER;
 	}
 
-	return (DWORD)_ftelli64(pFile->fp);
+	return (DWORD)FileTell(pFile);
 }
 
 static BOOL FileSetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove,
@@ -205,7 +270,7 @@ static BOOL FileSetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove,
 			return FALSE;
 	}
 
-	if (_fseeki64(pFile->fp, liDistanceToMove.QuadPart, whence))
+	if (!FileSeek(pFile, liDistanceToMove.QuadPart, whence))
 	{
 		char ebuffer[256] = { 0 };
 		WLog_ERR(TAG, "_fseeki64(%s) failed with %s [0x%08X]", pFile->lpFileName,
@@ -215,11 +280,66 @@ static BOOL FileSetFilePointerEx(HANDLE hFile, LARGE_INTEGER liDistanceToMove,
 	}
 
 	if (lpNewFilePointer)
-		lpNewFilePointer->QuadPart = _ftelli64(pFile->fp);
+		lpNewFilePointer->QuadPart = FileTell(pFile);
 
 	return TRUE;
 }
 
+static BOOL FilePositionalRead(WINPR_FILE* file, BYTE* buffer, DWORD length, DWORD* done)
+{
+	WINPR_ASSERT(file);
+	WINPR_ASSERT(done);
+
+	FileAdviseRead(file, file->offset);
+
+	*done = 0;
+	while (*done < length)
+	{
+		const ssize_t rc =
+		    pread(fileno(file->fp), &buffer[*done], length - *done, (off_t)(file->offset + *done));
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (*done > 0)
+				break;
+			return FALSE;
+		}
+		if (rc == 0)
+			break;
+		*done += (DWORD)rc;
+	}
+
+	file->offset += *done;
+	file->readEnd = file->offset;
+	return TRUE;
+}
+
+static BOOL FilePositionalWrite(WINPR_FILE* file, const BYTE* buffer, DWORD length, DWORD* done)
+{
+	WINPR_ASSERT(file);
+	WINPR_ASSERT(done);
+
+	*done = 0;
+	while (*done < length)
+	{
+		const ssize_t rc = pwrite(fileno(file->fp), &buffer[*done], length - *done,
+		                          (off_t)(file->offset + *done));
+		if (rc < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (*done > 0)
+				break;
+			return FALSE;
+		}
+		*done += (DWORD)rc;
+	}
+
+	file->offset += *done;
+	return TRUE;
+}
+
 static BOOL FileRead(PVOID Object, LPVOID lpBuffer, DWORD nNumberOfBytesToRead,
                      LPDWORD lpNumberOfBytesRead, LPOVERLAPPED lpOverlapped)
 {
@@ -238,10 +358,22 @@ static BOOL FileRead(PVOID Object, LPVOID lpBuffer, DWORD nNumberOfBytesToRead,
 		return FALSE;
 
 	file = (WINPR_FILE*)Object;
-	clearerr(file->fp);
-	io_status = fread(lpBuffer, 1, nNumberOfBytesToRead, file->fp);
 
-	if (io_status == 0 && ferror(file->fp))
+	if (file->positional)
+	{
+		DWORD done = 0;
+		status = FilePositionalRead(file, lpBuffer, nNumberOfBytesToRead, &done);
+		io_status = done;
+		if (!status)
+			SetLastError((errno == EWOULDBLOCK) ? ERROR_NO_DATA : map_posix_err(errno));
+	}
+	else
+	{
+		clearerr(file->fp);
+		io_status = fread(lpBuffer, 1, nNumberOfBytesToRead, file->fp);
+	}
+
+	if (!file->positional && (io_status == 0) && ferror(file->fp))
 	{
 		status = FALSE;
 
@@ -279,6 +411,19 @@ static BOOL FileWrite(PVOID Object, LPCVOID lpBuffer, DWORD nNumberOfBytesToWrit
 
 	file = (WINPR_FILE*)Object;
 
+	if (file->positional)
+	{
+		DWORD done = 0;
+		if (!FilePositionalWrite(file, lpBuffer, nNumberOfBytesToWrite, &done))
+		{
+			SetLastError(map_posix_err(errno));
+			return FALSE;
+		}
+
+		*lpNumberOfBytesWritten = done;
+		return TRUE;
+	}
+
 	clearerr(file->fp);
 	io_status = fwrite(lpBuffer, 1, nNumberOfBytesToWrite, file->fp);
 	if (io_status == 0 && ferror(file->fp))
@@ -302,6 +447,23 @@ static DWORD FileGetFileSize(HANDLE Object, LPDWORD lpFileSizeHigh)
 
 	file = (WINPR_FILE*)Object;
 
+	if (file->positional)
+	{
+		struct stat st = { 0 };
+		if (fstat(fileno(file->fp), &st) != 0)
+		{
+			char ebuffer[256] = { 0 };
+			WLog_ERR(TAG, "fstat(%s) failed with %s [0x%08X]", file->lpFileName,
+			         winpr_strerror(errno, ebuffer, sizeof(ebuffer)), errno);
+			SetLastError(map_posix_err(errno));
+			return INVALID_FILE_SIZE;
+		}
+
+		if (lpFileSizeHigh)
+			*lpFileSizeHigh = (UINT32)(((UINT64)st.st_size) >> 32);
+		return (UINT32)(st.st_size & 0xFFFFFFFF);
+	}
+
 	cur = _ftelli64(file->fp);
 
 	if (cur < 0)
@@ -1051,6 +1213,16 @@ static HANDLE FileCreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dw
 		}
 	}
 
+	/* Pipes and devices keep using the stream, they can not be accessed at an offset */
+	if ((fstat(fileno(pFile->fp), &st) == 0) && S_ISREG(st.st_mode))
+	{
+		pFile->positional = TRUE;
+		pFile->offset = _ftelli64(pFile->fp);
+		pFile->readEnd = -1;
+		if (pFile->offset < 0)
+			pFile->positional = FALSE;
+	}
+
 	SetLastError(STATUS_SUCCESS);
 	return pFile;
 }
@@ -54,6 +54,13 @@ struct winpr_file
 	HANDLE hTemplateFile;
 
 	BOOL bLocked;
+
+	/* Regular files are accessed with pread/pwrite at the offset tracked here instead of
+	 * going through the stdio stream. */
+	BOOL positional;
+	INT64 offset;
+	INT64 readEnd;
+	BOOL sequential;
 };
 typedef struct winpr_file WINPR_FILE;
 
@@ -2,9 +2,134 @@
 #include <stdio.h>
 #include <winpr/crt.h>
 #include <winpr/file.h>
+#include <winpr/path.h>
+#include <winpr/thread.h>
 #include <winpr/windows.h>
 
+#define TEST_FILE_SIZE (256 * 1024)
+
+static BOOL test_seek(HANDLE hdl, INT64 offset, DWORD method, INT64 expected)
+{
+	LARGE_INTEGER distance = { 0 };
+	LARGE_INTEGER position = { 0 };
+
+	distance.QuadPart = offset;
+	if (!SetFilePointerEx(hdl, distance, &position, method))
+		return FALSE;
+	return position.QuadPart == expected;
+}
+
+static BOOL test_read_at(HANDLE hdl, const BYTE* data, INT64 offset, DWORD length,
+                         DWORD expected)
+{
+	BOOL rc = FALSE;
+	DWORD read = 0;
+	BYTE* buffer = calloc(1, length);
+	if (!buffer)
+		return FALSE;
+
+	if (!test_seek(hdl, offset, FILE_BEGIN, offset))
+		goto fail;
+	if (!ReadFile(hdl, buffer, length, &read, NULL))
+		goto fail;
+	if (read != expected)
+		goto fail;
+	if (memcmp(buffer, &data[offset], read) != 0)
+		goto fail;
+
+	/* the file pointer moved past the data read */
+	rc = test_seek(hdl, 0, FILE_CURRENT, offset + read);
+fail:
+	free(buffer);
+	return rc;
+}
+
+static BOOL test_file(const char* filename, BYTE* data)
+{
+	BOOL rc = FALSE;
+	DWORD written = 0;
+	DWORD high = 0;
+
+	HANDLE hdl = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+	                         FILE_ATTRIBUTE_NORMAL, NULL);
+	if (!hdl || (hdl == INVALID_HANDLE_VALUE))
+		return FALSE;
+
+	if (!WriteFile(hdl, data, TEST_FILE_SIZE, &written, NULL) || (written != TEST_FILE_SIZE))
+		goto fail;
+	if (GetFileSize(hdl, &high) != TEST_FILE_SIZE)
+		goto fail;
+
+	/* sequential chunks, then random access and a short read at the end */
+	for (INT64 offset = 0; offset < TEST_FILE_SIZE; offset += 4096)
+	{
+		if (!test_read_at(hdl, data, offset, 4096, 4096))
+			goto fail;
+	}
+	if (!test_read_at(hdl, data, 12345, 777, 777))
+		goto fail;
+	if (!test_read_at(hdl, data, TEST_FILE_SIZE - 100, 4096, 100))
+		goto fail;
+
+	/* overwrite in the middle and relative to the end */
+	memset(&data[1000], 0xAB, 64);
+	if (!test_seek(hdl, 1000, FILE_BEGIN, 1000))
+		goto fail;
+	if (!WriteFile(hdl, &data[1000], 64, &written, NULL) || (written != 64))
+		goto fail;
+	if (!test_seek(hdl, 0, FILE_CURRENT, 1064))
+		goto fail;
+	if (!test_read_at(hdl, data, 900, 300, 300))
+		goto fail;
+	if (!test_seek(hdl, -16, FILE_END, TEST_FILE_SIZE - 16))
+		goto fail;
+	if (test_seek(hdl, -1, FILE_BEGIN, 0))
+		goto fail;
+
+	/* truncate at the current file pointer */
+	if (!test_seek(hdl, 4096, FILE_BEGIN, 4096))
+		goto fail;
+	if (!SetEndOfFile(hdl))
+		goto fail;
+	if (GetFileSize(hdl, &high) != 4096)
+		goto fail;
+	if (!test_read_at(hdl, data, 4000, 4096, 96))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	(void)CloseHandle(hdl);
+	return rc;
+}
+
 int TestFileReadFile(int argc, char* argv[])
 {
-	return 0;
+	int rc = -1;
+	char name[64] = { 0 };
+
+	WINPR_UNUSED(argc);
+	WINPR_UNUSED(argv);
+
+	BYTE* data = malloc(TEST_FILE_SIZE);
+	if (!data)
+		return -1;
+	for (size_t x = 0; x < TEST_FILE_SIZE; x++)
+		data[x] = (BYTE)(x * 7 + x / 251);
+
+	(void)_snprintf(name, sizeof(name), "TestFileReadFile-%" PRIu32 ".bin",
+	                GetCurrentProcessId());
+	char* filename = GetKnownSubPath(KNOWN_PATH_TEMP, name);
+	if (!filename)
+		goto fail;
+
+	if (test_file(filename, data))
+		rc = 0;
+	else
+		printf("TestFileReadFile failed for %s\n", filename);
+
+	(void)DeleteFileA(filename);
+fail:
+	free(filename);
+	free(data);
+	return rc;
 }
@@ -344,6 +344,8 @@ static void ntlm_ContextFree(NTLM_CONTEXT* context)
 
 	winpr_RC4_Free(context->SendRc4Seal);
 	winpr_RC4_Free(context->RecvRc4Seal);
+	winpr_HMAC_Free(context->SendHmac);
+	winpr_HMAC_Free(context->RecvHmac);
 	sspi_SecBufferFree(&context->NegotiateMessage);
 	sspi_SecBufferFree(&context->ChallengeMessage);
 	sspi_SecBufferFree(&context->AuthenticateMessage);
@@ -1047,12 +1049,36 @@ static SECURITY_STATUS SEC_ENTRY ntlm_RevertSecurityContext(WINPR_ATTR_UNUSED PC
 	return SEC_E_OK;
 }
 
+/* Compute the HMAC-MD5 hash of ConcatenationOf(seq_num,data). The HMAC context is kept with the
+ * NTLM context so signing a message does not allocate. */
+static BOOL ntlm_compute_message_digest(WINPR_HMAC_CTX** phmac, const BYTE* key, UINT32 SeqNo,
+                                        const void* data, size_t length,
+                                        BYTE digest[WINPR_MD5_DIGEST_LENGTH])
+{
+	BYTE seq[4] = { 0 };
+
+	WINPR_ASSERT(phmac);
+
+	if (!*phmac)
+		*phmac = winpr_HMAC_New();
+	if (!*phmac)
+		return FALSE;
+
+	winpr_Data_Write_UINT32(seq, SeqNo);
+	if (!winpr_HMAC_Init(*phmac, WINPR_MD_MD5, key, WINPR_MD5_DIGEST_LENGTH))
+		return FALSE;
+	if (!winpr_HMAC_Update(*phmac, seq, sizeof(seq)))
+		return FALSE;
+	if (!winpr_HMAC_Update(*phmac, data, length))
+		return FALSE;
+	return winpr_HMAC_Final(*phmac, digest, WINPR_MD5_DIGEST_LENGTH);
+}
+
 static SECURITY_STATUS SEC_ENTRY ntlm_EncryptMessage(PCtxtHandle phContext,
                                                      WINPR_ATTR_UNUSED ULONG fQOP,
                                                      PSecBufferDesc pMessage, ULONG MessageSeqNo)
 {
 	const UINT32 SeqNo = MessageSeqNo;
-	UINT32 value = 0;
 	BYTE digest[WINPR_MD5_DIGEST_LENGTH] = { 0 };
 	BYTE checksum[8] = { 0 };
 	ULONG version = 1;
@@ -1078,50 +1104,30 @@ static SECURITY_STATUS SEC_ENTRY ntlm_EncryptMessage(PCtxtHandle phContext,
 	if (!signature_buffer)
 		return SEC_E_INVALID_TOKEN;
 
-	/* Copy original data buffer */
-	ULONG length = data_buffer->cbBuffer;
-	void* data = malloc(length);
-
-	if (!data)
-		return SEC_E_INSUFFICIENT_MEMORY;
+	const ULONG length = data_buffer->cbBuffer;
 
-	CopyMemory(data, data_buffer->pvBuffer, length);
 	/* Compute the HMAC-MD5 hash of ConcatenationOf(seq_num,data) using the client signing key */
-	WINPR_HMAC_CTX* hmac = winpr_HMAC_New();
+	if (!ntlm_compute_message_digest(&context->SendHmac, context->SendSigningKey, SeqNo,
+	                                 data_buffer->pvBuffer, length, digest))
+		return SEC_E_INTERNAL_ERROR;
 
-	if (hmac &&
-	    winpr_HMAC_Init(hmac, WINPR_MD_MD5, context->SendSigningKey, WINPR_MD5_DIGEST_LENGTH))
-	{
-		winpr_Data_Write_UINT32(&value, SeqNo);
-		winpr_HMAC_Update(hmac, (void*)&value, 4);
-		winpr_HMAC_Update(hmac, data, length);
-		winpr_HMAC_Final(hmac, digest, WINPR_MD5_DIGEST_LENGTH);
-		winpr_HMAC_Free(hmac);
-	}
-	else
-	{
-		winpr_HMAC_Free(hmac);
-		free(data);
-		return SEC_E_INSUFFICIENT_MEMORY;
-	}
+#ifdef WITH_DEBUG_NTLM
+	WLog_DBG(TAG, "Data Buffer (length = %" PRIu32 ")", length);
+	winpr_HexDump(TAG, WLOG_DEBUG, data_buffer->pvBuffer, length);
+#endif
 
-	/* Encrypt message using with RC4, result overwrites original buffer */
+	/* Encrypt message using with RC4, the digest is already computed so do it in place */
 	if ((data_buffer->BufferType & SECBUFFER_READONLY) == 0)
 	{
 		if (context->confidentiality)
-			winpr_RC4_Update(context->SendRc4Seal, length, (BYTE*)data,
-			                 (BYTE*)data_buffer->pvBuffer);
-		else
-			CopyMemory(data_buffer->pvBuffer, data, length);
+			winpr_RC4_Update(context->SendRc4Seal, length, data_buffer->pvBuffer,
+			                 data_buffer->pvBuffer);
 	}
 
 #ifdef WITH_DEBUG_NTLM
-	WLog_DBG(TAG, "Data Buffer (length = %" PRIuz ")", length);
-	winpr_HexDump(TAG, WLOG_DEBUG, data, length);
 	WLog_DBG(TAG, "Encrypted Data Buffer (length = %" PRIu32 ")", data_buffer->cbBuffer);
 	winpr_HexDump(TAG, WLOG_DEBUG, data_buffer->pvBuffer, data_buffer->cbBuffer);
 #endif
-	free(data);
 	/* RC4-encrypt first 8 bytes of digest */
 	winpr_RC4_Update(context->SendRc4Seal, 8, digest, checksum);
 	if ((signature_buffer->BufferType & SECBUFFER_READONLY) == 0)
@@ -1145,7 +1151,6 @@ static SECURITY_STATUS SEC_ENTRY ntlm_DecryptMessage(PCtxtHandle phContext, PSec
                                                      WINPR_ATTR_UNUSED PULONG pfQOP)
 {
 	const UINT32 SeqNo = (UINT32)MessageSeqNo;
-	UINT32 value = 0;
 	BYTE digest[WINPR_MD5_DIGEST_LENGTH] = { 0 };
 	BYTE checksum[8] = { 0 };
 	UINT32 version = 1;
@@ -1170,48 +1175,27 @@ static SECURITY_STATUS SEC_ENTRY ntlm_DecryptMessage(PCtxtHandle phContext, PSec
 	if (!signature_buffer)
 		return SEC_E_INVALID_TOKEN;
 
-	/* Copy original data buffer */
 	const ULONG length = data_buffer->cbBuffer;
-	void* data = malloc(length);
-
-	if (!data)
-		return SEC_E_INSUFFICIENT_MEMORY;
 
-	CopyMemory(data, data_buffer->pvBuffer, length);
-
-	/* Decrypt message using with RC4, result overwrites original buffer */
+#ifdef WITH_DEBUG_NTLM
+	WLog_DBG(TAG, "Encrypted Data Buffer (length = %" PRIu32 ")", length);
+	winpr_HexDump(TAG, WLOG_DEBUG, data_buffer->pvBuffer, length);
+#endif
 
+	/* Decrypt message using with RC4 in place */
 	if (context->confidentiality)
-		winpr_RC4_Update(context->RecvRc4Seal, length, (BYTE*)data, (BYTE*)data_buffer->pvBuffer);
-	else
-		CopyMemory(data_buffer->pvBuffer, data, length);
+		winpr_RC4_Update(context->RecvRc4Seal, length, data_buffer->pvBuffer,
+		                 data_buffer->pvBuffer);
 
 	/* Compute the HMAC-MD5 hash of ConcatenationOf(seq_num,data) using the client signing key */
-	WINPR_HMAC_CTX* hmac = winpr_HMAC_New();
-
-	if (hmac &&
-	    winpr_HMAC_Init(hmac, WINPR_MD_MD5, context->RecvSigningKey, WINPR_MD5_DIGEST_LENGTH))
-	{
-		winpr_Data_Write_UINT32(&value, SeqNo);
-		winpr_HMAC_Update(hmac, (void*)&value, 4);
-		winpr_HMAC_Update(hmac, data_buffer->pvBuffer, data_buffer->cbBuffer);
-		winpr_HMAC_Final(hmac, digest, WINPR_MD5_DIGEST_LENGTH);
-		winpr_HMAC_Free(hmac);
-	}
-	else
-	{
-		winpr_HMAC_Free(hmac);
-		free(data);
-		return SEC_E_INSUFFICIENT_MEMORY;
-	}
+	if (!ntlm_compute_message_digest(&context->RecvHmac, context->RecvSigningKey, SeqNo,
+	                                 data_buffer->pvBuffer, length, digest))
+		return SEC_E_INTERNAL_ERROR;
 
 #ifdef WITH_DEBUG_NTLM
-	WLog_DBG(TAG, "Encrypted Data Buffer (length = %" PRIuz ")", length);
-	winpr_HexDump(TAG, WLOG_DEBUG, data, length);
 	WLog_DBG(TAG, "Data Buffer (length = %" PRIu32 ")", data_buffer->cbBuffer);
 	winpr_HexDump(TAG, WLOG_DEBUG, data_buffer->pvBuffer, data_buffer->cbBuffer);
 #endif
-	free(data);
 	/* RC4-encrypt first 8 bytes of digest */
 	winpr_RC4_Update(context->RecvRc4Seal, 8, digest, checksum);
 	/* Concatenate version, ciphertext and sequence number to build signature */
@@ -1261,19 +1245,12 @@ static SECURITY_STATUS SEC_ENTRY ntlm_MakeSignature(PCtxtHandle phContext,
 	if (!data_buffer || !sig_buffer)
 		return SEC_E_INVALID_TOKEN;
 
-	WINPR_HMAC_CTX* hmac = winpr_HMAC_New();
-
-	if (!winpr_HMAC_Init(hmac, WINPR_MD_MD5, context->SendSigningKey, WINPR_MD5_DIGEST_LENGTH))
-	{
-		winpr_HMAC_Free(hmac);
+	if (!ntlm_compute_message_digest(&context->SendHmac, context->SendSigningKey,
+	                                 (UINT32)MessageSeqNo, data_buffer->pvBuffer,
+	                                 data_buffer->cbBuffer, digest))
 		return SEC_E_INTERNAL_ERROR;
-	}
 
 	winpr_Data_Write_UINT32(&seq_no, MessageSeqNo);
-	winpr_HMAC_Update(hmac, (BYTE*)&seq_no, 4);
-	winpr_HMAC_Update(hmac, data_buffer->pvBuffer, data_buffer->cbBuffer);
-	winpr_HMAC_Final(hmac, digest, WINPR_MD5_DIGEST_LENGTH);
-	winpr_HMAC_Free(hmac);
 
 	winpr_RC4_Update(context->SendRc4Seal, 8, digest, checksum);
 
@@ -1312,19 +1289,12 @@ static SECURITY_STATUS SEC_ENTRY ntlm_VerifySignature(PCtxtHandle phContext,
 	if (!data_buffer || !sig_buffer)
 		return SEC_E_INVALID_TOKEN;
 
-	WINPR_HMAC_CTX* hmac = winpr_HMAC_New();
-
-	if (!winpr_HMAC_Init(hmac, WINPR_MD_MD5, context->RecvSigningKey, WINPR_MD5_DIGEST_LENGTH))
-	{
-		winpr_HMAC_Free(hmac);
+	if (!ntlm_compute_message_digest(&context->RecvHmac, context->RecvSigningKey,
+	                                 (UINT32)MessageSeqNo, data_buffer->pvBuffer,
+	                                 data_buffer->cbBuffer, digest))
 		return SEC_E_INTERNAL_ERROR;
-	}
 
 	winpr_Data_Write_UINT32(&seq_no, MessageSeqNo);
-	winpr_HMAC_Update(hmac, (BYTE*)&seq_no, 4);
-	winpr_HMAC_Update(hmac, data_buffer->pvBuffer, data_buffer->cbBuffer);
-	winpr_HMAC_Final(hmac, digest, WINPR_MD5_DIGEST_LENGTH);
-	winpr_HMAC_Free(hmac);
 
 	winpr_RC4_Update(context->RecvRc4Seal, 8, digest, checksum);
 
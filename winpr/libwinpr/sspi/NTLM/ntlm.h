@@ -232,6 +232,8 @@ typedef struct
 	BOOL confidentiality;
 	WINPR_RC4_CTX* SendRc4Seal;
 	WINPR_RC4_CTX* RecvRc4Seal;
+	WINPR_HMAC_CTX* SendHmac;
+	WINPR_HMAC_CTX* RecvHmac;
 	BYTE* SendSigningKey;
 	BYTE* RecvSigningKey;
 	BYTE* SendSealingKey;
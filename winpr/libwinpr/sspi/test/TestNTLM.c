@@ -525,6 +525,50 @@ static void test_ntlm_server_free(TEST_NTLM_SERVER* ntlm)
 	free(ntlm);
 }
 
+static BOOL test_ntlm_seal(TEST_NTLM_CLIENT* client, TEST_NTLM_SERVER* server)
+{
+	WINPR_ASSERT(client);
+	WINPR_ASSERT(server);
+
+	/* Several messages in a row, the contexts keep their state between them */
+	for (ULONG seq = 0; seq < 8; seq++)
+	{
+		BYTE plain[97] = { 0 };
+		BYTE data[sizeof(plain)] = { 0 };
+		BYTE signature[16] = { 0 };
+
+		for (size_t x = 0; x < sizeof(plain); x++)
+			plain[x] = (BYTE)(x * 7 + seq);
+		CopyMemory(data, plain, sizeof(data));
+
+		SecBuffer buffers[2] = { { sizeof(data), SECBUFFER_DATA, data },
+			                     { sizeof(signature), SECBUFFER_TOKEN, signature } };
+		SecBufferDesc desc = { SECBUFFER_VERSION, ARRAYSIZE(buffers), buffers };
+
+		SECURITY_STATUS status = client->table->EncryptMessage(&client->context, 0, &desc, seq);
+		if (status != SEC_E_OK)
+		{
+			printf("EncryptMessage failure %s\n", GetSecurityStatusString(status));
+			return FALSE;
+		}
+
+		status = server->table->DecryptMessage(&server->context, &desc, seq, NULL);
+		if (status != SEC_E_OK)
+		{
+			printf("DecryptMessage failure %s\n", GetSecurityStatusString(status));
+			return FALSE;
+		}
+
+		if (memcmp(data, plain, sizeof(data)) != 0)
+		{
+			printf("DecryptMessage data mismatch\n");
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
 static BOOL test_default(const struct test_input_t* arg)
 {
 	BOOL rc = FALSE;
@@ -753,6 +797,9 @@ static BOOL test_default(const struct test_input_t* arg)
 		goto fail;
 	}
 
+	if (arg->dynamic && !test_ntlm_seal(client, server))
+		goto fail;
+
 	rc = TRUE;
 
 fail:
@@ -20,10 +20,16 @@
 #include <winpr/config.h>
 
 #include <winpr/crt.h>
+#include <winpr/sysinfo.h>
+#include <winpr/thread.h>
 
 #include <winpr/collections.h>
 
 #define MAX(a, b) ((a) > (b)) ? (a) : (b)
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+
+/* upper limit for the number of free lists of a synchronized fixed size pool */
+#define BUFFERPOOL_MAX_SHARDS 16
 
 typedef struct
 {
@@ -31,6 +37,17 @@ typedef struct
 	void* buffer;
 } wBufferPoolItem;
 
+/* A free list of fixed size buffers. Threads are spread over the shards by their thread id,
+ * so that threads working on tiles in parallel rarely contend for the same lock. */
+typedef struct
+{
+	CRITICAL_SECTION lock;
+	SSIZE_T size;
+	SSIZE_T capacity;
+	void** array;
+	BYTE padding[64]; /* keep the shards on separate cache lines */
+} wBufferPoolShard;
+
 struct s_wBufferPool
 {
 	SSIZE_T fixedSize;
@@ -38,9 +55,8 @@ struct s_wBufferPool
 	BOOL synchronized;
 	CRITICAL_SECTION lock;
 
-	SSIZE_T size;
-	SSIZE_T capacity;
-	void** array;
+	size_t nshards;
+	wBufferPoolShard* shards;
 
 	SSIZE_T aSize;
 	SSIZE_T aCapacity;
@@ -51,12 +67,13 @@ struct s_wBufferPool
 	wBufferPoolItem* uArray;
 };
 
+/* fixed size pools lock the shard they use instead of the whole pool */
 static BOOL BufferPool_Lock(wBufferPool* pool)
 {
 	if (!pool)
 		return FALSE;
 
-	if (pool->synchronized)
+	if (pool->synchronized && !pool->fixedSize)
 		EnterCriticalSection(&pool->lock);
 	return TRUE;
 }
@@ -66,11 +83,84 @@ static BOOL BufferPool_Unlock(wBufferPool* pool)
 	if (!pool)
 		return FALSE;
 
-	if (pool->synchronized)
+	if (pool->synchronized && !pool->fixedSize)
 		LeaveCriticalSection(&pool->lock);
 	return TRUE;
 }
 
+static void BufferPool_ShardLock(wBufferPool* pool, wBufferPoolShard* shard)
+{
+	if (pool->synchronized)
+		EnterCriticalSection(&shard->lock);
+}
+
+static void BufferPool_ShardUnlock(wBufferPool* pool, wBufferPoolShard* shard)
+{
+	if (pool->synchronized)
+		LeaveCriticalSection(&shard->lock);
+}
+
+static size_t BufferPool_ShardIndex(const wBufferPool* pool)
+{
+	if (pool->nshards < 2)
+		return 0;
+
+	/* thread ids are often aligned addresses, mix the bits before picking a shard */
+	UINT32 id = GetCurrentThreadId();
+	id ^= id >> 16;
+	id *= 0x45d9f3b;
+	id ^= id >> 16;
+	return id % pool->nshards;
+}
+
+static void* BufferPool_TakeFixed(wBufferPool* pool)
+{
+	const size_t start = BufferPool_ShardIndex(pool);
+
+	/* prefer the shard of the calling thread, take from the others before allocating */
+	for (size_t x = 0; x < pool->nshards; x++)
+	{
+		void* buffer = NULL;
+		wBufferPoolShard* shard = &pool->shards[(start + x) % pool->nshards];
+
+		BufferPool_ShardLock(pool, shard);
+		if (shard->size > 0)
+			buffer = shard->array[--(shard->size)];
+		BufferPool_ShardUnlock(pool, shard);
+
+		if (buffer)
+			return buffer;
+	}
+
+	return NULL;
+}
+
+static BOOL BufferPool_ReturnFixed(wBufferPool* pool, void* buffer)
+{
+	BOOL rc = FALSE;
+	wBufferPoolShard* shard = &pool->shards[BufferPool_ShardIndex(pool)];
+
+	BufferPool_ShardLock(pool, shard);
+
+	if ((shard->size + 1) >= shard->capacity)
+	{
+		SSIZE_T newCapacity = MAX(2, shard->size + (shard->size + 2) / 2 + 1);
+		void** newArray = (void**)realloc(
+		    (void*)shard->array, sizeof(void*) * WINPR_ASSERTING_INT_CAST(size_t, newCapacity));
+		if (!newArray)
+			goto out_error;
+
+		shard->capacity = newCapacity;
+		shard->array = newArray;
+	}
+
+	shard->array[(shard->size)++] = buffer;
+	rc = TRUE;
+out_error:
+	BufferPool_ShardUnlock(pool, shard);
+	return rc;
+}
+
 /**
  * C equivalent of the C# BufferManager Class:
  * http://msdn.microsoft.com/en-us/library/ms405814.aspx
@@ -170,7 +260,14 @@ SSIZE_T BufferPool_GetPoolSize(wBufferPool* pool)
 	if (pool->fixedSize)
 	{
 		/* fixed size buffers */
-		size = pool->size;
+		for (size_t x = 0; x < pool->nshards; x++)
+		{
+			wBufferPoolShard* shard = &pool->shards[x];
+
+			BufferPool_ShardLock(pool, shard);
+			size += shard->size;
+			BufferPool_ShardUnlock(pool, shard);
+		}
 	}
 	else
 	{
@@ -238,8 +335,7 @@ void* BufferPool_Take(wBufferPool* pool, SSIZE_T size)
 	{
 		/* fixed size buffers */
 
-		if (pool->size > 0)
-			buffer = pool->array[--(pool->size)];
+		buffer = BufferPool_TakeFixed(pool);
 
 		if (!buffer)
 		{
@@ -377,19 +473,8 @@ BOOL BufferPool_Return(wBufferPool* pool, void* buffer)
 	{
 		/* fixed size buffers */
 
-		if ((pool->size + 1) >= pool->capacity)
-		{
-			SSIZE_T newCapacity = MAX(2, pool->size + (pool->size + 2) / 2 + 1);
-			void** newArray = (void**)realloc(
-			    (void*)pool->array, sizeof(void*) * WINPR_ASSERTING_INT_CAST(size_t, newCapacity));
-			if (!newArray)
-				goto out_error;
-
-			pool->capacity = newCapacity;
-			pool->array = newArray;
-		}
-
-		pool->array[(pool->size)++] = buffer;
+		if (!BufferPool_ReturnFixed(pool, buffer))
+			goto out_error;
 	}
 	else
 	{
@@ -451,14 +536,21 @@ void BufferPool_Clear(wBufferPool* pool)
 	{
 		/* fixed size buffers */
 
-		while (pool->size > 0)
+		for (size_t x = 0; x < pool->nshards; x++)
 		{
-			(pool->size)--;
+			wBufferPoolShard* shard = &pool->shards[x];
 
-			if (pool->alignment)
-				winpr_aligned_free(pool->array[pool->size]);
-			else
-				free(pool->array[pool->size]);
+			BufferPool_ShardLock(pool, shard);
+			while (shard->size > 0)
+			{
+				(shard->size)--;
+
+				if (pool->alignment)
+					winpr_aligned_free(shard->array[shard->size]);
+				else
+					free(shard->array[shard->size]);
+			}
+			BufferPool_ShardUnlock(pool, shard);
 		}
 	}
 	else
@@ -515,13 +607,32 @@ wBufferPool* BufferPool_New(BOOL synchronized, SSIZE_T fixedSize, DWORD alignmen
 		if (pool->fixedSize)
 		{
 			/* fixed size buffers */
+			size_t nshards = 1;
+			if (pool->synchronized)
+			{
+				SYSTEM_INFO info = { 0 };
+				GetSystemInfo(&info);
+				nshards = MIN(BUFFERPOOL_MAX_SHARDS, MAX(1, info.dwNumberOfProcessors));
+			}
 
-			pool->size = 0;
-			pool->capacity = 32;
-			pool->array =
-			    (void**)calloc(WINPR_ASSERTING_INT_CAST(size_t, pool->capacity), sizeof(void*));
-			if (!pool->array)
+			pool->shards = (wBufferPoolShard*)calloc(nshards, sizeof(wBufferPoolShard));
+			if (!pool->shards)
 				goto out_error;
+			pool->nshards = nshards;
+
+			for (size_t x = 0; pool->synchronized && (x < pool->nshards); x++)
+				InitializeCriticalSectionAndSpinCount(&pool->shards[x].lock, 4000);
+
+			for (size_t x = 0; x < pool->nshards; x++)
+			{
+				wBufferPoolShard* shard = &pool->shards[x];
+
+				shard->capacity = 32;
+				shard->array = (void**)calloc(WINPR_ASSERTING_INT_CAST(size_t, shard->capacity),
+				                              sizeof(void*));
+				if (!shard->array)
+					goto out_error;
+			}
 		}
 		else
 		{
@@ -565,8 +676,15 @@ void BufferPool_Free(wBufferPool* pool)
 		if (pool->fixedSize)
 		{
 			/* fixed size buffers */
+			for (size_t x = 0; x < pool->nshards; x++)
+			{
+				wBufferPoolShard* shard = &pool->shards[x];
 
-			free((void*)pool->array);
+				if (pool->synchronized)
+					DeleteCriticalSection(&shard->lock);
+				free((void*)shard->array);
+			}
+			free(pool->shards);
 		}
 		else
 		{
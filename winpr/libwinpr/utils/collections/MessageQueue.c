@@ -132,6 +132,9 @@ BOOL MessageQueue_Dispatch(wMessageQueue* queue, const wMessage* message)
 	if (!message)
 		return FALSE;
 
+	/* the tick count is a syscall on some platforms, keep it out of the lock */
+	const UINT64 now = GetTickCount64();
+
 	WINPR_ASSERT(queue);
 	EnterCriticalSection(&queue->lock);
 
@@ -143,12 +146,13 @@ BOOL MessageQueue_Dispatch(wMessageQueue* queue, const wMessage* message)
 
 	dst = &(queue->array[queue->tail]);
 	*dst = *message;
-	dst->time = GetTickCount64();
+	dst->time = now;
 
 	queue->tail = (queue->tail + 1) % queue->capacity;
 	queue->size++;
 
-	if (queue->size > 0)
+	/* The event is reset when the queue drains, only signal the transition to non-empty */
+	if (queue->size == 1)
 		(void)SetEvent(queue->event);
 
 	if (message->id == WMQ_QUIT)
@@ -233,6 +237,38 @@ int MessageQueue_Peek(wMessageQueue* queue, wMessage* message, BOOL remove)
 	return status;
 }
 
+size_t MessageQueue_DrainBatch(wMessageQueue* queue, wMessage* messages, size_t count)
+{
+	size_t drained = 0;
+
+	WINPR_ASSERT(queue);
+	WINPR_ASSERT(messages || (count == 0));
+
+	EnterCriticalSection(&queue->lock);
+
+	while ((drained < count) && (queue->size > 0))
+	{
+		wMessage* msg = &(queue->array[queue->head]);
+		const BOOL quit = (msg->id == WMQ_QUIT);
+
+		messages[drained++] = *msg;
+		ZeroMemory(msg, sizeof(wMessage));
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->size--;
+
+		/* WMQ_QUIT always terminates a batch */
+		if (quit)
+			break;
+	}
+
+	if (queue->size < 1)
+		(void)ResetEvent(queue->event);
+
+	LeaveCriticalSection(&queue->lock);
+
+	return drained;
+}
+
 /**
  * Construction, Destruction
  */
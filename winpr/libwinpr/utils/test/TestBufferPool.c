@@ -1,8 +1,98 @@
 
 #include <winpr/crt.h>
 #include <winpr/stream.h>
+#include <winpr/thread.h>
 #include <winpr/collections.h>
 
+#define FIXED_SIZE 4096
+#define FIXED_THREADS 4
+#define FIXED_ROUNDS 1000
+
+static DWORD WINAPI fixed_pool_thread(LPVOID arg)
+{
+	wBufferPool* pool = arg;
+
+	for (size_t x = 0; x < FIXED_ROUNDS; x++)
+	{
+		BYTE* buffers[4] = { 0 };
+
+		for (size_t y = 0; y < ARRAYSIZE(buffers); y++)
+		{
+			buffers[y] = BufferPool_Take(pool, 0);
+			if (!buffers[y])
+				return 1;
+			memset(buffers[y], (int)y, FIXED_SIZE);
+		}
+
+		for (size_t y = 0; y < ARRAYSIZE(buffers); y++)
+		{
+			if (buffers[y][FIXED_SIZE - 1] != y)
+				return 1;
+			if (!BufferPool_Return(pool, buffers[y]))
+				return 1;
+		}
+	}
+	return 0;
+}
+
+static BOOL test_fixed_pool(void)
+{
+	BOOL rc = FALSE;
+	HANDLE threads[FIXED_THREADS] = { 0 };
+	wBufferPool* pool = BufferPool_New(TRUE, FIXED_SIZE, 16);
+	if (!pool)
+		return FALSE;
+
+	void* buffer = BufferPool_Take(pool, 0);
+	if (!buffer || (BufferPool_GetBufferSize(pool, buffer) != FIXED_SIZE))
+		goto fail;
+	if (!BufferPool_Return(pool, buffer) || (BufferPool_GetPoolSize(pool) != 1))
+		goto fail;
+
+	for (size_t x = 0; x < ARRAYSIZE(threads); x++)
+	{
+		threads[x] = CreateThread(NULL, 0, fixed_pool_thread, pool, 0, NULL);
+		if (!threads[x])
+			goto fail;
+	}
+
+	rc = TRUE;
+	for (size_t x = 0; x < ARRAYSIZE(threads); x++)
+	{
+		DWORD status = 1;
+		(void)WaitForSingleObject(threads[x], INFINITE);
+		if (!GetExitCodeThread(threads[x], &status) || (status != 0))
+		{
+			printf("BufferPool fixed size thread %" PRIuz " failed\n", x);
+			rc = FALSE;
+		}
+	}
+
+	/* every buffer is back, at most as many as were in use at the same time */
+	const SSIZE_T size = BufferPool_GetPoolSize(pool);
+	if ((size < 4) || (size > 4 * FIXED_THREADS))
+	{
+		printf("BufferPool_GetPoolSize failure: Actual: %" PRIdz "\n", size);
+		rc = FALSE;
+	}
+
+	BufferPool_Clear(pool);
+	if (BufferPool_GetPoolSize(pool) != 0)
+		rc = FALSE;
+
+fail:
+	for (size_t x = 0; x < ARRAYSIZE(threads); x++)
+	{
+		if (threads[x])
+		{
+			(void)WaitForSingleObject(threads[x], INFINITE);
+			(void)CloseHandle(threads[x]);
+		}
+	}
+	BufferPool_Free(pool);
+	return rc;
+}
+
 int TestBufferPool(int argc, char* argv[])
 {
 	DWORD PoolSize = 0;
@@ -64,5 +154,8 @@ int TestBufferPool(int argc, char* argv[])
 
 	BufferPool_Free(pool);
 
+	if (!test_fixed_pool())
+		return -1;
+
 	return 0;
 }
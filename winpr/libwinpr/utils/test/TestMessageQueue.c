@@ -1,6 +1,7 @@
 
 #include <winpr/crt.h>
 #include <winpr/thread.h>
+#include <winpr/sysinfo.h>
 #include <winpr/collections.h>
 
 static DWORD WINAPI message_queue_consumer_thread(LPVOID arg)
@@ -22,6 +23,181 @@ static DWORD WINAPI message_queue_consumer_thread(LPVOID arg)
 	return 0;
 }
 
+#define TEST_PRODUCERS 4
+#define TEST_MESSAGES_PER_PRODUCER 20000
+
+typedef struct
+{
+	wMessageQueue* queue;
+	UINT32 id;
+} test_producer;
+
+static DWORD WINAPI message_queue_producer_thread(LPVOID arg)
+{
+	const test_producer* producer = (const test_producer*)arg;
+
+	for (size_t x = 0; x < TEST_MESSAGES_PER_PRODUCER; x++)
+	{
+		if (!MessageQueue_Post(producer->queue, NULL, producer->id, (void*)x, NULL))
+			return 1;
+	}
+
+	return 0;
+}
+
+static BOOL test_message_queue_drain_batch(void)
+{
+	BOOL rc = FALSE;
+	size_t total = 0;
+	BOOL quit = FALSE;
+	test_producer producers[TEST_PRODUCERS] = { 0 };
+	size_t next[TEST_PRODUCERS] = { 0 };
+	HANDLE threads[TEST_PRODUCERS] = { 0 };
+	wMessage messages[64] = { 0 };
+
+	wMessageQueue* queue = MessageQueue_New(NULL);
+	if (!queue)
+		return FALSE;
+
+	for (size_t x = 0; x < TEST_PRODUCERS; x++)
+	{
+		producers[x].queue = queue;
+		producers[x].id = (UINT32)x;
+		threads[x] = CreateThread(NULL, 0, message_queue_producer_thread, &producers[x], 0, NULL);
+		if (!threads[x])
+			goto fail;
+	}
+
+	const UINT64 start = GetTickCount64();
+	while (!quit)
+	{
+		if (!MessageQueue_Wait(queue))
+			goto fail;
+
+		const size_t count = MessageQueue_DrainBatch(queue, messages, ARRAYSIZE(messages));
+		for (size_t x = 0; x < count; x++)
+		{
+			const wMessage* msg = &messages[x];
+			if (msg->id == WMQ_QUIT)
+			{
+				/* WMQ_QUIT must terminate the batch */
+				if (x + 1 != count)
+					goto fail;
+				quit = TRUE;
+				break;
+			}
+
+			/* messages of a single producer must arrive in order */
+			const UINT32 y = msg->id;
+			if ((y >= TEST_PRODUCERS) || (next[y] != (size_t)msg->wParam))
+				goto fail;
+			next[y]++;
+			total++;
+		}
+
+		if (!quit && (total == TEST_PRODUCERS * TEST_MESSAGES_PER_PRODUCER))
+		{
+			if (MessageQueue_Size(queue) != 0)
+				goto fail;
+			if (!MessageQueue_PostQuit(queue, 0))
+				goto fail;
+		}
+	}
+
+	printf("drained %" PRIuz " messages from %d producers in %" PRIu64 "ms\n", total,
+	       TEST_PRODUCERS, GetTickCount64() - start);
+	rc = (total == TEST_PRODUCERS * TEST_MESSAGES_PER_PRODUCER);
+
+fail:
+	for (size_t x = 0; x < TEST_PRODUCERS; x++)
+	{
+		if (!threads[x])
+			continue;
+		(void)WaitForSingleObject(threads[x], INFINITE);
+		(void)CloseHandle(threads[x]);
+	}
+	MessageQueue_Free(queue);
+	return rc;
+}
+
+#define TEST_BATCH 8
+#define TEST_SENTINEL 0xDEAD
+
+/* Drains one batch and checks it continues the posted sequence without exceeding the limit */
+static BOOL test_drain_one_batch(wMessageQueue* queue, wMessage* messages, size_t* drained,
+                                 size_t posted)
+{
+	const size_t left = posted - *drained;
+	const size_t expected = (left < TEST_BATCH) ? left : TEST_BATCH;
+
+	messages[TEST_BATCH].id = TEST_SENTINEL;
+	if ((MessageQueue_DrainBatch(queue, messages, TEST_BATCH) != expected) ||
+	    (messages[TEST_BATCH].id != TEST_SENTINEL))
+		return FALSE;
+
+	for (size_t x = 0; x < expected; x++)
+	{
+		if ((messages[x].id != 1) || ((size_t)messages[x].wParam != *drained))
+			return FALSE;
+		(*drained)++;
+	}
+
+	/* the event is signaled as long as messages are left */
+	const DWORD status = WaitForSingleObject(MessageQueue_Event(queue), 0);
+	return (status == WAIT_OBJECT_0) == (*drained < posted);
+}
+
+static BOOL test_message_queue_batch_limit(void)
+{
+	BOOL rc = FALSE;
+	size_t posted = 0;
+	size_t drained = 0;
+	wMessage messages[TEST_BATCH + 1] = { 0 };
+
+	wMessageQueue* queue = MessageQueue_New(NULL);
+	if (!queue)
+		return FALSE;
+
+	if ((MessageQueue_DrainBatch(queue, messages, TEST_BATCH) != 0) ||
+	    (MessageQueue_DrainBatch(queue, NULL, 0) != 0))
+		goto fail;
+
+	/* the consumer lags behind, the ring wraps and grows while batches are taken */
+	for (size_t round = 0; round < 20; round++)
+	{
+		for (size_t x = 0; x < TEST_BATCH + 3; x++)
+		{
+			if (!MessageQueue_Post(queue, NULL, 1, (void*)posted++, NULL))
+				goto fail;
+		}
+
+		if (!test_drain_one_batch(queue, messages, &drained, posted))
+			goto fail;
+	}
+
+	while (drained < posted)
+	{
+		if (!test_drain_one_batch(queue, messages, &drained, posted))
+			goto fail;
+	}
+
+	/* WMQ_QUIT ends the batch even if more messages fit */
+	if (!MessageQueue_Post(queue, NULL, 1, NULL, NULL) || !MessageQueue_PostQuit(queue, 0) ||
+	    MessageQueue_Post(queue, NULL, 1, NULL, NULL))
+		goto fail;
+
+	if ((MessageQueue_DrainBatch(queue, messages, TEST_BATCH) != 2) ||
+	    (messages[1].id != WMQ_QUIT) || (MessageQueue_Size(queue) != 0))
+		goto fail;
+
+	rc = TRUE;
+fail:
+	if (!rc)
+		printf("batch limit: drained %" PRIuz " of %" PRIuz " messages\n", drained, posted);
+	MessageQueue_Free(queue);
+	return rc;
+}
+
 int TestMessageQueue(int argc, char* argv[])
 {
 	HANDLE thread = NULL;
@@ -52,5 +228,17 @@ int TestMessageQueue(int argc, char* argv[])
 	MessageQueue_Free(queue);
 	(void)CloseHandle(thread);
 
+	if (!test_message_queue_drain_batch())
+	{
+		printf("MessageQueue_DrainBatch test failed\n");
+		return -1;
+	}
+
+	if (!test_message_queue_batch_limit())
+	{
+		printf("MessageQueue_DrainBatch batch limit test failed\n");
+		return -1;
+	}
+
 	return 0;
 }